@@ -0,0 +1,82 @@
+#pragma once
+#ifndef __MATHS_ARRAYVIEW_HPP__
+#define __MATHS_ARRAYVIEW_HPP__
+
+#include <cstddef>
+
+namespace Math
+{
+	// Non-owning read only view of contiguous elements, such as an array inside a memory mapped file
+	template <class Type>
+	class ArrayView
+	{
+	public:
+		typedef Type value_type;
+		typedef const Type* const_iterator;
+		typedef const Type* iterator;
+
+	private:
+		const Type* mData;
+		size_t mSize;
+
+	public:
+		ArrayView() : mData(nullptr), mSize(0)
+		{
+		}
+
+		ArrayView(const Type* data, size_t size) : mData(data), mSize(size)
+		{
+		}
+
+		ArrayView(const ArrayView& view) : mData(view.mData), mSize(view.mSize)
+		{
+		}
+
+		ArrayView& operator = (const ArrayView& view)
+		{
+			mData = view.mData;
+			mSize = view.mSize;
+			return *this;
+		}
+
+		size_t size() const
+		{
+			return mSize;
+		}
+
+		bool empty() const
+		{
+			return mSize == 0;
+		}
+
+		const Type* data() const
+		{
+			return mData;
+		}
+
+		const Type& operator [] (size_t index) const
+		{
+			XMASSERT(index < mSize);
+			return mData[index];
+		}
+
+		const Type* begin() const
+		{
+			return mData;
+		}
+
+		const Type* end() const
+		{
+			return mData + mSize;
+		}
+
+		ArrayView sub_view(size_t first, size_t count) const
+		{
+			XMASSERT(first <= mSize && count <= mSize - first);
+			return ArrayView(mData + first, count);
+		}
+	};
+
+} // namespace Math
+
+#endif // __MATHS_ARRAYVIEW_HPP__
@@ -0,0 +1,238 @@
+#include "Precompiled.hpp"
+#include "BinaryArchive.hpp"
+#include "Vector3.hpp"
+#include "Plane.hpp"
+#include "Quaternion.hpp"
+#include "Matrix.hpp"
+#include "BoundingBox.hpp"
+#include "BoundingSphere.hpp"
+
+#include <cstring>
+
+namespace
+{
+	size_t align(size_t offset)
+	{
+		return (offset + Math::ARCHIVE_ALIGNMENT - 1) & ~static_cast<size_t>(Math::ARCHIVE_ALIGNMENT - 1);
+	}
+
+	size_t element_size(Math::ArchiveElement element)
+	{
+		switch (element)
+		{
+		case Math::ARCHIVE_ELEMENT_BYTE: return sizeof(uchar_t);
+		case Math::ARCHIVE_ELEMENT_VECTOR3: return sizeof(Math::Vector3);
+		case Math::ARCHIVE_ELEMENT_BOUNDINGBOX: return sizeof(Math::BoundingBox);
+		case Math::ARCHIVE_ELEMENT_BOUNDINGSPHERE: return sizeof(Math::BoundingSphere);
+		case Math::ARCHIVE_ELEMENT_PLANE: return sizeof(Math::Plane);
+		case Math::ARCHIVE_ELEMENT_MATRIX: return sizeof(Math::Matrix);
+		case Math::ARCHIVE_ELEMENT_QUATERNION: return sizeof(Math::Quaternion);
+		default: return 0;
+		}
+	}
+
+	bool is_finite(FXMVECTOR v)
+	{
+		return !XMVector4IsNaN(v) && !XMVector4IsInfinite(v);
+	}
+
+	bool is_finite3(FXMVECTOR v)
+	{
+		return !XMVector3IsNaN(v) && !XMVector3IsInfinite(v);
+	}
+
+	bool is_unit_length(FXMVECTOR length_squared)
+	{
+		return std::abs(XMVectorGetX(length_squared) - 1.0f) <= Math::UNIT_LENGTH_TOLERANCE;
+	}
+
+	bool is_valid(const Math::Vector3& v)
+	{
+		return is_finite3(v);
+	}
+
+	bool is_valid(const Math::BoundingBox& box)
+	{
+		return is_finite3(box.minimum_corner()) && is_finite3(box.maximum_corner()) && box.minimum_corner() <= box.maximum_corner();
+	}
+
+	bool is_valid(const Math::BoundingSphere& sphere)
+	{
+		return is_finite3(sphere.center()) && std::isfinite(sphere.radius()) && sphere.radius() >= 0.0f;
+	}
+
+	bool is_valid(const Math::Plane& plane)
+	{
+		return is_finite(plane) && plane.is_normalised();
+	}
+
+	bool is_valid(const Math::Matrix& matrix)
+	{
+		return is_finite(matrix.r[0]) && is_finite(matrix.r[1]) && is_finite(matrix.r[2]) && is_finite(matrix.r[3]);
+	}
+
+	bool is_valid(const Math::Quaternion& quaternion)
+	{
+		return is_finite(quaternion) && is_unit_length(XMQuaternionLengthSq(quaternion));
+	}
+
+	template <class Type>
+	bool all_valid(const uchar_t* data, size_t count)
+	{
+		const Type* elements = reinterpret_cast<const Type*>(data);
+		return std::all_of(elements, elements + count, [](const Type& element) { return is_valid(element); });
+	}
+
+	bool validate_elements(Math::ArchiveElement element, const uchar_t* data, size_t count)
+	{
+		switch (element)
+		{
+		case Math::ARCHIVE_ELEMENT_BYTE: return true;
+		case Math::ARCHIVE_ELEMENT_VECTOR3: return all_valid<Math::Vector3>(data, count);
+		case Math::ARCHIVE_ELEMENT_BOUNDINGBOX: return all_valid<Math::BoundingBox>(data, count);
+		case Math::ARCHIVE_ELEMENT_BOUNDINGSPHERE: return all_valid<Math::BoundingSphere>(data, count);
+		case Math::ARCHIVE_ELEMENT_PLANE: return all_valid<Math::Plane>(data, count);
+		case Math::ARCHIVE_ELEMENT_MATRIX: return all_valid<Math::Matrix>(data, count);
+		case Math::ARCHIVE_ELEMENT_QUATERNION: return all_valid<Math::Quaternion>(data, count);
+		default: return false;
+		}
+	}
+}
+
+namespace Math
+{
+	//--------------------------------------------------------------------------
+	// ArchiveWriter
+	//
+
+	size_t ArchiveWriter::size() const
+	{
+		size_t offset = sizeof(ArchiveHeader) + mSections.size() * sizeof(ArchiveSection);
+		for (size_t i = 0; i < mSections.size(); ++i)
+		{
+			offset = ::align(offset) + mSections[i].data.size();
+		}
+		return offset;
+	}
+
+	void ArchiveWriter::write(void* buffer) const
+	{
+		uchar_t* output = static_cast<uchar_t*>(buffer);
+		std::memset(output, 0, size());
+
+		ArchiveHeader header = {};
+		header.magic = ARCHIVE_MAGIC;
+		header.version = ARCHIVE_VERSION;
+		header.section_count = static_cast<uint_t>(mSections.size());
+		std::memcpy(output, &header, sizeof(header));
+
+		size_t offset = sizeof(ArchiveHeader) + mSections.size() * sizeof(ArchiveSection);
+		for (size_t i = 0; i < mSections.size(); ++i)
+		{
+			const Section& source = mSections[i];
+			offset = ::align(offset);
+
+			ArchiveSection section = {};
+			section.element = source.element;
+			section.tag = source.tag;
+			section.element_size = source.element_size;
+			section.offset = offset;
+			section.count = source.count;
+			std::memcpy(output + sizeof(ArchiveHeader) + i * sizeof(ArchiveSection), &section, sizeof(section));
+
+			if (!source.data.empty())
+			{
+				std::memcpy(output + offset, source.data.data(), source.data.size());
+			}
+			offset += source.data.size();
+		}
+	}
+
+	bool ArchiveWriter::save(const wchar_t* path) const
+	{
+		std::vector<uchar_t> buffer(size());
+		write(buffer.data());
+
+		const HANDLE file = CreateFileW(path, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+
+		// WriteFile takes a 32 bit size, so large archives are written in pieces
+		static const size_t MAX_WRITE = 0x40000000;
+		bool success = true;
+		for (size_t written = 0; success && written < buffer.size();)
+		{
+			const DWORD amount = static_cast<DWORD>(std::min(buffer.size() - written, MAX_WRITE));
+			DWORD result = 0;
+			success = WriteFile(file, buffer.data() + written, amount, &result, nullptr) != FALSE && result == amount;
+			written += result;
+		}
+
+		CloseHandle(file);
+		return success;
+	}
+
+	void ArchiveWriter::add_section(ArchiveElement element, uint_t tag, size_t element_size, const void* elements, size_t count)
+	{
+		XMASSERT(element_size == ::element_size(element));
+
+		Section section;
+		section.element = element;
+		section.tag = tag;
+		section.element_size = static_cast<uint_t>(element_size);
+		section.count = count;
+
+		const uchar_t* bytes = static_cast<const uchar_t*>(elements);
+		section.data.assign(bytes, bytes + element_size * count);
+		mSections.push_back(std::move(section));
+	}
+
+	//--------------------------------------------------------------------------
+	// ArchiveReader
+	//
+
+	bool ArchiveReader::open(const void* data, size_t size, bool validate_elements)
+	{
+		close();
+
+		if (data == nullptr || (reinterpret_cast<size_t>(data) & (ARCHIVE_ALIGNMENT - 1)) != 0 || size < sizeof(ArchiveHeader)) return false;
+
+		const uchar_t* bytes = static_cast<const uchar_t*>(data);
+		ArchiveHeader header;
+		std::memcpy(&header, bytes, sizeof(header));
+		if (header.magic != ARCHIVE_MAGIC || header.version != ARCHIVE_VERSION) return false;
+		if (header.section_count > (size - sizeof(ArchiveHeader)) / sizeof(ArchiveSection)) return false;
+
+		const size_t data_start = sizeof(ArchiveHeader) + header.section_count * sizeof(ArchiveSection);
+		const ArchiveSection* sections = reinterpret_cast<const ArchiveSection*>(bytes + sizeof(ArchiveHeader));
+
+		for (uint_t i = 0; i < header.section_count; ++i)
+		{
+			const ArchiveSection& section = sections[i];
+			if (section.element >= ARCHIVE_ELEMENT_COUNT || section.element_size != ::element_size(section.element)) return false;
+			if (section.offset % ARCHIVE_ALIGNMENT != 0 || section.offset < data_start || section.offset > size) return false;
+			if (section.count > (size - section.offset) / section.element_size) return false;
+
+			if (validate_elements && !::validate_elements(section.element, bytes + section.offset, static_cast<size_t>(section.count))) return false;
+		}
+
+		mData = bytes;
+		mSize = size;
+		mSections = sections;
+		mSectionCount = header.section_count;
+		return true;
+	}
+
+	bool ArchiveReader::find_section(uint_t tag, uint_t& index) const
+	{
+		for (uint_t i = 0; i < mSectionCount; ++i)
+		{
+			if (mSections[i].tag == tag)
+			{
+				index = i;
+				return true;
+			}
+		}
+		return false;
+	}
+
+} // namespace Math
@@ -0,0 +1,193 @@
+#pragma once
+#ifndef __MATHS_BINARYARCHIVE_HPP__
+#define __MATHS_BINARYARCHIVE_HPP__
+
+#include "ArrayView.hpp"
+
+#include <vector>
+
+namespace Math
+{
+	class Vector3;
+	class Plane;
+	class Quaternion;
+	class Matrix;
+	class BoundingBox;
+	class BoundingSphere;
+
+	//--------------------------------------------------------------------------
+	// File Layout
+	//
+	// An ArchiveHeader, followed by section_count ArchiveSections, followed by the
+	// data of each section. Every section starts on a 16 byte boundary and holds
+	// the elements exactly as they are laid out in memory, so a reader can use them
+	// in place straight from a memory mapped file.
+	//
+
+	static const uint_t ARCHIVE_MAGIC = 0x4854414D; // "MATH"
+	static const uint_t ARCHIVE_VERSION = 1;
+	static const uint_t ARCHIVE_ALIGNMENT = 16;
+
+	enum ArchiveElement : uint_t
+	{
+		ARCHIVE_ELEMENT_BYTE, // Opaque data, such as a serialized MeshBvh
+		ARCHIVE_ELEMENT_VECTOR3,
+		ARCHIVE_ELEMENT_BOUNDINGBOX,
+		ARCHIVE_ELEMENT_BOUNDINGSPHERE,
+		ARCHIVE_ELEMENT_PLANE,
+		ARCHIVE_ELEMENT_MATRIX,
+		ARCHIVE_ELEMENT_QUATERNION,
+
+		ARCHIVE_ELEMENT_COUNT
+	};
+
+	struct ArchiveHeader
+	{
+		uint_t magic;
+		uint_t version;
+		uint_t section_count;
+		uint_t reserved;
+	};
+
+	struct ArchiveSection
+	{
+		ArchiveElement element;
+		uint_t tag; // Chosen by the writer to identify the section
+		uint_t element_size; // Catches a file written with a different layout of the type
+		uint_t reserved;
+		uint64_t offset; // From the start of the archive
+		uint64_t count;
+	};
+
+	template <class Type> struct ArchiveTraits;
+
+	template <> struct ArchiveTraits<uchar_t> { static const ArchiveElement ELEMENT = ARCHIVE_ELEMENT_BYTE; };
+	template <> struct ArchiveTraits<Vector3> { static const ArchiveElement ELEMENT = ARCHIVE_ELEMENT_VECTOR3; };
+	template <> struct ArchiveTraits<BoundingBox> { static const ArchiveElement ELEMENT = ARCHIVE_ELEMENT_BOUNDINGBOX; };
+	template <> struct ArchiveTraits<BoundingSphere> { static const ArchiveElement ELEMENT = ARCHIVE_ELEMENT_BOUNDINGSPHERE; };
+	template <> struct ArchiveTraits<Plane> { static const ArchiveElement ELEMENT = ARCHIVE_ELEMENT_PLANE; };
+	template <> struct ArchiveTraits<Matrix> { static const ArchiveElement ELEMENT = ARCHIVE_ELEMENT_MATRIX; };
+	template <> struct ArchiveTraits<Quaternion> { static const ArchiveElement ELEMENT = ARCHIVE_ELEMENT_QUATERNION; };
+
+	//--------------------------------------------------------------------------
+	// ArchiveWriter
+	//
+	// Collects copies of the arrays to write, then lays them out in one buffer or file.
+	//
+
+	class ArchiveWriter
+	{
+	private:
+		struct Section
+		{
+			ArchiveElement element;
+			uint_t tag;
+			uint_t element_size;
+			size_t count;
+			std::vector<uchar_t> data;
+		};
+
+		std::vector<Section> mSections;
+
+	public:
+		template <class Type>
+		void add(uint_t tag, const Type* elements, size_t count)
+		{
+			add_section(ArchiveTraits<Type>::ELEMENT, tag, sizeof(Type), elements, count);
+		}
+
+		template <class Type>
+		void add(uint_t tag, const std::vector<Type>& elements)
+		{
+			add(tag, elements.data(), elements.size());
+		}
+
+		void clear()
+		{
+			mSections.clear();
+		}
+
+		size_t size() const;
+
+		// The buffer must be size() bytes long, the padding between sections is zeroed
+		void write(void* buffer) const;
+
+		bool save(const wchar_t* path) const;
+
+	private:
+		void add_section(ArchiveElement element, uint_t tag, size_t element_size, const void* elements, size_t count);
+	};
+
+	//--------------------------------------------------------------------------
+	// ArchiveReader
+	//
+	// Checks an archive once when it is opened, after which its arrays are used in
+	// place without copying or constructing the elements. The data must stay alive
+	// and unchanged while the reader and any views from it are used.
+	//
+
+	class ArchiveReader
+	{
+	private:
+		const uchar_t* mData;
+		size_t mSize;
+		const ArchiveSection* mSections;
+		uint_t mSectionCount;
+
+	public:
+		ArchiveReader() : mData(nullptr), mSize(0), mSections(nullptr), mSectionCount(0)
+		{
+		}
+
+		// Checks the header and that every section lies within the data. With validate_elements it also
+		// checks every element is finite and already in the form its constructors would make it: boxes
+		// with their minimum below their maximum, spheres with a positive radius, and normalised planes
+		// and quaternions. Skipping that is only safe for trusted data, as the elements are used as is.
+		// Returns false, leaving the reader empty, if the archive is not valid.
+		bool open(const void* data, size_t size, bool validate_elements = true);
+
+		void close()
+		{
+			*this = ArchiveReader();
+		}
+
+		bool is_open() const
+		{
+			return mData != nullptr;
+		}
+
+		uint_t section_count() const
+		{
+			return mSectionCount;
+		}
+
+		const ArchiveSection& section(uint_t index) const
+		{
+			XMASSERT(index < mSectionCount);
+			return mSections[index];
+		}
+
+		// Returns false if there is no section with the tag, otherwise the first one is found
+		bool find_section(uint_t tag, uint_t& index) const;
+
+		// An empty view if the section holds a different type
+		template <class Type>
+		ArrayView<Type> get(uint_t index) const
+		{
+			const ArchiveSection& found = section(index);
+			if (found.element != ArchiveTraits<Type>::ELEMENT) return ArrayView<Type>();
+			return ArrayView<Type>(reinterpret_cast<const Type*>(mData + found.offset), static_cast<size_t>(found.count));
+		}
+
+		template <class Type>
+		ArrayView<Type> find(uint_t tag) const
+		{
+			uint_t index;
+			if (!find_section(tag, index)) return ArrayView<Type>();
+			return get<Type>(index);
+		}
+	};
+
+} // namespace Math
+
+#endif // __MATHS_BINARYARCHIVE_HPP__
@@ -1,7 +1,12 @@
 #include "Precompiled.hpp"
 #include "BoundingBox.hpp"
+#include "Matrix.hpp"
+#include "SoaArray.hpp"
 
 #include <algorithm>
+#include <future>
+#include <thread>
+#include <vector>
 
 namespace
 {
@@ -11,6 +16,148 @@ namespace
 		corner = static_cast<Math::BoundingBox::BoxCorner>(corner + 1); 
 		return old_corner;
 	}
+
+	// Below this many elements per thread it costs more to start a thread than to do the work
+	const size_t MINIMUM_ELEMENTS_PER_THREAD = 64 * 1024;
+
+	struct Bounds
+	{
+		XMVECTOR minimum;
+		XMVECTOR maximum;
+	};
+
+	Bounds empty_bounds()
+	{
+		const Bounds bounds = { XMVectorSplatInfinity(), XMVectorNegate(XMVectorSplatInfinity()) };
+		return bounds;
+	}
+
+	Bounds combine(const Bounds& a, const Bounds& b)
+	{
+		const Bounds bounds = { XMVectorMin(a.minimum, b.minimum), XMVectorMax(a.maximum, b.maximum) };
+		return bounds;
+	}
+
+	// Minimum of the four lanes, replicated into all lanes
+	XMVECTOR horizontal_min(FXMVECTOR v)
+	{
+		const XMVECTOR pairs = XMVectorMin(v, XMVectorSwizzle(v, 2, 3, 0, 1));
+		return XMVectorMin(pairs, XMVectorSwizzle(pairs, 1, 0, 3, 2));
+	}
+
+	XMVECTOR horizontal_max(FXMVECTOR v)
+	{
+		const XMVECTOR pairs = XMVectorMax(v, XMVectorSwizzle(v, 2, 3, 0, 1));
+		return XMVectorMax(pairs, XMVectorSwizzle(pairs, 1, 0, 3, 2));
+	}
+
+	XMVECTOR load_point(const uchar_t* positions, size_t stride, size_t index)
+	{
+		return XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(positions + index * stride));
+	}
+
+	// The reductions keep four independent accumulators so that consecutive min/max instructions do not
+	// have to wait on each other's results
+	Bounds reduce_points(const uchar_t* positions, size_t stride, size_t first, size_t last)
+	{
+		Bounds bounds[4] = { empty_bounds(), empty_bounds(), empty_bounds(), empty_bounds() };
+
+		size_t i = first;
+		for (; i + 4 <= last; i += 4)
+		{
+			for (uint_t j = 0; j < 4; ++j)
+			{
+				const XMVECTOR point = load_point(positions, stride, i + j);
+				bounds[j].minimum = XMVectorMin(bounds[j].minimum, point);
+				bounds[j].maximum = XMVectorMax(bounds[j].maximum, point);
+			}
+		}
+		for (; i < last; ++i)
+		{
+			const XMVECTOR point = load_point(positions, stride, i);
+			bounds[0].minimum = XMVectorMin(bounds[0].minimum, point);
+			bounds[0].maximum = XMVectorMax(bounds[0].maximum, point);
+		}
+
+		return combine(combine(bounds[0], bounds[1]), combine(bounds[2], bounds[3]));
+	}
+
+	Bounds reduce_boxes(const Math::BoundingBox* boxes, size_t first, size_t last)
+	{
+		Bounds bounds[4] = { empty_bounds(), empty_bounds(), empty_bounds(), empty_bounds() };
+
+		size_t i = first;
+		for (; i + 4 <= last; i += 4)
+		{
+			for (uint_t j = 0; j < 4; ++j)
+			{
+				bounds[j].minimum = XMVectorMin(bounds[j].minimum, boxes[i + j].minimum_corner());
+				bounds[j].maximum = XMVectorMax(bounds[j].maximum, boxes[i + j].maximum_corner());
+			}
+		}
+		for (; i < last; ++i)
+		{
+			bounds[0].minimum = XMVectorMin(bounds[0].minimum, boxes[i].minimum_corner());
+			bounds[0].maximum = XMVectorMax(bounds[0].maximum, boxes[i].maximum_corner());
+		}
+
+		return combine(combine(bounds[0], bounds[1]), combine(bounds[2], bounds[3]));
+	}
+
+	// Splits [0, count) into one range per thread, reduces them concurrently and combines the results
+	template <class Reduce>
+	Bounds reduce_parallel(size_t count, uint_t thread_count, Reduce reduce)
+	{
+		if (thread_count == 0)
+		{
+			thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+		}
+
+		const size_t useful_threads = std::max<size_t>(count / MINIMUM_ELEMENTS_PER_THREAD, 1);
+		const size_t threads = std::min<size_t>(thread_count, useful_threads);
+		if (threads == 1)
+		{
+			return reduce(0, count);
+		}
+
+		const size_t range = (count + threads - 1) / threads;
+		std::vector<std::future<Bounds>> results;
+		for (size_t first = range; first < count; first += range)
+		{
+			results.push_back(std::async(std::launch::async, reduce, first, std::min(first + range, count)));
+		}
+
+		// This thread does the first range while waiting for the others
+		Bounds bounds = reduce(0, range);
+		for (auto& result : results)
+		{
+			bounds = combine(bounds, result.get());
+		}
+		return bounds;
+	}
+
+	Math::BoundingBox make_box(const Bounds& bounds)
+	{
+		return Math::BoundingBox(Math::Vector3(bounds.minimum), Math::Vector3(bounds.maximum), Math::ALREADY_SORTED);
+	}
+
+	// The upper 3x3 of the matrix with every element made positive
+	Math::Matrix absolute_rotation(const Math::Matrix& matrix)
+	{
+		return Math::Matrix(XMVectorAbs(matrix.r[0]), XMVectorAbs(matrix.r[1]), XMVectorAbs(matrix.r[2]), XMVectorZero());
+	}
+
+	// Arvo's method with the box as a center and extents: the center is transformed as a point and each new
+	// extent is the sum of the old extents projected through the absolute rotation and scale
+	Math::BoundingBox transform_box(const Math::BoundingBox& box, const Math::Matrix& matrix, const Math::Matrix& absolute)
+	{
+		const XMVECTOR minimum = box.minimum_corner();
+		const XMVECTOR maximum = box.maximum_corner();
+		const XMVECTOR half = XMVectorReplicate(0.5f);
+		const XMVECTOR center = XMVector3Transform(XMVectorMultiply(XMVectorAdd(minimum, maximum), half), matrix);
+		const XMVECTOR extents = XMVector3TransformNormal(XMVectorMultiply(XMVectorSubtract(maximum, minimum), half), absolute);
+		return Math::BoundingBox(Math::Vector3(XMVectorSubtract(center, extents)), Math::Vector3(XMVectorAdd(center, extents)), Math::ALREADY_SORTED);
+	}
 }
 
 namespace Math
@@ -57,8 +204,157 @@ namespace Math
 		return result;
 	}
 
+	BoundingBox BoundingBox::transform(const Matrix& matrix) const
+	{
+		return transform_box(*this, matrix, absolute_rotation(matrix));
+	}
+
+	void BoundingBox::transform(const BoundingBox* boxes, size_t count, const Matrix& matrix, BoundingBox* output)
+	{
+		const Matrix absolute = absolute_rotation(matrix);
+		for (size_t i = 0; i < count; ++i)
+		{
+			output[i] = transform_box(boxes[i], matrix, absolute);
+		}
+	}
+
+	void BoundingBox::transform(const BoundingBox* boxes, const Matrix* matrices, size_t count, BoundingBox* output)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			output[i] = transform_box(boxes[i], matrices[i], absolute_rotation(matrices[i]));
+		}
+	}
+
+	void BoundingBox::transform(const SoaView<BoundingBox>& boxes, const Matrix& matrix, SoaArray<BoundingBox>& output)
+	{
+		typedef SoaTraits<BoundingBox> Traits;
+
+		// Four boxes at a time, with each matrix element replicated across the lanes
+		XMVECTOR m[4][3];
+		XMVECTOR a[3][3];
+		for (uint_t row = 0; row < 4; ++row)
+		{
+			for (uint_t column = 0; column < 3; ++column)
+			{
+				m[row][column] = XMVectorReplicate(matrix(row, column));
+				if (row < 3)
+				{
+					a[row][column] = XMVectorReplicate(std::abs(matrix(row, column)));
+				}
+			}
+		}
+
+		output.resize(boxes.size());
+		const XMVECTOR half = XMVectorReplicate(0.5f);
+
+		for (size_t block = 0; block < boxes.block_count(); ++block)
+		{
+			const SoaBlock<BoundingBox> box = boxes.load_block(block);
+			const XMVECTOR center[3] =
+			{
+				XMVectorMultiply(XMVectorAdd(box[Traits::MIN_X], box[Traits::MAX_X]), half),
+				XMVectorMultiply(XMVectorAdd(box[Traits::MIN_Y], box[Traits::MAX_Y]), half),
+				XMVectorMultiply(XMVectorAdd(box[Traits::MIN_Z], box[Traits::MAX_Z]), half)
+			};
+			const XMVECTOR extents[3] =
+			{
+				XMVectorMultiply(XMVectorSubtract(box[Traits::MAX_X], box[Traits::MIN_X]), half),
+				XMVectorMultiply(XMVectorSubtract(box[Traits::MAX_Y], box[Traits::MIN_Y]), half),
+				XMVectorMultiply(XMVectorSubtract(box[Traits::MAX_Z], box[Traits::MIN_Z]), half)
+			};
+
+			SoaBlock<BoundingBox> result;
+			for (uint_t axis = 0; axis < 3; ++axis)
+			{
+				const XMVECTOR new_center = XMVectorMultiplyAdd(center[2], m[2][axis], XMVectorMultiplyAdd(center[1], m[1][axis], XMVectorMultiplyAdd(center[0], m[0][axis], m[3][axis])));
+				const XMVECTOR new_extents = XMVectorMultiplyAdd(extents[2], a[2][axis], XMVectorMultiplyAdd(extents[1], a[1][axis], XMVectorMultiply(extents[0], a[0][axis])));
+				result[Traits::MIN_X + axis] = XMVectorSubtract(new_center, new_extents);
+				result[Traits::MAX_X + axis] = XMVectorAdd(new_center, new_extents);
+			}
+			output.store_block(block, result);
+		}
+
+		output.pad_last_block();
+	}
+
 	BoundingBox BoundingBox::compute_containing_box(const BoundingBox& a, const BoundingBox& b)
 	{
-		return BoundingBox(Vector3::minimise(a.minimum_corner(), b.minimum_corner()), Vector3::maximise(a.maximum_corner(), b.maximum_corner()));
+		return BoundingBox(Vector3::minimise(a.minimum_corner(), b.minimum_corner()), Vector3::maximise(a.maximum_corner(), b.maximum_corner()), ALREADY_SORTED);
+	}
+
+	BoundingBox BoundingBox::compute_containing_box(const BoundingBox* boxes, size_t count, uint_t thread_count)
+	{
+		if (count == 0) return BoundingBox();
+
+		return make_box(reduce_parallel(count, thread_count, [boxes](size_t first, size_t last) { return reduce_boxes(boxes, first, last); }));
+	}
+
+	BoundingBox BoundingBox::compute_containing_box(const SoaView<BoundingBox>& boxes)
+	{
+		typedef SoaTraits<BoundingBox> Traits;
+
+		if (boxes.empty()) return BoundingBox();
+
+		// The padding lanes repeat the last box so whole blocks can be reduced
+		Bounds x = empty_bounds();
+		Bounds y = empty_bounds();
+		Bounds z = empty_bounds();
+
+		for (size_t block = 0; block < boxes.block_count(); ++block)
+		{
+			x.minimum = XMVectorMin(x.minimum, boxes.load(Traits::MIN_X, block));
+			y.minimum = XMVectorMin(y.minimum, boxes.load(Traits::MIN_Y, block));
+			z.minimum = XMVectorMin(z.minimum, boxes.load(Traits::MIN_Z, block));
+			x.maximum = XMVectorMax(x.maximum, boxes.load(Traits::MAX_X, block));
+			y.maximum = XMVectorMax(y.maximum, boxes.load(Traits::MAX_Y, block));
+			z.maximum = XMVectorMax(z.maximum, boxes.load(Traits::MAX_Z, block));
+		}
+
+		const Vector3 minimum(XMVectorGetX(horizontal_min(x.minimum)), XMVectorGetX(horizontal_min(y.minimum)), XMVectorGetX(horizontal_min(z.minimum)));
+		const Vector3 maximum(XMVectorGetX(horizontal_max(x.maximum)), XMVectorGetX(horizontal_max(y.maximum)), XMVectorGetX(horizontal_max(z.maximum)));
+		return BoundingBox(minimum, maximum, ALREADY_SORTED);
+	}
+
+	BoundingBox BoundingBox::compute_from_points(const Vector3* points, size_t count, uint_t thread_count)
+	{
+		return compute_from_vertices(points, sizeof(Vector3), count, thread_count);
+	}
+
+	BoundingBox BoundingBox::compute_from_vertices(const void* vertices, size_t stride, size_t count, uint_t thread_count)
+	{
+		if (count == 0) return BoundingBox();
+
+		const uchar_t* bytes = static_cast<const uchar_t*>(vertices);
+		return make_box(reduce_parallel(count, thread_count, [bytes, stride](size_t first, size_t last) { return reduce_points(bytes, stride, first, last); }));
+	}
+
+	BoundingBox BoundingBox::compute_from_points(const SoaView<Vector3>& points)
+	{
+		typedef SoaTraits<Vector3> Traits;
+
+		if (points.empty()) return BoundingBox();
+
+		// The padding lanes repeat the last point so whole blocks can be reduced
+		Bounds x = empty_bounds();
+		Bounds y = empty_bounds();
+		Bounds z = empty_bounds();
+
+		for (size_t block = 0; block < points.block_count(); ++block)
+		{
+			const XMVECTOR px = points.load(Traits::X, block);
+			const XMVECTOR py = points.load(Traits::Y, block);
+			const XMVECTOR pz = points.load(Traits::Z, block);
+			x.minimum = XMVectorMin(x.minimum, px);
+			y.minimum = XMVectorMin(y.minimum, py);
+			z.minimum = XMVectorMin(z.minimum, pz);
+			x.maximum = XMVectorMax(x.maximum, px);
+			y.maximum = XMVectorMax(y.maximum, py);
+			z.maximum = XMVectorMax(z.maximum, pz);
+		}
+
+		const Vector3 minimum(XMVectorGetX(horizontal_min(x.minimum)), XMVectorGetX(horizontal_min(y.minimum)), XMVectorGetX(horizontal_min(z.minimum)));
+		const Vector3 maximum(XMVectorGetX(horizontal_max(x.maximum)), XMVectorGetX(horizontal_max(y.maximum)), XMVectorGetX(horizontal_max(z.maximum)));
+		return BoundingBox(minimum, maximum, ALREADY_SORTED);
 	}
 }
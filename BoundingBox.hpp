@@ -3,15 +3,18 @@
 #define __BOUNDINGBOX_HPP__
 
 #include "Vector3.hpp"
+#include "Trusted.hpp"
 
 #include <type_traits>
 #include <iterator>
-#include <numeric>
-#include <functional>
 #include <array>
 
 namespace Math
 {
+	class Matrix;
+	template <class Type> struct SoaTraits;
+	template <class Type> class SoaView;
+	template <class Type> class SoaArray;
 
 	class BoundingBox
 	{
@@ -43,6 +46,11 @@ namespace Math
 
 		BoundingBox(const Vector3& minimum, const Vector3& maximum);
 
+		BoundingBox(const Vector3& minimum, const Vector3& maximum, AlreadySorted) : mMinimum(minimum), mMaximum(maximum)
+		{
+			XMASSERT(minimum <= maximum);
+		}
+
 		BoundingBox(const BoundingBox& box) : mMinimum(box.mMinimum), mMaximum(box.mMaximum)
 		{
 		}
@@ -85,6 +93,13 @@ namespace Math
 
 		void set(const Vector3& minimum, const Vector3& maximum);
 
+		void set(const Vector3& minimum, const Vector3& maximum, AlreadySorted)
+		{
+			XMASSERT(minimum <= maximum);
+			mMinimum = minimum;
+			mMaximum = maximum;
+		}
+
 		const Vector3& minimum_corner() const
 		{
 			return mMinimum;
@@ -95,6 +110,17 @@ namespace Math
 			return mMaximum;
 		}
 
+		Vector3 center() const
+		{
+			return Vector3::lerp(mMinimum, mMaximum, 0.5f);
+		}
+
+		// Half the size of the box along each axis
+		Vector3 extents() const
+		{
+			return (mMaximum - mMinimum) * 0.5f;
+		}
+
 		Vector3 get_corner(BoxCorner corner) const;
 
 		CornerArray get_all_corners() const;
@@ -103,6 +129,17 @@ namespace Math
 		// Computation
 		//
 
+		// The axis aligned box containing this box after it is transformed (Arvo's method)
+		BoundingBox transform(const Matrix& matrix) const;
+
+		// Transforms every box by the same matrix, output may be the same array as boxes
+		static void transform(const BoundingBox* boxes, size_t count, const Matrix& matrix, BoundingBox* output);
+
+		// Transforms each box by its own matrix, output may be the same array as boxes
+		static void transform(const BoundingBox* boxes, const Matrix* matrices, size_t count, BoundingBox* output);
+
+		static void transform(const SoaView<BoundingBox>& boxes, const Matrix& matrix, SoaArray<BoundingBox>& output);
+
 		static BoundingBox compute_containing_box(const BoundingBox& a, const BoundingBox& b);
 
 		template <class Iterator>
@@ -111,12 +148,83 @@ namespace Math
 		{
 			if (begin != end)
 			{
-				BoundingBox bounds = *begin++;
-				return std::accumulate(begin, end, bounds, std::ptr_fun(&compute_containing_box));
+				XMVECTOR minimum = begin->minimum_corner();
+				XMVECTOR maximum = begin->maximum_corner();
+				for (++begin; begin != end; ++begin)
+				{
+					minimum = XMVectorMin(minimum, begin->minimum_corner());
+					maximum = XMVectorMax(maximum, begin->maximum_corner());
+				}
+				return BoundingBox(Vector3(minimum), Vector3(maximum), ALREADY_SORTED);
 			}
 
 			return BoundingBox();
 		}
+
+		// A thread_count of 0 uses all hardware threads, large inputs are split between the threads
+		static BoundingBox compute_containing_box(const BoundingBox* boxes, size_t count, uint_t thread_count = 1);
+
+		static BoundingBox compute_containing_box(const SoaView<BoundingBox>& boxes);
+
+		static BoundingBox compute_from_points(const Vector3* points, size_t count, uint_t thread_count = 1);
+
+		// For positions at the start of each vertex in a vertex buffer, where each vertex is stride bytes after the previous one
+		static BoundingBox compute_from_vertices(const void* vertices, size_t stride, size_t count, uint_t thread_count = 1);
+
+		static BoundingBox compute_from_points(const SoaView<Vector3>& points);
+
+		template <class Iterator>
+		typename std::enable_if<std::is_same<typename std::iterator_traits<Iterator>::value_type, Vector3>::value, BoundingBox>::type 
+			static compute_from_points(Iterator begin, Iterator end)
+		{
+			if (begin != end)
+			{
+				XMVECTOR minimum = *begin;
+				XMVECTOR maximum = minimum;
+				for (++begin; begin != end; ++begin)
+				{
+					const XMVECTOR point = *begin;
+					minimum = XMVectorMin(minimum, point);
+					maximum = XMVectorMax(maximum, point);
+				}
+				return BoundingBox(Vector3(minimum), Vector3(maximum), ALREADY_SORTED);
+			}
+
+			return BoundingBox();
+		}
+	};
+
+	// Component layout of an SoaArray<BoundingBox>
+	template <> struct SoaTraits<BoundingBox>
+	{
+		enum Component : uint_t
+		{
+			MIN_X,
+			MIN_Y,
+			MIN_Z,
+			MAX_X,
+			MAX_Y,
+			MAX_Z,
+
+			COMPONENT_COUNT
+		};
+
+		static void scatter(const BoundingBox& box, float* components)
+		{
+			const Vector3& minimum = box.minimum_corner();
+			const Vector3& maximum = box.maximum_corner();
+			components[MIN_X] = minimum.x;
+			components[MIN_Y] = minimum.y;
+			components[MIN_Z] = minimum.z;
+			components[MAX_X] = maximum.x;
+			components[MAX_Y] = maximum.y;
+			components[MAX_Z] = maximum.z;
+		}
+
+		static BoundingBox gather(const float* components)
+		{
+			return BoundingBox(Vector3(components[MIN_X], components[MIN_Y], components[MIN_Z]), Vector3(components[MAX_X], components[MAX_Y], components[MAX_Z]), ALREADY_SORTED);
+		}
 	};
 
 } // namespace Math
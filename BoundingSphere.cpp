@@ -1,27 +1,404 @@
 #include "Precompiled.hpp"
 #include "BoundingSphere.hpp"
-#include "Intersect.hpp"
-#include "Line.hpp"
+#include "Matrix.hpp"
+#include "SoaArray.hpp"
+
+#include <random>
+
+namespace
+{
+	// Directions used to find extremal points, stored as groups of four directions with their x, y and z components
+	// in separate vectors so that a point is projected onto four directions at once.
+	// Group 0 holds the axes then (1, 1, 1), group 1 the other corner diagonals then the edge diagonals follow,
+	// with the unused slots of the last group repeating the X axis.
+	const uint_t DIRECTION_GROUP_COUNT = 4;
+
+	const XMVECTORF32 DIRECTIONS[DIRECTION_GROUP_COUNT][3] =
+	{
+		{ { 1.0f, 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, 1.0f, 1.0f } },
+		{ { 1.0f, 1.0f, 1.0f, 1.0f }, { 1.0f, -1.0f, -1.0f, 1.0f }, { -1.0f, 1.0f, -1.0f, 0.0f } },
+		{ { 1.0f, 1.0f, 1.0f, 0.0f }, { -1.0f, 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, -1.0f, 1.0f } },
+		{ { 0.0f, 1.0f, 1.0f, 1.0f }, { 1.0f, 0.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f, 0.0f } }
+	};
+
+	// Relative tolerance used when testing if a point is inside a sphere, so that points on the surface are not
+	// seen as outside due to rounding (which would make Welzl's algorithm keep rebuilding the same sphere)
+	const float CONTAINMENT_TOLERANCE = 1.0e-5f;
+
+	XMVECTOR load_point(const uchar_t* positions, size_t stride, size_t index)
+	{
+		return XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(positions + index * stride));
+	}
+
+	bool encloses(const Math::BoundingSphere& sphere, const Math::Vector3& point)
+	{
+		const float radius_squared = sphere.radius() * sphere.radius();
+		return Math::Vector3(point - sphere.center()).length_squared() <= radius_squared + radius_squared * CONTAINMENT_TOLERANCE;
+	}
+
+	// Finds the index of the point with the smallest and largest projection onto each direction
+	void find_extremal_points(const uchar_t* positions, size_t stride, size_t count, uint_t group_count, uint_t* minimum_index, uint_t* maximum_index)
+	{
+		XMVECTOR minimum_projection[DIRECTION_GROUP_COUNT];
+		XMVECTOR maximum_projection[DIRECTION_GROUP_COUNT];
+		XMVECTOR minimum_indices[DIRECTION_GROUP_COUNT];
+		XMVECTOR maximum_indices[DIRECTION_GROUP_COUNT];
+
+		for (uint_t group = 0; group < group_count; ++group)
+		{
+			minimum_projection[group] = XMVectorSplatInfinity();
+			maximum_projection[group] = XMVectorNegate(XMVectorSplatInfinity());
+			minimum_indices[group] = XMVectorZero();
+			maximum_indices[group] = XMVectorZero();
+		}
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			const XMVECTOR point = load_point(positions, stride, i);
+			const XMVECTOR x = XMVectorSplatX(point);
+			const XMVECTOR y = XMVectorSplatY(point);
+			const XMVECTOR z = XMVectorSplatZ(point);
+			const XMVECTOR index = XMVectorReplicateInt(static_cast<uint_t>(i));
+
+			for (uint_t group = 0; group < group_count; ++group)
+			{
+				const XMVECTOR projection = XMVectorMultiplyAdd(z, DIRECTIONS[group][2], XMVectorMultiplyAdd(y, DIRECTIONS[group][1], XMVectorMultiply(x, DIRECTIONS[group][0])));
+				const XMVECTOR less = XMVectorLess(projection, minimum_projection[group]);
+				const XMVECTOR greater = XMVectorGreater(projection, maximum_projection[group]);
+
+				minimum_projection[group] = XMVectorSelect(minimum_projection[group], projection, less);
+				minimum_indices[group] = XMVectorSelect(minimum_indices[group], index, less);
+				maximum_projection[group] = XMVectorSelect(maximum_projection[group], projection, greater);
+				maximum_indices[group] = XMVectorSelect(maximum_indices[group], index, greater);
+			}
+		}
+
+		for (uint_t group = 0; group < group_count; ++group)
+		{
+			XMStoreInt4(minimum_index + group * 4, minimum_indices[group]);
+			XMStoreInt4(maximum_index + group * 4, maximum_indices[group]);
+		}
+	}
+
+	Math::BoundingSphere sphere_from_points(const Math::Vector3& a, const Math::Vector3& b)
+	{
+		return Math::BoundingSphere((a + b) * 0.5f, Math::Vector3(b - a).length() * 0.5f);
+	}
+
+	Math::BoundingSphere sphere_from_points(const Math::Vector3& a, const Math::Vector3& b, const Math::Vector3& c)
+	{
+		const Math::Vector3 ab = b - a;
+		const Math::Vector3 ac = c - a;
+		const Math::Vector3 normal = ab.cross(ac);
+		const float denominator = 2.0f * normal.length_squared();
+
+		// Collinear points, so the sphere is defined by the two furthest apart. The test is relative to the lengths of
+		// the sides so that small triangles are not mistaken for collinear ones.
+		if (denominator <= FLT_EPSILON * ab.length_squared() * ac.length_squared())
+		{
+			const float bc_squared = Math::Vector3(c - b).length_squared();
+			if (ab.length_squared() >= ac.length_squared())
+			{
+				return (ab.length_squared() >= bc_squared) ? sphere_from_points(a, b) : sphere_from_points(b, c);
+			}
+			return (ac.length_squared() >= bc_squared) ? sphere_from_points(a, c) : sphere_from_points(b, c);
+		}
+
+		const Math::Vector3 offset = (normal.cross(ab) * ac.length_squared() + ac.cross(normal) * ab.length_squared()) / denominator;
+		return Math::BoundingSphere(a + offset, offset.length());
+	}
+
+	Math::BoundingSphere sphere_from_points(const Math::Vector3& a, const Math::Vector3& b, const Math::Vector3& c, const Math::Vector3& d)
+	{
+		const Math::Vector3 ab = b - a;
+		const Math::Vector3 ac = c - a;
+		const Math::Vector3 ad = d - a;
+		const float denominator = 2.0f * ab.dot(ac.cross(ad));
+
+		// Coplanar points, so use the circle through three of them and grow it to reach the fourth. As for three points
+		// the test is relative to the lengths of the edges.
+		if (std::abs(denominator) <= FLT_EPSILON * ab.length() * ac.length() * ad.length())
+		{
+			const Math::BoundingSphere sphere = sphere_from_points(a, b, c);
+			return Math::BoundingSphere::compute_containing_sphere(sphere, Math::BoundingSphere(d, 0.0f));
+		}
+
+		const Math::Vector3 offset = (ac.cross(ad) * ab.length_squared() + ad.cross(ab) * ac.length_squared() + ab.cross(ac) * ad.length_squared()) / denominator;
+		return Math::BoundingSphere(a + offset, offset.length());
+	}
+
+	// Smallest sphere with all the support points on its surface
+	Math::BoundingSphere sphere_from_support(const Math::Vector3* support, uint_t count)
+	{
+		switch (count)
+		{
+		case 1: return Math::BoundingSphere(support[0], 0.0f);
+		case 2: return sphere_from_points(support[0], support[1]);
+		case 3: return sphere_from_points(support[0], support[1], support[2]);
+		case 4: return sphere_from_points(support[0], support[1], support[2], support[3]);
+		}
+
+		return Math::BoundingSphere();
+	}
+
+	// Welzl's algorithm with the move to front heuristic, the recursion is never deeper than the four support points
+	Math::BoundingSphere welzl(std::vector<Math::Vector3>& points, size_t end, Math::Vector3* support, uint_t support_count)
+	{
+		Math::BoundingSphere sphere = sphere_from_support(support, support_count);
+		if (support_count == 4) return sphere;
+
+		for (size_t i = 0; i < end; ++i)
+		{
+			if (support_count == 0 && i == 0)
+			{
+				sphere = Math::BoundingSphere(points[0], 0.0f);
+			}
+			else if (!encloses(sphere, points[i]))
+			{
+				support[support_count] = points[i];
+				sphere = welzl(points, i, support, support_count + 1);
+				std::rotate(points.begin(), points.begin() + i, points.begin() + i + 1);
+			}
+		}
+
+		return sphere;
+	}
+
+	// Second pass of Ritter's method, each point outside the sphere moves and grows it just enough to include the point
+	Math::BoundingSphere grow_to_fit(const Math::BoundingSphere& sphere, const uchar_t* positions, size_t stride, size_t count)
+	{
+		XMVECTOR center = sphere.center();
+		float radius = sphere.radius();
+		float radius_squared = radius * radius;
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			const XMVECTOR offset = XMVectorSubtract(load_point(positions, stride, i), center);
+			const float distance_squared = XMVectorGetX(XMVector3LengthSq(offset));
+
+			if (distance_squared > radius_squared)
+			{
+				const float distance = std::sqrt(distance_squared);
+				const float new_radius = (radius + distance) * 0.5f;
+				center = XMVectorAdd(center, XMVectorScale(offset, (new_radius - radius) / distance));
+				radius = new_radius;
+				radius_squared = radius * radius;
+			}
+		}
+
+		return Math::BoundingSphere(Math::Vector3(center), radius);
+	}
+
+	// Length of the longest transformed axis, which bounds how much the matrix can stretch a radius
+	// The largest sum of the absolute dot products of one of the first three rows with each of them
+	float largest_row_sum(CXMMATRIX matrix)
+	{
+		float largest = 0.0f;
+		for (uint_t i = 0; i < 3; ++i)
+		{
+			const XMVECTOR sum = XMVectorAdd(XMVectorAbs(XMVector3Dot(matrix.r[i], matrix.r[0])), XMVectorAdd(XMVectorAbs(XMVector3Dot(matrix.r[i], matrix.r[1])), XMVectorAbs(XMVector3Dot(matrix.r[i], matrix.r[2]))));
+			largest = std::max(largest, XMVectorGetX(sum));
+		}
+		return largest;
+	}
+
+	// An upper bound on how far the matrix stretches any direction, its largest singular value. The squared singular
+	// values are the eigenvalues of the matrix times its transpose, and of the transpose times the matrix, and no
+	// eigenvalue is more than the largest absolute row sum of either (Gershgorin). The first is exact when the rows are
+	// orthogonal (scaling then rotating) and the second when the columns are (rotating then scaling).
+	float maximum_scale(const Math::Matrix& matrix)
+	{
+		return std::sqrt(std::min(::largest_row_sum(matrix), ::largest_row_sum(XMMatrixTranspose(matrix))));
+	}
+
+	Math::BoundingSphere transform_sphere(const Math::BoundingSphere& sphere, const Math::Matrix& matrix, float scale)
+	{
+		return Math::BoundingSphere(Math::Vector3(XMVector3Transform(sphere.center(), matrix)), sphere.radius() * scale);
+	}
+}
 
 namespace Math
 {
 
+	BoundingSphere BoundingSphere::transform(const Matrix& matrix) const
+	{
+		return transform_sphere(*this, matrix, maximum_scale(matrix));
+	}
+
+	void BoundingSphere::transform(const BoundingSphere* spheres, size_t count, const Matrix& matrix, BoundingSphere* output)
+	{
+		const float scale = maximum_scale(matrix);
+		for (size_t i = 0; i < count; ++i)
+		{
+			output[i] = transform_sphere(spheres[i], matrix, scale);
+		}
+	}
+
+	void BoundingSphere::transform(const BoundingSphere* spheres, const Matrix* matrices, size_t count, BoundingSphere* output)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			output[i] = transform_sphere(spheres[i], matrices[i], maximum_scale(matrices[i]));
+		}
+	}
+
+	void BoundingSphere::transform(const SoaView<BoundingSphere>& spheres, const Matrix& matrix, SoaArray<BoundingSphere>& output)
+	{
+		typedef SoaTraits<BoundingSphere> Traits;
+
+		// Four spheres at a time, with each matrix element replicated across the lanes
+		XMVECTOR m[4][3];
+		for (uint_t row = 0; row < 4; ++row)
+		{
+			for (uint_t column = 0; column < 3; ++column)
+			{
+				m[row][column] = XMVectorReplicate(matrix(row, column));
+			}
+		}
+		const XMVECTOR scale = XMVectorReplicate(maximum_scale(matrix));
+
+		output.resize(spheres.size());
+
+		for (size_t block = 0; block < spheres.block_count(); ++block)
+		{
+			const SoaBlock<BoundingSphere> sphere = spheres.load_block(block);
+
+			SoaBlock<BoundingSphere> result;
+			for (uint_t axis = 0; axis < 3; ++axis)
+			{
+				result[Traits::CENTER_X + axis] = XMVectorMultiplyAdd(sphere[Traits::CENTER_Z], m[2][axis], XMVectorMultiplyAdd(sphere[Traits::CENTER_Y], m[1][axis], XMVectorMultiplyAdd(sphere[Traits::CENTER_X], m[0][axis], m[3][axis])));
+			}
+			result[Traits::RADIUS] = XMVectorMultiply(sphere[Traits::RADIUS], scale);
+			output.store_block(block, result);
+		}
+
+		output.pad_last_block();
+	}
+
 	BoundingSphere BoundingSphere::compute_containing_sphere(const BoundingSphere& a, const BoundingSphere& b)
 	{
-		Intersect::VolumeResult result = Intersect::test(a, b);
+		const Vector3 offset = b.center() - a.center();
+		const float distance = offset.length();
 
-		if (result == Intersect::VOLUME_CONTAINS) // A contains B
+		if (distance + b.radius() <= a.radius()) // A contains B
 		{
 			return a;
 		}
 
-		if (result == Intersect::VOLUME_CONTAINED) // B contains A
+		if (distance + a.radius() <= b.radius()) // B contains A
 		{
 			return b;
 		}
 
-		Line line(a.center(), b.center());
-		line.extend(a.radius(), b.radius());
-		return BoundingSphere(line.mid_point(), line.length() / 2);
+		// The new sphere spans from the far side of A to the far side of B along the line between the centers.
+		// Rounding can leave the center a little off that line, so the radius is made to reach both far sides
+		// from where the center actually ended up.
+		const float radius = (distance + a.radius() + b.radius()) * 0.5f;
+		const Vector3 center = a.center() + offset * ((radius - a.radius()) / distance);
+		const float reach_a = Vector3(a.center() - center).length() + a.radius();
+		const float reach_b = Vector3(b.center() - center).length() + b.radius();
+		return BoundingSphere(center, std::max(radius, std::max(reach_a, reach_b)));
+	}
+
+	BoundingSphere BoundingSphere::compute_containing_sphere(const BoundingSphere* spheres, size_t count)
+	{
+		if (count == 0) return BoundingSphere();
+
+		// Each pass merges neighbouring pairs and halves the count, so every sphere goes through log2(n) merges
+		std::vector<BoundingSphere> merged(spheres, spheres + count);
+		for (size_t remaining = count; remaining > 1; remaining = (remaining + 1) / 2)
+		{
+			for (size_t i = 0; i < remaining / 2; ++i)
+			{
+				merged[i] = compute_containing_sphere(merged[2 * i], merged[2 * i + 1]);
+			}
+
+			if (remaining & 1)
+			{
+				merged[remaining / 2] = merged[remaining - 1];
+			}
+		}
+
+		// Each merge only knows the two spheres it was given, so the result is usually larger than it needs to be
+		// around its center. Measuring out to the original spheres takes the slack back out.
+		const Vector3 center = merged.front().center();
+		float radius = 0.0f;
+		for (size_t i = 0; i < count; ++i)
+		{
+			radius = std::max(radius, Vector3(spheres[i].center() - center).length() + spheres[i].radius());
+		}
+		return BoundingSphere(center, radius);
+	}
+
+	BoundingSphere BoundingSphere::compute_from_points(const Vector3* points, size_t count, SphereMethod method)
+	{
+		return compute_from_vertices(points, sizeof(Vector3), count, method);
+	}
+
+	BoundingSphere BoundingSphere::compute_from_vertices(const void* vertices, size_t stride, size_t count, SphereMethod method)
+	{
+		if (count == 0) return BoundingSphere();
+
+		const uchar_t* bytes = static_cast<const uchar_t*>(vertices);
+
+		if (method == SPHERE_METHOD_WELZL)
+		{
+			std::vector<Vector3> points(count);
+			for (size_t i = 0; i < count; ++i)
+			{
+				points[i] = load_point(bytes, stride, i);
+			}
+
+			// Welzl's algorithm is only expected linear time on randomly ordered input, the fixed seed keeps results repeatable
+			std::shuffle(points.begin(), points.end(), std::minstd_rand());
+
+			// The spheres through the support points are only as exact as floats allow, so grow the result over
+			// any point left just outside as the other methods do
+			Vector3 support[4];
+			return grow_to_fit(welzl(points, points.size(), support, 0), bytes, stride, count);
+		}
+
+		uint_t direction_count = 3;
+		if (method == SPHERE_METHOD_EPOS_14) direction_count = 7;
+		if (method == SPHERE_METHOD_EPOS_26) direction_count = 13;
+
+		uint_t minimum_index[DIRECTION_GROUP_COUNT * 4];
+		uint_t maximum_index[DIRECTION_GROUP_COUNT * 4];
+		find_extremal_points(bytes, stride, count, (direction_count + 3) / 4, minimum_index, maximum_index);
+
+		BoundingSphere sphere;
+
+		if (method == SPHERE_METHOD_RITTER)
+		{
+			// Start with the sphere spanning the pair of axis extremal points that are furthest apart
+			float largest_distance = -1.0f;
+			for (uint_t axis = 0; axis < 3; ++axis)
+			{
+				const Vector3 minimum(load_point(bytes, stride, minimum_index[axis]));
+				const Vector3 maximum(load_point(bytes, stride, maximum_index[axis]));
+				const float distance = Vector3(maximum - minimum).length_squared();
+				if (distance > largest_distance)
+				{
+					largest_distance = distance;
+					sphere = sphere_from_points(minimum, maximum);
+				}
+			}
+		}
+		else
+		{
+			// Start with the exact sphere around the extremal points
+			std::vector<Vector3> extremal_points;
+			extremal_points.reserve(direction_count * 2);
+			for (uint_t direction = 0; direction < direction_count; ++direction)
+			{
+				extremal_points.push_back(Vector3(load_point(bytes, stride, minimum_index[direction])));
+				extremal_points.push_back(Vector3(load_point(bytes, stride, maximum_index[direction])));
+			}
+
+			Vector3 support[4];
+			sphere = welzl(extremal_points, extremal_points.size(), support, 0);
+		}
+
+		return grow_to_fit(sphere, bytes, stride, count);
 	}
 }
@@ -7,14 +7,28 @@
 #include <type_traits>
 #include <iterator>
 #include <algorithm>
-#include <functional>
-#include <numeric>
+#include <vector>
 
 namespace Math
 {
+	class Matrix;
+	template <class Type> struct SoaTraits;
+	template <class Type> class SoaView;
+	template <class Type> class SoaArray;
 
 	class BoundingSphere
 	{
+	public:
+		// Algorithms for building a sphere around a set of points, from fastest and loosest to slowest and tightest
+		enum SphereMethod
+		{
+			SPHERE_METHOD_RITTER,		// Ritter's two pass method, extremal points along the three axes
+			SPHERE_METHOD_EPOS_6,		// Exact sphere of the extremal points along 3 directions, then grown to fit
+			SPHERE_METHOD_EPOS_14,		// As above with 7 directions (axes and corner diagonals)
+			SPHERE_METHOD_EPOS_26,		// As above with 13 directions (axes, corner and edge diagonals)
+			SPHERE_METHOD_WELZL			// Exact minimum bounding sphere
+		};
+
 	private:
 		Vector3 mCenter;
 		float mRadius;
@@ -101,19 +115,76 @@ namespace Math
 			return mRadius;
 		}
 
+		//--------------------------------------------------------------------------
+		// Computation
+		//
+
+		// The radius is scaled by a bound on how far the matrix stretches any direction, so the result contains the
+		// sphere under any rotation and non-uniform scale, in either order
+		BoundingSphere transform(const Matrix& matrix) const;
+
+		// Transforms every sphere by the same matrix, output may be the same array as spheres
+		static void transform(const BoundingSphere* spheres, size_t count, const Matrix& matrix, BoundingSphere* output);
+
+		// Transforms each sphere by its own matrix, output may be the same array as spheres
+		static void transform(const BoundingSphere* spheres, const Matrix* matrices, size_t count, BoundingSphere* output);
+
+		static void transform(const SoaView<BoundingSphere>& spheres, const Matrix& matrix, SoaArray<BoundingSphere>& output);
+
+		// The smallest sphere containing both, the radius is rounded up so it always does
 		static BoundingSphere compute_containing_sphere(const BoundingSphere& a, const BoundingSphere& b);
 
+		// Merges the spheres pairwise in a balanced tree, which gives tighter results than merging them one after another,
+		// then keeps the merged center and shrinks the radius to just reach the farthest sphere
+		static BoundingSphere compute_containing_sphere(const BoundingSphere* spheres, size_t count);
+
 		template <class Iterator>
 		typename std::enable_if<std::is_same<typename std::iterator_traits<Iterator>::value_type, BoundingSphere>::value, BoundingSphere>::type 
 			static compute_containing_sphere(Iterator begin, Iterator end)
 		{
-			if (begin != end)
-			{
-				BoundingSphere bounds = *begin++;
-				return std::accumulate(begin, end, bounds, std::ptr_fun(&compute_containing_sphere));
-			}
+			const std::vector<BoundingSphere> spheres(begin, end);
+			return compute_containing_sphere(spheres.data(), spheres.size());
+		}
+
+		static BoundingSphere compute_from_points(const Vector3* points, size_t count, SphereMethod method = SPHERE_METHOD_EPOS_14);
+
+		// For positions at the start of each vertex in a vertex buffer, where each vertex is stride bytes after the previous one
+		static BoundingSphere compute_from_vertices(const void* vertices, size_t stride, size_t count, SphereMethod method = SPHERE_METHOD_EPOS_14);
 
-			return BoundingSphere();
+		template <class Iterator>
+		typename std::enable_if<std::is_same<typename std::iterator_traits<Iterator>::value_type, Vector3>::value, BoundingSphere>::type 
+			static compute_from_points(Iterator begin, Iterator end, SphereMethod method = SPHERE_METHOD_EPOS_14)
+		{
+			const std::vector<Vector3> points(begin, end);
+			return compute_from_points(points.data(), points.size(), method);
+		}
+	};
+
+	// Component layout of an SoaArray<BoundingSphere>
+	template <> struct SoaTraits<BoundingSphere>
+	{
+		enum Component : uint_t
+		{
+			CENTER_X,
+			CENTER_Y,
+			CENTER_Z,
+			RADIUS,
+
+			COMPONENT_COUNT
+		};
+
+		static void scatter(const BoundingSphere& sphere, float* components)
+		{
+			const Vector3& center = sphere.center();
+			components[CENTER_X] = center.x;
+			components[CENTER_Y] = center.y;
+			components[CENTER_Z] = center.z;
+			components[RADIUS] = sphere.radius();
+		}
+
+		static BoundingSphere gather(const float* components)
+		{
+			return BoundingSphere(Vector3(components[CENTER_X], components[CENTER_Y], components[CENTER_Z]), components[RADIUS]);
 		}
 	};
 
@@ -0,0 +1,857 @@
+#include "Precompiled.hpp"
+#include "BoxBvh.hpp"
+#include "Vector3.hpp"
+#include "Ray.hpp"
+#include "Line.hpp"
+#include "BoundingBox.hpp"
+#include "BoundingSphere.hpp"
+#include "Frustum.hpp"
+#include "SoaArray.hpp"
+#include "SpatialCode.hpp"
+#include "RadixSort.hpp"
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <thread>
+
+namespace
+{
+	typedef Math::BoxBvh::Node Node;
+
+	const uint_t LEAF = Math::BoxBvh::LEAF;
+	const uint_t NO_PARENT = 0xFFFFFFFF;
+
+	// Fewer objects than this are not worth starting a thread for
+	const size_t MINIMUM_OBJECTS_PER_THREAD = 16 * 1024;
+
+	// Leaves of the treelets rearranged by optimize, the work grows as three to the power of this
+	const uint_t TREELET_LEAVES = 7;
+	const uint_t TREELET_SUBSETS = 1 << TREELET_LEAVES;
+
+	uint_t thread_total(uint_t thread_count)
+	{
+		return (thread_count == 0) ? std::max(std::thread::hardware_concurrency(), 1u) : thread_count;
+	}
+
+	// Splits [0, count) into one range per thread and calls function(first, last) for each concurrently
+	template <class Function>
+	void for_each_range(size_t count, uint_t thread_count, Function function)
+	{
+		const size_t useful_threads = std::max<size_t>(count / MINIMUM_OBJECTS_PER_THREAD, 1);
+		const size_t threads = std::min<size_t>(::thread_total(thread_count), useful_threads);
+		const size_t range = (count + threads - 1) / threads;
+
+		std::vector<std::future<void>> results;
+		for (size_t first = range; first < count; first += range)
+		{
+			results.push_back(std::async(std::launch::async, function, first, std::min(first + range, count)));
+		}
+
+		// This thread does the first range while waiting for the others
+		function(0, std::min(range, count));
+		for (auto& result : results)
+		{
+			result.get();
+		}
+	}
+
+	// Walks up the tree from the leaves (the nodes from first_leaf on) and calls visit(node) on each interior
+	// node once both of its children are done. The second walk to reach a node carries on up from it and the
+	// first stops there, so the leaves can be split between threads and every node is visited exactly once.
+	template <class Visit>
+	void visit_upwards(const std::vector<uint_t>& parents, uint_t first_leaf, uint_t thread_count, Visit visit)
+	{
+		std::unique_ptr<std::atomic<uint_t>[]> arrivals(new std::atomic<uint_t>[first_leaf]);
+		for (uint_t node = 0; node < first_leaf; ++node)
+		{
+			arrivals[node].store(0, std::memory_order_relaxed);
+		}
+
+		const uint_t leaf_count = static_cast<uint_t>(parents.size()) - first_leaf;
+		::for_each_range(leaf_count, thread_count, [&](size_t first, size_t last)
+		{
+			for (size_t leaf = first; leaf < last; ++leaf)
+			{
+				uint_t node = parents[first_leaf + leaf];
+				while (node != NO_PARENT)
+				{
+					// Acquiring and releasing makes the other child's work visible to the second walk
+					if (arrivals[node].fetch_add(1, std::memory_order_acq_rel) == 0) break;
+					visit(node);
+					node = parents[node];
+				}
+			}
+		});
+	}
+
+	int leading_zeros(uint32_t value)
+	{
+		if (value == 0) return 32;
+
+		int count = 0;
+		if ((value & 0xFFFF0000) == 0) { count += 16; value <<= 16; }
+		if ((value & 0xFF000000) == 0) { count += 8; value <<= 8; }
+		if ((value & 0xF0000000) == 0) { count += 4; value <<= 4; }
+		if ((value & 0xC0000000) == 0) { count += 2; value <<= 2; }
+		if ((value & 0x80000000) == 0) { count += 1; }
+		return count;
+	}
+
+	// Length of the prefix the sorted codes at i and j have in common, with the positions themselves breaking
+	// ties between equal codes, or -1 when j is outside the codes
+	int common_prefix(const uint32_t* codes, sint_t count, sint_t i, sint_t j)
+	{
+		if (j < 0 || j >= count) return -1;
+		if (codes[i] == codes[j]) return 32 + ::leading_zeros(static_cast<uint32_t>(i ^ j));
+		return ::leading_zeros(codes[i] ^ codes[j]);
+	}
+
+	// Finds the range of codes interior node i covers and where it splits between its children. The range
+	// starts or ends at i, and goes in the direction of the neighbour i has the longer common prefix with.
+	void split_node(const uint32_t* codes, sint_t count, sint_t i, uint_t& left, uint_t& right)
+	{
+		const sint_t first_leaf = count - 1;
+		const sint_t direction = (::common_prefix(codes, count, i, i + 1) > ::common_prefix(codes, count, i, i - 1)) ? 1 : -1;
+
+		// Everything in the range has a longer prefix in common with i than the neighbour outside it
+		const int outside_prefix = ::common_prefix(codes, count, i, i - direction);
+		sint_t max_length = 2;
+		while (::common_prefix(codes, count, i, i + max_length * direction) > outside_prefix)
+		{
+			max_length *= 2;
+		}
+
+		sint_t length = 0;
+		for (sint_t step = max_length / 2; step > 0; step /= 2)
+		{
+			if (::common_prefix(codes, count, i, i + (length + step) * direction) > outside_prefix)
+			{
+				length += step;
+			}
+		}
+		const sint_t other_end = i + length * direction;
+
+		// The split is after the last code sharing more than the range's common prefix with i
+		const int node_prefix = ::common_prefix(codes, count, i, other_end);
+		sint_t split = 0;
+		sint_t step = length;
+		do
+		{
+			step = (step + 1) / 2;
+			if (::common_prefix(codes, count, i, i + (split + step) * direction) > node_prefix)
+			{
+				split += step;
+			}
+		}
+		while (step > 1);
+		const sint_t middle = i + split * direction + std::min<sint_t>(direction, 0);
+
+		left = static_cast<uint_t>((std::min(i, other_end) == middle) ? first_leaf + middle : middle);
+		right = static_cast<uint_t>((std::max(i, other_end) == middle + 1) ? first_leaf + middle + 1 : middle + 1);
+	}
+
+	// Half the surface area, the scale doesn't matter to the heuristic
+	float half_area(FXMVECTOR minimum, FXMVECTOR maximum)
+	{
+		const XMVECTOR size = XMVectorMax(XMVectorSubtract(maximum, minimum), XMVectorZero());
+		const XMVECTOR products = XMVectorMultiply(size, XMVectorSwizzle(size, 1, 2, 0, 3));
+		return XMVectorGetX(products) + XMVectorGetY(products) + XMVectorGetZ(products);
+	}
+
+	float half_area(const Node& node)
+	{
+		return ::half_area(XMLoadFloat3(&node.minimum), XMLoadFloat3(&node.maximum));
+	}
+
+	void set_bounds(Node& node, FXMVECTOR minimum, FXMVECTOR maximum)
+	{
+		XMStoreFloat3(&node.minimum, minimum);
+		XMStoreFloat3(&node.maximum, maximum);
+	}
+
+	Math::BoundingBox node_box(const Node& node)
+	{
+		return Math::BoundingBox(Math::Vector3(XMLoadFloat3(&node.minimum)), Math::Vector3(XMLoadFloat3(&node.maximum)), Math::ALREADY_SORTED);
+	}
+
+	// The best arrangement found for a treelet, with each subset of its leaves given the cheapest subtree over
+	// them and how that subtree splits its leaves between its children
+	struct Treelet
+	{
+		uint_t leaves[TREELET_LEAVES];
+		uint_t interiors[TREELET_LEAVES - 1];
+		XMVECTOR minimums[TREELET_SUBSETS];
+		XMVECTOR maximums[TREELET_SUBSETS];
+		float costs[TREELET_SUBSETS];
+		uint_t splits[TREELET_SUBSETS];
+	};
+
+	// Links up the subtree over the subset of the treelet's leaves from its recorded splits, reusing the
+	// treelet's interior nodes in order, and returns the subtree's root
+	uint_t link_subset(const Treelet& treelet, uint_t subset, uint_t& next_interior, std::vector<Node>& nodes, std::vector<uint_t>& parents)
+	{
+		if ((subset & (subset - 1)) == 0)
+		{
+			uint_t leaf = 0;
+			while ((subset >> leaf) != 1) ++leaf;
+			return treelet.leaves[leaf];
+		}
+
+		const uint_t node = treelet.interiors[next_interior++];
+		const uint_t left = ::link_subset(treelet, treelet.splits[subset], next_interior, nodes, parents);
+		const uint_t right = ::link_subset(treelet, subset ^ treelet.splits[subset], next_interior, nodes, parents);
+		nodes[node].left = left;
+		nodes[node].right = right;
+		::set_bounds(nodes[node], treelet.minimums[subset], treelet.maximums[subset]);
+		parents[left] = node;
+		parents[right] = node;
+		return node;
+	}
+
+	// A ray or line prepared for the slab tests against the nodes
+	struct Segment
+	{
+		XMVECTOR origin;
+		XMVECTOR inverse_direction;
+		float max_distance;
+	};
+
+	Segment make_segment(FXMVECTOR origin, FXMVECTOR direction, float max_distance)
+	{
+		// Clamping the infinities from zero components keeps (0 * inverse) from making NaNs on the slab planes
+		const XMVECTOR limit = XMVectorReplicate(FLT_MAX);
+		const Segment segment = { origin, XMVectorClamp(XMVectorReciprocal(direction), XMVectorNegate(limit), limit), max_distance };
+		return segment;
+	}
+
+	bool enter_node(const Segment& segment, const Node& node, float max_distance, float& entry)
+	{
+		const XMVECTOR t1 = XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&node.minimum), segment.origin), segment.inverse_direction);
+		const XMVECTOR t2 = XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&node.maximum), segment.origin), segment.inverse_direction);
+		const XMVECTOR near_planes = XMVectorMin(t1, t2);
+		const XMVECTOR far_planes = XMVectorMax(t1, t2);
+
+		const float t_min = std::max(std::max(XMVectorGetX(near_planes), XMVectorGetY(near_planes)), std::max(XMVectorGetZ(near_planes), 0.0f));
+		const float t_max = std::min(std::min(XMVectorGetX(far_planes), XMVectorGetY(far_planes)), std::min(XMVectorGetZ(far_planes), max_distance));
+		entry = t_min;
+		return t_min <= t_max;
+	}
+
+	// The treelet pass can make the tree deeper than the build does, so the stack moves to the heap rather
+	// than having a fixed limit
+	template <class Entry>
+	class TraversalStack
+	{
+	private:
+		static const uint_t FIXED_SIZE = 64;
+
+		Entry mFixed[FIXED_SIZE];
+		std::vector<Entry> mOverflow;
+		uint_t mSize;
+
+	public:
+		TraversalStack() : mSize(0)
+		{
+		}
+
+		bool empty() const
+		{
+			return mSize == 0;
+		}
+
+		const Entry& top() const
+		{
+			return (mSize <= FIXED_SIZE) ? mFixed[mSize - 1] : mOverflow.back();
+		}
+
+		void push(const Entry& entry)
+		{
+			if (mSize < FIXED_SIZE)
+			{
+				mFixed[mSize] = entry;
+			}
+			else
+			{
+				mOverflow.push_back(entry);
+			}
+			++mSize;
+		}
+
+		Entry pop()
+		{
+			const Entry entry = top();
+			if (mSize > FIXED_SIZE) mOverflow.pop_back();
+			--mSize;
+			return entry;
+		}
+	};
+
+	struct StackEntry
+	{
+		uint_t node;
+		float entry;
+	};
+
+	// Visits the nearer child first and skips anything further away than the closest hit so far
+	Math::Intersect::LinearResult find_closest(const Segment& segment, const Node* nodes, uint_t* object_index)
+	{
+		Math::Intersect::LinearResult closest;
+		float closest_distance = segment.max_distance;
+
+		float entry;
+		if (!enter_node(segment, nodes[0], closest_distance, entry)) return closest;
+
+		TraversalStack<StackEntry> stack;
+		uint_t node_index = 0;
+
+		for (;;)
+		{
+			const Node& node = nodes[node_index];
+
+			if (node.right == LEAF)
+			{
+				// The leaf was only entered if its box is hit no further away than the closest so far
+				closest_distance = entry;
+				closest = Math::Intersect::LinearResult(entry);
+				if (object_index) *object_index = node.left;
+			}
+			else
+			{
+				uint_t near_child = node.left;
+				uint_t far_child = node.right;
+				float near_entry;
+				float far_entry;
+				const bool hit_near = enter_node(segment, nodes[near_child], closest_distance, near_entry);
+				const bool hit_far = enter_node(segment, nodes[far_child], closest_distance, far_entry);
+
+				if (hit_near && hit_far)
+				{
+					if (far_entry < near_entry)
+					{
+						std::swap(near_child, far_child);
+						std::swap(near_entry, far_entry);
+					}
+					const StackEntry pending = { far_child, far_entry };
+					stack.push(pending);
+					node_index = near_child;
+					entry = near_entry;
+					continue;
+				}
+				if (hit_near || hit_far)
+				{
+					node_index = hit_near ? near_child : far_child;
+					entry = hit_near ? near_entry : far_entry;
+					continue;
+				}
+			}
+
+			// Pop the next node that could still hold a closer hit
+			while (!stack.empty() && stack.top().entry > closest_distance)
+			{
+				stack.pop();
+			}
+			if (stack.empty()) break;
+			const StackEntry next = stack.pop();
+			node_index = next.node;
+			entry = next.entry;
+		}
+
+		return closest;
+	}
+
+	bool find_any(const Segment& segment, const Node* nodes)
+	{
+		float entry;
+		if (!enter_node(segment, nodes[0], segment.max_distance, entry)) return false;
+
+		TraversalStack<uint_t> stack;
+		uint_t node_index = 0;
+
+		for (;;)
+		{
+			const Node& node = nodes[node_index];
+			if (node.right == LEAF) return true;
+
+			const bool hit_first = enter_node(segment, nodes[node.left], segment.max_distance, entry);
+			const bool hit_second = enter_node(segment, nodes[node.right], segment.max_distance, entry);
+
+			if (hit_first && hit_second)
+			{
+				stack.push(node.right);
+				node_index = node.left;
+				continue;
+			}
+			if (hit_first || hit_second)
+			{
+				node_index = hit_first ? node.left : node.right;
+				continue;
+			}
+
+			if (stack.empty()) break;
+			node_index = stack.pop();
+		}
+
+		return false;
+	}
+
+	// Whether a volume query takes in everything below a node, skips it or has to look further down
+	Math::Intersect::PlaneResult classify(const Math::Frustum& frustum, const Node& node)
+	{
+		return frustum.test(::node_box(node));
+	}
+
+	template <class Volume>
+	Math::Intersect::PlaneResult classify(const Volume& volume, const Node& node)
+	{
+		switch (Math::Intersect::test(volume, ::node_box(node)))
+		{
+		case Math::Intersect::VOLUME_DISJOINT:
+			return Math::Intersect::OUTSIDE_PLANE;
+		case Math::Intersect::VOLUME_CONTAINS:
+		case Math::Intersect::VOLUME_IDENTICAL:
+			return Math::Intersect::INSIDE_PLANE;
+		default:
+			return Math::Intersect::INTERSECTS_PLANE;
+		}
+	}
+}
+
+namespace Math
+{
+
+	BoxBvh::BoxBvh(const SoaView<BoundingBox>& boxes, uint_t thread_count) : mObjectCount(0)
+	{
+		build(boxes, thread_count);
+	}
+
+	// The pending counts are only used during a refit, and are all zero between them
+	BoxBvh::BoxBvh(const BoxBvh& bvh) :
+		mNodes(bvh.mNodes),
+		mParents(bvh.mParents),
+		mLeaves(bvh.mLeaves),
+		mDirtyLeaves(bvh.mDirtyLeaves),
+		mDirtyObjects(bvh.mDirtyObjects),
+		mPendingChildren(bvh.mPendingChildren.size()),
+		mObjectCount(bvh.mObjectCount)
+	{
+	}
+
+	BoxBvh& BoxBvh::operator = (const BoxBvh& bvh)
+	{
+		mNodes = bvh.mNodes;
+		mParents = bvh.mParents;
+		mLeaves = bvh.mLeaves;
+		mDirtyLeaves = bvh.mDirtyLeaves;
+		mDirtyObjects = bvh.mDirtyObjects;
+		if (mPendingChildren.size() != bvh.mPendingChildren.size())
+		{
+			std::vector<std::atomic<uint_t>>(bvh.mPendingChildren.size()).swap(mPendingChildren);
+		}
+		mObjectCount = bvh.mObjectCount;
+		return *this;
+	}
+
+	BoundingBox BoxBvh::bounds() const
+	{
+		if (is_empty()) return BoundingBox();
+		return ::node_box(mNodes[0]);
+	}
+
+	float BoxBvh::cost() const
+	{
+		if (mObjectCount < 2) return 0.0f;
+
+		const float root_area = ::half_area(mNodes[0]);
+		if (root_area <= 0.0f) return 0.0f;
+
+		float area = 0.0f;
+		for (uint_t node = 0; node < mObjectCount - 1; ++node)
+		{
+			area += ::half_area(mNodes[node]);
+		}
+		return area / root_area;
+	}
+
+	//--------------------------------------------------------------------------
+	// Building
+	//
+
+	void BoxBvh::build(const SoaView<BoundingBox>& boxes, uint_t thread_count)
+	{
+		const uint_t count = static_cast<uint_t>(boxes.size());
+		mObjectCount = count;
+		mNodes.resize(count ? 2 * count - 1 : 0);
+		mParents.resize(mNodes.size());
+		mLeaves.resize(count);
+		mDirtyLeaves.clear();
+		mDirtyObjects.assign(count, 0);
+		if (mPendingChildren.size() != (count ? count - 1 : 0))
+		{
+			std::vector<std::atomic<uint_t>>(count ? count - 1 : 0).swap(mPendingChildren);
+		}
+		if (count == 0) return;
+
+		// Sorting the boxes by the Morton codes of their centers puts boxes that are close together next to
+		// each other, and each interior node covers a range of them
+		std::vector<uint32_t> codes(count);
+		std::vector<uint32_t> code_scratch(count);
+		std::vector<uint_t> order(count);
+		std::vector<uint_t> order_scratch(count);
+		SpatialCode::morton_32(boxes, BoundingBox::compute_containing_box(boxes), codes.data(), thread_count);
+		for (uint_t i = 0; i < count; ++i)
+		{
+			order[i] = i;
+		}
+		radix_sort(codes.data(), order.data(), count, code_scratch.data(), order_scratch.data(), thread_count);
+
+		const uint_t first_leaf = count - 1;
+		::for_each_range(count, thread_count, [&](size_t first, size_t last)
+		{
+			for (size_t i = first; i < last; ++i)
+			{
+				const BoundingBox box = boxes[order[i]];
+				Node& leaf = mNodes[first_leaf + i];
+				::set_bounds(leaf, box.minimum_corner(), box.maximum_corner());
+				leaf.left = order[i];
+				leaf.right = LEAF;
+				mLeaves[order[i]] = static_cast<uint_t>(first_leaf + i);
+			}
+		});
+
+		mParents[0] = NO_PARENT;
+		::for_each_range(first_leaf, thread_count, [&](size_t first, size_t last)
+		{
+			for (size_t i = first; i < last; ++i)
+			{
+				Node& node = mNodes[i];
+				::split_node(codes.data(), count, static_cast<sint_t>(i), node.left, node.right);
+				mParents[node.left] = static_cast<uint_t>(i);
+				mParents[node.right] = static_cast<uint_t>(i);
+			}
+		});
+
+		::visit_upwards(mParents, first_leaf, thread_count, [this](uint_t node) { fit(node); });
+	}
+
+	void BoxBvh::optimize(uint_t thread_count)
+	{
+		if (mObjectCount < 3) return;
+
+		::visit_upwards(mParents, mObjectCount - 1, thread_count, [this](uint_t node) { restructure_treelet(node); });
+	}
+
+	//--------------------------------------------------------------------------
+	// Refitting
+	//
+
+	void BoxBvh::update(uint_t object, const BoundingBox& box)
+	{
+		XMASSERT(object < mObjectCount);
+		const uint_t leaf = mLeaves[object];
+		::set_bounds(mNodes[leaf], box.minimum_corner(), box.maximum_corner());
+		if (!mDirtyObjects[object])
+		{
+			mDirtyObjects[object] = 1;
+			mDirtyLeaves.push_back(leaf);
+		}
+	}
+
+	void BoxBvh::refit(bool rotate, uint_t thread_count)
+	{
+		// Count the dirty children of the nodes above the dirty leaves. A walk up stops at a node an earlier walk
+		// went through, since everything above it is already counted.
+		for (uint_t leaf : mDirtyLeaves)
+		{
+			uint_t node = mParents[leaf];
+			while (node != NO_PARENT)
+			{
+				if (mPendingChildren[node].fetch_add(1, std::memory_order_relaxed) != 0) break;
+				node = mParents[node];
+			}
+		}
+
+		// The walk that brings a node's count to zero is the last one through it, so its children are done and
+		// it is refitted and carried on up from. Only the counted nodes are ever touched.
+		::for_each_range(mDirtyLeaves.size(), thread_count, [this, rotate](size_t first, size_t last)
+		{
+			for (size_t i = first; i < last; ++i)
+			{
+				uint_t node = mParents[mDirtyLeaves[i]];
+				while (node != NO_PARENT)
+				{
+					if (mPendingChildren[node].fetch_sub(1, std::memory_order_acq_rel) != 1) break;
+					fit(node);
+					if (rotate) rotate_node(node);
+					node = mParents[node];
+				}
+			}
+		});
+
+		for (uint_t leaf : mDirtyLeaves)
+		{
+			mDirtyObjects[mNodes[leaf].left] = 0;
+		}
+		mDirtyLeaves.clear();
+	}
+
+	void BoxBvh::refit(const SoaView<BoundingBox>& boxes, bool rotate, uint_t thread_count)
+	{
+		XMASSERT(boxes.size() == mObjectCount);
+		if (mObjectCount == 0) return;
+
+		// Every node is refitted, so the walk over all the leaves does without counting
+		::for_each_range(mObjectCount, thread_count, [this, &boxes](size_t first, size_t last)
+		{
+			for (size_t object = first; object < last; ++object)
+			{
+				const BoundingBox box = boxes[object];
+				::set_bounds(mNodes[mLeaves[object]], box.minimum_corner(), box.maximum_corner());
+			}
+		});
+
+		::visit_upwards(mParents, mObjectCount - 1, thread_count, [this, rotate](uint_t node)
+		{
+			fit(node);
+			if (rotate) rotate_node(node);
+		});
+
+		std::fill(mDirtyObjects.begin(), mDirtyObjects.end(), 0);
+		mDirtyLeaves.clear();
+	}
+
+	void BoxBvh::fit(uint_t node)
+	{
+		const Node& left = mNodes[mNodes[node].left];
+		const Node& right = mNodes[mNodes[node].right];
+		::set_bounds(mNodes[node],
+			XMVectorMin(XMLoadFloat3(&left.minimum), XMLoadFloat3(&right.minimum)),
+			XMVectorMax(XMLoadFloat3(&left.maximum), XMLoadFloat3(&right.maximum)));
+	}
+
+	// Tries swapping each child with each of its sibling's children, which leaves the sibling around the
+	// child and the other grandchild, and keeps the swap that shrinks the sibling the most. The node's own
+	// bounds stay the same.
+	void BoxBvh::rotate_node(uint_t node)
+	{
+		uint_t* children[2] = { &mNodes[node].left, &mNodes[node].right };
+		uint_t* best_child = nullptr;
+		uint_t* best_grandchild = nullptr;
+		uint_t best_sibling = 0;
+		float best_saving = 0.0f;
+
+		for (uint_t side = 0; side < 2; ++side)
+		{
+			const uint_t sibling = *children[1 - side];
+			if (is_leaf(sibling)) continue;
+
+			const Node& child = mNodes[*children[side]];
+			const float sibling_area = ::half_area(mNodes[sibling]);
+			uint_t* grandchildren[2] = { &mNodes[sibling].left, &mNodes[sibling].right };
+			for (uint_t swapped = 0; swapped < 2; ++swapped)
+			{
+				const Node& kept = mNodes[*grandchildren[1 - swapped]];
+				const float saving = sibling_area - ::half_area(
+					XMVectorMin(XMLoadFloat3(&child.minimum), XMLoadFloat3(&kept.minimum)),
+					XMVectorMax(XMLoadFloat3(&child.maximum), XMLoadFloat3(&kept.maximum)));
+				if (saving > best_saving)
+				{
+					best_child = children[side];
+					best_grandchild = grandchildren[swapped];
+					best_sibling = sibling;
+					best_saving = saving;
+				}
+			}
+		}
+
+		if (!best_child) return;
+
+		std::swap(*best_child, *best_grandchild);
+		mParents[*best_child] = node;
+		mParents[*best_grandchild] = best_sibling;
+		fit(best_sibling);
+	}
+
+	void BoxBvh::restructure_treelet(uint_t root)
+	{
+		Treelet treelet;
+
+		// Grow the treelet from its root by opening up its largest leaf until it has enough leaves
+		treelet.interiors[0] = root;
+		treelet.leaves[0] = mNodes[root].left;
+		treelet.leaves[1] = mNodes[root].right;
+		uint_t leaf_count = 2;
+		float current_cost = ::half_area(mNodes[root]);
+		while (leaf_count < TREELET_LEAVES)
+		{
+			uint_t largest = TREELET_LEAVES;
+			float largest_area = -1.0f;
+			for (uint_t leaf = 0; leaf < leaf_count; ++leaf)
+			{
+				if (is_leaf(treelet.leaves[leaf])) continue;
+
+				const float area = ::half_area(mNodes[treelet.leaves[leaf]]);
+				if (area > largest_area)
+				{
+					largest = leaf;
+					largest_area = area;
+				}
+			}
+			if (largest == TREELET_LEAVES) break;
+
+			const uint_t node = treelet.leaves[largest];
+			treelet.interiors[leaf_count - 1] = node;
+			treelet.leaves[largest] = mNodes[node].left;
+			treelet.leaves[leaf_count++] = mNodes[node].right;
+			current_cost += largest_area;
+		}
+		if (leaf_count < 3) return;
+
+		// Subsets only contain smaller subsets, so going through them in order finds the best subtree of every
+		// part of a subset before the subset itself. A leaf's own subtree is the same in any arrangement, so
+		// only the interior nodes added above the leaves count towards the cost.
+		const uint_t subset_count = 1u << leaf_count;
+		for (uint_t subset = 1; subset < subset_count; ++subset)
+		{
+			const uint_t lowest = subset & (~subset + 1);
+			const uint_t rest = subset ^ lowest;
+			if (rest == 0)
+			{
+				uint_t leaf = 0;
+				while ((lowest >> leaf) != 1) ++leaf;
+				const Node& node = mNodes[treelet.leaves[leaf]];
+				treelet.minimums[subset] = XMLoadFloat3(&node.minimum);
+				treelet.maximums[subset] = XMLoadFloat3(&node.maximum);
+				treelet.costs[subset] = 0.0f;
+				continue;
+			}
+
+			treelet.minimums[subset] = XMVectorMin(treelet.minimums[lowest], treelet.minimums[rest]);
+			treelet.maximums[subset] = XMVectorMax(treelet.maximums[lowest], treelet.maximums[rest]);
+
+			// Keeping the lowest leaf in the first part counts each way of splitting the subset once
+			float best_cost = FLT_MAX;
+			uint_t best_split = lowest;
+			uint_t part = rest;
+			for (;;)
+			{
+				part = (part - 1) & rest;
+				const uint_t first = part | lowest;
+				const float cost = treelet.costs[first] + treelet.costs[subset ^ first];
+				if (cost < best_cost)
+				{
+					best_cost = cost;
+					best_split = first;
+				}
+				if (part == 0) break;
+			}
+
+			treelet.costs[subset] = ::half_area(treelet.minimums[subset], treelet.maximums[subset]) + best_cost;
+			treelet.splits[subset] = best_split;
+		}
+
+		// The arrangement the treelet already has is one of those tried, so only a real improvement is worth
+		// relinking for
+		if (treelet.costs[subset_count - 1] >= current_cost * 0.999f) return;
+
+		uint_t next_interior = 0;
+		::link_subset(treelet, subset_count - 1, next_interior, mNodes, mParents);
+	}
+
+	//--------------------------------------------------------------------------
+	// Queries
+	//
+
+	Intersect::LinearResult BoxBvh::closest_hit(const Ray& ray, uint_t* object_index) const
+	{
+		if (is_empty()) return Intersect::LinearResult();
+		return ::find_closest(::make_segment(ray.origin(), ray.direction(), FLT_MAX), mNodes.data(), object_index);
+	}
+
+	Intersect::LinearResult BoxBvh::closest_hit(const Line& line, uint_t* object_index) const
+	{
+		if (is_empty()) return Intersect::LinearResult();
+		return ::find_closest(::make_segment(line.start_point, line.vector(), 1.0f), mNodes.data(), object_index);
+	}
+
+	bool BoxBvh::any_hit(const Ray& ray) const
+	{
+		if (is_empty()) return false;
+		return ::find_any(::make_segment(ray.origin(), ray.direction(), FLT_MAX), mNodes.data());
+	}
+
+	bool BoxBvh::any_hit(const Line& line) const
+	{
+		if (is_empty()) return false;
+		return ::find_any(::make_segment(line.start_point, line.vector(), 1.0f), mNodes.data());
+	}
+
+	void BoxBvh::query(const Frustum& frustum, std::vector<uint_t>& objects) const
+	{
+		query_volume(frustum, objects);
+	}
+
+	void BoxBvh::query(const BoundingBox& box, std::vector<uint_t>& objects) const
+	{
+		query_volume(box, objects);
+	}
+
+	void BoxBvh::query(const BoundingSphere& sphere, std::vector<uint_t>& objects) const
+	{
+		query_volume(sphere, objects);
+	}
+
+	void BoxBvh::add_subtree(uint_t node, std::vector<uint_t>& objects) const
+	{
+		TraversalStack<uint_t> stack;
+		for (;;)
+		{
+			if (is_leaf(node))
+			{
+				objects.push_back(mNodes[node].left);
+				if (stack.empty()) break;
+				node = stack.pop();
+			}
+			else
+			{
+				stack.push(mNodes[node].right);
+				node = mNodes[node].left;
+			}
+		}
+	}
+
+	// Nodes entirely inside the volume have everything below them added without testing any further
+	template <class Volume>
+	void BoxBvh::query_volume(const Volume& volume, std::vector<uint_t>& objects) const
+	{
+		if (is_empty()) return;
+
+		TraversalStack<uint_t> stack;
+		uint_t node = 0;
+		for (;;)
+		{
+			const Intersect::PlaneResult result = ::classify(volume, mNodes[node]);
+			if (result == Intersect::INSIDE_PLANE)
+			{
+				add_subtree(node, objects);
+			}
+			else if (result == Intersect::INTERSECTS_PLANE)
+			{
+				if (is_leaf(node))
+				{
+					objects.push_back(mNodes[node].left);
+				}
+				else
+				{
+					stack.push(mNodes[node].right);
+					node = mNodes[node].left;
+					continue;
+				}
+			}
+
+			if (stack.empty()) break;
+			node = stack.pop();
+		}
+	}
+
+} // namespace Math
@@ -0,0 +1,185 @@
+#pragma once
+#ifndef __MATHS_BOXBVH_HPP__
+#define __MATHS_BOXBVH_HPP__
+
+#include "Intersect.hpp"
+
+#include <atomic>
+#include <vector>
+
+namespace Math
+{
+	class Ray;
+	class Line;
+	class BoundingBox;
+	class BoundingSphere;
+	class Frustum;
+
+	template <class Type> class SoaView;
+
+	// Bounding volume hierarchy over an array of boxes, such as the bounds of the objects in a scene, for ray
+	// casts, frustum culling and overlap queries.
+	//
+	// The tree is built as a linear bvh (T. Karras, "Maximizing Parallelism in the Construction of BVHs,
+	// Octrees, and k-d Trees", 2012): the boxes are sorted by the Morton codes of their centers, and every
+	// interior node is found from the sorted codes on its own, so the build is spread over threads and is
+	// cheap enough to redo every frame when everything moves. The tree is worse for queries than one built
+	// with the surface area heuristic, which the optional treelet pass makes up some of.
+	//
+	// Each object has a leaf of its own, and the queries give the index of the object's box in the view the
+	// tree was built from.
+	//
+	// When objects move the tree can be refitted rather than rebuilt, which keeps its shape and only grows and
+	// shrinks the nodes above the objects that moved. The tree gets worse for queries as the objects move away
+	// from where it was built, which rotating nodes while refitting slows down, until a rebuild is worth it.
+	class BoxBvh
+	{
+	public:
+		struct Node
+		{
+			XMFLOAT3 minimum;
+			uint_t left; // Leaf: the object, Interior: the first child
+			XMFLOAT3 maximum;
+			uint_t right; // Leaf: LEAF, Interior: the second child
+		};
+
+		static const uint_t LEAF = 0xFFFFFFFF;
+
+	private:
+		// The root is the first node, then the other interior nodes, then the leaves
+		std::vector<Node> mNodes;
+		std::vector<uint_t> mParents;
+		std::vector<uint_t> mLeaves; // The leaf of each object
+		std::vector<uint_t> mDirtyLeaves;
+		std::vector<uchar_t> mDirtyObjects;
+		std::vector<std::atomic<uint_t>> mPendingChildren; // Dirty children of each interior node left to refit
+		uint_t mObjectCount;
+
+	public:
+		//--------------------------------------------------------------------------
+		// Constructors
+		//
+
+		BoxBvh() : mObjectCount(0)
+		{
+		}
+
+		// A thread_count of 0 uses all hardware threads, large inputs are split between the threads
+		explicit BoxBvh(const SoaView<BoundingBox>& boxes, uint_t thread_count = 1);
+
+		BoxBvh(const BoxBvh& bvh);
+
+		//--------------------------------------------------------------------------
+		// Assignment
+		//
+
+		BoxBvh& operator = (const BoxBvh& bvh);
+
+		//--------------------------------------------------------------------------
+		// Accessors
+		//
+
+		bool is_empty() const
+		{
+			return mObjectCount == 0;
+		}
+
+		size_t object_count() const
+		{
+			return mObjectCount;
+		}
+
+		size_t node_count() const
+		{
+			return mNodes.size();
+		}
+
+		const Node* nodes() const
+		{
+			return mNodes.data();
+		}
+
+		BoundingBox bounds() const;
+
+		// The surface area heuristic's cost of the tree with every box costing the same to test, which is the
+		// summed surface area of the interior nodes relative to the root's. Lower is better for queries.
+		float cost() const;
+
+		//--------------------------------------------------------------------------
+		// Building
+		//
+
+		// Replaces the tree with one over the boxes. A thread_count of 0 uses all hardware threads, large inputs
+		// are split between the threads.
+		void build(const SoaView<BoundingBox>& boxes, uint_t thread_count = 1);
+
+		// Rearranges the tree around every interior node to lower its cost (T. Karras and T. Aila, "Fast
+		// Parallel Construction of High-Quality Bounding Volume Hierarchies", 2013). The best arrangement of
+		// the seven largest nodes below each node is found by trying all of them, so this takes several times
+		// as long as the build. Each pass lowers the cost further by less than the one before.
+		void optimize(uint_t thread_count = 1);
+
+		//--------------------------------------------------------------------------
+		// Refitting
+		//
+
+		// Moves the object's leaf to the box and marks it dirty, the nodes above it are fixed by the next refit
+		void update(uint_t object, const BoundingBox& box);
+
+		bool is_dirty() const
+		{
+			return !mDirtyLeaves.empty();
+		}
+
+		// Fits the nodes above the dirty leaves around their children again, from the bottom up, leaving the
+		// rest of the tree untouched. With rotate each refitted node also swaps a child with a grandchild when
+		// that shrinks the child (D. Kopta et al., "Fast, Effective BVH Updates for Animated Scenes", 2012).
+		// A thread_count of 0 uses all hardware threads, many dirty leaves are split between the threads.
+		void refit(bool rotate = false, uint_t thread_count = 1);
+
+		// Moves every object to its box in the view, which must be in the same order and as long as the one the
+		// tree was built from, and refits the whole tree
+		void refit(const SoaView<BoundingBox>& boxes, bool rotate = false, uint_t thread_count = 1);
+
+		//--------------------------------------------------------------------------
+		// Queries
+		//
+		// The distances are as for the Intersect tests against a BoundingBox, and object_index is the index
+		// of the hit object's box. The object indices found by the other queries are appended to objects.
+		//
+
+		Intersect::LinearResult closest_hit(const Ray& ray, uint_t* object_index = nullptr) const;
+		Intersect::LinearResult closest_hit(const Line& line, uint_t* object_index = nullptr) const;
+
+		// Stops at the first hit found, for occlusion tests
+		bool any_hit(const Ray& ray) const;
+		bool any_hit(const Line& line) const;
+
+		// The objects whose boxes are not outside the frustum
+		void query(const Frustum& frustum, std::vector<uint_t>& objects) const;
+
+		// The objects whose boxes touch the box or sphere
+		void query(const BoundingBox& box, std::vector<uint_t>& objects) const;
+		void query(const BoundingSphere& sphere, std::vector<uint_t>& objects) const;
+
+	private:
+		bool is_leaf(uint_t node) const
+		{
+			return mNodes[node].right == LEAF;
+		}
+
+		void fit(uint_t node);
+
+		void rotate_node(uint_t node);
+
+		void restructure_treelet(uint_t root);
+
+		void add_subtree(uint_t node, std::vector<uint_t>& objects) const;
+
+		template <class Volume>
+		void query_volume(const Volume& volume, std::vector<uint_t>& objects) const;
+	};
+
+} // namespace Math
+
+#endif // __MATHS_BOXBVH_HPP__
@@ -0,0 +1,59 @@
+#include "Precompiled.hpp"
+#include "Capsule.hpp"
+#include "BoundingBox.hpp"
+#include "BoundingSphere.hpp"
+#include "Distance.hpp"
+#include "Matrix.hpp"
+
+namespace
+{
+	// The largest sum of the absolute dot products of one of the first three rows with each of them
+	float largest_row_sum(CXMMATRIX matrix)
+	{
+		float largest = 0.0f;
+		for (uint_t i = 0; i < 3; ++i)
+		{
+			const XMVECTOR sum = XMVectorAdd(XMVectorAbs(XMVector3Dot(matrix.r[i], matrix.r[0])), XMVectorAdd(XMVectorAbs(XMVector3Dot(matrix.r[i], matrix.r[1])), XMVectorAbs(XMVector3Dot(matrix.r[i], matrix.r[2]))));
+			largest = std::max(largest, XMVectorGetX(sum));
+		}
+		return largest;
+	}
+
+	// An upper bound on how far the matrix stretches any direction, its largest singular value. The squared singular
+	// values are the eigenvalues of the matrix times its transpose, and of the transpose times the matrix, and no
+	// eigenvalue is more than the largest absolute row sum of either (Gershgorin). The first is exact when the rows are
+	// orthogonal (scaling then rotating) and the second when the columns are (rotating then scaling).
+	float maximum_scale(const Math::Matrix& matrix)
+	{
+		return std::sqrt(std::min(::largest_row_sum(matrix), ::largest_row_sum(XMMatrixTranspose(matrix))));
+	}
+}
+
+namespace Math
+{
+
+	bool Capsule::contains(const Vector3& point) const
+	{
+		return Distance::closest(point, mSegment).distance_squared() <= mRadius * mRadius;
+	}
+
+	Capsule Capsule::transform(const Matrix& matrix) const
+	{
+		const Line segment(matrix.transform(mSegment.start_point), matrix.transform(mSegment.end_point));
+		return Capsule(segment, mRadius * ::maximum_scale(matrix));
+	}
+
+	BoundingBox Capsule::get_bounding_box() const
+	{
+		const Vector3 radius(mRadius, mRadius, mRadius);
+		const Vector3 minimum = Vector3::minimise(mSegment.start_point, mSegment.end_point);
+		const Vector3 maximum = Vector3::maximise(mSegment.start_point, mSegment.end_point);
+		return BoundingBox(minimum - radius, maximum + radius, ALREADY_SORTED);
+	}
+
+	BoundingSphere Capsule::get_bounding_sphere() const
+	{
+		return BoundingSphere(mSegment.mid_point(), 0.5f * mSegment.length() + mRadius);
+	}
+
+} // namespace Math
@@ -0,0 +1,155 @@
+#pragma once
+#ifndef __MATHS_CAPSULE_HPP__
+#define __MATHS_CAPSULE_HPP__
+
+#include "Vector3.hpp"
+#include "Line.hpp"
+
+namespace Math
+{
+	class Matrix;
+	class BoundingBox;
+	class BoundingSphere;
+	template <class Type> struct SoaTraits;
+
+	// All the points within radius of a line segment, a sphere swept from one end of the segment to the other
+	class Capsule
+	{
+	private:
+		Line mSegment;
+		float mRadius;
+
+	public:
+		//--------------------------------------------------------------------------
+		// Constructors
+		//
+
+		Capsule() : mRadius(0.0f)
+		{
+		}
+
+		Capsule(const Line& segment, float radius) : mSegment(segment), mRadius(std::abs(radius))
+		{
+		}
+
+		Capsule(const Vector3& start, const Vector3& end, float radius) : mSegment(start, end), mRadius(std::abs(radius))
+		{
+		}
+
+		Capsule(const Capsule& capsule) : mSegment(capsule.mSegment), mRadius(capsule.mRadius)
+		{
+		}
+
+		//--------------------------------------------------------------------------
+		// Assignment
+		//
+
+		Capsule& operator = (const Capsule& capsule)
+		{
+			mSegment = capsule.mSegment;
+			mRadius = capsule.mRadius;
+			return *this;
+		}
+
+		//--------------------------------------------------------------------------
+		// Comparison
+		//
+
+		bool operator == (const Capsule& capsule) const
+		{
+			return mSegment == capsule.mSegment && mRadius == capsule.mRadius;
+		}
+
+		bool operator != (const Capsule& capsule) const
+		{
+			return mSegment != capsule.mSegment || mRadius != capsule.mRadius;
+		}
+
+		bool contains(const Vector3& point) const;
+
+		bool is_empty() const
+		{
+			return mRadius <= FLT_EPSILON;
+		}
+
+		//--------------------------------------------------------------------------
+		// Accessors
+		//
+
+		void set(const Line& segment, float radius)
+		{
+			mSegment = segment;
+			mRadius = std::abs(radius);
+		}
+
+		void segment(const Line& segment)
+		{
+			mSegment = segment;
+		}
+
+		const Line& segment() const
+		{
+			return mSegment;
+		}
+
+		void radius(float radius)
+		{
+			mRadius = std::abs(radius);
+		}
+
+		float radius() const
+		{
+			return mRadius;
+		}
+
+		//--------------------------------------------------------------------------
+		// Computation
+		//
+
+		// The radius is scaled by a bound on how far the matrix stretches any direction, so the result contains the
+		// capsule under any rotation and non-uniform scale, in either order
+		Capsule transform(const Matrix& matrix) const;
+
+		BoundingBox get_bounding_box() const;
+
+		// Centered on the middle of the segment, which is the smallest sphere containing the capsule
+		BoundingSphere get_bounding_sphere() const;
+	};
+
+	// Component layout of an SoaArray<Capsule>
+	template <> struct SoaTraits<Capsule>
+	{
+		enum Component : uint_t
+		{
+			START_X,
+			START_Y,
+			START_Z,
+			END_X,
+			END_Y,
+			END_Z,
+			RADIUS,
+
+			COMPONENT_COUNT
+		};
+
+		static void scatter(const Capsule& capsule, float* components)
+		{
+			const Line& segment = capsule.segment();
+			components[START_X] = segment.start_point.x;
+			components[START_Y] = segment.start_point.y;
+			components[START_Z] = segment.start_point.z;
+			components[END_X] = segment.end_point.x;
+			components[END_Y] = segment.end_point.y;
+			components[END_Z] = segment.end_point.z;
+			components[RADIUS] = capsule.radius();
+		}
+
+		static Capsule gather(const float* components)
+		{
+			return Capsule(Vector3(components[START_X], components[START_Y], components[START_Z]), Vector3(components[END_X], components[END_Y], components[END_Z]), components[RADIUS]);
+		}
+	};
+
+} // namespace Math
+
+#endif // __MATHS_CAPSULE_HPP__
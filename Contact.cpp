@@ -0,0 +1,650 @@
+#include "Precompiled.hpp"
+#include "Contact.hpp"
+#include "Distance.hpp"
+#include "Line.hpp"
+#include "BoundingSphere.hpp"
+#include "BoundingBox.hpp"
+#include "OrientedBox.hpp"
+#include "Matrix.hpp"
+#include "SoaArray.hpp"
+#include "SoaVector3.hpp"
+
+namespace
+{
+	// Squared lengths below this are treated as zero, so have no direction
+	const float DEGENERATE_LENGTH_SQUARED = FLT_EPSILON * FLT_EPSILON;
+
+	// An edge axis has to beat the best face axis by this factor to be used, which stops the contact
+	// flipping between a face and an edge when boxes rest on each other
+	const float EDGE_AXIS_TOLERANCE = 0.95f;
+
+	// A face of B has to beat the best face of A by this factor, for the same reason
+	const float FACE_AXIS_TOLERANCE = 0.98f;
+
+	// Ids of edge/edge contacts have this bit set, face contacts never do
+	const uint_t EDGE_CONTACT_ID = 1 << 20;
+
+	const Math::Vector3 AXES[3] = { Math::Vector3(1.0f, 0.0f, 0.0f), Math::Vector3(0.0f, 1.0f, 0.0f), Math::Vector3(0.0f, 0.0f, 1.0f) };
+
+	float component(const Math::Vector3& v, uint_t axis)
+	{
+		return (&v.x)[axis];
+	}
+
+	uint_t smallest_axis(const Math::Vector3& v)
+	{
+		if (v.x <= v.y && v.x <= v.z) return 0;
+		return v.y <= v.z ? 1 : 2;
+	}
+
+	// Sphere against the box [-extents, extents] with the sphere's center in the box's local space. Gives the normal
+	// from the sphere to the box, the depth and the point halfway between the deepest points of each shape.
+	bool sphere_box_local(const Math::Vector3& center, float radius, const Math::Vector3& extents, Math::Vector3& normal, Math::Vector3& position, float& depth)
+	{
+		const Math::Vector3 closest(XMVectorClamp(center, XMVectorNegate(extents), extents));
+		const Math::Vector3 offset = closest - center;
+		const float distance_squared = offset.length_squared();
+		if (distance_squared > radius * radius) return false;
+
+		if (distance_squared > DEGENERATE_LENGTH_SQUARED)
+		{
+			const float distance = std::sqrt(distance_squared);
+			normal = offset / distance;
+			depth = radius - distance;
+			position = closest + normal * (depth * 0.5f);
+			return true;
+		}
+
+		// The center is inside the box, so it is pushed out through the nearest face
+		const Math::Vector3 face_distance(XMVectorSubtract(extents, XMVectorAbs(center)));
+		const uint_t axis = ::smallest_axis(face_distance);
+		const float side = component(center, axis) < 0.0f ? -1.0f : 1.0f;
+
+		Math::Vector3 face_point = center;
+		(&face_point.x)[axis] = side * component(extents, axis);
+
+		normal = AXES[axis] * -side;
+		depth = radius + component(face_distance, axis);
+		position = Math::Vector3::lerp(face_point, center + normal * radius, 0.5f);
+		return true;
+	}
+
+	// Two axis aligned boxes are pushed apart along the axis they penetrate least on, which is not always the one their
+	// overlap is thinnest along as one box may be inside the other. The contacts are the corners of the overlap's face
+	// across that axis, halfway between the two faces that are touching.
+	bool box_box(const Math::Vector3& minimum_a, const Math::Vector3& maximum_a, const Math::Vector3& minimum_b, const Math::Vector3& maximum_b, Math::Contact::Manifold& manifold)
+	{
+		const Math::Vector3 lower = Math::Vector3::maximise(minimum_a, minimum_b);
+		const Math::Vector3 upper = Math::Vector3::minimise(maximum_a, maximum_b);
+		if (lower.x > upper.x || lower.y > upper.y || lower.z > upper.z) return false;
+
+		// Moving B up or down each axis
+		const Math::Vector3 up = maximum_a - minimum_b;
+		const Math::Vector3 down = maximum_b - minimum_a;
+		const uint_t axis = ::smallest_axis(Math::Vector3::minimise(up, down));
+		const bool positive = component(up, axis) <= component(down, axis);
+
+		const uint_t u = (axis + 1) % 3;
+		const uint_t v = (axis + 2) % 3;
+		const float depth = positive ? component(up, axis) : component(down, axis);
+		const float middle = positive ? (component(maximum_a, axis) + component(minimum_b, axis)) * 0.5f : (component(maximum_b, axis) + component(minimum_a, axis)) * 0.5f;
+		const uint_t face = axis * 2 + (positive ? 0 : 1);
+
+		manifold.set_normal(positive ? AXES[axis] : -AXES[axis]);
+
+		static const uint_t CORNERS[4][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } };
+		for (uint_t corner = 0; corner < 4; ++corner)
+		{
+			Math::Vector3 position;
+			(&position.x)[axis] = middle;
+			(&position.x)[u] = component(CORNERS[corner][0] ? upper : lower, u);
+			(&position.x)[v] = component(CORNERS[corner][1] ? upper : lower, v);
+			manifold.add_point(position, depth, (face << 2) | corner);
+		}
+		return true;
+	}
+
+	// An oriented box as its center, axes and extents in world space
+	struct BoxFrame
+	{
+		Math::Vector3 center;
+		Math::Vector3 axes[3];
+		float extents[3];
+	};
+
+	BoxFrame box_frame(const Math::OrientedBox& box)
+	{
+		const Math::Matrix rotation = box.rotation_matrix();
+
+		BoxFrame frame;
+		frame.center = box.center();
+		for (uint_t i = 0; i < 3; ++i)
+		{
+			frame.axes[i] = Math::Vector3(rotation.r[i]);
+			frame.extents[i] = component(box.extents(), i);
+		}
+		return frame;
+	}
+
+	float projected_radius(const BoxFrame& box, const Math::Vector3& axis)
+	{
+		return box.extents[0] * std::abs(box.axes[0].dot(axis)) + box.extents[1] * std::abs(box.axes[1].dot(axis)) + box.extents[2] * std::abs(box.axes[2].dot(axis));
+	}
+
+	// A vertex of a face being clipped, with the feature of the incident box that it came from
+	struct ClipVertex
+	{
+		Math::Vector3 position;
+		uint_t feature;
+	};
+
+	// Sutherland-Hodgman clip of a polygon against the plane normal . p <= offset. Points made by cutting the edge
+	// starting at vertex i with plane number plane are given the feature 4 + plane * 8 + i.
+	uint_t clip_polygon(const ClipVertex* input, uint_t count, const Math::Vector3& normal, float offset, uint_t plane, ClipVertex* output)
+	{
+		uint_t output_count = 0;
+		for (uint_t i = 0; i < count; ++i)
+		{
+			const ClipVertex& a = input[i];
+			const ClipVertex& b = input[(i + 1) % count];
+			const float distance_a = normal.dot(a.position) - offset;
+			const float distance_b = normal.dot(b.position) - offset;
+
+			if (distance_a <= 0.0f) output[output_count++] = a;
+			if ((distance_a < 0.0f && distance_b > 0.0f) || (distance_a > 0.0f && distance_b < 0.0f))
+			{
+				const ClipVertex cut = { Math::Vector3::lerp(a.position, b.position, distance_a / (distance_a - distance_b)), 4 + plane * 8 + i };
+				output[output_count++] = cut;
+			}
+		}
+		return output_count;
+	}
+
+	// Keeps four of the points, the deepest, the one furthest from it and the two either side of the line between
+	// them that make the largest triangles, which keeps the most area for the least points
+	void reduce_points(Math::Contact::ContactPoint* points, uint_t& count, const Math::Vector3& normal)
+	{
+		if (count <= Math::Contact::MAX_CONTACT_POINTS) return;
+
+		uint_t chosen[4] = { 0, 0, 0, 0 };
+		for (uint_t i = 1; i < count; ++i)
+		{
+			if (points[i].depth > points[chosen[0]].depth) chosen[0] = i;
+		}
+
+		const Math::Vector3 first = points[chosen[0]].position;
+		float furthest = -1.0f;
+		for (uint_t i = 0; i < count; ++i)
+		{
+			const float distance_squared = Math::Vector3(points[i].position - first).length_squared();
+			if (distance_squared > furthest)
+			{
+				furthest = distance_squared;
+				chosen[1] = i;
+			}
+		}
+
+		const Math::Vector3 edge = points[chosen[1]].position - first;
+		float largest = -FLT_MAX;
+		float smallest = FLT_MAX;
+		for (uint_t i = 0; i < count; ++i)
+		{
+			const float area = edge.cross(points[i].position - first).dot(normal);
+			if (area > largest)
+			{
+				largest = area;
+				chosen[2] = i;
+			}
+			if (area < smallest)
+			{
+				smallest = area;
+				chosen[3] = i;
+			}
+		}
+
+		// Nearly collinear points can pick the same point more than once
+		Math::Contact::ContactPoint reduced[4];
+		uint_t reduced_count = 0;
+		for (uint_t i = 0; i < 4; ++i)
+		{
+			if (std::find(chosen, chosen + i, chosen[i]) == chosen + i) reduced[reduced_count++] = points[chosen[i]];
+		}
+		std::copy(reduced, reduced + reduced_count, points);
+		count = reduced_count;
+	}
+
+	// Clips the face of the incident box that faces the reference face against the sides of the reference face, and
+	// keeps the points below it. reference_normal is the outward normal of the reference face.
+	void add_face_points(Math::Contact::Manifold& manifold, const BoxFrame& reference, uint_t reference_axis, const Math::Vector3& reference_normal, const BoxFrame& incident, uint_t id_base)
+	{
+		// The incident face is the one most against the reference normal
+		uint_t incident_axis = 0;
+		float most_aligned = -1.0f;
+		for (uint_t i = 0; i < 3; ++i)
+		{
+			const float alignment = std::abs(incident.axes[i].dot(reference_normal));
+			if (alignment > most_aligned)
+			{
+				most_aligned = alignment;
+				incident_axis = i;
+			}
+		}
+		const float incident_side = incident.axes[incident_axis].dot(reference_normal) > 0.0f ? -1.0f : 1.0f;
+		const Math::Vector3 incident_center = incident.center + incident.axes[incident_axis] * (incident_side * incident.extents[incident_axis]);
+
+		const uint_t iu = (incident_axis + 1) % 3;
+		const uint_t iv = (incident_axis + 2) % 3;
+		const Math::Vector3 u = incident.axes[iu] * incident.extents[iu];
+		const Math::Vector3 v = incident.axes[iv] * incident.extents[iv];
+
+		ClipVertex polygon[8] =
+		{
+			{ incident_center + u + v, 0 },
+			{ incident_center - u + v, 1 },
+			{ incident_center - u - v, 2 },
+			{ incident_center + u - v, 3 }
+		};
+		ClipVertex clipped[8];
+		uint_t count = 4;
+
+		// The four side planes of the reference face
+		const uint_t ru = (reference_axis + 1) % 3;
+		const uint_t rv = (reference_axis + 2) % 3;
+		const Math::Vector3 sides[4] = { reference.axes[ru], -reference.axes[ru], reference.axes[rv], -reference.axes[rv] };
+		const float extents[4] = { reference.extents[ru], reference.extents[ru], reference.extents[rv], reference.extents[rv] };
+		for (uint_t plane = 0; plane < 4 && count > 0; ++plane)
+		{
+			count = ::clip_polygon(polygon, count, sides[plane], sides[plane].dot(reference.center) + extents[plane], plane, clipped);
+			std::copy(clipped, clipped + count, polygon);
+		}
+
+		const float face_offset = reference_normal.dot(reference.center) + reference.extents[reference_axis];
+		const uint_t incident_face = incident_axis * 2 + (incident_side < 0.0f ? 1 : 0);
+
+		Math::Contact::ContactPoint points[8];
+		uint_t point_count = 0;
+		for (uint_t i = 0; i < count; ++i)
+		{
+			const float separation = reference_normal.dot(polygon[i].position) - face_offset;
+			if (separation > 0.0f) continue;
+
+			const Math::Contact::ContactPoint point = { polygon[i].position - reference_normal * (separation * 0.5f), -separation, id_base | (incident_face << 8) | polygon[i].feature };
+			points[point_count++] = point;
+		}
+
+		::reduce_points(points, point_count, reference_normal);
+		for (uint_t i = 0; i < point_count; ++i)
+		{
+			manifold.add_point(points[i].position, points[i].depth, points[i].id);
+		}
+	}
+
+	// The edge of the box along axis that is furthest in direction, with an id from the axis and the sides it is on
+	Math::Line support_edge(const BoxFrame& box, uint_t axis, const Math::Vector3& direction, uint_t& id)
+	{
+		Math::Vector3 middle = box.center;
+		id = axis << 2;
+		for (uint_t k = 1; k < 3; ++k)
+		{
+			const uint_t other = (axis + k) % 3;
+			const bool positive = box.axes[other].dot(direction) >= 0.0f;
+			middle += box.axes[other] * (positive ? box.extents[other] : -box.extents[other]);
+			if (positive) id |= k;
+		}
+		const Math::Vector3 half = box.axes[axis] * box.extents[axis];
+		return Math::Line(middle - half, middle + half);
+	}
+
+	// Separating axis test between two oriented boxes tracking the axis of least penetration, then contact points from
+	// clipping the incident face against the reference face, or a single point between two edges. Follows the approach
+	// of Box2D and ODE's dBoxBox, and the axes are the same 15 as in Gottschalk's OBBTree.
+	bool box_box(const BoxFrame& a, const BoxFrame& b, Math::Contact::Manifold& manifold)
+	{
+		const Math::Vector3 t = b.center - a.center;
+
+		float best_face_depth = FLT_MAX;
+		uint_t best_face = 0;
+		bool face_of_b = false;
+
+		for (uint_t i = 0; i < 3; ++i)
+		{
+			const float depth = a.extents[i] + ::projected_radius(b, a.axes[i]) - std::abs(t.dot(a.axes[i]));
+			if (depth < 0.0f) return false;
+			if (depth < best_face_depth)
+			{
+				best_face_depth = depth;
+				best_face = i;
+			}
+		}
+
+		const float best_a_depth = best_face_depth;
+		for (uint_t i = 0; i < 3; ++i)
+		{
+			const float depth = b.extents[i] + ::projected_radius(a, b.axes[i]) - std::abs(t.dot(b.axes[i]));
+			if (depth < 0.0f) return false;
+			if (depth < FACE_AXIS_TOLERANCE * best_a_depth && depth < best_face_depth)
+			{
+				best_face_depth = depth;
+				best_face = i;
+				face_of_b = true;
+			}
+		}
+
+		float best_edge_depth = FLT_MAX;
+		uint_t edge_a = 0;
+		uint_t edge_b = 0;
+		Math::Vector3 edge_axis;
+
+		// Edge cross product axes, skipping the near zero ones from parallel edges as the face axes cover those
+		for (uint_t i = 0; i < 3; ++i)
+		{
+			for (uint_t j = 0; j < 3; ++j)
+			{
+				Math::Vector3 axis = a.axes[i].cross(b.axes[j]);
+				const float length_squared = axis.length_squared();
+				if (length_squared <= 1.0e-6f) continue;
+
+				axis /= std::sqrt(length_squared);
+				const float depth = ::projected_radius(a, axis) + ::projected_radius(b, axis) - std::abs(t.dot(axis));
+				if (depth < 0.0f) return false;
+				if (depth < best_edge_depth)
+				{
+					best_edge_depth = depth;
+					edge_a = i;
+					edge_b = j;
+					edge_axis = axis;
+				}
+			}
+		}
+
+		if (best_edge_depth < EDGE_AXIS_TOLERANCE * best_face_depth)
+		{
+			const Math::Vector3 normal = edge_axis.dot(t) < 0.0f ? -edge_axis : edge_axis;
+			manifold.set_normal(normal);
+
+			uint_t id_a;
+			uint_t id_b;
+			const Math::Line line_a = ::support_edge(a, edge_a, normal, id_a);
+			const Math::Line line_b = ::support_edge(b, edge_b, -normal, id_b);
+			const Math::Distance::ClosestResult closest = Math::Distance::closest(line_a, line_b);
+			manifold.add_point(Math::Vector3::lerp(closest.point_a(), closest.point_b(), 0.5f), best_edge_depth, EDGE_CONTACT_ID | (id_a << 4) | id_b);
+			return true;
+		}
+
+		const BoxFrame& reference = face_of_b ? b : a;
+		const BoxFrame& incident = face_of_b ? a : b;
+		const Math::Vector3& axis = reference.axes[best_face];
+
+		// The normal runs from A to B, and the reference face is the one facing the other box
+		const Math::Vector3 normal = axis.dot(t) < 0.0f ? -axis : axis;
+		const Math::Vector3 reference_normal = face_of_b ? -normal : normal;
+		const uint_t reference_face = best_face * 2 + (reference_normal.dot(axis) < 0.0f ? 1 : 0);
+
+		manifold.set_normal(normal);
+		::add_face_points(manifold, reference, best_face, reference_normal, incident, ((face_of_b ? 1 : 0) << 16) | (reference_face << 12));
+		return !manifold.empty();
+	}
+
+	// Loads one component of the elements at the given indices of a view into the lanes of a vector
+	template <class Type>
+	XMVECTOR gather(const Math::SoaView<Type>& view, uint_t c, const uint_t* indices)
+	{
+		const float* values = view.component(c);
+		return XMVectorSet(values[indices[0]], values[indices[1]], values[indices[2]], values[indices[3]]);
+	}
+
+	// Splits up to four pairs into the index lanes of A and B, with unused lanes repeating the first pair
+	uint_t pair_lanes(const Math::ArrayView<Math::Contact::Pair>& pairs, size_t first, uint_t* indices_a, uint_t* indices_b)
+	{
+		const uint_t lane_count = static_cast<uint_t>(std::min<size_t>(Math::SOA_LANE_COUNT, pairs.size() - first));
+		for (uint_t lane = 0; lane < Math::SOA_LANE_COUNT; ++lane)
+		{
+			const Math::Contact::Pair& pair = pairs[first + (lane < lane_count ? lane : 0)];
+			indices_a[lane] = pair.first;
+			indices_b[lane] = pair.second;
+		}
+		return lane_count;
+	}
+}
+
+namespace Math
+{
+
+	bool Contact::generate(const BoundingSphere& sphereA, const BoundingSphere& sphereB, Manifold& manifold)
+	{
+		manifold.clear();
+
+		const Vector3 offset = sphereB.center() - sphereA.center();
+		const float radius = sphereA.radius() + sphereB.radius();
+		const float distance_squared = offset.length_squared();
+		if (distance_squared > radius * radius) return false;
+
+		// Concentric spheres have no preferred direction, so any will do
+		const float distance = std::sqrt(distance_squared);
+		const Vector3 normal = distance_squared > DEGENERATE_LENGTH_SQUARED ? offset / distance : AXES[1];
+		const float depth = radius - distance;
+
+		manifold.set_normal(normal);
+		manifold.add_point(sphereA.center() + normal * (sphereA.radius() - depth * 0.5f), depth, 0);
+		return true;
+	}
+
+	bool Contact::generate(const BoundingSphere& sphereA, const BoundingBox& boxB, Manifold& manifold)
+	{
+		manifold.clear();
+
+		const Vector3 center = boxB.center();
+		Vector3 normal;
+		Vector3 position;
+		float depth;
+		if (!::sphere_box_local(sphereA.center() - center, sphereA.radius(), boxB.extents(), normal, position, depth)) return false;
+
+		manifold.set_normal(normal);
+		manifold.add_point(position + center, depth, 0);
+		return true;
+	}
+
+	bool Contact::generate(const BoundingSphere& sphereA, const OrientedBox& boxB, Manifold& manifold)
+	{
+		manifold.clear();
+
+		// In the box's space it is the same as the axis aligned test
+		const XMVECTOR inverse_orientation = XMQuaternionConjugate(boxB.orientation());
+		const Vector3 center(XMVector3Rotate(XMVectorSubtract(sphereA.center(), boxB.center()), inverse_orientation));
+
+		Vector3 normal;
+		Vector3 position;
+		float depth;
+		if (!::sphere_box_local(center, sphereA.radius(), boxB.extents(), normal, position, depth)) return false;
+
+		manifold.set_normal(Vector3(XMVector3Rotate(normal, boxB.orientation())));
+		manifold.add_point(Vector3(XMVector3Rotate(position, boxB.orientation())) + boxB.center(), depth, 0);
+		return true;
+	}
+
+	bool Contact::generate(const BoundingBox& boxA, const BoundingBox& boxB, Manifold& manifold)
+	{
+		manifold.clear();
+
+		return ::box_box(boxA.minimum_corner(), boxA.maximum_corner(), boxB.minimum_corner(), boxB.maximum_corner(), manifold);
+	}
+
+	bool Contact::generate(const BoundingBox& boxA, const OrientedBox& boxB, Manifold& manifold)
+	{
+		return generate(OrientedBox(boxA), boxB, manifold);
+	}
+
+	bool Contact::generate(const OrientedBox& boxA, const OrientedBox& boxB, Manifold& manifold)
+	{
+		manifold.clear();
+		if (::box_box(::box_frame(boxA), ::box_frame(boxB), manifold)) return true;
+
+		manifold.clear();
+		return false;
+	}
+
+
+	void Contact::generate(const SoaView<BoundingSphere>& spheresA, const SoaView<BoundingSphere>& spheresB, const ArrayView<Pair>& pairs, Manifold* manifolds)
+	{
+		typedef SoaTraits<BoundingSphere> Traits;
+
+		const XMVECTOR zero = XMVectorZero();
+		const XMVECTOR half = XMVectorReplicate(0.5f);
+
+		for (size_t first = 0; first < pairs.size(); first += SOA_LANE_COUNT)
+		{
+			uint_t indices_a[SOA_LANE_COUNT];
+			uint_t indices_b[SOA_LANE_COUNT];
+			const uint_t lane_count = ::pair_lanes(pairs, first, indices_a, indices_b);
+
+			const SoaVector3 center_a = soa_vector3(::gather(spheresA, Traits::CENTER_X, indices_a), ::gather(spheresA, Traits::CENTER_Y, indices_a), ::gather(spheresA, Traits::CENTER_Z, indices_a));
+			const SoaVector3 center_b = soa_vector3(::gather(spheresB, Traits::CENTER_X, indices_b), ::gather(spheresB, Traits::CENTER_Y, indices_b), ::gather(spheresB, Traits::CENTER_Z, indices_b));
+			const XMVECTOR radius_a = ::gather(spheresA, Traits::RADIUS, indices_a);
+			const XMVECTOR radius = XMVectorAdd(radius_a, ::gather(spheresB, Traits::RADIUS, indices_b));
+
+			// As the scalar test, with concentric pairs given the y axis as their normal
+			const SoaVector3 offset = soa_subtract(center_b, center_a);
+			const XMVECTOR distance_squared = soa_length_squared(offset);
+			const XMVECTOR distance = XMVectorSqrt(distance_squared);
+			const XMVECTOR degenerate = XMVectorLessOrEqual(distance_squared, XMVectorReplicate(DEGENERATE_LENGTH_SQUARED));
+			const SoaVector3 normal = soa_select(soa_scale(offset, XMVectorReciprocal(distance)), soa_vector3(zero, XMVectorSplatOne(), zero), degenerate);
+
+			XMVECTORU32 hit;
+			hit.v = XMVectorLessOrEqual(distance_squared, XMVectorMultiply(radius, radius));
+
+			XMVECTORF32 depth;
+			depth.v = XMVectorSubtract(radius, distance);
+			const SoaVector3 position = soa_multiply_add(normal, XMVectorNegativeMultiplySubtract(depth.v, half, radius_a), center_a);
+
+			XMVECTORF32 normal_x, normal_y, normal_z, position_x, position_y, position_z;
+			normal_x.v = normal.x;
+			normal_y.v = normal.y;
+			normal_z.v = normal.z;
+			position_x.v = position.x;
+			position_y.v = position.y;
+			position_z.v = position.z;
+
+			for (uint_t lane = 0; lane < lane_count; ++lane)
+			{
+				Manifold& manifold = manifolds[first + lane];
+				manifold.clear();
+				if (!hit.u[lane]) continue;
+
+				manifold.set_normal(Vector3(normal_x.f[lane], normal_y.f[lane], normal_z.f[lane]));
+				manifold.add_point(Vector3(position_x.f[lane], position_y.f[lane], position_z.f[lane]), depth.f[lane], 0);
+			}
+		}
+	}
+
+	void Contact::generate(const SoaView<BoundingSphere>& spheresA, const SoaView<BoundingBox>& boxesB, const ArrayView<Pair>& pairs, Manifold* manifolds)
+	{
+		typedef SoaTraits<BoundingSphere> SphereTraits;
+		typedef SoaTraits<BoundingBox> BoxTraits;
+
+		const XMVECTOR half = XMVectorReplicate(0.5f);
+
+		for (size_t first = 0; first < pairs.size(); first += SOA_LANE_COUNT)
+		{
+			uint_t indices_a[SOA_LANE_COUNT];
+			uint_t indices_b[SOA_LANE_COUNT];
+			const uint_t lane_count = ::pair_lanes(pairs, first, indices_a, indices_b);
+
+			const SoaVector3 center = soa_vector3(::gather(spheresA, SphereTraits::CENTER_X, indices_a), ::gather(spheresA, SphereTraits::CENTER_Y, indices_a), ::gather(spheresA, SphereTraits::CENTER_Z, indices_a));
+			const XMVECTOR radius = ::gather(spheresA, SphereTraits::RADIUS, indices_a);
+			const SoaVector3 minimum = soa_vector3(::gather(boxesB, BoxTraits::MIN_X, indices_b), ::gather(boxesB, BoxTraits::MIN_Y, indices_b), ::gather(boxesB, BoxTraits::MIN_Z, indices_b));
+			const SoaVector3 maximum = soa_vector3(::gather(boxesB, BoxTraits::MAX_X, indices_b), ::gather(boxesB, BoxTraits::MAX_Y, indices_b), ::gather(boxesB, BoxTraits::MAX_Z, indices_b));
+
+			// The centers outside their box are done here, the few inside are left to the scalar test
+			const SoaVector3 closest = soa_min(soa_max(center, minimum), maximum);
+			const SoaVector3 offset = soa_subtract(closest, center);
+			const XMVECTOR distance_squared = soa_length_squared(offset);
+			const XMVECTOR distance = XMVectorSqrt(distance_squared);
+
+			XMVECTORU32 hit, inside;
+			hit.v = XMVectorLessOrEqual(distance_squared, XMVectorMultiply(radius, radius));
+			inside.v = XMVectorLessOrEqual(distance_squared, XMVectorReplicate(DEGENERATE_LENGTH_SQUARED));
+
+			XMVECTORF32 depth;
+			depth.v = XMVectorSubtract(radius, distance);
+			const SoaVector3 normal = soa_scale(offset, XMVectorReciprocal(distance));
+			const SoaVector3 position = soa_multiply_add(normal, XMVectorMultiply(depth.v, half), closest);
+
+			XMVECTORF32 normal_x, normal_y, normal_z, position_x, position_y, position_z;
+			normal_x.v = normal.x;
+			normal_y.v = normal.y;
+			normal_z.v = normal.z;
+			position_x.v = position.x;
+			position_y.v = position.y;
+			position_z.v = position.z;
+
+			for (uint_t lane = 0; lane < lane_count; ++lane)
+			{
+				Manifold& manifold = manifolds[first + lane];
+				manifold.clear();
+				if (!hit.u[lane]) continue;
+
+				if (inside.u[lane])
+				{
+					generate(spheresA[indices_a[lane]], boxesB[indices_b[lane]], manifold);
+					continue;
+				}
+
+				manifold.set_normal(Vector3(normal_x.f[lane], normal_y.f[lane], normal_z.f[lane]));
+				manifold.add_point(Vector3(position_x.f[lane], position_y.f[lane], position_z.f[lane]), depth.f[lane], 0);
+			}
+		}
+	}
+
+	void Contact::generate(const SoaView<BoundingBox>& boxesA, const SoaView<BoundingBox>& boxesB, const ArrayView<Pair>& pairs, Manifold* manifolds)
+	{
+		typedef SoaTraits<BoundingBox> Traits;
+
+		for (size_t first = 0; first < pairs.size(); first += SOA_LANE_COUNT)
+		{
+			uint_t indices_a[SOA_LANE_COUNT];
+			uint_t indices_b[SOA_LANE_COUNT];
+			const uint_t lane_count = ::pair_lanes(pairs, first, indices_a, indices_b);
+
+			const SoaVector3 minimum_a = soa_vector3(::gather(boxesA, Traits::MIN_X, indices_a), ::gather(boxesA, Traits::MIN_Y, indices_a), ::gather(boxesA, Traits::MIN_Z, indices_a));
+			const SoaVector3 maximum_a = soa_vector3(::gather(boxesA, Traits::MAX_X, indices_a), ::gather(boxesA, Traits::MAX_Y, indices_a), ::gather(boxesA, Traits::MAX_Z, indices_a));
+			const SoaVector3 minimum_b = soa_vector3(::gather(boxesB, Traits::MIN_X, indices_b), ::gather(boxesB, Traits::MIN_Y, indices_b), ::gather(boxesB, Traits::MIN_Z, indices_b));
+			const SoaVector3 maximum_b = soa_vector3(::gather(boxesB, Traits::MAX_X, indices_b), ::gather(boxesB, Traits::MAX_Y, indices_b), ::gather(boxesB, Traits::MAX_Z, indices_b));
+
+			// Pairs that are apart are ruled out four at a time, the axis and the corners are picked per pair
+			const SoaVector3 lower = soa_max(minimum_a, minimum_b);
+			const SoaVector3 upper = soa_min(maximum_a, maximum_b);
+
+			XMVECTORU32 hit;
+			hit.v = XMVectorAndInt(XMVectorLessOrEqual(lower.x, upper.x), XMVectorAndInt(XMVectorLessOrEqual(lower.y, upper.y), XMVectorLessOrEqual(lower.z, upper.z)));
+
+			XMVECTORF32 lanes[12];
+			const XMVECTOR values[12] = { minimum_a.x, minimum_a.y, minimum_a.z, maximum_a.x, maximum_a.y, maximum_a.z, minimum_b.x, minimum_b.y, minimum_b.z, maximum_b.x, maximum_b.y, maximum_b.z };
+			for (uint_t i = 0; i < 12; ++i)
+			{
+				lanes[i].v = values[i];
+			}
+
+			for (uint_t lane = 0; lane < lane_count; ++lane)
+			{
+				Manifold& manifold = manifolds[first + lane];
+				manifold.clear();
+				if (!hit.u[lane]) continue;
+
+				const Vector3 lane_minimum_a(lanes[0].f[lane], lanes[1].f[lane], lanes[2].f[lane]);
+				const Vector3 lane_maximum_a(lanes[3].f[lane], lanes[4].f[lane], lanes[5].f[lane]);
+				const Vector3 lane_minimum_b(lanes[6].f[lane], lanes[7].f[lane], lanes[8].f[lane]);
+				const Vector3 lane_maximum_b(lanes[9].f[lane], lanes[10].f[lane], lanes[11].f[lane]);
+				::box_box(lane_minimum_a, lane_maximum_a, lane_minimum_b, lane_maximum_b, manifold);
+			}
+		}
+	}
+
+	void Contact::generate(const ArrayView<OrientedBox>& boxesA, const ArrayView<OrientedBox>& boxesB, const ArrayView<Pair>& pairs, Manifold* manifolds)
+	{
+		for (size_t i = 0; i < pairs.size(); ++i)
+		{
+			generate(boxesA[pairs[i].first], boxesB[pairs[i].second], manifolds[i]);
+		}
+	}
+
+} // namespace Math
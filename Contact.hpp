@@ -0,0 +1,134 @@
+#pragma once
+#ifndef __MATHS_CONTACT_HPP__
+#define __MATHS_CONTACT_HPP__
+
+#include "Vector3.hpp"
+#include "ArrayView.hpp"
+
+namespace Math
+{
+	class BoundingSphere;
+	class BoundingBox;
+	class OrientedBox;
+
+	template <class Type> class SoaView;
+
+	namespace Contact
+	{
+		static const uint_t MAX_CONTACT_POINTS = 4;
+
+		// A point where the shapes touch, halfway between their surfaces. The id is made from the features of
+		// the two shapes that produced the point, so it stays the same from step to step while they keep touching
+		// the same way and can be used to match up points for warm starting.
+		struct ContactPoint
+		{
+			Vector3 position;
+			float depth;
+			uint_t id;
+		};
+
+		class Manifold
+		{
+		private:
+			Vector3 mNormal; // From A towards B, moving B along it separates them
+			ContactPoint mPoints[MAX_CONTACT_POINTS];
+			uint_t mPointCount;
+
+		public:
+			Manifold() : mPointCount(0)
+			{
+			}
+
+			Manifold(const Manifold& manifold) : mNormal(manifold.mNormal), mPointCount(manifold.mPointCount)
+			{
+				std::copy(manifold.mPoints, manifold.mPoints + mPointCount, mPoints);
+			}
+
+			Manifold& operator = (const Manifold& manifold)
+			{
+				mNormal = manifold.mNormal;
+				mPointCount = manifold.mPointCount;
+				std::copy(manifold.mPoints, manifold.mPoints + mPointCount, mPoints);
+				return *this;
+			}
+
+			bool empty() const
+			{
+				return mPointCount == 0;
+			}
+
+			const Vector3& normal() const
+			{
+				return mNormal;
+			}
+
+			uint_t point_count() const
+			{
+				return mPointCount;
+			}
+
+			const ContactPoint& point(uint_t index) const
+			{
+				XMASSERT(index < mPointCount);
+				return mPoints[index];
+			}
+
+			// Finds the point with the given id, for carrying impulses over from the previous step
+			bool find_point(uint_t id, uint_t& index) const
+			{
+				for (uint_t i = 0; i < mPointCount; ++i)
+				{
+					if (mPoints[i].id == id)
+					{
+						index = i;
+						return true;
+					}
+				}
+				return false;
+			}
+
+			void clear()
+			{
+				mPointCount = 0;
+			}
+
+			void set_normal(const Vector3& normal)
+			{
+				mNormal = normal;
+			}
+
+			void add_point(const Vector3& position, float depth, uint_t id)
+			{
+				XMASSERT(mPointCount < MAX_CONTACT_POINTS);
+				const ContactPoint point = { position, depth, id };
+				mPoints[mPointCount++] = point;
+			}
+		};
+
+		// Candidate pair from a broadphase, indices into the A and B arrays given alongside it
+		struct Pair
+		{
+			uint_t first;
+			uint_t second;
+		};
+
+		// Returns false, leaving the manifold empty, when A and B do not touch
+		bool generate(const BoundingSphere& sphereA, const BoundingSphere& sphereB, Manifold& manifold);
+		bool generate(const BoundingSphere& sphereA, const BoundingBox& boxB, Manifold& manifold);
+		bool generate(const BoundingSphere& sphereA, const OrientedBox& boxB, Manifold& manifold);
+		bool generate(const BoundingBox& boxA, const BoundingBox& boxB, Manifold& manifold);
+		bool generate(const BoundingBox& boxA, const OrientedBox& boxB, Manifold& manifold);
+		bool generate(const OrientedBox& boxA, const OrientedBox& boxB, Manifold& manifold);
+
+
+		// One manifold per pair, pairs that do not touch are given an empty manifold
+		void generate(const SoaView<BoundingSphere>& spheresA, const SoaView<BoundingSphere>& spheresB, const ArrayView<Pair>& pairs, Manifold* manifolds);
+		void generate(const SoaView<BoundingSphere>& spheresA, const SoaView<BoundingBox>& boxesB, const ArrayView<Pair>& pairs, Manifold* manifolds);
+		void generate(const SoaView<BoundingBox>& boxesA, const SoaView<BoundingBox>& boxesB, const ArrayView<Pair>& pairs, Manifold* manifolds);
+		void generate(const ArrayView<OrientedBox>& boxesA, const ArrayView<OrientedBox>& boxesB, const ArrayView<Pair>& pairs, Manifold* manifolds);
+
+	} // namespace Contact
+
+} // namespace Math
+
+#endif // __MATHS_CONTACT_HPP__
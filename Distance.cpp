@@ -0,0 +1,325 @@
+#include "Precompiled.hpp"
+#include "Distance.hpp"
+#include "Intersect.hpp"
+#include "Line.hpp"
+#include "BoundingSphere.hpp"
+#include "BoundingBox.hpp"
+#include "Triangle.hpp"
+#include "SoaArray.hpp"
+#include "SoaVector3.hpp"
+
+namespace
+{
+	// Squared lengths below this are treated as a segment of zero length
+	const float DEGENERATE_LENGTH_SQUARED = FLT_EPSILON * FLT_EPSILON;
+
+	float clamp01(const float n)
+	{
+		return std::min(std::max(n, 0.0f), 1.0f);
+	}
+
+	XMVECTOR closest_on_segment(FXMVECTOR point, FXMVECTOR start, FXMVECTOR end)
+	{
+		const XMVECTOR vector = XMVectorSubtract(end, start);
+		const float length_squared = XMVectorGetX(XMVector3LengthSq(vector));
+		if (length_squared <= DEGENERATE_LENGTH_SQUARED) return start;
+
+		const float t = clamp01(XMVectorGetX(XMVector3Dot(XMVectorSubtract(point, start), vector)) / length_squared);
+		return XMVectorMultiplyAdd(vector, XMVectorReplicate(t), start);
+	}
+
+	// Corner of a box with bit i of corner picking the maximum on axis i
+	Math::Vector3 box_corner(const Math::BoundingBox& box, uint_t corner)
+	{
+		const Math::Vector3& minimum = box.minimum_corner();
+		const Math::Vector3& maximum = box.maximum_corner();
+		return Math::Vector3((corner & 1) ? maximum.x : minimum.x, (corner & 2) ? maximum.y : minimum.y, (corner & 4) ? maximum.z : minimum.z);
+	}
+
+	// Writes the lanes of a block that hold real elements, so output only needs to hold the view's size
+	void store_lanes(FXMVECTOR values, float* output, size_t block, uint_t lane_count)
+	{
+		XMVECTORF32 lanes;
+		lanes.v = values;
+		std::copy(lanes.f, lanes.f + lane_count, output + block * Math::SOA_LANE_COUNT);
+	}
+
+	XMVECTOR box_distance_squared(const Math::SoaVector3& point, const Math::SoaBlock<Math::BoundingBox>& boxes)
+	{
+		typedef Math::SoaTraits<Math::BoundingBox> Traits;
+
+		const Math::SoaVector3 minimum = Math::soa_vector3(boxes[Traits::MIN_X], boxes[Traits::MIN_Y], boxes[Traits::MIN_Z]);
+		const Math::SoaVector3 maximum = Math::soa_vector3(boxes[Traits::MAX_X], boxes[Traits::MAX_Y], boxes[Traits::MAX_Z]);
+		const Math::SoaVector3 closest = Math::soa_min(Math::soa_max(point, minimum), maximum);
+		return Math::soa_length_squared(Math::soa_subtract(point, closest));
+	}
+}
+
+namespace Math
+{
+
+	Distance::ClosestResult Distance::closest(const Vector3& pointA, const Line& lineB)
+	{
+		return ClosestResult(pointA, Vector3(::closest_on_segment(pointA, lineB.start_point, lineB.end_point)));
+	}
+
+	Distance::ClosestResult Distance::closest(const Vector3& pointA, const BoundingBox& boxB)
+	{
+		return ClosestResult(pointA, Vector3(XMVectorClamp(pointA, boxB.minimum_corner(), boxB.maximum_corner())));
+	}
+
+	Distance::ClosestResult Distance::closest(const Vector3& pointA, const Triangle& triangleB)
+	{
+		return ClosestResult(pointA, triangleB.closest_point(pointA));
+	}
+
+	Distance::ClosestResult Distance::closest(const Line& lineA, const Line& lineB)
+	{
+		// From Ericson's Real-Time Collision Detection (5.1.9), with s along A and t along B
+		const Vector3 d1 = lineA.vector();
+		const Vector3 d2 = lineB.vector();
+		const Vector3 r = lineA.start_point - lineB.start_point;
+		const float a = d1.length_squared();
+		const float e = d2.length_squared();
+		const float f = d2.dot(r);
+
+		float s = 0.0f;
+		float t = 0.0f;
+
+		if (a <= DEGENERATE_LENGTH_SQUARED)
+		{
+			// A is a point
+			if (e > DEGENERATE_LENGTH_SQUARED) t = ::clamp01(f / e);
+		}
+		else
+		{
+			const float c = d1.dot(r);
+			if (e <= DEGENERATE_LENGTH_SQUARED)
+			{
+				// B is a point
+				s = ::clamp01(-c / a);
+			}
+			else
+			{
+				// Parallel segments have no unique closest pair so any s will do
+				const float b = d1.dot(d2);
+				const float denom = a * e - b * b;
+				s = (denom != 0.0f) ? ::clamp01((b * f - c * e) / denom) : 0.0f;
+
+				// Closest point on B to A's point, clamped to B and then A's point recomputed
+				t = (b * s + f) / e;
+				if (t < 0.0f)
+				{
+					t = 0.0f;
+					s = ::clamp01(-c / a);
+				}
+				else if (t > 1.0f)
+				{
+					t = 1.0f;
+					s = ::clamp01((b - c) / a);
+				}
+			}
+		}
+
+		return ClosestResult(lineA.start_point + d1 * s, lineB.start_point + d2 * t);
+	}
+
+	Distance::ClosestResult Distance::closest(const Line& lineA, const BoundingBox& boxB)
+	{
+		// A segment passing through the box shares the point where it enters
+		const Intersect::LinearResult hit = Intersect::test(lineA, boxB);
+		if (hit.intersects())
+		{
+			const Vector3 point = lineA.point_at(hit.distance());
+			return ClosestResult(point, point);
+		}
+
+		// Otherwise the closest point on the box is on one of its edges, or on a face with the closest point on the
+		// segment at one of its ends (a segment running parallel to a face also passes over the face's edges)
+		ClosestResult result = closest(lineA.start_point, boxB);
+		const ClosestResult end_result = closest(lineA.end_point, boxB);
+		if (end_result.distance_squared() < result.distance_squared()) result = end_result;
+
+		for (uint_t corner = 0; corner < 8; ++corner)
+		{
+			for (uint_t axis = 1; axis < 8; axis <<= 1)
+			{
+				if (corner & axis) continue;
+
+				const ClosestResult edge_result = closest(lineA, Line(::box_corner(boxB, corner), ::box_corner(boxB, corner | axis)));
+				if (edge_result.distance_squared() < result.distance_squared()) result = edge_result;
+			}
+		}
+
+		return result;
+	}
+
+	Distance::ClosestResult Distance::closest(const BoundingBox& boxA, const BoundingBox& boxB)
+	{
+		// Each axis is separate: where the boxes overlap both points go in the middle of the overlap,
+		// otherwise they go on the facing sides
+		const XMVECTOR min_a = boxA.minimum_corner();
+		const XMVECTOR max_a = boxA.maximum_corner();
+		const XMVECTOR min_b = boxB.minimum_corner();
+		const XMVECTOR max_b = boxB.maximum_corner();
+
+		const XMVECTOR overlap_min = XMVectorMax(min_a, min_b);
+		const XMVECTOR overlap_max = XMVectorMin(max_a, max_b);
+		const XMVECTOR overlaps = XMVectorLessOrEqual(overlap_min, overlap_max);
+		const XMVECTOR middle = XMVectorScale(XMVectorAdd(overlap_min, overlap_max), 0.5f);
+		const XMVECTOR a_below = XMVectorLess(max_a, min_b);
+
+		const XMVECTOR point_a = XMVectorSelect(XMVectorSelect(min_a, max_a, a_below), middle, overlaps);
+		const XMVECTOR point_b = XMVectorSelect(XMVectorSelect(max_b, min_b, a_below), middle, overlaps);
+		return ClosestResult(Vector3(point_a), Vector3(point_b));
+	}
+
+	Distance::ClosestResult Distance::closest(const BoundingSphere& sphereA, const BoundingBox& boxB)
+	{
+		const Vector3& center = sphereA.center();
+		const Vector3 point_b(XMVectorClamp(center, boxB.minimum_corner(), boxB.maximum_corner()));
+		const Vector3 offset = point_b - center;
+		const float length = offset.length();
+
+		if (length <= sphereA.radius()) return ClosestResult(point_b, point_b);
+		return ClosestResult(center + offset * (sphereA.radius() / length), point_b);
+	}
+
+
+	void Distance::distance_squared(const Vector3& pointA, const SoaView<Vector3>& pointsB, float* output)
+	{
+		typedef SoaTraits<Vector3> Traits;
+
+		const SoaVector3 point = soa_splat(pointA);
+		for (size_t block = 0; block < pointsB.block_count(); ++block)
+		{
+			const SoaVector3 other = soa_vector3(pointsB.load(Traits::X, block), pointsB.load(Traits::Y, block), pointsB.load(Traits::Z, block));
+			::store_lanes(soa_length_squared(soa_subtract(other, point)), output, block, pointsB.lane_count(block));
+		}
+	}
+
+	void Distance::distance_squared(const Vector3& pointA, const SoaView<Line>& linesB, float* output)
+	{
+		typedef SoaTraits<Line> Traits;
+
+		const SoaVector3 point = soa_splat(pointA);
+		const XMVECTOR zero = XMVectorZero();
+		const XMVECTOR one = XMVectorSplatOne();
+
+		for (size_t block = 0; block < linesB.block_count(); ++block)
+		{
+			const SoaBlock<Line> lines = linesB.load_block(block);
+			const SoaVector3 start = soa_vector3(lines[Traits::START_X], lines[Traits::START_Y], lines[Traits::START_Z]);
+			const SoaVector3 end = soa_vector3(lines[Traits::END_X], lines[Traits::END_Y], lines[Traits::END_Z]);
+
+			// Zero length lines take the start point rather than dividing by zero
+			const SoaVector3 vector = soa_subtract(end, start);
+			const XMVECTOR length_squared = soa_length_squared(vector);
+			const XMVECTOR t = XMVectorClamp(XMVectorDivide(soa_dot(soa_subtract(point, start), vector), length_squared), zero, one);
+			const XMVECTOR degenerate = XMVectorLessOrEqual(length_squared, XMVectorReplicate(DEGENERATE_LENGTH_SQUARED));
+			const SoaVector3 closest = soa_multiply_add(vector, XMVectorSelect(t, zero, degenerate), start);
+
+			::store_lanes(soa_length_squared(soa_subtract(point, closest)), output, block, linesB.lane_count(block));
+		}
+	}
+
+	void Distance::distance_squared(const Vector3& pointA, const SoaView<BoundingBox>& boxesB, float* output)
+	{
+		const SoaVector3 point = soa_splat(pointA);
+		for (size_t block = 0; block < boxesB.block_count(); ++block)
+		{
+			::store_lanes(::box_distance_squared(point, boxesB.load_block(block)), output, block, boxesB.lane_count(block));
+		}
+	}
+
+	void Distance::distance_squared(const Vector3& pointA, const SoaView<Triangle>& trianglesB, float* output)
+	{
+		typedef SoaTraits<Triangle> Traits;
+
+		const SoaVector3 point = soa_splat(pointA);
+		const XMVECTOR zero = XMVectorZero();
+		const XMVECTOR one = XMVectorSplatOne();
+
+		for (size_t block = 0; block < trianglesB.block_count(); ++block)
+		{
+			const SoaBlock<Triangle> triangles = trianglesB.load_block(block);
+			const SoaVector3 a = soa_vector3(triangles[Traits::A_X], triangles[Traits::A_Y], triangles[Traits::A_Z]);
+			const SoaVector3 b = soa_vector3(triangles[Traits::B_X], triangles[Traits::B_Y], triangles[Traits::B_Z]);
+			const SoaVector3 c = soa_vector3(triangles[Traits::C_X], triangles[Traits::C_Y], triangles[Traits::C_Z]);
+
+			// The same Voronoi region tests as Triangle::closest_point, but every region is worked out as
+			// the weights (s, t) of the closest point a + ab * s + ac * t and the right one selected per lane
+			const SoaVector3 ab = soa_subtract(b, a);
+			const SoaVector3 ac = soa_subtract(c, a);
+			const SoaVector3 ap = soa_subtract(point, a);
+			const SoaVector3 bp = soa_subtract(point, b);
+			const SoaVector3 cp = soa_subtract(point, c);
+
+			const XMVECTOR d1 = soa_dot(ab, ap);
+			const XMVECTOR d2 = soa_dot(ac, ap);
+			const XMVECTOR d3 = soa_dot(ab, bp);
+			const XMVECTOR d4 = soa_dot(ac, bp);
+			const XMVECTOR d5 = soa_dot(ab, cp);
+			const XMVECTOR d6 = soa_dot(ac, cp);
+
+			const XMVECTOR va = XMVectorSubtract(XMVectorMultiply(d3, d6), XMVectorMultiply(d5, d4));
+			const XMVECTOR vb = XMVectorSubtract(XMVectorMultiply(d5, d2), XMVectorMultiply(d1, d6));
+			const XMVECTOR vc = XMVectorSubtract(XMVectorMultiply(d1, d4), XMVectorMultiply(d3, d2));
+
+			// Inside the face
+			const XMVECTOR denom = XMVectorReciprocal(XMVectorAdd(XMVectorAdd(va, vb), vc));
+			XMVECTOR s = XMVectorMultiply(vb, denom);
+			XMVECTOR t = XMVectorMultiply(vc, denom);
+
+			// Edge BC
+			const XMVECTOR d43 = XMVectorSubtract(d4, d3);
+			const XMVECTOR d56 = XMVectorSubtract(d5, d6);
+			const XMVECTOR in_bc = XMVectorAndInt(XMVectorLessOrEqual(va, zero), XMVectorAndInt(XMVectorGreaterOrEqual(d43, zero), XMVectorGreaterOrEqual(d56, zero)));
+			const XMVECTOR w_bc = XMVectorDivide(d43, XMVectorAdd(d43, d56));
+			s = XMVectorSelect(s, XMVectorSubtract(one, w_bc), in_bc);
+			t = XMVectorSelect(t, w_bc, in_bc);
+
+			// Edge AC
+			const XMVECTOR in_ac = XMVectorAndInt(XMVectorLessOrEqual(vb, zero), XMVectorAndInt(XMVectorGreaterOrEqual(d2, zero), XMVectorLessOrEqual(d6, zero)));
+			s = XMVectorSelect(s, zero, in_ac);
+			t = XMVectorSelect(t, XMVectorDivide(d2, XMVectorSubtract(d2, d6)), in_ac);
+
+			// Vertex C
+			const XMVECTOR in_c = XMVectorAndInt(XMVectorGreaterOrEqual(d6, zero), XMVectorLessOrEqual(d5, d6));
+			s = XMVectorSelect(s, zero, in_c);
+			t = XMVectorSelect(t, one, in_c);
+
+			// Edge AB
+			const XMVECTOR in_ab = XMVectorAndInt(XMVectorLessOrEqual(vc, zero), XMVectorAndInt(XMVectorGreaterOrEqual(d1, zero), XMVectorLessOrEqual(d3, zero)));
+			s = XMVectorSelect(s, XMVectorDivide(d1, XMVectorSubtract(d1, d3)), in_ab);
+			t = XMVectorSelect(t, zero, in_ab);
+
+			// Vertex B
+			const XMVECTOR in_b = XMVectorAndInt(XMVectorGreaterOrEqual(d3, zero), XMVectorLessOrEqual(d4, d3));
+			s = XMVectorSelect(s, one, in_b);
+			t = XMVectorSelect(t, zero, in_b);
+
+			// Vertex A
+			const XMVECTOR in_a = XMVectorAndInt(XMVectorLessOrEqual(d1, zero), XMVectorLessOrEqual(d2, zero));
+			s = XMVectorSelect(s, zero, in_a);
+			t = XMVectorSelect(t, zero, in_a);
+
+			const SoaVector3 closest = soa_multiply_add(ac, t, soa_multiply_add(ab, s, a));
+			::store_lanes(soa_length_squared(soa_subtract(point, closest)), output, block, trianglesB.lane_count(block));
+		}
+	}
+
+	void Distance::distance(const BoundingSphere& sphereA, const SoaView<BoundingBox>& boxesB, float* output)
+	{
+		const SoaVector3 center = soa_splat(sphereA.center());
+		const XMVECTOR radius = XMVectorReplicate(sphereA.radius());
+		const XMVECTOR zero = XMVectorZero();
+
+		for (size_t block = 0; block < boxesB.block_count(); ++block)
+		{
+			const XMVECTOR distance = XMVectorSqrt(::box_distance_squared(center, boxesB.load_block(block)));
+			::store_lanes(XMVectorMax(XMVectorSubtract(distance, radius), zero), output, block, boxesB.lane_count(block));
+		}
+	}
+
+} // namespace Math
@@ -0,0 +1,94 @@
+#pragma once
+#ifndef __MATHS_DISTANCE_HPP__
+#define __MATHS_DISTANCE_HPP__
+
+#include "Vector3.hpp"
+
+namespace Math
+{
+	class Line;
+	class BoundingSphere;
+	class BoundingBox;
+	class Triangle;
+
+	template <class Type> class SoaView;
+
+	namespace Distance
+	{
+		class ClosestResult
+		{
+		private:
+			Vector3 mPointA;
+			Vector3 mPointB;
+			float mDistanceSquared;
+
+		public:
+			ClosestResult() : mDistanceSquared(0.0f)
+			{
+			}
+
+			ClosestResult(const Vector3& point_a, const Vector3& point_b) :
+				mPointA(point_a),
+				mPointB(point_b),
+				mDistanceSquared(Vector3(point_b - point_a).length_squared())
+			{
+			}
+
+			ClosestResult(const ClosestResult& result) : mPointA(result.mPointA), mPointB(result.mPointB), mDistanceSquared(result.mDistanceSquared)
+			{
+			}
+
+			ClosestResult& operator = (const ClosestResult& result)
+			{
+				mPointA = result.mPointA;
+				mPointB = result.mPointB;
+				mDistanceSquared = result.mDistanceSquared;
+				return *this;
+			}
+
+			const Vector3& point_a() const
+			{
+				return mPointA;
+			}
+
+			const Vector3& point_b() const
+			{
+				return mPointB;
+			}
+
+			float distance() const
+			{
+				return std::sqrt(mDistanceSquared);
+			}
+
+			float distance_squared() const
+			{
+				return mDistanceSquared;
+			}
+		};
+
+		// Result is: (Closest point on A, Closest point on B, Distance between them)
+		// When A and B overlap the distance is zero and both points are a point they share.
+		ClosestResult closest(const Vector3& pointA, const Line& lineB);
+		ClosestResult closest(const Vector3& pointA, const BoundingBox& boxB);
+		ClosestResult closest(const Vector3& pointA, const Triangle& triangleB);
+		ClosestResult closest(const Line& lineA, const Line& lineB);
+		ClosestResult closest(const Line& lineA, const BoundingBox& boxB);
+		ClosestResult closest(const BoundingBox& boxA, const BoundingBox& boxB);
+		ClosestResult closest(const BoundingSphere& sphereA, const BoundingBox& boxB);
+
+
+		// One to many, output is given the squared distance from A to each element of the view
+		void distance_squared(const Vector3& pointA, const SoaView<Vector3>& pointsB, float* output);
+		void distance_squared(const Vector3& pointA, const SoaView<Line>& linesB, float* output);
+		void distance_squared(const Vector3& pointA, const SoaView<BoundingBox>& boxesB, float* output);
+		void distance_squared(const Vector3& pointA, const SoaView<Triangle>& trianglesB, float* output);
+
+		// One to many, output is given the distance from the sphere's surface to each box (zero when they overlap)
+		void distance(const BoundingSphere& sphereA, const SoaView<BoundingBox>& boxesB, float* output);
+
+	} // namespace Distance
+
+} // namespace Math
+
+#endif // __MATHS_DISTANCE_HPP__
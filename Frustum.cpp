@@ -2,6 +2,37 @@
 #include "Frustum.hpp"
 
 #include "Matrix.hpp"
+#include "BoundingBox.hpp"
+#include "BoundingSphere.hpp"
+#include "OrientedBox.hpp"
+#include "Capsule.hpp"
+#include "SoaArray.hpp"
+
+namespace
+{
+	// With the clip coordinates of the box's center and bounds on how far each of them can move within the box,
+	// from D3D's clip volume -w <= x <= w, -w <= y <= w and 0 <= z <= w
+	Math::Intersect::PlaneResult clip_result(const XMFLOAT4A& center, const XMFLOAT4A& radius)
+	{
+		if (std::abs(center.x) > center.w + radius.w + radius.x ||
+			std::abs(center.y) > center.w + radius.w + radius.y ||
+			center.z + radius.z < 0.0f ||
+			center.z - radius.z > center.w + radius.w)
+		{
+			return Math::Intersect::OUTSIDE_PLANE;
+		}
+
+		if (std::abs(center.x) <= center.w - radius.w - radius.x &&
+			std::abs(center.y) <= center.w - radius.w - radius.y &&
+			center.z - radius.z >= 0.0f &&
+			center.z + radius.z <= center.w - radius.w)
+		{
+			return Math::Intersect::INSIDE_PLANE;
+		}
+
+		return Math::Intersect::INTERSECTS_PLANE;
+	}
+}
 
 namespace Math
 {
@@ -16,6 +47,8 @@ namespace Math
 		const Vector4 m3 = matrix.column(2);
 		const Vector4 m4 = matrix.column(3);
 
+		mMatrix = matrix;
+
 		mPlanes[FRUSTUM_PLANE_NEAR] = Plane(m3);
 		mPlanes[FRUSTUM_PLANE_FAR] = Plane(m4 - m3);
 		mPlanes[FRUSTUM_PLANE_LEFT] = Plane(m4 + m1);
@@ -50,4 +83,106 @@ namespace Math
 
 		return (inside_count == FRUSTUM_PLANE_COUNT) ? Intersect::INSIDE_PLANE : Intersect::INTERSECTS_PLANE;
 	}
-}
+
+	Intersect::PlaneResult Frustum::test_clip_space(const BoundingBox& box) const
+	{
+		// Each clip coordinate is linear over the box, so it moves at most extents.x * |row 0| + ... from the center's
+		const XMVECTOR extents = box.extents();
+		XMVECTOR radius = XMVectorMultiply(XMVectorSplatX(extents), XMVectorAbs(mMatrix.r[0]));
+		radius = XMVectorMultiplyAdd(XMVectorSplatY(extents), XMVectorAbs(mMatrix.r[1]), radius);
+		radius = XMVectorMultiplyAdd(XMVectorSplatZ(extents), XMVectorAbs(mMatrix.r[2]), radius);
+
+		XMFLOAT4A clip_center;
+		XMFLOAT4A clip_radius;
+		XMStoreFloat4A(&clip_center, XMVector3Transform(box.center(), mMatrix));
+		XMStoreFloat4A(&clip_radius, radius);
+		return ::clip_result(clip_center, clip_radius);
+	}
+
+	void Frustum::test_clip_space(const SoaView<BoundingBox>& boxes, Intersect::PlaneResult* results) const
+	{
+		typedef SoaTraits<BoundingBox> Traits;
+
+		// Four boxes at a time, with each matrix element and its absolute value replicated across the lanes
+		XMVECTOR m[4][4];
+		XMVECTOR a[3][4];
+		for (uint_t row = 0; row < 4; ++row)
+		{
+			for (uint_t column = 0; column < 4; ++column)
+			{
+				m[row][column] = XMVectorReplicate(mMatrix(row, column));
+				if (row < 3) a[row][column] = XMVectorAbs(m[row][column]);
+			}
+		}
+
+		const XMVECTOR half = XMVectorReplicate(0.5f);
+
+		for (size_t block = 0; block < boxes.block_count(); ++block)
+		{
+			const SoaBlock<BoundingBox> box = boxes.load_block(block);
+			const XMVECTOR center[3] =
+			{
+				XMVectorMultiply(XMVectorAdd(box[Traits::MIN_X], box[Traits::MAX_X]), half),
+				XMVectorMultiply(XMVectorAdd(box[Traits::MIN_Y], box[Traits::MAX_Y]), half),
+				XMVectorMultiply(XMVectorAdd(box[Traits::MIN_Z], box[Traits::MAX_Z]), half)
+			};
+			const XMVECTOR extents[3] =
+			{
+				XMVectorMultiply(XMVectorSubtract(box[Traits::MAX_X], box[Traits::MIN_X]), half),
+				XMVectorMultiply(XMVectorSubtract(box[Traits::MAX_Y], box[Traits::MIN_Y]), half),
+				XMVectorMultiply(XMVectorSubtract(box[Traits::MAX_Z], box[Traits::MIN_Z]), half)
+			};
+
+			XMVECTOR clip_center[4];
+			XMVECTOR clip_radius[4];
+			for (uint_t column = 0; column < 4; ++column)
+			{
+				clip_center[column] = XMVectorMultiplyAdd(center[0], m[0][column], m[3][column]);
+				clip_center[column] = XMVectorMultiplyAdd(center[1], m[1][column], clip_center[column]);
+				clip_center[column] = XMVectorMultiplyAdd(center[2], m[2][column], clip_center[column]);
+
+				clip_radius[column] = XMVectorMultiply(extents[0], a[0][column]);
+				clip_radius[column] = XMVectorMultiplyAdd(extents[1], a[1][column], clip_radius[column]);
+				clip_radius[column] = XMVectorMultiplyAdd(extents[2], a[2][column], clip_radius[column]);
+			}
+
+			// The same conditions as clip_result with the w range folded in, using w + rw for outside and w - rw for inside
+			const XMVECTOR w_high = XMVectorAdd(clip_center[3], clip_radius[3]);
+			const XMVECTOR w_low = XMVectorSubtract(clip_center[3], clip_radius[3]);
+			const XMVECTOR abs_x = XMVectorAbs(clip_center[0]);
+			const XMVECTOR abs_y = XMVectorAbs(clip_center[1]);
+			const XMVECTOR z_high = XMVectorAdd(clip_center[2], clip_radius[2]);
+			const XMVECTOR z_low = XMVectorSubtract(clip_center[2], clip_radius[2]);
+			const XMVECTOR zero = XMVectorZero();
+
+			XMVECTOR outside = XMVectorGreater(abs_x, XMVectorAdd(w_high, clip_radius[0]));
+			outside = XMVectorOrInt(outside, XMVectorGreater(abs_y, XMVectorAdd(w_high, clip_radius[1])));
+			outside = XMVectorOrInt(outside, XMVectorLess(z_high, zero));
+			outside = XMVectorOrInt(outside, XMVectorGreater(z_low, w_high));
+
+			XMVECTOR inside = XMVectorLessOrEqual(abs_x, XMVectorSubtract(w_low, clip_radius[0]));
+			inside = XMVectorAndInt(inside, XMVectorLessOrEqual(abs_y, XMVectorSubtract(w_low, clip_radius[1])));
+			inside = XMVectorAndInt(inside, XMVectorGreaterOrEqual(z_low, zero));
+			inside = XMVectorAndInt(inside, XMVectorLessOrEqual(z_high, w_low));
+
+			XMVECTORU32 outside_lanes;
+			XMVECTORU32 inside_lanes;
+			outside_lanes.v = outside;
+			inside_lanes.v = inside;
+
+			Intersect::PlaneResult* output = results + block * SOA_LANE_COUNT;
+			const uint_t lane_count = boxes.lane_count(block);
+			for (uint_t lane = 0; lane < lane_count; ++lane)
+			{
+				if (outside_lanes.u[lane]) output[lane] = Intersect::OUTSIDE_PLANE;
+				else if (inside_lanes.u[lane]) output[lane] = Intersect::INSIDE_PLANE;
+				else output[lane] = Intersect::INTERSECTS_PLANE;
+			}
+		}
+	}
+
+	template Intersect::PlaneResult Frustum::test<BoundingBox>(const BoundingBox& object) const;
+	template Intersect::PlaneResult Frustum::test<BoundingSphere>(const BoundingSphere& object) const;
+	template Intersect::PlaneResult Frustum::test<OrientedBox>(const OrientedBox& object) const;
+	template Intersect::PlaneResult Frustum::test<Capsule>(const Capsule& object) const;
+}
\ No newline at end of file
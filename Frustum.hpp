@@ -3,13 +3,16 @@
 #define __FRUSTUM_HPP__
 
 #include "Plane.hpp"
+#include "Matrix.hpp"
 #include "Intersect.hpp"
 
 namespace Math
 {
-	class Matrix;
+	class BoundingBox;
 	class BoundingSphere;
 
+	template <class Type> class SoaView;
+
 	class Frustum
 	{
 	public:
@@ -27,6 +30,7 @@ namespace Math
 
 	private:
 		Plane mPlanes[FRUSTUM_PLANE_COUNT];
+		Matrix mMatrix; // The matrix the planes were taken from, for testing in clip space
 
 	public:
 		Frustum();
@@ -35,8 +39,16 @@ namespace Math
 
 		const Plane& get_plane(FrustumPlane plane_enum) const;
 
-		// BoundingBox, BoundingSphere
+		// BoundingBox, BoundingSphere, OrientedBox, Capsule
 		template <class Object> Intersect::PlaneResult test(const Object& object) const;
+
+		// Transforms the box's center into clip space and bounds how far each clip coordinate can move from it within
+		// the box, then tests that range against the clip volume rather than the box's corners against each plane.
+		// The bound is looser than the planes, so it is conservative: OUTSIDE_PLANE and INSIDE_PLANE are only returned
+		// when the plane test would return the same, and some boxes the plane test finds outside or inside come out
+		// as intersecting. Cheap enough to run over every instance in a scene before any finer test.
+		Intersect::PlaneResult test_clip_space(const BoundingBox& box) const;
+		void test_clip_space(const SoaView<BoundingBox>& boxes, Intersect::PlaneResult* results) const;
 	};
 
 } // namespace Math
@@ -0,0 +1,641 @@
+#include "Precompiled.hpp"
+#include "Gjk.hpp"
+#include "Contact.hpp"
+#include "SoaVector3.hpp"
+
+namespace
+{
+	const uint_t MAX_ITERATIONS = 64;
+
+	// GJK has converged when a new support point brings the squared distance down by less than this fraction of it,
+	// which is about twice the relative error left in the distance
+	const float RELATIVE_TOLERANCE = 1.0e-5f;
+
+	// A tetrahedron whose volume is less than this fraction of the cube of its longest edge is treated as flat, as
+	// rounding makes the sides of its faces unreliable. Curved shapes give these as GJK closes in on them.
+	const float FLAT_VOLUME_TOLERANCE = 1.0e-5f;
+
+	// Squared distances from the origin below this count as touching
+	const float TOUCHING_DISTANCE_SQUARED = 1.0e-12f;
+
+	// EPA has converged when a new support point is less than this much further out than the closest face, scaled
+	// by the depth so it is relative for deep penetrations
+	const float EPA_TOLERANCE = 1.0e-4f;
+
+	const uint_t MAX_EPA_ITERATIONS = 64;
+	const uint_t MAX_POLYTOPE_VERTICES = Math::Gjk::MAX_SIMPLEX_SIZE + MAX_EPA_ITERATIONS;
+
+	// A closed triangle mesh has 2V - 4 faces, and each face has three edges on the horizon at most
+	const uint_t MAX_POLYTOPE_FACES = 2 * MAX_POLYTOPE_VERTICES;
+	const uint_t MAX_HORIZON_EDGES = 3 * MAX_POLYTOPE_FACES;
+
+	// A point of the difference A - B, the points of A and B it came from and the direction that found it
+	struct Vertex
+	{
+		Math::Vector3 w;
+		Math::Vector3 a;
+		Math::Vector3 b;
+		Math::Vector3 direction;
+	};
+
+	Vertex support(const Math::Gjk::Shape& shape_a, const Math::Gjk::Shape& shape_b, const Math::Vector3& direction)
+	{
+		Vertex vertex;
+		vertex.a = shape_a.support(direction);
+		vertex.b = shape_b.support(-direction);
+		vertex.w = vertex.a - vertex.b;
+		vertex.direction = direction;
+		return vertex;
+	}
+
+	// The simplex being worked on, with the barycentric weights of its point closest to the origin
+	struct WorkingSimplex
+	{
+		Vertex vertices[Math::Gjk::MAX_SIMPLEX_SIZE];
+		float weights[Math::Gjk::MAX_SIMPLEX_SIZE];
+		uint_t size;
+		Math::Vector3 closest;
+	};
+
+	void keep(WorkingSimplex& simplex, const Vertex* vertices, const float* weights, uint_t size)
+	{
+		Vertex kept[Math::Gjk::MAX_SIMPLEX_SIZE];
+		std::copy(vertices, vertices + size, kept);
+
+		simplex.closest = Math::Vector3::ZERO;
+		for (uint_t i = 0; i < size; ++i)
+		{
+			simplex.vertices[i] = kept[i];
+			simplex.weights[i] = weights[i];
+			simplex.closest += kept[i].w * weights[i];
+		}
+		simplex.size = size;
+	}
+
+	void solve_point(WorkingSimplex& simplex, const Vertex& a)
+	{
+		const float weight = 1.0f;
+		::keep(simplex, &a, &weight, 1);
+	}
+
+	void solve_segment(WorkingSimplex& simplex, const Vertex& a, const Vertex& b)
+	{
+		const Math::Vector3 ab = b.w - a.w;
+		const float length_squared = ab.length_squared();
+		const float t = length_squared > TOUCHING_DISTANCE_SQUARED ? -a.w.dot(ab) / length_squared : 0.0f;
+
+		if (t <= 0.0f) return solve_point(simplex, a);
+		if (t >= 1.0f) return solve_point(simplex, b);
+
+		const Vertex vertices[2] = { a, b };
+		const float weights[2] = { 1.0f - t, t };
+		::keep(simplex, vertices, weights, 2);
+	}
+
+	// Closest point of a triangle to the origin, from Ericson's Real-Time Collision Detection (5.1.5)
+	void solve_triangle(WorkingSimplex& simplex, const Vertex& a, const Vertex& b, const Vertex& c)
+	{
+		const Math::Vector3 ab = b.w - a.w;
+		const Math::Vector3 ac = c.w - a.w;
+
+		const float d1 = -ab.dot(a.w);
+		const float d2 = -ac.dot(a.w);
+		if (d1 <= 0.0f && d2 <= 0.0f) return solve_point(simplex, a);
+
+		const float d3 = -ab.dot(b.w);
+		const float d4 = -ac.dot(b.w);
+		if (d3 >= 0.0f && d4 <= d3) return solve_point(simplex, b);
+
+		const float vc = d1 * d4 - d3 * d2;
+		if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) return solve_segment(simplex, a, b);
+
+		const float d5 = -ab.dot(c.w);
+		const float d6 = -ac.dot(c.w);
+		if (d6 >= 0.0f && d5 <= d6) return solve_point(simplex, c);
+
+		const float vb = d5 * d2 - d1 * d6;
+		if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) return solve_segment(simplex, a, c);
+
+		const float va = d3 * d6 - d5 * d4;
+		if (va <= 0.0f && d4 - d3 >= 0.0f && d5 - d6 >= 0.0f) return solve_segment(simplex, b, c);
+
+		// A flat triangle has no inside, so the closest point is on whichever edge is nearest
+		const float sum = va + vb + vc;
+		if (sum <= TOUCHING_DISTANCE_SQUARED)
+		{
+			WorkingSimplex edges[3];
+			solve_segment(edges[0], a, b);
+			solve_segment(edges[1], b, c);
+			solve_segment(edges[2], c, a);
+
+			uint_t best = 0;
+			for (uint_t i = 1; i < 3; ++i)
+			{
+				if (edges[i].closest.length_squared() < edges[best].closest.length_squared()) best = i;
+			}
+			simplex = edges[best];
+			return;
+		}
+
+		const Vertex vertices[3] = { a, b, c };
+		const float weights[3] = { va / sum, vb / sum, vc / sum };
+		::keep(simplex, vertices, weights, 3);
+	}
+
+	// Closest point of a tetrahedron to the origin, from Ericson's Real-Time Collision Detection (5.1.6). The origin is
+	// inside when it is on the same side of every face as the opposite vertex, and a flat tetrahedron counts as outside
+	// all of its faces.
+	void solve_tetrahedron(WorkingSimplex& simplex, const Vertex& a, const Vertex& b, const Vertex& c, const Vertex& d)
+	{
+		const Vertex* faces[4][4] = { { &a, &b, &c, &d }, { &a, &c, &d, &b }, { &a, &d, &b, &c }, { &b, &d, &c, &a } };
+
+		const Math::Vector3 ab = b.w - a.w;
+		const Math::Vector3 ac = c.w - a.w;
+		const Math::Vector3 ad = d.w - a.w;
+		const float longest_squared = std::max(std::max(std::max(ab.length_squared(), ac.length_squared()), ad.length_squared()),
+			std::max(std::max(Math::Vector3(c.w - b.w).length_squared(), Math::Vector3(d.w - b.w).length_squared()), Math::Vector3(d.w - c.w).length_squared()));
+		const float volume = std::abs(ab.dot(ac.cross(ad)));
+		const bool flat = volume <= FLAT_VOLUME_TOLERANCE * longest_squared * std::sqrt(longest_squared);
+
+		WorkingSimplex best;
+		best.size = 0;
+		float best_distance = FLT_MAX;
+
+		for (uint_t i = 0; i < 4; ++i)
+		{
+			const Vertex& p = *faces[i][0];
+			const Vertex& q = *faces[i][1];
+			const Vertex& r = *faces[i][2];
+			const Math::Vector3 normal = Math::Vector3(q.w - p.w).cross(r.w - p.w);
+			const float origin_side = -normal.dot(p.w);
+			const float opposite_side = normal.dot(faces[i][3]->w - p.w);
+			if (!flat && origin_side * opposite_side > 0.0f) continue;
+
+			WorkingSimplex face;
+			solve_triangle(face, p, q, r);
+			const float distance = face.closest.length_squared();
+			if (distance < best_distance)
+			{
+				best_distance = distance;
+				best = face;
+			}
+		}
+
+		if (best.size != 0)
+		{
+			simplex = best;
+			return;
+		}
+
+		const Vertex vertices[4] = { a, b, c, d };
+		const float weights[4] = { 0.25f, 0.25f, 0.25f, 0.25f };
+		::keep(simplex, vertices, weights, 4);
+		simplex.closest = Math::Vector3::ZERO;
+	}
+
+	void solve(WorkingSimplex& simplex)
+	{
+		const Vertex* v = simplex.vertices;
+		switch (simplex.size)
+		{
+		case 1:
+			solve_point(simplex, v[0]);
+			break;
+		case 2:
+			solve_segment(simplex, v[0], v[1]);
+			break;
+		case 3:
+			solve_triangle(simplex, v[0], v[1], v[2]);
+			break;
+		default:
+			solve_tetrahedron(simplex, v[0], v[1], v[2], v[3]);
+			break;
+		}
+	}
+
+	// Runs GJK on the difference A - B, starting from the cached simplex when there is one, and returns true when the
+	// origin is inside it. With early_out set it returns false as soon as a support point shows a separating axis.
+	bool run_gjk(const Math::Gjk::Shape& shape_a, const Math::Gjk::Shape& shape_b, Math::Gjk::Simplex& cache, bool early_out, WorkingSimplex& simplex)
+	{
+		uint_t iterations = 0;
+		simplex.size = 0;
+
+		for (uint_t i = 0; i < cache.size(); ++i)
+		{
+			simplex.vertices[simplex.size++] = ::support(shape_a, shape_b, cache.direction(i));
+			++iterations;
+		}
+		if (simplex.size == 0)
+		{
+			Math::Vector3 direction = shape_b.center() - shape_a.center();
+			if (direction.length_squared() <= TOUCHING_DISTANCE_SQUARED) direction = Math::Vector3(1.0f, 0.0f, 0.0f);
+			simplex.vertices[simplex.size++] = ::support(shape_a, shape_b, direction);
+			++iterations;
+		}
+		solve(simplex);
+
+		bool intersect = false;
+		bool separated = false;
+		float distance_squared = simplex.closest.length_squared();
+
+		while (iterations < MAX_ITERATIONS)
+		{
+			if (simplex.size == Math::Gjk::MAX_SIMPLEX_SIZE || distance_squared <= TOUCHING_DISTANCE_SQUARED)
+			{
+				intersect = true;
+				break;
+			}
+
+			const Math::Vector3 direction = -simplex.closest;
+			const Vertex vertex = ::support(shape_a, shape_b, direction);
+			++iterations;
+
+			// The new point does not get past the origin, so the direction separates the shapes
+			const float reach = vertex.w.dot(direction);
+			if (early_out && reach < 0.0f)
+			{
+				separated = true;
+				break;
+			}
+
+			if (distance_squared + reach <= RELATIVE_TOLERANCE * distance_squared) break;
+
+			bool duplicate = false;
+			for (uint_t i = 0; i < simplex.size; ++i)
+			{
+				duplicate = duplicate || Math::Vector3(simplex.vertices[i].w - vertex.w).length_squared() <= TOUCHING_DISTANCE_SQUARED;
+			}
+			if (duplicate) break;
+
+			// Going back to the previous simplex when rounding stops the distance getting smaller
+			const WorkingSimplex previous = simplex;
+			simplex.vertices[simplex.size++] = vertex;
+			solve(simplex);
+
+			const float next_distance_squared = simplex.closest.length_squared();
+			if (next_distance_squared >= distance_squared)
+			{
+				simplex = previous;
+				break;
+			}
+			distance_squared = next_distance_squared;
+		}
+
+		Math::Vector3 directions[Math::Gjk::MAX_SIMPLEX_SIZE];
+		for (uint_t i = 0; i < simplex.size; ++i)
+		{
+			directions[i] = simplex.vertices[i].direction;
+		}
+		cache.set(directions, simplex.size, iterations);
+
+		return intersect && !separated;
+	}
+
+	void witness_points(const WorkingSimplex& simplex, Math::Vector3& point_a, Math::Vector3& point_b)
+	{
+		point_a = Math::Vector3::ZERO;
+		point_b = Math::Vector3::ZERO;
+		for (uint_t i = 0; i < simplex.size; ++i)
+		{
+			point_a += simplex.vertices[i].a * simplex.weights[i];
+			point_b += simplex.vertices[i].b * simplex.weights[i];
+		}
+	}
+
+	struct Face
+	{
+		uint_t vertices[3];
+		Math::Vector3 normal;
+		float distance;
+	};
+
+	struct Edge
+	{
+		uint_t start;
+		uint_t end;
+	};
+
+	bool make_face(const Vertex* vertices, uint_t a, uint_t b, uint_t c, Face& face)
+	{
+		const Math::Vector3 normal = Math::Vector3(vertices[b].w - vertices[a].w).cross(vertices[c].w - vertices[a].w);
+		const float length = normal.length();
+		if (length <= FLT_EPSILON) return false;
+
+		face.vertices[0] = a;
+		face.vertices[1] = b;
+		face.vertices[2] = c;
+		face.normal = normal / length;
+		face.distance = face.normal.dot(vertices[a].w);
+		return true;
+	}
+
+	// Adds support points until the simplex is a tetrahedron with some volume, which EPA needs to start from
+	bool grow_to_tetrahedron(const Math::Gjk::Shape& shape_a, const Math::Gjk::Shape& shape_b, Vertex* vertices, uint_t& count)
+	{
+		static const Math::Vector3 AXES[3] = { Math::Vector3(1.0f, 0.0f, 0.0f), Math::Vector3(0.0f, 1.0f, 0.0f), Math::Vector3(0.0f, 0.0f, 1.0f) };
+
+		if (count == 1)
+		{
+			for (uint_t i = 0; i < 6 && count == 1; ++i)
+			{
+				const Vertex vertex = ::support(shape_a, shape_b, (i & 1) ? -AXES[i / 2] : AXES[i / 2]);
+				if (Math::Vector3(vertex.w - vertices[0].w).length_squared() > TOUCHING_DISTANCE_SQUARED) vertices[count++] = vertex;
+			}
+		}
+
+		if (count == 2)
+		{
+			// Directions around the segment, starting from one perpendicular to it
+			const Math::Vector3 line = vertices[1].w - vertices[0].w;
+			const uint_t axis = std::abs(line.x) < std::abs(line.y) ? (std::abs(line.x) < std::abs(line.z) ? 0 : 2) : (std::abs(line.y) < std::abs(line.z) ? 1 : 2);
+			const Math::Vector3 first = line.cross(AXES[axis]);
+			const Math::Vector3 second = line.cross(first);
+			const Math::Vector3 directions[4] = { first, -first, second, -second };
+			for (uint_t i = 0; i < 4 && count == 2; ++i)
+			{
+				const Vertex vertex = ::support(shape_a, shape_b, directions[i]);
+				if (line.cross(vertex.w - vertices[0].w).length_squared() > TOUCHING_DISTANCE_SQUARED) vertices[count++] = vertex;
+			}
+		}
+
+		if (count == 3)
+		{
+			const Math::Vector3 normal = Math::Vector3(vertices[1].w - vertices[0].w).cross(vertices[2].w - vertices[0].w);
+			for (uint_t i = 0; i < 2 && count == 3; ++i)
+			{
+				const Vertex vertex = ::support(shape_a, shape_b, i == 0 ? normal : -normal);
+				if (std::abs(normal.dot(vertex.w - vertices[0].w)) > FLT_EPSILON * normal.length()) vertices[count++] = vertex;
+			}
+		}
+
+		return count == 4;
+	}
+
+	// Expanding Polytope Algorithm, growing the final GJK simplex out to the surface of A - B until the face nearest
+	// the origin is on it. That face's normal and distance are the direction and depth of the penetration.
+	bool run_epa(const Math::Gjk::Shape& shape_a, const Math::Gjk::Shape& shape_b, const WorkingSimplex& simplex, Math::Vector3& normal, float& depth, Math::Vector3& point_a, Math::Vector3& point_b)
+	{
+		Vertex vertices[MAX_POLYTOPE_VERTICES];
+		uint_t vertex_count = simplex.size;
+		std::copy(simplex.vertices, simplex.vertices + simplex.size, vertices);
+
+		// Shapes that only touch have nothing to expand into
+		if (!::grow_to_tetrahedron(shape_a, shape_b, vertices, vertex_count)) return false;
+
+		// Wind the faces of the tetrahedron so they all face out
+		Face faces[MAX_POLYTOPE_FACES];
+		uint_t face_count = 0;
+		const Math::Vector3 inside = (vertices[0].w + vertices[1].w + vertices[2].w + vertices[3].w) * 0.25f;
+		static const uint_t TETRAHEDRON[4][3] = { { 0, 1, 2 }, { 0, 3, 1 }, { 0, 2, 3 }, { 1, 3, 2 } };
+		for (uint_t i = 0; i < 4; ++i)
+		{
+			Face& face = faces[face_count];
+			if (!::make_face(vertices, TETRAHEDRON[i][0], TETRAHEDRON[i][1], TETRAHEDRON[i][2], face)) return false;
+			if (face.normal.dot(vertices[TETRAHEDRON[i][0]].w - inside) < 0.0f)
+			{
+				::make_face(vertices, TETRAHEDRON[i][0], TETRAHEDRON[i][2], TETRAHEDRON[i][1], face);
+			}
+			++face_count;
+		}
+
+		uint_t closest = 0;
+		for (uint_t iteration = 0; ; ++iteration)
+		{
+			closest = 0;
+			for (uint_t i = 1; i < face_count; ++i)
+			{
+				if (faces[i].distance < faces[closest].distance) closest = i;
+			}
+
+			if (iteration == MAX_EPA_ITERATIONS || vertex_count == MAX_POLYTOPE_VERTICES) break;
+
+			const Face nearest = faces[closest];
+			const Vertex vertex = ::support(shape_a, shape_b, nearest.normal);
+			if (vertex.w.dot(nearest.normal) - nearest.distance <= EPA_TOLERANCE * std::max(1.0f, nearest.distance)) break;
+
+			// Find the horizon around the faces the new point can see
+			Edge horizon[MAX_HORIZON_EDGES];
+			uint_t horizon_count = 0;
+			uint_t visible_count = 0;
+			for (uint_t i = 0; i < face_count; ++i)
+			{
+				const Face& face = faces[i];
+				if (face.normal.dot(vertex.w - vertices[face.vertices[0]].w) <= 0.0f) continue;
+				++visible_count;
+
+				// An edge shared with another visible face is not on the horizon, and is seen the other way round there
+				for (uint_t e = 0; e < 3; ++e)
+				{
+					const Edge edge = { face.vertices[e], face.vertices[(e + 1) % 3] };
+					uint_t j = 0;
+					while (j < horizon_count && !(horizon[j].start == edge.end && horizon[j].end == edge.start)) ++j;
+
+					if (j < horizon_count) horizon[j] = horizon[--horizon_count];
+					else horizon[horizon_count++] = edge;
+				}
+			}
+
+			// Checked while the faces are untouched, so that closest still names the nearest face
+			if (face_count - visible_count + horizon_count > MAX_POLYTOPE_FACES) break;
+
+			// Take out the visible faces, leaving a hole bounded by the horizon edges
+			uint_t kept = 0;
+			for (uint_t i = 0; i < face_count; ++i)
+			{
+				const Face& face = faces[i];
+				if (face.normal.dot(vertex.w - vertices[face.vertices[0]].w) <= 0.0f) faces[kept++] = face;
+			}
+			face_count = kept;
+
+			// Fill the hole with faces from the horizon to the new point
+			const uint_t index = vertex_count;
+			vertices[vertex_count++] = vertex;
+			for (uint_t i = 0; i < horizon_count; ++i)
+			{
+				if (::make_face(vertices, horizon[i].start, horizon[i].end, index, faces[face_count])) ++face_count;
+			}
+
+			if (face_count == 0) return false;
+		}
+
+		const Face& face = faces[closest];
+		normal = face.normal;
+		depth = std::max(face.distance, 0.0f);
+
+		// Barycentric coordinates of the origin projected on to the face give the points on A and B
+		const Vertex& a = vertices[face.vertices[0]];
+		const Vertex& b = vertices[face.vertices[1]];
+		const Vertex& c = vertices[face.vertices[2]];
+		const Math::Vector3 projected = normal * face.distance;
+		const Math::Vector3 ab = b.w - a.w;
+		const Math::Vector3 ac = c.w - a.w;
+		const Math::Vector3 ap = projected - a.w;
+		const float d00 = ab.dot(ab);
+		const float d01 = ab.dot(ac);
+		const float d11 = ac.dot(ac);
+		const float d20 = ap.dot(ab);
+		const float d21 = ap.dot(ac);
+		const float denominator = d00 * d11 - d01 * d01;
+
+		float v = 1.0f / 3.0f;
+		float w = 1.0f / 3.0f;
+		if (denominator > FLT_EPSILON * FLT_EPSILON)
+		{
+			v = (d11 * d20 - d01 * d21) / denominator;
+			w = (d00 * d21 - d01 * d20) / denominator;
+		}
+		const float u = 1.0f - v - w;
+
+		point_a = a.a * u + b.a * v + c.a * w;
+		point_b = a.b * u + b.b * v + c.b * w;
+		return true;
+	}
+}
+
+namespace Math
+{
+
+	//--------------------------------------------------------------------------
+	// Support Functions
+	//
+
+	Vector3 Gjk::SphereShape::support(const Vector3& direction) const
+	{
+		const float length_squared = direction.length_squared();
+		if (length_squared <= TOUCHING_DISTANCE_SQUARED) return mSphere.center();
+		return mSphere.center() + direction * (mSphere.radius() / std::sqrt(length_squared));
+	}
+
+	Vector3 Gjk::BoxShape::support(const Vector3& direction) const
+	{
+		return Vector3(XMVectorSelect(mBox.minimum_corner(), mBox.maximum_corner(), XMVectorGreaterOrEqual(direction, XMVectorZero())));
+	}
+
+	Vector3 Gjk::OrientedBoxShape::support(const Vector3& direction) const
+	{
+		// The corner on the same side of each box axis as the direction
+		const XMVECTOR local = XMVector3Rotate(direction, XMQuaternionConjugate(mBox.orientation()));
+		const XMVECTOR extents = mBox.extents();
+		const XMVECTOR corner = XMVectorSelect(XMVectorNegate(extents), extents, XMVectorGreaterOrEqual(local, XMVectorZero()));
+		return Vector3(XMVectorAdd(XMVector3Rotate(corner, mBox.orientation()), mBox.center()));
+	}
+
+	Vector3 Gjk::CapsuleShape::support(const Vector3& direction) const
+	{
+		const Vector3& end = direction.dot(mSegment.end_point) > direction.dot(mSegment.start_point) ? mSegment.end_point : mSegment.start_point;
+
+		const float length_squared = direction.length_squared();
+		if (length_squared <= TOUCHING_DISTANCE_SQUARED) return end;
+		return end + direction * (mRadius / std::sqrt(length_squared));
+	}
+
+	Gjk::HullShape::HullShape(const SoaView<Vector3>& points) : mPoints(points)
+	{
+		XMASSERT(!points.empty());
+
+		Vector3 sum = Vector3::ZERO;
+		for (size_t i = 0; i < points.size(); ++i)
+		{
+			sum += points[i];
+		}
+		mCenter = sum / static_cast<float>(points.size());
+	}
+
+	Vector3 Gjk::HullShape::support(const Vector3& direction) const
+	{
+		typedef SoaTraits<Vector3> Traits;
+
+		// The best point of each lane is kept as its integer index. The first index of a block is a multiple of four,
+		// so or-ing in the lane gives the index of each lane.
+		static const XMVECTORF32 LANE_OFFSETS = { 0.0f, 1.0f, 2.0f, 3.0f };
+		static const XMVECTORU32 LANE_INDICES = { 0, 1, 2, 3 };
+		const SoaVector3 d = soa_splat(direction);
+		const XMVECTOR infinity = XMVectorSplatInfinity();
+		XMVECTOR best_dot = XMVectorNegate(infinity);
+		XMVECTOR best_index = XMVectorZero();
+
+		for (size_t block = 0; block < mPoints.block_count(); ++block)
+		{
+			const SoaBlock<Vector3> points = mPoints.load_block(block);
+			XMVECTOR dot = soa_dot(d, soa_vector3(points[Traits::X], points[Traits::Y], points[Traits::Z]));
+
+			// The padding lanes of the last block are never picked
+			const XMVECTOR valid = XMVectorLess(LANE_OFFSETS, XMVectorReplicate(static_cast<float>(mPoints.lane_count(block))));
+			dot = XMVectorSelect(XMVectorNegate(infinity), dot, valid);
+
+			const XMVECTOR better = XMVectorGreater(dot, best_dot);
+			best_dot = XMVectorSelect(best_dot, dot, better);
+			best_index = XMVectorSelect(best_index, XMVectorOrInt(LANE_INDICES, XMVectorReplicateInt(static_cast<uint_t>(block * SOA_LANE_COUNT))), better);
+		}
+
+		XMVECTORF32 dots;
+		XMVECTORU32 indices;
+		dots.v = best_dot;
+		indices.v = best_index;
+
+		uint_t best = 0;
+		for (uint_t lane = 1; lane < SOA_LANE_COUNT; ++lane)
+		{
+			if (dots.f[lane] > dots.f[best]) best = lane;
+		}
+		return mPoints[indices.u[best]];
+	}
+
+	//--------------------------------------------------------------------------
+	// Queries
+	//
+
+	Distance::ClosestResult Gjk::closest(const Shape& shapeA, const Shape& shapeB, Simplex& simplex)
+	{
+		WorkingSimplex working;
+		const bool intersect = ::run_gjk(shapeA, shapeB, simplex, false, working);
+
+		Vector3 point_a;
+		Vector3 point_b;
+		::witness_points(working, point_a, point_b);
+		return Distance::ClosestResult(point_a, intersect ? point_a : point_b);
+	}
+
+	Distance::ClosestResult Gjk::closest(const Shape& shapeA, const Shape& shapeB)
+	{
+		Simplex simplex;
+		return closest(shapeA, shapeB, simplex);
+	}
+
+	bool Gjk::intersects(const Shape& shapeA, const Shape& shapeB, Simplex& simplex)
+	{
+		WorkingSimplex working;
+		return ::run_gjk(shapeA, shapeB, simplex, true, working);
+	}
+
+	bool Gjk::intersects(const Shape& shapeA, const Shape& shapeB)
+	{
+		Simplex simplex;
+		return intersects(shapeA, shapeB, simplex);
+	}
+
+	bool Gjk::penetration(const Shape& shapeA, const Shape& shapeB, Contact::Manifold& manifold, Simplex& simplex)
+	{
+		manifold.clear();
+
+		WorkingSimplex working;
+		if (!::run_gjk(shapeA, shapeB, simplex, false, working)) return false;
+
+		Vector3 normal;
+		float depth;
+		Vector3 point_a;
+		Vector3 point_b;
+		if (!::run_epa(shapeA, shapeB, working, normal, depth, point_a, point_b)) return false;
+
+		manifold.set_normal(normal);
+		manifold.add_point(Vector3::lerp(point_a, point_b, 0.5f), depth, 0);
+		return true;
+	}
+
+	bool Gjk::penetration(const Shape& shapeA, const Shape& shapeB, Contact::Manifold& manifold)
+	{
+		Simplex simplex;
+		return penetration(shapeA, shapeB, manifold, simplex);
+	}
+
+} // namespace Math
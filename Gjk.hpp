@@ -0,0 +1,238 @@
+#pragma once
+#ifndef __MATHS_GJK_HPP__
+#define __MATHS_GJK_HPP__
+
+#include "Vector3.hpp"
+#include "Line.hpp"
+#include "BoundingSphere.hpp"
+#include "BoundingBox.hpp"
+#include "OrientedBox.hpp"
+#include "Capsule.hpp"
+#include "Distance.hpp"
+#include "SoaArray.hpp"
+
+namespace Math
+{
+	namespace Contact
+	{
+		class Manifold;
+	}
+
+	namespace Gjk
+	{
+		//--------------------------------------------------------------------------
+		// Shape
+		//
+		// A convex shape given by its support function, which returns the point of
+		// the shape that is furthest along a direction. The direction need not be
+		// normalised and may be zero, in which case any point of the shape will do.
+		//
+
+		class Shape
+		{
+		public:
+			virtual ~Shape()
+			{
+			}
+
+			virtual Vector3 support(const Vector3& direction) const = 0;
+
+			// A point inside the shape, where the search starts from
+			virtual Vector3 center() const = 0;
+		};
+
+		class SphereShape : public Shape
+		{
+		private:
+			BoundingSphere mSphere;
+
+		public:
+			explicit SphereShape(const BoundingSphere& sphere) : mSphere(sphere)
+			{
+			}
+
+			Vector3 support(const Vector3& direction) const;
+
+			Vector3 center() const
+			{
+				return mSphere.center();
+			}
+		};
+
+		class BoxShape : public Shape
+		{
+		private:
+			BoundingBox mBox;
+
+		public:
+			explicit BoxShape(const BoundingBox& box) : mBox(box)
+			{
+			}
+
+			Vector3 support(const Vector3& direction) const;
+
+			Vector3 center() const
+			{
+				return mBox.center();
+			}
+		};
+
+		class OrientedBoxShape : public Shape
+		{
+		private:
+			OrientedBox mBox;
+
+		public:
+			explicit OrientedBoxShape(const OrientedBox& box) : mBox(box)
+			{
+			}
+
+			Vector3 support(const Vector3& direction) const;
+
+			Vector3 center() const
+			{
+				return mBox.center();
+			}
+		};
+
+		// All the points within radius of the line segment
+		class CapsuleShape : public Shape
+		{
+		private:
+			Line mSegment;
+			float mRadius;
+
+		public:
+			CapsuleShape(const Line& segment, float radius) : mSegment(segment), mRadius(std::abs(radius))
+			{
+			}
+
+			explicit CapsuleShape(const Capsule& capsule) : mSegment(capsule.segment()), mRadius(capsule.radius())
+			{
+			}
+
+			Vector3 support(const Vector3& direction) const;
+
+			Vector3 center() const
+			{
+				return Vector3::lerp(mSegment.start_point, mSegment.end_point, 0.5f);
+			}
+		};
+
+		// The convex hull of a set of points, which are searched four at a time. The points are not copied and have
+		// to stay alive while the shape is used.
+		class HullShape : public Shape
+		{
+		private:
+			SoaView<Vector3> mPoints;
+			Vector3 mCenter;
+
+		public:
+			explicit HullShape(const SoaView<Vector3>& points);
+
+			Vector3 support(const Vector3& direction) const;
+
+			Vector3 center() const
+			{
+				return mCenter;
+			}
+		};
+
+		//--------------------------------------------------------------------------
+		// Simplex
+		//
+		// What a query finished with, kept from one step to the next so the query
+		// for the same pair starts from it. Only the search directions are kept, so
+		// it stays usable after the shapes move.
+		//
+
+		static const uint_t MAX_SIMPLEX_SIZE = 4;
+
+		class Simplex
+		{
+		private:
+			Vector3 mDirections[MAX_SIMPLEX_SIZE];
+			uint_t mSize;
+			uint_t mIterations;
+
+		public:
+			Simplex() : mSize(0), mIterations(0)
+			{
+			}
+
+			Simplex(const Simplex& simplex) : mSize(simplex.mSize), mIterations(simplex.mIterations)
+			{
+				std::copy(simplex.mDirections, simplex.mDirections + mSize, mDirections);
+			}
+
+			Simplex& operator = (const Simplex& simplex)
+			{
+				mSize = simplex.mSize;
+				mIterations = simplex.mIterations;
+				std::copy(simplex.mDirections, simplex.mDirections + mSize, mDirections);
+				return *this;
+			}
+
+			bool empty() const
+			{
+				return mSize == 0;
+			}
+
+			uint_t size() const
+			{
+				return mSize;
+			}
+
+			const Vector3& direction(uint_t index) const
+			{
+				XMASSERT(index < mSize);
+				return mDirections[index];
+			}
+
+			// Support points the last query used, which shows how much starting from the simplex saved
+			uint_t iterations() const
+			{
+				return mIterations;
+			}
+
+			void clear()
+			{
+				mSize = 0;
+				mIterations = 0;
+			}
+
+			void set(const Vector3* directions, uint_t size, uint_t iterations)
+			{
+				XMASSERT(size <= MAX_SIMPLEX_SIZE);
+				std::copy(directions, directions + size, mDirections);
+				mSize = size;
+				mIterations = iterations;
+			}
+		};
+
+		//--------------------------------------------------------------------------
+		// Queries
+		//
+		// The simplex is used as the starting point when it is not empty, and is
+		// updated with the one the query finished with.
+		//
+
+		// Result is: (Closest point on A, Closest point on B, Distance between them)
+		// When A and B overlap the distance is zero and the points are not meaningful.
+		Distance::ClosestResult closest(const Shape& shapeA, const Shape& shapeB, Simplex& simplex);
+		Distance::ClosestResult closest(const Shape& shapeA, const Shape& shapeB);
+
+		// Stops as soon as it finds a separating axis, so it is cheaper than closest when only overlap is needed
+		bool intersects(const Shape& shapeA, const Shape& shapeB, Simplex& simplex);
+		bool intersects(const Shape& shapeA, const Shape& shapeB);
+
+		// Expands the GJK simplex into the shape of the overlap (EPA) to find how far they penetrate. The manifold is given
+		// the normal from A to B and a single point, and is left empty, returning false, when they do not overlap.
+		bool penetration(const Shape& shapeA, const Shape& shapeB, Contact::Manifold& manifold, Simplex& simplex);
+		bool penetration(const Shape& shapeA, const Shape& shapeB, Contact::Manifold& manifold);
+
+	} // namespace Gjk
+
+} // namespace Math
+
+#endif // __MATHS_GJK_HPP__
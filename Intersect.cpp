@@ -3,8 +3,16 @@
 #include "Plane.hpp"
 #include "BoundingSphere.hpp"
 #include "BoundingBox.hpp"
+#include "OrientedBox.hpp"
+#include "Triangle.hpp"
+#include "SoaArray.hpp"
+#include "SoaVector3.hpp"
+#include "Matrix.hpp"
 #include "Ray.hpp"
 #include "Line.hpp"
+#include "Capsule.hpp"
+#include "Distance.hpp"
+#include "Sweep.hpp"
 
 namespace 
 {
@@ -17,6 +25,400 @@ namespace
 	{
 		return n * n;
 	}
+
+	// Slab test of a ray against the box [-extents, extents], with the ray already in the box's local space.
+	// Distances are in units of the direction vector and limited to [0, max_distance].
+	Math::Intersect::LinearResult slab_test(FXMVECTOR origin, FXMVECTOR direction, FXMVECTOR extents, float max_distance)
+	{
+		const XMVECTOR parallel = XMVectorLessOrEqual(XMVectorAbs(direction), XMVectorSplatEpsilon());
+
+		// A ray parallel to a slab misses if it starts outside of it
+		const XMVECTOR outside = XMVectorAndInt(parallel, XMVectorGreater(XMVectorAbs(origin), extents));
+		if (XMVector3NotEqualInt(outside, XMVectorFalseInt())) return Math::Intersect::LinearResult();
+
+		const XMVECTOR inverse = XMVectorReciprocal(direction);
+		const XMVECTOR t1 = XMVectorMultiply(XMVectorSubtract(XMVectorNegate(extents), origin), inverse);
+		const XMVECTOR t2 = XMVectorMultiply(XMVectorSubtract(extents, origin), inverse);
+
+		// Parallel slabs do not limit the distances
+		const XMVECTOR infinity = XMVectorSplatInfinity();
+		const XMVECTOR entry = XMVectorSelect(XMVectorMin(t1, t2), XMVectorNegate(infinity), parallel);
+		const XMVECTOR exit = XMVectorSelect(XMVectorMax(t1, t2), infinity, parallel);
+
+		const float t_min = std::max(std::max(XMVectorGetX(entry), XMVectorGetY(entry)), std::max(XMVectorGetZ(entry), 0.0f));
+		const float t_max = std::min(std::min(XMVectorGetX(exit), XMVectorGetY(exit)), std::min(XMVectorGetZ(exit), max_distance));
+
+		if (t_min > t_max) return Math::Intersect::LinearResult();
+		return Math::Intersect::LinearResult(t_min);
+	}
+
+	// Separating axis test between two oriented boxes, following Gottschalk's OBBTree and Ericson's
+	// Real-Time Collision Detection (4.4.1). The 6 face axes are tested with vector operations and
+	// the 9 edge cross product axes with scalars.
+	bool overlaps(const Math::OrientedBox& a, const Math::OrientedBox& b)
+	{
+		const Math::Matrix rotation_a = a.rotation_matrix();
+		const Math::Matrix rotation_b = b.rotation_matrix();
+
+		// R[i][j] = dot(Ai, Bj), and the epsilon stops parallel edges producing a near zero cross product axis
+		const Math::Matrix r = rotation_a * rotation_b.transpose();
+		const XMVECTOR epsilon = XMVectorSplatEpsilon();
+		const Math::Matrix abs_r(XMVectorAdd(XMVectorAbs(r.r[0]), epsilon), XMVectorAdd(XMVectorAbs(r.r[1]), epsilon), XMVectorAdd(XMVectorAbs(r.r[2]), epsilon), XMVectorZero());
+
+		const XMVECTOR extents_a = a.extents();
+		const XMVECTOR extents_b = b.extents();
+
+		// Translation between the centers in A's space
+		const XMVECTOR t_vector = XMVector3TransformNormal(XMVectorSubtract(b.center(), a.center()), rotation_a.transpose());
+
+		// Face axes of A
+		const XMVECTOR radius_b = XMVector3TransformNormal(extents_b, abs_r.transpose());
+		if (!XMVector3LessOrEqual(XMVectorAbs(t_vector), XMVectorAdd(extents_a, radius_b))) return false;
+
+		// Face axes of B
+		const XMVECTOR radius_a = XMVector3TransformNormal(extents_a, abs_r);
+		if (!XMVector3LessOrEqual(XMVectorAbs(XMVector3TransformNormal(t_vector, r)), XMVectorAdd(extents_b, radius_a))) return false;
+
+		const Math::Vector3 ea(extents_a);
+		const Math::Vector3 eb(extents_b);
+		const Math::Vector3 t(t_vector);
+		const float ra[3] = { ea.x, ea.y, ea.z };
+		const float rb[3] = { eb.x, eb.y, eb.z };
+		const float tt[3] = { t.x, t.y, t.z };
+
+		// Edge axes Ai x Bj
+		for (uint_t i = 0; i < 3; ++i)
+		{
+			const uint_t i1 = (i + 1) % 3;
+			const uint_t i2 = (i + 2) % 3;
+
+			for (uint_t j = 0; j < 3; ++j)
+			{
+				const uint_t j1 = (j + 1) % 3;
+				const uint_t j2 = (j + 2) % 3;
+
+				const float edge_radius_a = ra[i1] * abs_r(i2, j) + ra[i2] * abs_r(i1, j);
+				const float edge_radius_b = rb[j1] * abs_r(i, j2) + rb[j2] * abs_r(i, j1);
+				const float distance = std::abs(tt[i2] * r(i1, j) - tt[i1] * r(i2, j));
+				if (distance > edge_radius_a + edge_radius_b) return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool contains_all(const Math::OrientedBox& box, const Math::OrientedBox::CornerArray& corners)
+	{
+		return std::all_of(std::begin(corners), std::end(corners), [&box](const Math::Vector3& corner) { return box.contains(corner); });
+	}
+
+	// Möller–Trumbore ray/triangle test, giving the distance in units of the direction vector limited to [0, max_distance]
+	Math::Intersect::TriangleResult moller_trumbore(FXMVECTOR origin, FXMVECTOR direction, const Math::Triangle& triangle, float max_distance)
+	{
+		const XMVECTOR edge1 = XMVectorSubtract(triangle.point_b, triangle.point_a);
+		const XMVECTOR edge2 = XMVectorSubtract(triangle.point_c, triangle.point_a);
+
+		// The determinant is the dot product of the direction with the triangle's normal, so the direction is parallel
+		// to the triangle when it is small relative to their lengths. An absolute epsilon would instead reject every
+		// small triangle and short direction, the squares save the square roots.
+		const XMVECTOR p = XMVector3Cross(direction, edge2);
+		const float det = XMVectorGetX(XMVector3Dot(edge1, p));
+		const XMVECTOR normal = XMVector3Cross(edge1, edge2);
+		const float parallel = FLT_EPSILON * FLT_EPSILON * XMVectorGetX(XMVector3LengthSq(normal)) * XMVectorGetX(XMVector3LengthSq(direction));
+		if (det * det <= parallel) return Math::Intersect::TriangleResult();
+
+		const float inverse_det = 1.0f / det;
+		const XMVECTOR s = XMVectorSubtract(origin, triangle.point_a);
+		const float u = XMVectorGetX(XMVector3Dot(s, p)) * inverse_det;
+		if (u < 0.0f || u > 1.0f) return Math::Intersect::TriangleResult();
+
+		const XMVECTOR q = XMVector3Cross(s, edge1);
+		const float v = XMVectorGetX(XMVector3Dot(direction, q)) * inverse_det;
+		if (v < 0.0f || u + v > 1.0f) return Math::Intersect::TriangleResult();
+
+		const float t = XMVectorGetX(XMVector3Dot(edge2, q)) * inverse_det;
+		if (t < 0.0f || t > max_distance) return Math::Intersect::TriangleResult();
+
+		return Math::Intersect::TriangleResult(t, u, v);
+	}
+
+	// The same test as moller_trumbore against the four triangles of a block, without any early outs
+	Math::Intersect::TriangleBlockResult moller_trumbore(FXMVECTOR origin, FXMVECTOR direction, const Math::SoaBlock<Math::Triangle>& triangles, float max_distance)
+	{
+		typedef Math::SoaTraits<Math::Triangle> Traits;
+
+		const Math::SoaVector3 a = Math::soa_vector3(triangles[Traits::A_X], triangles[Traits::A_Y], triangles[Traits::A_Z]);
+		const Math::SoaVector3 b = Math::soa_vector3(triangles[Traits::B_X], triangles[Traits::B_Y], triangles[Traits::B_Z]);
+		const Math::SoaVector3 c = Math::soa_vector3(triangles[Traits::C_X], triangles[Traits::C_Y], triangles[Traits::C_Z]);
+		const Math::SoaVector3 o = Math::soa_splat(origin);
+		const Math::SoaVector3 d = Math::soa_splat(direction);
+
+		const Math::SoaVector3 edge1 = Math::soa_subtract(b, a);
+		const Math::SoaVector3 edge2 = Math::soa_subtract(c, a);
+
+		const Math::SoaVector3 p = Math::soa_cross(d, edge2);
+		const XMVECTOR det = Math::soa_dot(edge1, p);
+		const XMVECTOR inverse_det = XMVectorReciprocal(det);
+		const Math::SoaVector3 normal = Math::soa_cross(edge1, edge2);
+		const XMVECTOR parallel = XMVectorMultiply(XMVectorReplicate(FLT_EPSILON * FLT_EPSILON), XMVectorMultiply(Math::soa_length_squared(normal), XMVector3LengthSq(direction)));
+
+		const Math::SoaVector3 s = Math::soa_subtract(o, a);
+		const Math::SoaVector3 q = Math::soa_cross(s, edge1);
+
+		Math::Intersect::TriangleBlockResult result;
+		result.u = XMVectorMultiply(Math::soa_dot(s, p), inverse_det);
+		result.v = XMVectorMultiply(Math::soa_dot(d, q), inverse_det);
+		result.distance = XMVectorMultiply(Math::soa_dot(edge2, q), inverse_det);
+
+		const XMVECTOR zero = XMVectorZero();
+		const XMVECTOR one = XMVectorSplatOne();
+		XMVECTOR hit = XMVectorGreater(XMVectorMultiply(det, det), parallel);
+		hit = XMVectorAndInt(hit, XMVectorGreaterOrEqual(result.u, zero));
+		hit = XMVectorAndInt(hit, XMVectorGreaterOrEqual(result.v, zero));
+		hit = XMVectorAndInt(hit, XMVectorLessOrEqual(XMVectorAdd(result.u, result.v), one));
+		hit = XMVectorAndInt(hit, XMVectorGreaterOrEqual(result.distance, zero));
+		hit = XMVectorAndInt(hit, XMVectorLessOrEqual(result.distance, XMVectorReplicate(max_distance)));
+		result.intersect = hit;
+
+		return result;
+	}
+
+	// Closest hit over all the blocks, the padding lanes of the last block are ignored
+	Math::Intersect::TriangleResult closest_hit(FXMVECTOR origin, FXMVECTOR direction, const Math::SoaView<Math::Triangle>& triangles, float max_distance, size_t* hit_index)
+	{
+		Math::Intersect::TriangleResult closest;
+		float closest_distance = max_distance;
+
+		for (size_t block = 0; block < triangles.block_count(); ++block)
+		{
+			const Math::Intersect::TriangleBlockResult result = moller_trumbore(origin, direction, triangles.load_block(block), closest_distance);
+			if (!XMVector4NotEqualInt(result.intersect, XMVectorFalseInt())) continue;
+
+			// Lanes that missed are pushed out to infinity so only the distance needs checking
+			XMVECTORF32 distances;
+			XMVECTORF32 u;
+			XMVECTORF32 v;
+			distances.v = XMVectorSelect(XMVectorSplatInfinity(), result.distance, result.intersect);
+			u.v = result.u;
+			v.v = result.v;
+
+			const uint_t lane_count = triangles.lane_count(block);
+			for (uint_t lane = 0; lane < lane_count; ++lane)
+			{
+				if (distances.f[lane] <= closest_distance)
+				{
+					closest_distance = distances.f[lane];
+					closest = Math::Intersect::TriangleResult(distances.f[lane], u.f[lane], v.f[lane]);
+					if (hit_index) *hit_index = block * Math::SOA_LANE_COUNT + lane;
+				}
+			}
+		}
+
+		return closest;
+	}
+
+	// Separating axis test between a triangle and the box [-extents, extents], with the triangle already in the box's
+	// local space. From Akenine-Möller's "Fast 3D Triangle-Box Overlap Testing" and Ericson's Real-Time Collision Detection (5.2.9).
+	bool overlaps(FXMVECTOR extents, FXMVECTOR v0, FXMVECTOR v1, CXMVECTOR v2)
+	{
+		// Face axes of the box, which is the bounding box of the triangle against the box
+		const XMVECTOR minimum = XMVectorMin(XMVectorMin(v0, v1), v2);
+		const XMVECTOR maximum = XMVectorMax(XMVectorMax(v0, v1), v2);
+		if (!XMVector3LessOrEqual(minimum, extents) || !XMVector3GreaterOrEqual(maximum, XMVectorNegate(extents))) return false;
+
+		const XMVECTOR edges[3] = { XMVectorSubtract(v1, v0), XMVectorSubtract(v2, v1), XMVectorSubtract(v0, v2) };
+
+		// Plane of the triangle
+		const XMVECTOR normal = XMVector3Cross(edges[0], edges[1]);
+		const float plane_radius = XMVectorGetX(XMVector3Dot(XMVectorAbs(normal), extents));
+		if (std::abs(XMVectorGetX(XMVector3Dot(normal, v0))) > plane_radius) return false;
+
+		// Edge cross product axes, which are zero and so never separate for degenerate edges
+		static const XMVECTORF32 AXES[3] = { { 1.0f, 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f, 0.0f } };
+		for (uint_t i = 0; i < 3; ++i)
+		{
+			for (uint_t j = 0; j < 3; ++j)
+			{
+				const XMVECTOR axis = XMVector3Cross(AXES[i], edges[j]);
+				const float p0 = XMVectorGetX(XMVector3Dot(axis, v0));
+				const float p1 = XMVectorGetX(XMVector3Dot(axis, v1));
+				const float p2 = XMVectorGetX(XMVector3Dot(axis, v2));
+				const float radius = XMVectorGetX(XMVector3Dot(XMVectorAbs(axis), extents));
+				if (std::min(std::min(p0, p1), p2) > radius || std::max(std::max(p0, p1), p2) < -radius) return false;
+			}
+		}
+
+		return true;
+	}
+
+	Math::Intersect::VolumeResult test_local(FXMVECTOR extents, FXMVECTOR v0, FXMVECTOR v1, CXMVECTOR v2)
+	{
+		if (!overlaps(extents, v0, v1, v2)) return Math::Intersect::VOLUME_DISJOINT;
+
+		if (XMVector3InBounds(v0, extents) && XMVector3InBounds(v1, extents) && XMVector3InBounds(v2, extents))
+		{
+			return Math::Intersect::VOLUME_CONTAINS;
+		}
+
+		return Math::Intersect::VOLUME_INTERSECT;
+	}
+
+	// Squared lengths below this are treated as a segment of zero length
+	const float DEGENERATE_LENGTH_SQUARED = FLT_EPSILON * FLT_EPSILON;
+
+	// First point within the capsule along direction from origin, in units of the direction vector limited to [0, max_distance]
+	Math::Intersect::LinearResult capsule_hit(const Math::Vector3& origin, const Math::Vector3& direction, const Math::Capsule& capsule, float max_distance)
+	{
+		// Swept no further than it takes to pass the whole capsule, which keeps the sweep's times in [0, 1]
+		const Math::BoundingSphere bounds = capsule.get_bounding_sphere();
+		const float length = direction.length();
+		float reach = max_distance;
+		if (length > FLT_EPSILON) reach = std::min(reach, (Math::Vector3(bounds.center() - origin).length() + bounds.radius()) / length);
+
+		const Math::Intersect::LinearResult result = Math::Sweep::test(Math::BoundingSphere(origin, 0.0f), direction * reach, capsule);
+		return Math::Intersect::LinearResult(result.intersects(), result.distance() * reach);
+	}
+
+	// Closest hit over all the capsules. The bounding sphere of each capsule is tested a block at a time, and only
+	// the capsules whose sphere is hit before the closest hit so far are tested on their own.
+	Math::Intersect::LinearResult closest_hit(const Math::Vector3& origin, const Math::Vector3& direction, const Math::SoaView<Math::Capsule>& capsules, float max_distance, size_t* hit_index)
+	{
+		typedef Math::SoaTraits<Math::Capsule> Traits;
+
+		const Math::SoaVector3 o = Math::soa_splat(origin);
+		const Math::SoaVector3 d = Math::soa_splat(direction);
+		const XMVECTOR a = Math::soa_length_squared(d);
+		const XMVECTOR zero = XMVectorZero();
+		const XMVECTOR half = XMVectorReplicate(0.5f);
+
+		Math::Intersect::LinearResult closest;
+		float closest_distance = max_distance;
+
+		for (size_t block = 0; block < capsules.block_count(); ++block)
+		{
+			const Math::SoaBlock<Math::Capsule> capsule_block = capsules.load_block(block);
+			const Math::SoaVector3 start = Math::soa_vector3(capsule_block[Traits::START_X], capsule_block[Traits::START_Y], capsule_block[Traits::START_Z]);
+			const Math::SoaVector3 end = Math::soa_vector3(capsule_block[Traits::END_X], capsule_block[Traits::END_Y], capsule_block[Traits::END_Z]);
+			const Math::SoaVector3 axis = Math::soa_subtract(end, start);
+			const Math::SoaVector3 center = Math::soa_multiply_add(axis, half, start);
+			const XMVECTOR radius = XMVectorMultiplyAdd(XMVectorSqrt(Math::soa_length_squared(axis)), half, capsule_block[Traits::RADIUS]);
+
+			const Math::SoaVector3 offset = Math::soa_subtract(o, center);
+			const XMVECTOR b = Math::soa_dot(d, offset);
+			const XMVECTOR c = XMVectorSubtract(Math::soa_length_squared(offset), XMVectorMultiply(radius, radius));
+			const XMVECTOR discriminant = XMVectorSubtract(XMVectorMultiply(b, b), XMVectorMultiply(a, c));
+			const XMVECTOR entry = XMVectorDivide(c, XMVectorSubtract(XMVectorSqrt(discriminant), b));
+
+			XMVECTOR candidate = XMVectorLess(b, zero);
+			candidate = XMVectorAndInt(candidate, XMVectorGreaterOrEqual(discriminant, zero));
+			candidate = XMVectorAndInt(candidate, XMVectorLessOrEqual(entry, XMVectorReplicate(closest_distance)));
+			candidate = XMVectorOrInt(candidate, XMVectorLessOrEqual(c, zero));
+			if (!XMVector4NotEqualInt(candidate, XMVectorFalseInt())) continue;
+
+			XMVECTORU32 lanes;
+			lanes.v = candidate;
+
+			const uint_t lane_count = capsules.lane_count(block);
+			for (uint_t lane = 0; lane < lane_count; ++lane)
+			{
+				if (!lanes.u[lane]) continue;
+
+				const size_t index = block * Math::SOA_LANE_COUNT + lane;
+				const Math::Intersect::LinearResult result = capsule_hit(origin, direction, capsules[index], closest_distance);
+				if (result.intersects() && result.distance() <= closest_distance)
+				{
+					closest_distance = result.distance();
+					closest = result;
+					if (hit_index) *hit_index = index;
+				}
+			}
+		}
+
+		return closest;
+	}
+
+	// Squared distance from each point to the closest point on its segment, with zero length segments taking the start point
+	XMVECTOR distance_squared(const Math::SoaVector3& point, const Math::SoaVector3& start, const Math::SoaVector3& vector)
+	{
+		const XMVECTOR length_squared = Math::soa_length_squared(vector);
+		const XMVECTOR degenerate = XMVectorLessOrEqual(length_squared, XMVectorReplicate(DEGENERATE_LENGTH_SQUARED));
+		const XMVECTOR t = XMVectorClamp(XMVectorDivide(Math::soa_dot(Math::soa_subtract(point, start), vector), length_squared), XMVectorZero(), XMVectorSplatOne());
+		const Math::SoaVector3 closest = Math::soa_multiply_add(vector, XMVectorSelect(t, XMVectorZero(), degenerate), start);
+		return Math::soa_length_squared(Math::soa_subtract(point, closest));
+	}
+
+	// Squared distance between the closest points of the segments, from Ericson's Real-Time Collision Detection (5.1.9)
+	// as in Distance::closest but with every branch worked out and the right one selected in each lane
+	XMVECTOR distance_squared(const Math::SoaVector3& start1, const Math::SoaVector3& vector1, const Math::SoaVector3& start2, const Math::SoaVector3& vector2)
+	{
+		const XMVECTOR zero = XMVectorZero();
+		const XMVECTOR one = XMVectorSplatOne();
+		const XMVECTOR degenerate = XMVectorReplicate(DEGENERATE_LENGTH_SQUARED);
+
+		const Math::SoaVector3 r = Math::soa_subtract(start1, start2);
+		const XMVECTOR a = Math::soa_length_squared(vector1);
+		const XMVECTOR e = Math::soa_length_squared(vector2);
+		const XMVECTOR f = Math::soa_dot(vector2, r);
+		const XMVECTOR c = Math::soa_dot(vector1, r);
+		const XMVECTOR b = Math::soa_dot(vector1, vector2);
+
+		// Divisors that would be zero are replaced by one, and the lanes that needed them are selected away below
+		const XMVECTOR point1 = XMVectorLessOrEqual(a, degenerate);
+		const XMVECTOR point2 = XMVectorLessOrEqual(e, degenerate);
+		const XMVECTOR safe_a = XMVectorSelect(a, one, point1);
+		const XMVECTOR safe_e = XMVectorSelect(e, one, point2);
+		const XMVECTOR denom = XMVectorSubtract(XMVectorMultiply(a, e), XMVectorMultiply(b, b));
+		const XMVECTOR parallel = XMVectorEqual(denom, zero);
+		const XMVECTOR safe_denom = XMVectorSelect(denom, one, parallel);
+
+		// Parallel segments have no unique closest pair so any s will do
+		XMVECTOR s = XMVectorSubtract(XMVectorMultiply(b, f), XMVectorMultiply(c, e));
+		s = XMVectorSelect(XMVectorClamp(XMVectorDivide(s, safe_denom), zero, one), zero, parallel);
+
+		// Closest point on the second segment to the first's point, clamped and then the first's point recomputed
+		const XMVECTOR t = XMVectorDivide(XMVectorMultiplyAdd(b, s, f), safe_e);
+		const XMVECTOR s_low = XMVectorClamp(XMVectorDivide(XMVectorNegate(c), safe_a), zero, one);
+		const XMVECTOR s_high = XMVectorClamp(XMVectorDivide(XMVectorSubtract(b, c), safe_a), zero, one);
+		s = XMVectorSelect(s, s_low, XMVectorLess(t, zero));
+		s = XMVectorSelect(s, s_high, XMVectorGreater(t, one));
+		XMVECTOR clamped_t = XMVectorClamp(t, zero, one);
+
+		// When the second segment is a point
+		s = XMVectorSelect(s, s_low, point2);
+		clamped_t = XMVectorSelect(clamped_t, zero, point2);
+
+		// When the first segment is a point
+		s = XMVectorSelect(s, zero, point1);
+		clamped_t = XMVectorSelect(clamped_t, XMVectorClamp(XMVectorDivide(f, safe_e), zero, one), point1);
+		clamped_t = XMVectorSelect(clamped_t, zero, XMVectorAndInt(point1, point2));
+
+		const Math::SoaVector3 closest1 = Math::soa_multiply_add(vector1, s, start1);
+		const Math::SoaVector3 closest2 = Math::soa_multiply_add(vector2, clamped_t, start2);
+		return Math::soa_length_squared(Math::soa_subtract(closest2, closest1));
+	}
+
+	// Writes the lanes of a block that hold real elements, checking in the same order as the single tests
+	void store_results(FXMVECTOR intersect, FXMVECTOR contains, FXMVECTOR contained, CXMVECTOR identical, Math::Intersect::VolumeResult* results, size_t block, uint_t lane_count)
+	{
+		XMVECTORU32 intersect_lanes;
+		XMVECTORU32 contains_lanes;
+		XMVECTORU32 contained_lanes;
+		XMVECTORU32 identical_lanes;
+		intersect_lanes.v = intersect;
+		contains_lanes.v = contains;
+		contained_lanes.v = contained;
+		identical_lanes.v = identical;
+
+		Math::Intersect::VolumeResult* output = results + block * Math::SOA_LANE_COUNT;
+		for (uint_t lane = 0; lane < lane_count; ++lane)
+		{
+			if (identical_lanes.u[lane]) output[lane] = Math::Intersect::VOLUME_IDENTICAL;
+			else if (!intersect_lanes.u[lane]) output[lane] = Math::Intersect::VOLUME_DISJOINT;
+			else if (contains_lanes.u[lane]) output[lane] = Math::Intersect::VOLUME_CONTAINS;
+			else if (contained_lanes.u[lane]) output[lane] = Math::Intersect::VOLUME_CONTAINED;
+			else output[lane] = Math::Intersect::VOLUME_INTERSECT;
+		}
+	}
 }
 
 namespace Math
@@ -115,7 +517,7 @@ namespace Math
 		if (yt >= 0.0f)
 		{
 			hitpoint = ray * yt;
-			if ((minimum.y <= hitpoint.x && hitpoint.x <= maximum.x) &&
+			if ((minimum.x <= hitpoint.x && hitpoint.x <= maximum.x) &&
 				(minimum.z <= hitpoint.z && hitpoint.z <= maximum.z))
 			{
 				if (!intersect || yt < t)
@@ -142,6 +544,30 @@ namespace Math
 		return LinearResult(intersect, t);
 	}
 
+	Intersect::LinearResult Intersect::test(const Ray& ray, const OrientedBox& box)
+	{
+		// Rotating into the box's space keeps the direction normalised, so the distance is unchanged
+		const XMVECTOR inverse_orientation = XMQuaternionConjugate(box.orientation());
+		const XMVECTOR origin = XMVector3Rotate(XMVectorSubtract(ray.origin(), box.center()), inverse_orientation);
+		const XMVECTOR direction = XMVector3Rotate(ray.direction(), inverse_orientation);
+		return ::slab_test(origin, direction, box.extents(), FLT_MAX);
+	}
+
+	Intersect::LinearResult Intersect::test(const Ray& ray, const Capsule& capsule)
+	{
+		return ::capsule_hit(ray.origin(), ray.direction(), capsule, FLT_MAX);
+	}
+
+	Intersect::TriangleResult Intersect::test(const Ray& ray, const Triangle& triangle)
+	{
+		return ::moller_trumbore(ray.origin(), ray.direction(), triangle, FLT_MAX);
+	}
+
+	Intersect::TriangleBlockResult Intersect::test(const Ray& ray, const SoaBlock<Triangle>& triangles)
+	{
+		return ::moller_trumbore(ray.origin(), ray.direction(), triangles, FLT_MAX);
+	}
+
 
 	Intersect::LinearResult Intersect::test(const Line& line, const Plane& plane)
 	{
@@ -195,6 +621,53 @@ namespace Math
 		return LinearResult();
 	}
 
+	Intersect::LinearResult Intersect::test(const Line& line, const OrientedBox& box)
+	{
+		// With the unnormalised line vector as the direction the distances come out in [0, 1] along the line
+		const XMVECTOR inverse_orientation = XMQuaternionConjugate(box.orientation());
+		const XMVECTOR origin = XMVector3Rotate(XMVectorSubtract(line.start_point, box.center()), inverse_orientation);
+		const XMVECTOR direction = XMVector3Rotate(line.vector(), inverse_orientation);
+		return ::slab_test(origin, direction, box.extents(), 1.0f);
+	}
+
+	Intersect::LinearResult Intersect::test(const Line& line, const Capsule& capsule)
+	{
+		// With the unnormalised line vector as the direction the distance comes out in [0, 1] along the line
+		return ::capsule_hit(line.start_point, line.vector(), capsule, 1.0f);
+	}
+
+	Intersect::TriangleResult Intersect::test(const Line& line, const Triangle& triangle)
+	{
+		// With the unnormalised line vector as the direction the distance comes out in [0, 1] along the line
+		return ::moller_trumbore(line.start_point, line.vector(), triangle, 1.0f);
+	}
+
+	Intersect::TriangleBlockResult Intersect::test(const Line& line, const SoaBlock<Triangle>& triangles)
+	{
+		return ::moller_trumbore(line.start_point, line.vector(), triangles, 1.0f);
+	}
+
+
+	Intersect::TriangleResult Intersect::test(const Ray& ray, const SoaView<Triangle>& triangles, size_t* hit_index)
+	{
+		return ::closest_hit(ray.origin(), ray.direction(), triangles, FLT_MAX, hit_index);
+	}
+
+	Intersect::TriangleResult Intersect::test(const Line& line, const SoaView<Triangle>& triangles, size_t* hit_index)
+	{
+		return ::closest_hit(line.start_point, line.vector(), triangles, 1.0f, hit_index);
+	}
+
+	Intersect::LinearResult Intersect::test(const Ray& ray, const SoaView<Capsule>& capsules, size_t* hit_index)
+	{
+		return ::closest_hit(ray.origin(), ray.direction(), capsules, FLT_MAX, hit_index);
+	}
+
+	Intersect::LinearResult Intersect::test(const Line& line, const SoaView<Capsule>& capsules, size_t* hit_index)
+	{
+		return ::closest_hit(line.start_point, line.vector(), capsules, 1.0f, hit_index);
+	}
+
 
 	Intersect::VolumeResult Intersect::test(const BoundingSphere& sphereA, const BoundingSphere& sphereB)
 	{
@@ -296,6 +769,259 @@ namespace Math
 		return VOLUME_DISJOINT;
 	}
 
+	Intersect::VolumeResult Intersect::test(const OrientedBox& boxA, const OrientedBox& boxB)
+	{
+		if (boxA == boxB) return VOLUME_IDENTICAL;
+
+		if (::overlaps(boxA, boxB))
+		{
+			if (::contains_all(boxA, boxB.get_all_corners()))
+			{
+				return VOLUME_CONTAINS;
+			}
+			if (::contains_all(boxB, boxA.get_all_corners()))
+			{
+				return VOLUME_CONTAINED;
+			}
+
+			return VOLUME_INTERSECT;
+		}
+
+		return VOLUME_DISJOINT;
+	}
+
+	Intersect::VolumeResult Intersect::test(const OrientedBox& boxA, const BoundingBox& boxB)
+	{
+		return test(boxA, OrientedBox(boxB));
+	}
+
+	Intersect::VolumeResult Intersect::test(const BoundingBox& boxA, const OrientedBox& boxB)
+	{
+		return test(OrientedBox(boxA), boxB);
+	}
+
+	Intersect::VolumeResult Intersect::test(const BoundingSphere& sphereA, const OrientedBox& boxB)
+	{
+		// In the box's space this is the sphere against an axis aligned box centered on the origin
+		const XMVECTOR extents = boxB.extents();
+		const XMVECTOR center = XMVector3Rotate(XMVectorSubtract(sphereA.center(), boxB.center()), XMQuaternionConjugate(boxB.orientation()));
+		const XMVECTOR radius = XMVectorReplicate(sphereA.radius());
+
+		const XMVECTOR closest = XMVectorClamp(center, XMVectorNegate(extents), extents);
+		if (XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(center, closest))) > ::square(sphereA.radius()))
+		{
+			return VOLUME_DISJOINT;
+		}
+
+		const XMVECTOR distance = XMVectorAbs(center);
+		if (XMVector3LessOrEqual(XMVectorAdd(distance, radius), extents))
+		{
+			return VOLUME_CONTAINED;
+		}
+
+		// The furthest corner is the one on the far side of the box on every axis
+		if (XMVectorGetX(XMVector3LengthSq(XMVectorAdd(distance, extents))) <= ::square(sphereA.radius()))
+		{
+			return VOLUME_CONTAINS;
+		}
+
+		return VOLUME_INTERSECT;
+	}
+
+	Intersect::VolumeResult Intersect::test(const OrientedBox& boxA, const BoundingSphere& sphereB)
+	{
+		const VolumeResult result = test(sphereB, boxA);
+		if (result == VOLUME_CONTAINED) return VOLUME_CONTAINS;
+		if (result == VOLUME_CONTAINS) return VOLUME_CONTAINED;
+		return result;
+	}
+
+	Intersect::VolumeResult Intersect::test(const Capsule& capsuleA, const Capsule& capsuleB)
+	{
+		if (capsuleA == capsuleB) return VOLUME_IDENTICAL;
+
+		const Line& segmentA = capsuleA.segment();
+		const Line& segmentB = capsuleB.segment();
+		const float radiusA = capsuleA.radius();
+		const float radiusB = capsuleB.radius();
+
+		const float distance = Distance::closest(segmentA, segmentB).distance();
+		if (distance > radiusA + radiusB) return VOLUME_DISJOINT;
+
+		// A capsule is convex, so it contains another capsule when it contains the spheres at both of its ends
+		if (Distance::closest(segmentB.start_point, segmentA).distance() + radiusB <= radiusA &&
+			Distance::closest(segmentB.end_point, segmentA).distance() + radiusB <= radiusA)
+		{
+			return VOLUME_CONTAINS;
+		}
+		else if (Distance::closest(segmentA.start_point, segmentB).distance() + radiusA <= radiusB &&
+			Distance::closest(segmentA.end_point, segmentB).distance() + radiusA <= radiusB)
+		{
+			return VOLUME_CONTAINED;
+		}
+
+		return VOLUME_INTERSECT;
+	}
+
+	Intersect::VolumeResult Intersect::test(const Capsule& capsuleA, const BoundingSphere& sphereB)
+	{
+		const Line& segment = capsuleA.segment();
+		const float radiusA = capsuleA.radius();
+		const float radiusB = sphereB.radius();
+
+		const float distance = Distance::closest(sphereB.center(), segment).distance();
+		if (distance > radiusA + radiusB) return VOLUME_DISJOINT;
+
+		if (distance + radiusB <= radiusA)
+		{
+			return VOLUME_CONTAINS;
+		}
+		else if (Vector3(segment.start_point - sphereB.center()).length() + radiusA <= radiusB &&
+			Vector3(segment.end_point - sphereB.center()).length() + radiusA <= radiusB)
+		{
+			return VOLUME_CONTAINED;
+		}
+
+		return VOLUME_INTERSECT;
+	}
+
+	Intersect::VolumeResult Intersect::test(const BoundingSphere& sphereA, const Capsule& capsuleB)
+	{
+		const VolumeResult result = test(capsuleB, sphereA);
+		if (result == VOLUME_CONTAINED) return VOLUME_CONTAINS;
+		if (result == VOLUME_CONTAINS) return VOLUME_CONTAINED;
+		return result;
+	}
+
+	Intersect::VolumeResult Intersect::test(const Capsule& capsuleA, const BoundingBox& boxB)
+	{
+		const float radius = capsuleA.radius();
+		if (Distance::closest(capsuleA.segment(), boxB).distance_squared() > radius * radius) return VOLUME_DISJOINT;
+
+		const BoundingBox::CornerArray corners = boxB.get_all_corners();
+		if (std::all_of(std::begin(corners), std::end(corners), [&capsuleA](const Vector3& corner) { return capsuleA.contains(corner); }))
+		{
+			return VOLUME_CONTAINS;
+		}
+
+		const BoundingBox bounds = capsuleA.get_bounding_box();
+		if (XMVector3GreaterOrEqual(bounds.minimum_corner(), boxB.minimum_corner()) && XMVector3LessOrEqual(bounds.maximum_corner(), boxB.maximum_corner()))
+		{
+			return VOLUME_CONTAINED;
+		}
+
+		return VOLUME_INTERSECT;
+	}
+
+	Intersect::VolumeResult Intersect::test(const BoundingBox& boxA, const Capsule& capsuleB)
+	{
+		const VolumeResult result = test(capsuleB, boxA);
+		if (result == VOLUME_CONTAINED) return VOLUME_CONTAINS;
+		if (result == VOLUME_CONTAINS) return VOLUME_CONTAINED;
+		return result;
+	}
+
+	Intersect::VolumeResult Intersect::test(const BoundingBox& boxA, const Triangle& triangleB)
+	{
+		// Move the triangle so the box is centered on the origin
+		const XMVECTOR center = XMVectorScale(XMVectorAdd(boxA.minimum_corner(), boxA.maximum_corner()), 0.5f);
+		const XMVECTOR extents = XMVectorScale(XMVectorSubtract(boxA.maximum_corner(), boxA.minimum_corner()), 0.5f);
+		return ::test_local(extents,
+			XMVectorSubtract(triangleB.point_a, center),
+			XMVectorSubtract(triangleB.point_b, center),
+			XMVectorSubtract(triangleB.point_c, center));
+	}
+
+	Intersect::VolumeResult Intersect::test(const OrientedBox& boxA, const Triangle& triangleB)
+	{
+		const XMVECTOR inverse_orientation = XMQuaternionConjugate(boxA.orientation());
+		return ::test_local(boxA.extents(),
+			XMVector3Rotate(XMVectorSubtract(triangleB.point_a, boxA.center()), inverse_orientation),
+			XMVector3Rotate(XMVectorSubtract(triangleB.point_b, boxA.center()), inverse_orientation),
+			XMVector3Rotate(XMVectorSubtract(triangleB.point_c, boxA.center()), inverse_orientation));
+	}
+
+	Intersect::VolumeResult Intersect::test(const BoundingSphere& sphereA, const Triangle& triangleB)
+	{
+		const Vector3& center = sphereA.center();
+		const float radius_squared = ::square(sphereA.radius());
+
+		const Vector3 closest = triangleB.closest_point(center);
+		if (Vector3(closest - center).length_squared() > radius_squared) return VOLUME_DISJOINT;
+
+		if (Vector3(triangleB.point_a - center).length_squared() <= radius_squared &&
+			Vector3(triangleB.point_b - center).length_squared() <= radius_squared &&
+			Vector3(triangleB.point_c - center).length_squared() <= radius_squared)
+		{
+			return VOLUME_CONTAINS;
+		}
+
+		return VOLUME_INTERSECT;
+	}
+
+
+	void Intersect::test(const Capsule& capsuleA, const SoaView<Capsule>& capsulesB, VolumeResult* results)
+	{
+		typedef SoaTraits<Capsule> Traits;
+
+		const SoaVector3 start_a = soa_splat(capsuleA.segment().start_point);
+		const SoaVector3 end_a = soa_splat(capsuleA.segment().end_point);
+		const SoaVector3 vector_a = soa_subtract(end_a, start_a);
+		const XMVECTOR radius_a = XMVectorReplicate(capsuleA.radius());
+
+		for (size_t block = 0; block < capsulesB.block_count(); ++block)
+		{
+			const SoaBlock<Capsule> capsules = capsulesB.load_block(block);
+			const SoaVector3 start_b = soa_vector3(capsules[Traits::START_X], capsules[Traits::START_Y], capsules[Traits::START_Z]);
+			const SoaVector3 end_b = soa_vector3(capsules[Traits::END_X], capsules[Traits::END_Y], capsules[Traits::END_Z]);
+			const SoaVector3 vector_b = soa_subtract(end_b, start_b);
+			const XMVECTOR radius_b = capsules[Traits::RADIUS];
+
+			const XMVECTOR distance = XMVectorSqrt(::distance_squared(start_a, vector_a, start_b, vector_b));
+			const XMVECTOR intersect = XMVectorLessOrEqual(distance, XMVectorAdd(radius_a, radius_b));
+
+			const XMVECTOR contains = XMVectorAndInt(
+				XMVectorLessOrEqual(XMVectorAdd(XMVectorSqrt(::distance_squared(start_b, start_a, vector_a)), radius_b), radius_a),
+				XMVectorLessOrEqual(XMVectorAdd(XMVectorSqrt(::distance_squared(end_b, start_a, vector_a)), radius_b), radius_a));
+			const XMVECTOR contained = XMVectorAndInt(
+				XMVectorLessOrEqual(XMVectorAdd(XMVectorSqrt(::distance_squared(start_a, start_b, vector_b)), radius_a), radius_b),
+				XMVectorLessOrEqual(XMVectorAdd(XMVectorSqrt(::distance_squared(end_a, start_b, vector_b)), radius_a), radius_b));
+
+			XMVECTOR identical = XMVectorEqual(radius_a, radius_b);
+			identical = XMVectorAndInt(identical, XMVectorAndInt(XMVectorEqual(start_a.x, start_b.x), XMVectorEqual(end_a.x, end_b.x)));
+			identical = XMVectorAndInt(identical, XMVectorAndInt(XMVectorEqual(start_a.y, start_b.y), XMVectorEqual(end_a.y, end_b.y)));
+			identical = XMVectorAndInt(identical, XMVectorAndInt(XMVectorEqual(start_a.z, start_b.z), XMVectorEqual(end_a.z, end_b.z)));
+
+			::store_results(intersect, contains, contained, identical, results, block, capsulesB.lane_count(block));
+		}
+	}
+
+	void Intersect::test(const Capsule& capsuleA, const SoaView<BoundingSphere>& spheresB, VolumeResult* results)
+	{
+		typedef SoaTraits<BoundingSphere> Traits;
+
+		const SoaVector3 start_a = soa_splat(capsuleA.segment().start_point);
+		const SoaVector3 end_a = soa_splat(capsuleA.segment().end_point);
+		const SoaVector3 vector_a = soa_subtract(end_a, start_a);
+		const XMVECTOR radius_a = XMVectorReplicate(capsuleA.radius());
+
+		for (size_t block = 0; block < spheresB.block_count(); ++block)
+		{
+			const SoaBlock<BoundingSphere> spheres = spheresB.load_block(block);
+			const SoaVector3 center = soa_vector3(spheres[Traits::CENTER_X], spheres[Traits::CENTER_Y], spheres[Traits::CENTER_Z]);
+			const XMVECTOR radius_b = spheres[Traits::RADIUS];
+
+			const XMVECTOR distance = XMVectorSqrt(::distance_squared(center, start_a, vector_a));
+			const XMVECTOR intersect = XMVectorLessOrEqual(distance, XMVectorAdd(radius_a, radius_b));
+			const XMVECTOR contains = XMVectorLessOrEqual(XMVectorAdd(distance, radius_b), radius_a);
+			const XMVECTOR contained = XMVectorAndInt(
+				XMVectorLessOrEqual(XMVectorAdd(XMVectorSqrt(soa_length_squared(soa_subtract(start_a, center))), radius_a), radius_b),
+				XMVectorLessOrEqual(XMVectorAdd(XMVectorSqrt(soa_length_squared(soa_subtract(end_a, center))), radius_a), radius_b));
+
+			::store_results(intersect, contains, contained, XMVectorFalseInt(), results, block, spheresB.lane_count(block));
+		}
+	}
+
 
 	Intersect::PlaneResult Intersect::test(const Plane& plane, const Vector3& point)
 	{
@@ -339,4 +1065,36 @@ namespace Math
 		return INTERSECTS_PLANE;
 	}
 
+	Intersect::PlaneResult Intersect::test(const Plane& plane, const OrientedBox& box)
+	{
+		// Project the box onto the plane normal, working in the box's space where the projection is a dot product with the extents
+		const XMVECTOR normal = XMVector3Rotate(plane, XMQuaternionConjugate(box.orientation()));
+		const float radius = XMVectorGetX(XMVector3Dot(XMVectorAbs(normal), box.extents()));
+		const float distance = plane.distance(box.center());
+		if (distance > radius) return INSIDE_PLANE;
+		if (distance < -radius) return OUTSIDE_PLANE;
+		return INTERSECTS_PLANE;
+	}
+
+
+	Intersect::PlaneResult Intersect::test(const Plane& plane, const Triangle& triangle)
+	{
+		const float distance_a = plane.distance(triangle.point_a);
+		const float distance_b = plane.distance(triangle.point_b);
+		const float distance_c = plane.distance(triangle.point_c);
+		if (distance_a >= 0.0f && distance_b >= 0.0f && distance_c >= 0.0f) return INSIDE_PLANE;
+		if (distance_a < -0.0f && distance_b < -0.0f && distance_c < -0.0f) return OUTSIDE_PLANE;
+		return INTERSECTS_PLANE;
+	}
+
+	Intersect::PlaneResult Intersect::test(const Plane& plane, const Capsule& capsule)
+	{
+		const float start = plane.distance(capsule.segment().start_point);
+		const float end = plane.distance(capsule.segment().end_point);
+		const float radius = capsule.radius();
+		if (std::min(start, end) > radius) return INSIDE_PLANE;
+		if (std::max(start, end) < -radius) return OUTSIDE_PLANE;
+		return INTERSECTS_PLANE;
+	}
+
 } // namespace Math
@@ -10,6 +10,12 @@ namespace Math
 	class Plane;
 	class BoundingSphere;
 	class BoundingBox;
+	class OrientedBox;
+	class Triangle;
+	class Capsule;
+
+	template <class Type> struct SoaBlock;
+	template <class Type> class SoaView;
 
 	namespace Intersect
 	{
@@ -54,15 +60,79 @@ namespace Math
 			}
 		};
 
+		// A LinearResult that also has the barycentric coordinates of the hit point on the triangle, see Triangle::point_at
+		class TriangleResult : public LinearResult
+		{
+		private:
+			float mU;
+			float mV;
+
+		public:
+			TriangleResult() : mU(0.0f), mV(0.0f)
+			{
+			}
+
+			TriangleResult(float distance, float u, float v) : LinearResult(distance), mU(u), mV(v)
+			{
+			}
+
+			TriangleResult(const TriangleResult& result) : LinearResult(result), mU(result.mU), mV(result.mV)
+			{
+			}
+
+			TriangleResult& operator = (const TriangleResult& result)
+			{
+				LinearResult::operator = (result);
+				mU = result.mU;
+				mV = result.mV;
+				return *this;
+			}
+
+			float u() const
+			{
+				return mU;
+			}
+
+			float v() const
+			{
+				return mV;
+			}
+		};
+
+		// Results for the four triangles of a SoaBlock, lane i of each vector belongs to triangle i
+		struct TriangleBlockResult
+		{
+			XMVECTOR intersect; // All bits set in the lanes of the triangles that were hit
+			XMVECTOR distance;
+			XMVECTOR u;
+			XMVECTOR v;
+		};
+
 		// Result is: (Intersects, Distance from Origin)
 		LinearResult test(const Ray& ray, const Plane& plane);
 		LinearResult test(const Ray& ray, const BoundingSphere& sphere);
 		LinearResult test(const Ray& ray, const BoundingBox& box);
+		LinearResult test(const Ray& ray, const OrientedBox& box);
+		LinearResult test(const Ray& ray, const Capsule& capsule);
+		TriangleResult test(const Ray& ray, const Triangle& triangle);
+		TriangleBlockResult test(const Ray& ray, const SoaBlock<Triangle>& triangles);
 
 		// Result is: (Intersects, Distance along Line [0, 1])
 		LinearResult test(const Line& line, const Plane& plane);
 		LinearResult test(const Line& line, const BoundingSphere& sphere);
 		LinearResult test(const Line& line, const BoundingBox& box);
+		LinearResult test(const Line& line, const OrientedBox& box);
+		LinearResult test(const Line& line, const Capsule& capsule);
+		TriangleResult test(const Line& line, const Triangle& triangle);
+		TriangleBlockResult test(const Line& line, const SoaBlock<Triangle>& triangles);
+
+		// Closest hit amongst all the triangles, the index of the triangle hit is written to hit_index when there is one
+		TriangleResult test(const Ray& ray, const SoaView<Triangle>& triangles, size_t* hit_index);
+		TriangleResult test(const Line& line, const SoaView<Triangle>& triangles, size_t* hit_index);
+
+		// Closest hit amongst all the capsules, the index of the capsule hit is written to hit_index when there is one
+		LinearResult test(const Ray& ray, const SoaView<Capsule>& capsules, size_t* hit_index);
+		LinearResult test(const Line& line, const SoaView<Capsule>& capsules, size_t* hit_index);
 
 
 		// Result is:
@@ -84,6 +154,26 @@ namespace Math
 		VolumeResult test(const BoundingSphere& sphereA, const BoundingBox& boxB);
 		VolumeResult test(const BoundingBox& boxA, const BoundingSphere& sphereB);
 		VolumeResult test(const BoundingBox& boxA, const BoundingBox& boxB);
+		VolumeResult test(const OrientedBox& boxA, const OrientedBox& boxB);
+		VolumeResult test(const OrientedBox& boxA, const BoundingBox& boxB);
+		VolumeResult test(const BoundingBox& boxA, const OrientedBox& boxB);
+		VolumeResult test(const BoundingSphere& sphereA, const OrientedBox& boxB);
+		VolumeResult test(const OrientedBox& boxA, const BoundingSphere& sphereB);
+		VolumeResult test(const Capsule& capsuleA, const Capsule& capsuleB);
+		VolumeResult test(const Capsule& capsuleA, const BoundingSphere& sphereB);
+		VolumeResult test(const BoundingSphere& sphereA, const Capsule& capsuleB);
+		VolumeResult test(const Capsule& capsuleA, const BoundingBox& boxB);
+		VolumeResult test(const BoundingBox& boxA, const Capsule& capsuleB);
+
+		// A triangle has no volume so it never contains the other shape
+		VolumeResult test(const BoundingBox& boxA, const Triangle& triangleB);
+		VolumeResult test(const OrientedBox& boxA, const Triangle& triangleB);
+		VolumeResult test(const BoundingSphere& sphereA, const Triangle& triangleB);
+
+		// One to many, results is given the result against each element of the view, such as an agent against the
+		// rest of a crowd
+		void test(const Capsule& capsuleA, const SoaView<Capsule>& capsulesB, VolumeResult* results);
+		void test(const Capsule& capsuleA, const SoaView<BoundingSphere>& spheresB, VolumeResult* results);
 
 
 		// Result is: 
@@ -100,6 +190,9 @@ namespace Math
 		PlaneResult test(const Plane& plane, const Vector3& point);
 		PlaneResult test(const Plane& plane, const BoundingSphere& sphere);
 		PlaneResult test(const Plane& plane, const BoundingBox& box);
+		PlaneResult test(const Plane& plane, const OrientedBox& box);
+		PlaneResult test(const Plane& plane, const Triangle& triangle);
+		PlaneResult test(const Plane& plane, const Capsule& capsule);
 
 	} // namespace Intersect
 
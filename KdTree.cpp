@@ -0,0 +1,407 @@
+#include "Precompiled.hpp"
+#include "KdTree.hpp"
+#include "Vector3.hpp"
+#include "SoaVector3.hpp"
+
+#include <future>
+#include <numeric>
+#include <thread>
+
+namespace
+{
+	typedef Math::SoaTraits<Math::Vector3> Traits;
+	typedef Math::KdTree::Node Node;
+
+	const uint_t LEAF = Math::KdTree::LEAF;
+	const uint_t LEAF_SIZE = Math::KdTree::LEAF_SIZE;
+	const uint_t NO_OBJECT = Math::KdTree::NO_OBJECT;
+
+	// Fewer query points than this are not worth starting a thread for
+	const size_t MINIMUM_QUERIES_PER_THREAD = 1024;
+
+	// Each interior node halves its points and pushes at most one node, so even 2^32 points need fewer than this
+	const uint_t MAX_STACK_SIZE = 64;
+
+	uint_t thread_total(uint_t thread_count)
+	{
+		return (thread_count == 0) ? std::max(std::thread::hardware_concurrency(), 1u) : thread_count;
+	}
+
+	// Splits count queries into one range per thread
+	size_t range_size(size_t count, uint_t thread_count)
+	{
+		const size_t useful_threads = std::max<size_t>(count / MINIMUM_QUERIES_PER_THREAD, 1);
+		const size_t threads = std::min<size_t>(::thread_total(thread_count), useful_threads);
+		return std::max<size_t>((count + threads - 1) / threads, 1);
+	}
+
+	// Calls function(index, first, last) for each range of [0, count), concurrently when there is more than one
+	template <class Function>
+	void for_each_range(size_t count, size_t range, Function function)
+	{
+		std::vector<std::future<void>> results;
+		for (size_t first = range; first < count; first += range)
+		{
+			results.push_back(std::async(std::launch::async, function, first / range, first, std::min(first + range, count)));
+		}
+
+		// This thread does the first range while waiting for the others
+		function(0, 0, std::min(range, count));
+		for (auto& result : results)
+		{
+			result.get();
+		}
+	}
+
+	float coordinate(const Math::Vector3& point, uint_t axis)
+	{
+		return (axis == 0) ? point.x : (axis == 1) ? point.y : point.z;
+	}
+
+	// Adds the node for objects [first, last) and the nodes below it, depth first
+	void build_node(const float* const* coordinates, uint_t* objects, size_t first, size_t last, std::vector<Node>& nodes)
+	{
+		const size_t node_index = nodes.size();
+		nodes.push_back(Node());
+
+		const size_t count = last - first;
+		if (count <= LEAF_SIZE)
+		{
+			const Node leaf = { 0.0f, LEAF, static_cast<uint_t>(first), static_cast<uint_t>(count) };
+			nodes[node_index] = leaf;
+			return;
+		}
+
+		uint_t axis = 0;
+		float widest = -1.0f;
+		for (uint_t a = 0; a < 3; ++a)
+		{
+			const float* values = coordinates[a];
+			float minimum = FLT_MAX;
+			float maximum = -FLT_MAX;
+			for (size_t i = first; i < last; ++i)
+			{
+				minimum = std::min(minimum, values[objects[i]]);
+				maximum = std::max(maximum, values[objects[i]]);
+			}
+			if (maximum - minimum > widest)
+			{
+				widest = maximum - minimum;
+				axis = a;
+			}
+		}
+
+		// The first child is rounded down to whole blocks so that every leaf starts on one
+		const size_t middle = first + ((count / 2) & ~static_cast<size_t>(Math::SOA_LANE_COUNT - 1));
+		const float* values = coordinates[axis];
+		std::nth_element(objects + first, objects + middle, objects + last, [values](uint_t a, uint_t b)
+		{
+			return values[a] < values[b];
+		});
+
+		// Taken before the children reorder their points
+		const float split = values[objects[middle]];
+
+		build_node(coordinates, objects, first, middle, nodes);
+		const uint_t second = static_cast<uint_t>(nodes.size());
+		build_node(coordinates, objects, middle, last, nodes);
+
+		const Node interior = { split, axis, second, 0 };
+		nodes[node_index] = interior;
+	}
+
+	// The k nearest points found so far, sorted nearest first
+	class NearestPoints
+	{
+	private:
+		uint_t* mObjects;
+		float* mDistances;
+		uint_t mCapacity;
+		uint_t mCount;
+		float mMaximum;
+
+	public:
+		NearestPoints(uint_t* objects, float* distances_squared, uint_t k, float max_distance_squared) :
+			mObjects(objects),
+			mDistances(distances_squared),
+			mCapacity(k),
+			mCount(0),
+			mMaximum(max_distance_squared)
+		{
+		}
+
+		uint_t count() const
+		{
+			return mCount;
+		}
+
+		// Points further than this are not wanted
+		float limit() const
+		{
+			return (mCount < mCapacity) ? mMaximum : mDistances[mCapacity - 1];
+		}
+
+		void add(uint_t object, float distance_squared)
+		{
+			if (mCount == mCapacity && distance_squared >= mDistances[mCapacity - 1]) return;
+
+			uint_t position = (mCount < mCapacity) ? mCount++ : mCapacity - 1;
+			for (; position > 0 && mDistances[position - 1] > distance_squared; --position)
+			{
+				mObjects[position] = mObjects[position - 1];
+				mDistances[position] = mDistances[position - 1];
+			}
+			mObjects[position] = object;
+			mDistances[position] = distance_squared;
+		}
+	};
+
+	// Every point within a distance
+	class PointsInRadius
+	{
+	private:
+		std::vector<uint_t>& mObjects;
+		float mRadiusSquared;
+
+		PointsInRadius& operator = (const PointsInRadius&);
+
+	public:
+		PointsInRadius(std::vector<uint_t>& objects, float radius) : mObjects(objects), mRadiusSquared(radius * radius)
+		{
+		}
+
+		float limit() const
+		{
+			return mRadiusSquared;
+		}
+
+		void add(uint_t object, float)
+		{
+			mObjects.push_back(object);
+		}
+	};
+
+	// Visits the nodes nearest side first, skipping those further than the results' limit, and gives the results
+	// every point of the leaves visited within the limit
+	template <class Results>
+	void search(const std::vector<Node>& nodes, const Math::SoaArray<Math::Vector3>& points, const uint_t* objects, const Math::Vector3& point, Results& results)
+	{
+		struct Entry
+		{
+			uint_t node;
+			float distance_squared; // No point below the node is nearer than this
+		};
+
+		Entry stack[MAX_STACK_SIZE];
+		uint_t stack_size = 0;
+
+		const Math::SoaVector3 query = Math::soa_splat(point);
+		uint_t node_index = 0;
+		float distance_squared = 0.0f;
+
+		for (;;)
+		{
+			if (distance_squared <= results.limit())
+			{
+				const Node& node = nodes[node_index];
+				if (node.axis != LEAF)
+				{
+					const float offset = ::coordinate(point, node.axis) - node.split;
+					const uint_t near_child = (offset <= 0.0f) ? node_index + 1 : node.first;
+					const uint_t far_child = (offset <= 0.0f) ? node.first : node_index + 1;
+
+					XMASSERT(stack_size < MAX_STACK_SIZE);
+					const Entry far_entry = { far_child, std::max(distance_squared, offset * offset) };
+					stack[stack_size++] = far_entry;
+
+					node_index = near_child;
+					continue;
+				}
+
+				const size_t end = node.first + node.count;
+				for (size_t block = node.first / Math::SOA_LANE_COUNT; block * Math::SOA_LANE_COUNT < end; ++block)
+				{
+					const Math::SoaVector3 position = Math::soa_vector3(points.load(Traits::X, block), points.load(Traits::Y, block), points.load(Traits::Z, block));
+					XMVECTORF32 distances;
+					distances.v = Math::soa_length_squared(Math::soa_subtract(position, query));
+
+					XMVECTORU32 within;
+					within.v = XMVectorLessOrEqual(distances.v, XMVectorReplicate(results.limit()));
+					if (!XMVector4NotEqualInt(within.v, XMVectorFalseInt())) continue;
+
+					const size_t first_point = block * Math::SOA_LANE_COUNT;
+					const uint_t lane_count = static_cast<uint_t>(std::min<size_t>(Math::SOA_LANE_COUNT, end - first_point));
+					for (uint_t lane = 0; lane < lane_count; ++lane)
+					{
+						if (within.u[lane]) results.add(objects[first_point + lane], distances.f[lane]);
+					}
+				}
+			}
+
+			if (stack_size == 0) break;
+			--stack_size;
+			node_index = stack[stack_size].node;
+			distance_squared = stack[stack_size].distance_squared;
+		}
+	}
+}
+
+namespace Math
+{
+
+	KdTree::KdTree(const ArrayView<Vector3>& points)
+	{
+		build(points);
+	}
+
+	KdTree::KdTree(const SoaView<Vector3>& points)
+	{
+		build(points);
+	}
+
+	//--------------------------------------------------------------------------
+	// Building
+	//
+
+	void KdTree::build(const ArrayView<Vector3>& points)
+	{
+		std::vector<float> x(points.size());
+		std::vector<float> y(points.size());
+		std::vector<float> z(points.size());
+		for (size_t i = 0; i < points.size(); ++i)
+		{
+			x[i] = points[i].x;
+			y[i] = points[i].y;
+			z[i] = points[i].z;
+		}
+
+		const float* coordinates[3] = { x.data(), y.data(), z.data() };
+		build_tree(coordinates, points.size());
+	}
+
+	void KdTree::build(const SoaView<Vector3>& points)
+	{
+		const float* coordinates[3] = { points.component(::Traits::X), points.component(::Traits::Y), points.component(::Traits::Z) };
+		build_tree(coordinates, points.size());
+	}
+
+	void KdTree::build_tree(const float* const* coordinates, size_t count)
+	{
+		mNodes.clear();
+		mObjects.resize(count);
+		mPoints.clear();
+		if (count == 0) return;
+
+		std::iota(mObjects.begin(), mObjects.end(), 0u);
+		mNodes.reserve(2 * ((count + LEAF_SIZE / 2 - 1) / (LEAF_SIZE / 2)));
+		::build_node(coordinates, mObjects.data(), 0, count, mNodes);
+
+		mPoints.resize(count);
+		for (uint_t c = 0; c < 3; ++c)
+		{
+			float* component = mPoints.component(c);
+			for (size_t i = 0; i < count; ++i)
+			{
+				component[i] = coordinates[c][mObjects[i]];
+			}
+		}
+		mPoints.pad_last_block();
+	}
+
+	//--------------------------------------------------------------------------
+	// Queries
+	//
+
+	uint_t KdTree::nearest(const Vector3& point, float* distance_squared) const
+	{
+		uint_t object = NO_OBJECT;
+		float distance = FLT_MAX;
+		nearest(point, 1, &object, &distance);
+		if (distance_squared) *distance_squared = distance;
+		return object;
+	}
+
+	uint_t KdTree::nearest(const Vector3& point, uint_t k, uint_t* objects, float* distances_squared, float max_distance) const
+	{
+		if (is_empty() || k == 0) return 0;
+
+		std::vector<float> distances;
+		if (!distances_squared)
+		{
+			distances.resize(k);
+			distances_squared = distances.data();
+		}
+
+		::NearestPoints results(objects, distances_squared, k, (max_distance < FLT_MAX) ? max_distance * max_distance : FLT_MAX);
+		::search(mNodes, mPoints, mObjects.data(), point, results);
+		return results.count();
+	}
+
+	void KdTree::query(const Vector3& point, float radius, std::vector<uint_t>& objects) const
+	{
+		if (is_empty()) return;
+
+		::PointsInRadius results(objects, radius);
+		::search(mNodes, mPoints, mObjects.data(), point, results);
+	}
+
+	//--------------------------------------------------------------------------
+	// Batched queries
+	//
+
+	void KdTree::nearest(const ArrayView<Vector3>& points, uint_t k, uint_t* objects, float* distances_squared, float max_distance, uint_t thread_count) const
+	{
+		if (k == 0) return;
+
+		::for_each_range(points.size(), ::range_size(points.size(), thread_count), [&](size_t, size_t first, size_t last)
+		{
+			std::vector<float> distances;
+			if (!distances_squared) distances.resize(k);
+
+			for (size_t i = first; i < last; ++i)
+			{
+				uint_t* point_objects = objects + i * k;
+				float* point_distances = distances_squared ? distances_squared + i * k : distances.data();
+				const uint_t found = nearest(points[i], k, point_objects, point_distances, max_distance);
+				std::fill(point_objects + found, point_objects + k, ::NO_OBJECT);
+				std::fill(point_distances + found, point_distances + k, FLT_MAX);
+			}
+		});
+	}
+
+	void KdTree::query(const ArrayView<Vector3>& points, float radius, std::vector<uint_t>& objects, std::vector<size_t>& offsets, uint_t thread_count) const
+	{
+		// No ranges to find into, but for_each_range still calls the first one
+		if (points.size() == 0)
+		{
+			offsets.assign(1, objects.size());
+			return;
+		}
+
+		// Each range finds its points into a list of its own with offsets from its start, then the lists are joined
+		const size_t range = ::range_size(points.size(), thread_count);
+		std::vector<std::vector<uint_t>> range_objects((points.size() + range - 1) / range);
+		offsets.resize(points.size() + 1);
+		::for_each_range(points.size(), range, [&](size_t index, size_t first, size_t last)
+		{
+			std::vector<uint_t>& found = range_objects[index];
+			for (size_t i = first; i < last; ++i)
+			{
+				query(points[i], radius, found);
+				offsets[i + 1] = found.size();
+			}
+		});
+
+		offsets[0] = objects.size();
+		for (size_t index = 0; index < range_objects.size(); ++index)
+		{
+			const size_t base = objects.size();
+			objects.insert(objects.end(), range_objects[index].begin(), range_objects[index].end());
+			for (size_t i = index * range; i < std::min((index + 1) * range, points.size()); ++i)
+			{
+				offsets[i + 1] += base;
+			}
+		}
+	}
+
+} // namespace Math
@@ -0,0 +1,141 @@
+#pragma once
+#ifndef __MATHS_KDTREE_HPP__
+#define __MATHS_KDTREE_HPP__
+
+#include "ArrayView.hpp"
+#include "SoaArray.hpp"
+
+#include <vector>
+
+namespace Math
+{
+	class Vector3;
+
+	// k-d tree over an array of points, such as the positions of agents or sound sources, for finding the
+	// points nearest to another point or within a distance of it.
+	//
+	// Each interior node splits its points in half across the widest axis of their bounds, down to leaves of
+	// at most LEAF_SIZE points. The points are stored in tree order as an SoaArray, every leaf starting on a
+	// block, so a leaf is scanned four points at a time.
+	//
+	// The queries give the index of each point in the array the tree was built from, and distances are
+	// squared as from Vector3::length_squared.
+	class KdTree
+	{
+	public:
+		static const uint_t LEAF_SIZE = 4 * SOA_LANE_COUNT;
+		static const uint_t NO_OBJECT = 0xFFFFFFFF;
+
+		struct Node
+		{
+			float split; // Interior: the points in the first child are no further along the axis than this
+			uint_t axis; // Interior: 0, 1 or 2 for x, y or z, Leaf: LEAF
+			uint_t first; // Interior: the second child (the first follows the node), Leaf: the first point
+			uint_t count; // Leaf: the number of points
+		};
+
+		static const uint_t LEAF = 0xFFFFFFFF;
+
+	private:
+		std::vector<Node> mNodes; // Depth first, the root first
+		SoaArray<Vector3> mPoints; // The points in tree order
+		std::vector<uint_t> mObjects; // The index of each point in tree order
+
+	public:
+		//--------------------------------------------------------------------------
+		// Constructors
+		//
+
+		KdTree()
+		{
+		}
+
+		explicit KdTree(const ArrayView<Vector3>& points);
+		explicit KdTree(const SoaView<Vector3>& points);
+
+		KdTree(const KdTree& tree) : mNodes(tree.mNodes), mPoints(tree.mPoints), mObjects(tree.mObjects)
+		{
+		}
+
+		//--------------------------------------------------------------------------
+		// Assignment
+		//
+
+		KdTree& operator = (const KdTree& tree)
+		{
+			mNodes = tree.mNodes;
+			mPoints = tree.mPoints;
+			mObjects = tree.mObjects;
+			return *this;
+		}
+
+		//--------------------------------------------------------------------------
+		// Accessors
+		//
+
+		bool is_empty() const
+		{
+			return mObjects.empty();
+		}
+
+		size_t object_count() const
+		{
+			return mObjects.size();
+		}
+
+		size_t node_count() const
+		{
+			return mNodes.size();
+		}
+
+		const Node* nodes() const
+		{
+			return mNodes.data();
+		}
+
+		//--------------------------------------------------------------------------
+		// Building
+		//
+
+		// Replaces the tree with one over the points
+		void build(const ArrayView<Vector3>& points);
+		void build(const SoaView<Vector3>& points);
+
+		//--------------------------------------------------------------------------
+		// Queries
+		//
+
+		// The nearest point, or NO_OBJECT when the tree is empty
+		uint_t nearest(const Vector3& point, float* distance_squared = nullptr) const;
+
+		// The k nearest points no further than max_distance, nearest first, written to objects and
+		// distances_squared (when not null), which must both have room for k. Returns how many were found,
+		// fewer than k when there are not enough points close enough. Each point found costs an insertion into
+		// the sorted results, so this is meant for small k.
+		uint_t nearest(const Vector3& point, uint_t k, uint_t* objects, float* distances_squared = nullptr, float max_distance = FLT_MAX) const;
+
+		// Appends the points within radius of the point to objects, in no particular order
+		void query(const Vector3& point, float radius, std::vector<uint_t>& objects) const;
+
+		//--------------------------------------------------------------------------
+		// Batched queries
+		//
+		// A query for every point, the points split between threads. A thread_count of 0 uses all hardware
+		// threads, few points are done on the calling thread.
+		//
+
+		// The k nearest of every point, as for nearest, in k entries per point of objects and distances_squared
+		// (when not null). The entries past the points found are NO_OBJECT and FLT_MAX.
+		void nearest(const ArrayView<Vector3>& points, uint_t k, uint_t* objects, float* distances_squared = nullptr, float max_distance = FLT_MAX, uint_t thread_count = 1) const;
+
+		// Appends the points within radius of every point to objects, those for point i from objects[offsets[i]]
+		// up to objects[offsets[i + 1]], offsets having an entry more than there are points
+		void query(const ArrayView<Vector3>& points, float radius, std::vector<uint_t>& objects, std::vector<size_t>& offsets, uint_t thread_count = 1) const;
+
+	private:
+		void build_tree(const float* const* coordinates, size_t count);
+	};
+
+} // namespace Math
+
+#endif // __MATHS_KDTREE_HPP__
@@ -21,7 +21,7 @@ namespace Math
 	Vector3 Line::mid_point() const
 	{
 		static const float HALF = 0.5f;
-		return Vector3(XMVectorMultiply(XMVectorSubtract(end_point, start_point), XMVectorReplicate(HALF)));
+		return Vector3(XMVectorMultiply(XMVectorAdd(start_point, end_point), XMVectorReplicate(HALF)));
 	}
 
 	void Line::extend(float start_amount, float end_amount)
@@ -6,6 +6,7 @@
 
 namespace Math
 {
+	template <class Type> struct SoaTraits;
 
 	class Line
 	{
@@ -63,6 +64,37 @@ namespace Math
 		void extend(float start_amount, float end_amount);
 	};
 
+	// Component layout of an SoaArray<Line>
+	template <> struct SoaTraits<Line>
+	{
+		enum Component : uint_t
+		{
+			START_X,
+			START_Y,
+			START_Z,
+			END_X,
+			END_Y,
+			END_Z,
+
+			COMPONENT_COUNT
+		};
+
+		static void scatter(const Line& line, float* components)
+		{
+			components[START_X] = line.start_point.x;
+			components[START_Y] = line.start_point.y;
+			components[START_Z] = line.start_point.z;
+			components[END_X] = line.end_point.x;
+			components[END_Y] = line.end_point.y;
+			components[END_Z] = line.end_point.z;
+		}
+
+		static Line gather(const float* components)
+		{
+			return Line(Vector3(components[START_X], components[START_Y], components[START_Z]), Vector3(components[END_X], components[END_Y], components[END_Z]));
+		}
+	};
+
 } // namespace Math
 
 #endif // __MATHS_LINE_HPP__
@@ -0,0 +1,152 @@
+#include "Precompiled.hpp"
+#include "Lod.hpp"
+#include "Matrix.hpp"
+#include "BoundingSphere.hpp"
+#include "Frustum.hpp"
+#include "SoaArray.hpp"
+#include "SoaVector3.hpp"
+
+namespace
+{
+	// Screen radius from the squared distance to the sphere's center and its radius, as f * r / sqrt(d^2 - r^2)
+	// which is the tangent of the angle the sphere covers scaled to pixels
+	float screen_radius(float distance_squared, float radius, float pixel_scale)
+	{
+		const float tangent_squared = distance_squared - radius * radius;
+		if (tangent_squared <= 0.0f) return FLT_MAX;
+		return pixel_scale * radius / std::sqrt(tangent_squared);
+	}
+
+	// The shared pass of both batched selects, without any frustum when it is null
+	void select_blocks(const Math::SoaView<Math::BoundingSphere>& spheres, const Math::Matrix& view, const Math::Lod::ScreenProjection& projection,
+		const Math::Frustum* frustum, const Math::ArrayView<float>& thresholds, uint_t* lods, float* screen_radii)
+	{
+		typedef Math::SoaTraits<Math::BoundingSphere> Traits;
+
+		// Only the distance from the eye is needed, so only the view space position is worked out
+		XMVECTOR m[4][3];
+		for (uint_t row = 0; row < 4; ++row)
+		{
+			for (uint_t column = 0; column < 3; ++column)
+			{
+				m[row][column] = XMVectorReplicate(view(row, column));
+			}
+		}
+
+		XMVECTOR planes[Math::Frustum::FRUSTUM_PLANE_COUNT][4];
+		if (frustum)
+		{
+			for (uint_t plane = 0; plane < Math::Frustum::FRUSTUM_PLANE_COUNT; ++plane)
+			{
+				const Math::Plane& p = frustum->get_plane(static_cast<Math::Frustum::FrustumPlane>(plane));
+				planes[plane][0] = XMVectorReplicate(p.x);
+				planes[plane][1] = XMVectorReplicate(p.y);
+				planes[plane][2] = XMVectorReplicate(p.z);
+				planes[plane][3] = XMVectorReplicate(p.w);
+			}
+		}
+
+		const XMVECTOR zero = XMVectorZero();
+		const XMVECTOR one = XMVectorSplatOne();
+		const XMVECTOR pixel_scale = XMVectorReplicate(projection.pixel_scale());
+		const XMVECTOR infinite = XMVectorReplicate(FLT_MAX);
+
+		for (size_t block = 0; block < spheres.block_count(); ++block)
+		{
+			const Math::SoaBlock<Math::BoundingSphere> sphere = spheres.load_block(block);
+			const XMVECTOR radius = sphere[Traits::RADIUS];
+
+			XMVECTOR position[3];
+			for (uint_t column = 0; column < 3; ++column)
+			{
+				position[column] = XMVectorMultiplyAdd(sphere[Traits::CENTER_X], m[0][column], m[3][column]);
+				position[column] = XMVectorMultiplyAdd(sphere[Traits::CENTER_Y], m[1][column], position[column]);
+				position[column] = XMVectorMultiplyAdd(sphere[Traits::CENTER_Z], m[2][column], position[column]);
+			}
+
+			const Math::SoaVector3 offset = Math::soa_vector3(position[0], position[1], position[2]);
+			const XMVECTOR tangent_squared = XMVectorSubtract(Math::soa_length_squared(offset), XMVectorMultiply(radius, radius));
+			const XMVECTOR around_eye = XMVectorLessOrEqual(tangent_squared, zero);
+			XMVECTOR projected = XMVectorMultiply(XMVectorMultiply(pixel_scale, radius), XMVectorReciprocalSqrt(tangent_squared));
+			projected = XMVectorSelect(projected, infinite, around_eye);
+
+			// Counting the thresholds the radius is below gives the LOD when they are in decreasing order
+			XMVECTOR lod = zero;
+			for (float threshold : thresholds)
+			{
+				lod = XMVectorAdd(lod, XMVectorAndInt(one, XMVectorLess(projected, XMVectorReplicate(threshold))));
+			}
+
+			XMVECTOR culled = XMVectorFalseInt();
+			if (frustum)
+			{
+				const XMVECTOR negative_radius = XMVectorNegate(radius);
+				for (uint_t plane = 0; plane < Math::Frustum::FRUSTUM_PLANE_COUNT; ++plane)
+				{
+					XMVECTOR distance = XMVectorMultiplyAdd(sphere[Traits::CENTER_X], planes[plane][0], planes[plane][3]);
+					distance = XMVectorMultiplyAdd(sphere[Traits::CENTER_Y], planes[plane][1], distance);
+					distance = XMVectorMultiplyAdd(sphere[Traits::CENTER_Z], planes[plane][2], distance);
+					culled = XMVectorOrInt(culled, XMVectorLess(distance, negative_radius));
+				}
+				projected = XMVectorSelect(projected, zero, culled);
+			}
+
+			XMVECTORF32 lod_lanes;
+			XMVECTORU32 culled_lanes;
+			XMVECTORF32 radius_lanes;
+			lod_lanes.v = lod;
+			culled_lanes.v = culled;
+			radius_lanes.v = projected;
+
+			const size_t first = block * Math::SOA_LANE_COUNT;
+			const uint_t lane_count = spheres.lane_count(block);
+			for (uint_t lane = 0; lane < lane_count; ++lane)
+			{
+				lods[first + lane] = culled_lanes.u[lane] ? Math::Lod::CULLED : static_cast<uint_t>(lod_lanes.f[lane]);
+			}
+			if (screen_radii)
+			{
+				std::copy(radius_lanes.f, radius_lanes.f + lane_count, screen_radii + first);
+			}
+		}
+	}
+}
+
+namespace Math
+{
+
+	float Lod::screen_radius(const BoundingSphere& sphere, const Matrix& view, const ScreenProjection& projection)
+	{
+		const float distance_squared = XMVectorGetX(XMVector3LengthSq(XMVector3Transform(sphere.center(), view)));
+		return ::screen_radius(distance_squared, sphere.radius(), projection.pixel_scale());
+	}
+
+	float Lod::screen_area(const BoundingSphere& sphere, const Matrix& view, const ScreenProjection& projection)
+	{
+		const float radius = screen_radius(sphere, view, projection);
+		return (radius == FLT_MAX) ? FLT_MAX : XM_PI * radius * radius;
+	}
+
+	uint_t Lod::select(float screen_radius, const ArrayView<float>& thresholds)
+	{
+		uint_t lod = 0;
+		for (float threshold : thresholds)
+		{
+			if (screen_radius < threshold) ++lod;
+		}
+		return lod;
+	}
+
+	void Lod::select(const SoaView<BoundingSphere>& spheres, const Matrix& view, const ScreenProjection& projection,
+		const ArrayView<float>& thresholds, uint_t* lods, float* screen_radii)
+	{
+		::select_blocks(spheres, view, projection, nullptr, thresholds, lods, screen_radii);
+	}
+
+	void Lod::select(const SoaView<BoundingSphere>& spheres, const Matrix& view, const ScreenProjection& projection, const Frustum& frustum,
+		const ArrayView<float>& thresholds, uint_t* lods, float* screen_radii)
+	{
+		::select_blocks(spheres, view, projection, &frustum, thresholds, lods, screen_radii);
+	}
+
+} // namespace Math
@@ -0,0 +1,78 @@
+#pragma once
+#ifndef __MATHS_LOD_HPP__
+#define __MATHS_LOD_HPP__
+
+#include "ArrayView.hpp"
+
+namespace Math
+{
+	class Matrix;
+	class BoundingSphere;
+	class Frustum;
+
+	template <class Type> class SoaView;
+
+	namespace Lod
+	{
+		// Given to spheres outside the frustum by the culling select
+		static const uint_t CULLED = 0xFFFFFFFF;
+
+		// Turns sizes in view space into pixels, from the vertical field of view given to Matrix::perspective_fov
+		// and the height of the screen in pixels
+		class ScreenProjection
+		{
+		private:
+			float mPixelScale; // Pixels covered by one unit of size one unit away
+
+		public:
+			ScreenProjection() : mPixelScale(1.0f)
+			{
+			}
+
+			ScreenProjection(float fov, float screen_height) : mPixelScale(0.5f * screen_height / std::tan(0.5f * fov))
+			{
+			}
+
+			ScreenProjection(const ScreenProjection& projection) : mPixelScale(projection.mPixelScale)
+			{
+			}
+
+			ScreenProjection& operator = (const ScreenProjection& projection)
+			{
+				mPixelScale = projection.mPixelScale;
+				return *this;
+			}
+
+			float pixel_scale() const
+			{
+				return mPixelScale;
+			}
+		};
+
+		// Radius in pixels of the sphere's outline when it is in the middle of the screen, found from the angle it
+		// covers seen from the eye. Off center the outline stretches into a slightly larger ellipse, which is
+		// ignored for choosing detail. A sphere around the eye covers the whole screen and is given FLT_MAX.
+		float screen_radius(const BoundingSphere& sphere, const Matrix& view, const ScreenProjection& projection);
+
+		// Area in pixels of the circle with the screen radius
+		float screen_area(const BoundingSphere& sphere, const Matrix& view, const ScreenProjection& projection);
+
+		// The thresholds are screen radii in decreasing order, and LOD i is used while the radius is at least
+		// thresholds[i]. Smaller than every threshold gives thresholds.size(), for objects too small to draw.
+		uint_t select(float screen_radius, const ArrayView<float>& thresholds);
+
+
+		// The LOD of every sphere in one pass, with screen_radii given each sphere's radius when it is not null
+		void select(const SoaView<BoundingSphere>& spheres, const Matrix& view, const ScreenProjection& projection,
+			const ArrayView<float>& thresholds, uint_t* lods, float* screen_radii = nullptr);
+
+		// As above with each sphere tested against the frustum's planes in the same pass, so the spheres are only
+		// read once. Spheres outside the frustum are given CULLED and a screen radius of zero.
+		void select(const SoaView<BoundingSphere>& spheres, const Matrix& view, const ScreenProjection& projection, const Frustum& frustum,
+			const ArrayView<float>& thresholds, uint_t* lods, float* screen_radii = nullptr);
+
+	} // namespace Lod
+
+} // namespace Math
+
+#endif // __MATHS_LOD_HPP__
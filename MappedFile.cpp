@@ -0,0 +1,97 @@
+#include "Precompiled.hpp"
+#include "MappedFile.hpp"
+
+namespace Math
+{
+	MappedFile::MappedFile() :
+		mFile(INVALID_HANDLE_VALUE),
+		mMapping(nullptr),
+		mData(nullptr),
+		mSize(0)
+	{
+	}
+
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
+
+	MappedFile::MappedFile(MappedFile&& file) :
+		mFile(file.mFile),
+		mMapping(file.mMapping),
+		mData(file.mData),
+		mSize(file.mSize)
+	{
+		file.mFile = INVALID_HANDLE_VALUE;
+		file.mMapping = nullptr;
+		file.mData = nullptr;
+		file.mSize = 0;
+	}
+
+	MappedFile& MappedFile::operator = (MappedFile&& file)
+	{
+		if (this != &file)
+		{
+			close();
+			std::swap(mFile, file.mFile);
+			std::swap(mMapping, file.mMapping);
+			std::swap(mData, file.mData);
+			std::swap(mSize, file.mSize);
+		}
+		return *this;
+	}
+
+	bool MappedFile::open(const wchar_t* path)
+	{
+		close();
+
+		mFile = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+		if (mFile == INVALID_HANDLE_VALUE) return false;
+
+		// Mapping an empty file fails, and a file too large for the address space can't be viewed whole
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(mFile, &size) || size.QuadPart == 0 || static_cast<ULONGLONG>(size.QuadPart) > static_cast<ULONGLONG>(SIZE_MAX))
+		{
+			close();
+			return false;
+		}
+
+		mMapping = CreateFileMappingW(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mMapping == nullptr)
+		{
+			close();
+			return false;
+		}
+
+		mData = MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0);
+		if (mData == nullptr)
+		{
+			close();
+			return false;
+		}
+
+		mSize = static_cast<size_t>(size.QuadPart);
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		if (mData != nullptr)
+		{
+			UnmapViewOfFile(mData);
+			mData = nullptr;
+		}
+		if (mMapping != nullptr)
+		{
+			CloseHandle(mMapping);
+			mMapping = nullptr;
+		}
+		if (mFile != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(mFile);
+			mFile = INVALID_HANDLE_VALUE;
+		}
+		mSize = 0;
+	}
+
+} // namespace Math
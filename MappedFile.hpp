@@ -0,0 +1,53 @@
+#pragma once
+#ifndef __MATHS_MAPPEDFILE_HPP__
+#define __MATHS_MAPPEDFILE_HPP__
+
+namespace Math
+{
+	// Read only view of a whole file mapped into memory. The view starts on an allocation granularity
+	// boundary (64KB) so it is suitably aligned for any of the math types.
+	class MappedFile
+	{
+	private:
+		HANDLE mFile;
+		HANDLE mMapping;
+		const void* mData;
+		size_t mSize;
+
+	public:
+		MappedFile();
+
+		~MappedFile();
+
+		MappedFile(MappedFile&& file);
+
+		MappedFile& operator = (MappedFile&& file);
+
+		// Closes any previously opened file first, returns false if the file can't be opened or mapped or is empty
+		bool open(const wchar_t* path);
+
+		void close();
+
+		bool is_open() const
+		{
+			return mData != nullptr;
+		}
+
+		const void* data() const
+		{
+			return mData;
+		}
+
+		size_t size() const
+		{
+			return mSize;
+		}
+
+	private:
+		MappedFile(const MappedFile&);
+		MappedFile& operator = (const MappedFile&);
+	};
+
+} // namespace Math
+
+#endif // __MATHS_MAPPEDFILE_HPP__
@@ -0,0 +1,647 @@
+#include "Precompiled.hpp"
+#include "MeshBvh.hpp"
+#include "Vector3.hpp"
+#include "Ray.hpp"
+#include "Line.hpp"
+#include "Triangle.hpp"
+
+#include <cstring>
+#include <limits>
+
+namespace
+{
+	typedef Math::MeshBvh::Node Node;
+	typedef Math::MeshBvh::TriangleBlock TriangleBlock;
+
+	// Leaves of one block are never split, larger ones are only kept when the surface area heuristic says so
+	const uint_t LEAF_TRIANGLES = Math::SOA_LANE_COUNT;
+	const uint_t MAX_LEAF_TRIANGLES = 4 * Math::SOA_LANE_COUNT;
+	const uint_t SAH_BIN_COUNT = 12;
+	const float SAH_TRAVERSAL_COST = 1.0f; // Relative to testing one triangle block
+
+	// Limits the depth of the tree so the traversal stack can have a fixed size
+	const uint_t MAX_DEPTH = 64;
+
+	const uint_t BLOB_MAGIC = 0x4856424D; // "MBVH"
+	const uint_t BLOB_VERSION = 1;
+
+	struct BlobHeader
+	{
+		uint_t magic;
+		uint_t version;
+		uint_t node_count;
+		uint_t block_count;
+		uint_t triangle_count;
+		uint_t reserved[3];
+	};
+
+	size_t blob_size(uint_t node_count, uint_t block_count)
+	{
+		return sizeof(BlobHeader) + node_count * sizeof(Node) + block_count * (sizeof(TriangleBlock) + Math::SOA_LANE_COUNT * sizeof(uint_t));
+	}
+
+	uint_t blocks_needed(uint_t triangle_count)
+	{
+		return (triangle_count + Math::SOA_LANE_COUNT - 1) / Math::SOA_LANE_COUNT;
+	}
+
+	// Half the surface area, the scale doesn't matter to the heuristic
+	float half_area(FXMVECTOR minimum, FXMVECTOR maximum)
+	{
+		const XMVECTOR size = XMVectorMax(XMVectorSubtract(maximum, minimum), XMVectorZero());
+		const XMVECTOR products = XMVectorMultiply(size, XMVectorSwizzle(size, 1, 2, 0, 3));
+		return XMVectorGetX(products) + XMVectorGetY(products) + XMVectorGetZ(products);
+	}
+
+	struct BuildTriangle
+	{
+		XMVECTOR minimum;
+		XMVECTOR maximum;
+		XMVECTOR centroid;
+	};
+
+	struct Bin
+	{
+		XMVECTOR minimum;
+		XMVECTOR maximum;
+		uint_t count;
+	};
+
+	// Top down build with a binned surface area heuristic, where the cost of a leaf is the number of
+	// blocks it needs rather than the number of triangles since the blocks are tested as one
+	class Builder
+	{
+	private:
+		const Math::Vector3* mVertices;
+		const uint_t* mIndices;
+		std::vector<BuildTriangle> mTriangles;
+		std::vector<uint_t> mOrder;
+
+		std::vector<Node>& mNodes;
+		std::vector<TriangleBlock>& mBlocks;
+		std::vector<uint_t>& mTriangleIndices;
+
+	public:
+		Builder(const Math::Vector3* vertices, const uint_t* indices, size_t triangle_count,
+			std::vector<Node>& nodes, std::vector<TriangleBlock>& blocks, std::vector<uint_t>& triangle_indices) :
+			mVertices(vertices),
+			mIndices(indices),
+			mTriangles(triangle_count),
+			mOrder(triangle_count),
+			mNodes(nodes),
+			mBlocks(blocks),
+			mTriangleIndices(triangle_indices)
+		{
+			static const float THIRD = 1.0f / 3.0f;
+
+			for (size_t i = 0; i < triangle_count; ++i)
+			{
+				const XMVECTOR a = vertices[indices[i * 3]];
+				const XMVECTOR b = vertices[indices[i * 3 + 1]];
+				const XMVECTOR c = vertices[indices[i * 3 + 2]];
+				mTriangles[i].minimum = XMVectorMin(XMVectorMin(a, b), c);
+				mTriangles[i].maximum = XMVectorMax(XMVectorMax(a, b), c);
+				mTriangles[i].centroid = XMVectorScale(XMVectorAdd(XMVectorAdd(a, b), c), THIRD);
+				mOrder[i] = static_cast<uint_t>(i);
+			}
+		}
+
+		void build()
+		{
+			const uint_t triangle_count = static_cast<uint_t>(mOrder.size());
+			mNodes.reserve(2 * blocks_needed(triangle_count));
+			mBlocks.reserve(blocks_needed(triangle_count) * 2);
+			build_node(0, triangle_count, 0);
+		}
+
+	private:
+		void build_node(uint_t first, uint_t last, uint_t depth)
+		{
+			XMVECTOR minimum = XMVectorSplatInfinity();
+			XMVECTOR maximum = XMVectorNegate(minimum);
+			XMVECTOR centroid_minimum = minimum;
+			XMVECTOR centroid_maximum = maximum;
+			for (uint_t i = first; i < last; ++i)
+			{
+				const BuildTriangle& triangle = mTriangles[mOrder[i]];
+				minimum = XMVectorMin(minimum, triangle.minimum);
+				maximum = XMVectorMax(maximum, triangle.maximum);
+				centroid_minimum = XMVectorMin(centroid_minimum, triangle.centroid);
+				centroid_maximum = XMVectorMax(centroid_maximum, triangle.centroid);
+			}
+
+			const uint_t node_index = static_cast<uint_t>(mNodes.size());
+			mNodes.push_back(Node());
+			XMStoreFloat3(&mNodes[node_index].minimum, minimum);
+			XMStoreFloat3(&mNodes[node_index].maximum, maximum);
+
+			const uint_t count = last - first;
+			const uint_t middle = (count <= LEAF_TRIANGLES || depth + 1 >= MAX_DEPTH) ?
+				first : split(first, last, half_area(minimum, maximum), centroid_minimum, centroid_maximum);
+
+			if (middle == first)
+			{
+				make_leaf(node_index, first, last);
+				return;
+			}
+
+			build_node(first, middle, depth + 1);
+			mNodes[node_index].offset = static_cast<uint_t>(mNodes.size());
+			mNodes[node_index].block_count = 0;
+			build_node(middle, last, depth + 1);
+		}
+
+		// Returns the first triangle of the second child, or first to make a leaf
+		uint_t split(uint_t first, uint_t last, float area, FXMVECTOR centroid_minimum, FXMVECTOR centroid_maximum)
+		{
+			const uint_t count = last - first;
+			const float leaf_cost = area * blocks_needed(count);
+
+			const Math::Vector3 lower(centroid_minimum);
+			const Math::Vector3 extent(XMVectorSubtract(centroid_maximum, centroid_minimum));
+			const float lower_bounds[3] = { lower.x, lower.y, lower.z };
+			const float extents[3] = { extent.x, extent.y, extent.z };
+
+			float best_cost = std::numeric_limits<float>::infinity();
+			uint_t best_axis = 0;
+			uint_t best_bin = 0;
+
+			for (uint_t axis = 0; axis < 3; ++axis)
+			{
+				if (extents[axis] <= 0.0f) continue;
+
+				Bin bins[SAH_BIN_COUNT];
+				for (uint_t b = 0; b < SAH_BIN_COUNT; ++b)
+				{
+					bins[b].minimum = XMVectorSplatInfinity();
+					bins[b].maximum = XMVectorNegate(bins[b].minimum);
+					bins[b].count = 0;
+				}
+
+				const float scale = SAH_BIN_COUNT / extents[axis];
+				for (uint_t i = first; i < last; ++i)
+				{
+					const BuildTriangle& triangle = mTriangles[mOrder[i]];
+					Bin& bin = bins[bin_index(triangle.centroid, axis, lower_bounds[axis], scale)];
+					bin.minimum = XMVectorMin(bin.minimum, triangle.minimum);
+					bin.maximum = XMVectorMax(bin.maximum, triangle.maximum);
+					++bin.count;
+				}
+
+				// Sweep from the right to get the cost of everything right of each plane, then from the left
+				float right_costs[SAH_BIN_COUNT];
+				XMVECTOR right_minimum = XMVectorSplatInfinity();
+				XMVECTOR right_maximum = XMVectorNegate(right_minimum);
+				uint_t right_count = 0;
+				for (uint_t b = SAH_BIN_COUNT - 1; b > 0; --b)
+				{
+					right_minimum = XMVectorMin(right_minimum, bins[b].minimum);
+					right_maximum = XMVectorMax(right_maximum, bins[b].maximum);
+					right_count += bins[b].count;
+					right_costs[b] = half_area(right_minimum, right_maximum) * blocks_needed(right_count);
+				}
+
+				XMVECTOR left_minimum = XMVectorSplatInfinity();
+				XMVECTOR left_maximum = XMVectorNegate(left_minimum);
+				uint_t left_count = 0;
+				for (uint_t b = 0; b + 1 < SAH_BIN_COUNT; ++b)
+				{
+					left_minimum = XMVectorMin(left_minimum, bins[b].minimum);
+					left_maximum = XMVectorMax(left_maximum, bins[b].maximum);
+					left_count += bins[b].count;
+					if (left_count == 0 || left_count == count) continue;
+
+					const float cost = half_area(left_minimum, left_maximum) * blocks_needed(left_count) + right_costs[b + 1];
+					if (cost < best_cost)
+					{
+						best_cost = cost;
+						best_axis = axis;
+						best_bin = b;
+					}
+				}
+			}
+
+			if (best_cost == std::numeric_limits<float>::infinity())
+			{
+				// All the centroids are in the same place, so only split to keep the leaves small
+				if (count <= MAX_LEAF_TRIANGLES) return first;
+				return first + count / 2;
+			}
+
+			if (SAH_TRAVERSAL_COST * area + best_cost >= leaf_cost && count <= MAX_LEAF_TRIANGLES) return first;
+
+			const float scale = SAH_BIN_COUNT / extents[best_axis];
+			const float lower_bound = lower_bounds[best_axis];
+			const std::vector<uint_t>::iterator middle = std::partition(mOrder.begin() + first, mOrder.begin() + last,
+				[&](uint_t triangle) { return bin_index(mTriangles[triangle].centroid, best_axis, lower_bound, scale) <= best_bin; });
+			return static_cast<uint_t>(middle - mOrder.begin());
+		}
+
+		static uint_t bin_index(FXMVECTOR centroid, uint_t axis, float lower_bound, float scale)
+		{
+			const float position = (XMVectorGetByIndex(centroid, axis) - lower_bound) * scale;
+			return std::min(static_cast<uint_t>(std::max(position, 0.0f)), SAH_BIN_COUNT - 1);
+		}
+
+		// Packs the triangles into blocks, the unused lanes of the last block repeat its last triangle
+		void make_leaf(uint_t node_index, uint_t first, uint_t last)
+		{
+			typedef Math::SoaTraits<Math::Triangle> Traits;
+
+			const uint_t block_count = blocks_needed(last - first);
+			mNodes[node_index].offset = static_cast<uint_t>(mBlocks.size());
+			mNodes[node_index].block_count = block_count;
+
+			for (uint_t block = 0; block < block_count; ++block)
+			{
+				XMFLOAT4A lanes[Traits::COMPONENT_COUNT];
+				float* components = reinterpret_cast<float*>(lanes);
+				float values[Traits::COMPONENT_COUNT];
+
+				for (uint_t lane = 0; lane < Math::SOA_LANE_COUNT; ++lane)
+				{
+					const uint_t triangle = mOrder[std::min(first + block * Math::SOA_LANE_COUNT + lane, last - 1)];
+					Traits::scatter(Math::Triangle(mVertices[mIndices[triangle * 3]], mVertices[mIndices[triangle * 3 + 1]], mVertices[mIndices[triangle * 3 + 2]]), values);
+					for (uint_t c = 0; c < Traits::COMPONENT_COUNT; ++c)
+					{
+						components[c * Math::SOA_LANE_COUNT + lane] = values[c];
+					}
+					mTriangleIndices.push_back(triangle);
+				}
+
+				TriangleBlock triangles;
+				for (uint_t c = 0; c < Traits::COMPONENT_COUNT; ++c)
+				{
+					triangles[c] = XMLoadFloat4A(&lanes[c]);
+				}
+				mBlocks.push_back(triangles);
+			}
+		}
+	};
+
+	// A ray or line prepared for the slab tests against the nodes
+	struct Segment
+	{
+		XMVECTOR origin;
+		XMVECTOR inverse_direction;
+		float max_distance;
+	};
+
+	Segment make_segment(FXMVECTOR origin, FXMVECTOR direction, float max_distance)
+	{
+		// Clamping the infinities from zero components keeps (0 * inverse) from making NaNs on the slab planes
+		const XMVECTOR limit = XMVectorReplicate(FLT_MAX);
+		const Segment segment = { origin, XMVectorClamp(XMVectorReciprocal(direction), XMVectorNegate(limit), limit), max_distance };
+		return segment;
+	}
+
+	bool enter_node(const Segment& segment, const Node& node, float max_distance, float& entry)
+	{
+		const XMVECTOR t1 = XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&node.minimum), segment.origin), segment.inverse_direction);
+		const XMVECTOR t2 = XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&node.maximum), segment.origin), segment.inverse_direction);
+		const XMVECTOR near_planes = XMVectorMin(t1, t2);
+		const XMVECTOR far_planes = XMVectorMax(t1, t2);
+
+		const float t_min = std::max(std::max(XMVectorGetX(near_planes), XMVectorGetY(near_planes)), std::max(XMVectorGetZ(near_planes), 0.0f));
+		const float t_max = std::min(std::min(XMVectorGetX(far_planes), XMVectorGetY(far_planes)), std::min(XMVectorGetZ(far_planes), max_distance));
+		entry = t_min;
+		return t_min <= t_max;
+	}
+
+	struct StackEntry
+	{
+		uint_t node;
+		float entry;
+	};
+
+	// Visits the nearer child first and skips anything further away than the closest hit so far
+	template <class Query>
+	Math::Intersect::TriangleResult find_closest(const Query& query, const Segment& segment, const Node* nodes, const TriangleBlock* blocks, const uint_t* triangle_indices, uint_t* triangle_index)
+	{
+		Math::Intersect::TriangleResult closest;
+		float closest_distance = segment.max_distance;
+
+		float root_entry;
+		if (!enter_node(segment, nodes[0], closest_distance, root_entry)) return closest;
+
+		StackEntry stack[MAX_DEPTH];
+		uint_t stack_size = 0;
+		uint_t node_index = 0;
+
+		for (;;)
+		{
+			const Node& node = nodes[node_index];
+
+			if (node.block_count != 0)
+			{
+				for (uint_t block = node.offset; block < node.offset + node.block_count; ++block)
+				{
+					const Math::Intersect::TriangleBlockResult result = Math::Intersect::test(query, blocks[block]);
+
+					// Lanes that missed are pushed out to infinity so only the distance needs checking
+					XMVECTORF32 distances;
+					XMVECTORF32 u;
+					XMVECTORF32 v;
+					distances.v = XMVectorSelect(XMVectorSplatInfinity(), result.distance, result.intersect);
+					u.v = result.u;
+					v.v = result.v;
+
+					for (uint_t lane = 0; lane < Math::SOA_LANE_COUNT; ++lane)
+					{
+						if (distances.f[lane] <= closest_distance)
+						{
+							closest_distance = distances.f[lane];
+							closest = Math::Intersect::TriangleResult(distances.f[lane], u.f[lane], v.f[lane]);
+							if (triangle_index) *triangle_index = triangle_indices[block * Math::SOA_LANE_COUNT + lane];
+						}
+					}
+				}
+			}
+			else
+			{
+				uint_t near_child = node_index + 1;
+				uint_t far_child = node.offset;
+				float near_entry;
+				float far_entry;
+				const bool hit_near = enter_node(segment, nodes[near_child], closest_distance, near_entry);
+				const bool hit_far = enter_node(segment, nodes[far_child], closest_distance, far_entry);
+
+				if (hit_near && hit_far)
+				{
+					if (far_entry < near_entry)
+					{
+						std::swap(near_child, far_child);
+						std::swap(near_entry, far_entry);
+					}
+					const StackEntry pending = { far_child, far_entry };
+					stack[stack_size++] = pending;
+					node_index = near_child;
+					continue;
+				}
+				if (hit_near || hit_far)
+				{
+					node_index = hit_near ? near_child : far_child;
+					continue;
+				}
+			}
+
+			// Pop the next node that could still hold a closer hit
+			while (stack_size > 0 && stack[stack_size - 1].entry > closest_distance)
+			{
+				--stack_size;
+			}
+			if (stack_size == 0) break;
+			node_index = stack[--stack_size].node;
+		}
+
+		return closest;
+	}
+
+	template <class Query>
+	bool find_any(const Query& query, const Segment& segment, const Node* nodes, const TriangleBlock* blocks)
+	{
+		float entry;
+		if (!enter_node(segment, nodes[0], segment.max_distance, entry)) return false;
+
+		uint_t stack[MAX_DEPTH];
+		uint_t stack_size = 0;
+		uint_t node_index = 0;
+
+		for (;;)
+		{
+			const Node& node = nodes[node_index];
+
+			if (node.block_count != 0)
+			{
+				for (uint_t block = node.offset; block < node.offset + node.block_count; ++block)
+				{
+					const Math::Intersect::TriangleBlockResult result = Math::Intersect::test(query, blocks[block]);
+					if (XMVector4NotEqualInt(result.intersect, XMVectorFalseInt())) return true;
+				}
+			}
+			else
+			{
+				const bool hit_first = enter_node(segment, nodes[node_index + 1], segment.max_distance, entry);
+				const bool hit_second = enter_node(segment, nodes[node.offset], segment.max_distance, entry);
+
+				if (hit_first && hit_second)
+				{
+					stack[stack_size++] = node.offset;
+					node_index = node_index + 1;
+					continue;
+				}
+				if (hit_first || hit_second)
+				{
+					node_index = hit_first ? node_index + 1 : node.offset;
+					continue;
+				}
+			}
+
+			if (stack_size == 0) break;
+			node_index = stack[--stack_size];
+		}
+
+		return false;
+	}
+
+	// Checks a loaded tree only refers to nodes, blocks and triangles that exist, always points forwards
+	// (so the traversal ends), is no deeper than the traversal stack and is a tree. Every node must be reached
+	// exactly once, as otherwise nodes sharing children could make a walk over every path take forever.
+	bool validate(const Node* nodes, uint_t node_count, const uint_t* triangle_indices, uint_t block_count, uint_t triangle_count)
+	{
+		for (uint_t i = 0; i < block_count * Math::SOA_LANE_COUNT; ++i)
+		{
+			if (triangle_indices[i] >= triangle_count) return false;
+		}
+
+		std::vector<bool> visited(node_count, false);
+		uint_t visited_count = 0;
+
+		std::vector<std::pair<uint_t, uint_t>> stack(1, std::make_pair(0u, 0u));
+		while (!stack.empty())
+		{
+			const uint_t index = stack.back().first;
+			const uint_t depth = stack.back().second;
+			stack.pop_back();
+
+			if (depth >= MAX_DEPTH || visited[index]) return false;
+			visited[index] = true;
+			++visited_count;
+
+			const Node& node = nodes[index];
+			if (node.block_count != 0)
+			{
+				if (node.offset > block_count || node.block_count > block_count - node.offset) return false;
+			}
+			else
+			{
+				if (index + 1 >= node_count || node.offset <= index + 1 || node.offset >= node_count) return false;
+				stack.push_back(std::make_pair(index + 1, depth + 1));
+				stack.push_back(std::make_pair(node.offset, depth + 1));
+			}
+		}
+
+		return visited_count == node_count;
+	}
+}
+
+namespace Math
+{
+	MeshBvh::MeshBvh() :
+		mNodes(nullptr),
+		mBlocks(nullptr),
+		mTriangleIndices(nullptr),
+		mNodeCount(0),
+		mBlockCount(0),
+		mTriangleCount(0)
+	{
+	}
+
+	MeshBvh::MeshBvh(const Vector3* vertices, size_t vertex_count, const uint_t* indices, size_t index_count) :
+		mNodes(nullptr),
+		mBlocks(nullptr),
+		mTriangleIndices(nullptr),
+		mNodeCount(0),
+		mBlockCount(0),
+		mTriangleCount(0)
+	{
+		XMASSERT(index_count % 3 == 0);
+		XMASSERT(std::all_of(indices, indices + index_count, [vertex_count](uint_t index) { return index < vertex_count; }));
+		(void)vertex_count;
+
+		build(vertices, indices, index_count / 3);
+	}
+
+	MeshBvh::MeshBvh(const MeshBvh& bvh) :
+		mNodeStorage(bvh.mNodeStorage),
+		mBlockStorage(bvh.mBlockStorage),
+		mIndexStorage(bvh.mIndexStorage),
+		mNodes(bvh.mNodes),
+		mBlocks(bvh.mBlocks),
+		mTriangleIndices(bvh.mTriangleIndices),
+		mNodeCount(bvh.mNodeCount),
+		mBlockCount(bvh.mBlockCount),
+		mTriangleCount(bvh.mTriangleCount)
+	{
+		if (!mNodeStorage.empty()) use_storage();
+	}
+
+	MeshBvh& MeshBvh::operator = (const MeshBvh& bvh)
+	{
+		mNodeStorage = bvh.mNodeStorage;
+		mBlockStorage = bvh.mBlockStorage;
+		mIndexStorage = bvh.mIndexStorage;
+		mNodes = bvh.mNodes;
+		mBlocks = bvh.mBlocks;
+		mTriangleIndices = bvh.mTriangleIndices;
+		mNodeCount = bvh.mNodeCount;
+		mBlockCount = bvh.mBlockCount;
+		mTriangleCount = bvh.mTriangleCount;
+		if (!mNodeStorage.empty()) use_storage();
+		return *this;
+	}
+
+	BoundingBox MeshBvh::bounds() const
+	{
+		if (is_empty()) return BoundingBox();
+		return BoundingBox(Vector3(mNodes[0].minimum.x, mNodes[0].minimum.y, mNodes[0].minimum.z), Vector3(mNodes[0].maximum.x, mNodes[0].maximum.y, mNodes[0].maximum.z), ALREADY_SORTED);
+	}
+
+	Intersect::TriangleResult MeshBvh::closest_hit(const Ray& ray, uint_t* triangle_index) const
+	{
+		if (is_empty()) return Intersect::TriangleResult();
+		return ::find_closest(ray, ::make_segment(ray.origin(), ray.direction(), FLT_MAX), mNodes, mBlocks, mTriangleIndices, triangle_index);
+	}
+
+	Intersect::TriangleResult MeshBvh::closest_hit(const Line& line, uint_t* triangle_index) const
+	{
+		if (is_empty()) return Intersect::TriangleResult();
+		return ::find_closest(line, ::make_segment(line.start_point, line.vector(), 1.0f), mNodes, mBlocks, mTriangleIndices, triangle_index);
+	}
+
+	bool MeshBvh::any_hit(const Ray& ray) const
+	{
+		if (is_empty()) return false;
+		return ::find_any(ray, ::make_segment(ray.origin(), ray.direction(), FLT_MAX), mNodes, mBlocks);
+	}
+
+	bool MeshBvh::any_hit(const Line& line) const
+	{
+		if (is_empty()) return false;
+		return ::find_any(line, ::make_segment(line.start_point, line.vector(), 1.0f), mNodes, mBlocks);
+	}
+
+	size_t MeshBvh::serialized_size() const
+	{
+		return ::blob_size(mNodeCount, mBlockCount);
+	}
+
+	void MeshBvh::serialize(void* buffer) const
+	{
+		XMASSERT((reinterpret_cast<size_t>(buffer) & 15) == 0);
+
+		BlobHeader header = {};
+		header.magic = BLOB_MAGIC;
+		header.version = BLOB_VERSION;
+		header.node_count = mNodeCount;
+		header.block_count = mBlockCount;
+		header.triangle_count = mTriangleCount;
+
+		// Every section is a multiple of 16 bytes, so each one stays aligned
+		uchar_t* output = static_cast<uchar_t*>(buffer);
+		std::memcpy(output, &header, sizeof(header));
+		output += sizeof(header);
+		std::memcpy(output, mNodes, mNodeCount * sizeof(Node));
+		output += mNodeCount * sizeof(Node);
+		std::memcpy(output, mBlocks, mBlockCount * sizeof(TriangleBlock));
+		output += mBlockCount * sizeof(TriangleBlock);
+		std::memcpy(output, mTriangleIndices, mBlockCount * SOA_LANE_COUNT * sizeof(uint_t));
+	}
+
+	bool MeshBvh::load(const void* data, size_t size)
+	{
+		*this = MeshBvh();
+
+		if ((reinterpret_cast<size_t>(data) & 15) != 0 || size < sizeof(BlobHeader)) return false;
+
+		const uchar_t* input = static_cast<const uchar_t*>(data);
+		BlobHeader header;
+		std::memcpy(&header, input, sizeof(header));
+		if (header.magic != BLOB_MAGIC || header.version != BLOB_VERSION) return false;
+		if (header.node_count > size / sizeof(Node) || header.block_count > size / sizeof(TriangleBlock)) return false;
+		if (size != ::blob_size(header.node_count, header.block_count)) return false;
+		if (header.node_count == 0) return header.block_count == 0;
+
+		const Node* nodes = reinterpret_cast<const Node*>(input + sizeof(BlobHeader));
+		const TriangleBlock* blocks = reinterpret_cast<const TriangleBlock*>(nodes + header.node_count);
+		const uint_t* triangle_indices = reinterpret_cast<const uint_t*>(blocks + header.block_count);
+		if (!::validate(nodes, header.node_count, triangle_indices, header.block_count, header.triangle_count)) return false;
+
+		mNodes = nodes;
+		mBlocks = blocks;
+		mTriangleIndices = triangle_indices;
+		mNodeCount = header.node_count;
+		mBlockCount = header.block_count;
+		mTriangleCount = header.triangle_count;
+		return true;
+	}
+
+	void MeshBvh::build(const Vector3* vertices, const uint_t* indices, size_t triangle_count)
+	{
+		if (triangle_count == 0) return;
+
+		::Builder(vertices, indices, triangle_count, mNodeStorage, mBlockStorage, mIndexStorage).build();
+		mTriangleCount = static_cast<uint_t>(triangle_count);
+		use_storage();
+	}
+
+	void MeshBvh::use_storage()
+	{
+		mNodes = mNodeStorage.data();
+		mBlocks = mBlockStorage.data();
+		mTriangleIndices = mIndexStorage.data();
+		mNodeCount = static_cast<uint_t>(mNodeStorage.size());
+		mBlockCount = static_cast<uint_t>(mBlockStorage.size());
+	}
+
+} // namespace Math
@@ -0,0 +1,129 @@
+#pragma once
+#ifndef __MATHS_MESHBVH_HPP__
+#define __MATHS_MESHBVH_HPP__
+
+#include "Intersect.hpp"
+#include "BoundingBox.hpp"
+#include "SoaArray.hpp"
+
+#include <vector>
+
+namespace Math
+{
+	class Vector3;
+	class Ray;
+	class Line;
+
+	// Bounding volume hierarchy over an indexed triangle mesh, for ray casts.
+	//
+	// The nodes are stored depth first and each leaf's triangles are packed into
+	// SoaBlocks so they are tested four at a time. The nodes and triangles can be
+	// written out as one flat blob, which can later be used in place (for example
+	// straight from a memory mapped file) without rebuilding.
+	class MeshBvh
+	{
+	public:
+		struct Node
+		{
+			XMFLOAT3 minimum;
+			uint_t offset; // Leaf: the first triangle block, Interior: the second child (the first child follows this node)
+			XMFLOAT3 maximum;
+			uint_t block_count; // Zero for interior nodes
+		};
+
+		typedef SoaBlock<Triangle> TriangleBlock;
+
+	private:
+		// Owned storage, which is empty when the bvh uses a loaded blob
+		std::vector<Node> mNodeStorage;
+		std::vector<TriangleBlock> mBlockStorage;
+		std::vector<uint_t> mIndexStorage;
+
+		const Node* mNodes;
+		const TriangleBlock* mBlocks;
+		const uint_t* mTriangleIndices; // Mesh triangle of each lane of each block
+		uint_t mNodeCount;
+		uint_t mBlockCount;
+		uint_t mTriangleCount;
+
+	public:
+		//--------------------------------------------------------------------------
+		// Constructors
+		//
+
+		MeshBvh();
+
+		// Each three indices make a triangle, so index_count must be a multiple of three
+		MeshBvh(const Vector3* vertices, size_t vertex_count, const uint_t* indices, size_t index_count);
+
+		MeshBvh(const MeshBvh& bvh);
+
+		//--------------------------------------------------------------------------
+		// Assignment
+		//
+
+		MeshBvh& operator = (const MeshBvh& bvh);
+
+		//--------------------------------------------------------------------------
+		// Accessors
+		//
+
+		bool is_empty() const
+		{
+			return mNodeCount == 0;
+		}
+
+		size_t triangle_count() const
+		{
+			return mTriangleCount;
+		}
+
+		size_t node_count() const
+		{
+			return mNodeCount;
+		}
+
+		const Node* nodes() const
+		{
+			return mNodes;
+		}
+
+		BoundingBox bounds() const;
+
+		//--------------------------------------------------------------------------
+		// Queries
+		//
+		// The distances and barycentric coordinates are as for the Intersect tests against a
+		// Triangle, and triangle_index is the index of the hit triangle in the mesh (its first
+		// index divided by three).
+		//
+
+		Intersect::TriangleResult closest_hit(const Ray& ray, uint_t* triangle_index = nullptr) const;
+		Intersect::TriangleResult closest_hit(const Line& line, uint_t* triangle_index = nullptr) const;
+
+		// Stops at the first hit found, for occlusion tests
+		bool any_hit(const Ray& ray) const;
+		bool any_hit(const Line& line) const;
+
+		//--------------------------------------------------------------------------
+		// Serialization
+		//
+
+		size_t serialized_size() const;
+
+		// The buffer must be 16 byte aligned and serialized_size() bytes long
+		void serialize(void* buffer) const;
+
+		// Uses a blob written by serialize in place. The blob must be 16 byte aligned and stay alive
+		// and unchanged while this bvh uses it. Returns false, leaving the bvh empty, if it is not valid.
+		bool load(const void* data, size_t size);
+
+	private:
+		void build(const Vector3* vertices, const uint_t* indices, size_t triangle_count);
+
+		void use_storage();
+	};
+
+} // namespace Math
+
+#endif // __MATHS_MESHBVH_HPP__
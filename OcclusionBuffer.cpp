@@ -0,0 +1,514 @@
+#include "Precompiled.hpp"
+#include "OcclusionBuffer.hpp"
+#include "Vector3.hpp"
+#include "BoundingBox.hpp"
+#include "BoundingSphere.hpp"
+#include "Triangle.hpp"
+#include "SoaArray.hpp"
+
+#include <future>
+#include <thread>
+
+namespace
+{
+	const uint_t BLOCK_SIZE = Math::OcclusionBuffer::BLOCK_SIZE;
+	const uint_t BLOCK_PIXELS = BLOCK_SIZE * BLOCK_SIZE;
+	const uint_t TILE_BLOCKS = Math::OcclusionBuffer::TILE_SIZE / BLOCK_SIZE;
+
+	// Triangles with less than this area in pixels cover no pixel centers worth drawing
+	const float DEGENERATE_AREA = 1.0e-6f;
+
+	// Fewer occludees than this are not worth starting a thread for
+	const size_t MINIMUM_OCCLUDEES_PER_THREAD = 1024;
+
+	// Quads of box corners, with bit i of a corner picking the maximum on axis i
+	const uint_t BOX_FACES[6][4] =
+	{
+		{ 0, 2, 6, 4 }, { 1, 5, 7, 3 },
+		{ 0, 4, 5, 1 }, { 2, 3, 7, 6 },
+		{ 0, 1, 3, 2 }, { 4, 6, 7, 5 }
+	};
+
+	const XMVECTORF32 LANE_OFFSETS = { 0.5f, 1.5f, 2.5f, 3.5f }; // Pixel centers of the four lanes
+
+	uint_t thread_total(uint_t thread_count)
+	{
+		return (thread_count == 0) ? std::max(std::thread::hardware_concurrency(), 1u) : thread_count;
+	}
+
+	// Clip space corners of a box in two groups of four (the minimum z face then the maximum z face), a component
+	// in each vector. Returns false when the box is not entirely in front of the near plane, with visible set to
+	// whether any of it is.
+	bool project_box(const Math::Matrix& matrix, const Math::BoundingBox& box, XMVECTOR* x, XMVECTOR* y, XMVECTOR* depth, bool& visible)
+	{
+		const Math::Vector3& minimum = box.minimum_corner();
+		const Math::Vector3& maximum = box.maximum_corner();
+		const XMVECTOR corner_x = XMVectorSet(minimum.x, maximum.x, minimum.x, maximum.x);
+		const XMVECTOR corner_y = XMVectorSet(minimum.y, minimum.y, maximum.y, maximum.y);
+		const float corner_z[2] = { minimum.z, maximum.z };
+
+		XMVECTOR behind = XMVectorTrueInt();
+		XMVECTOR in_front = XMVectorTrueInt();
+		for (uint_t face = 0; face < 2; ++face)
+		{
+			XMVECTOR clip[4];
+			for (uint_t column = 0; column < 4; ++column)
+			{
+				clip[column] = XMVectorMultiplyAdd(corner_x, XMVectorReplicate(matrix(0, column)), XMVectorReplicate(corner_z[face] * matrix(2, column) + matrix(3, column)));
+				clip[column] = XMVectorMultiplyAdd(corner_y, XMVectorReplicate(matrix(1, column)), clip[column]);
+			}
+
+			const XMVECTOR in_front_of_near = XMVectorGreaterOrEqual(clip[2], XMVectorZero());
+			behind = XMVectorAndInt(behind, XMVectorLess(clip[2], XMVectorZero()));
+			in_front = XMVectorAndInt(in_front, XMVectorAndInt(in_front_of_near, XMVectorGreater(clip[3], XMVectorSplatEpsilon())));
+
+			const XMVECTOR inverse_w = XMVectorReciprocal(clip[3]);
+			x[face] = XMVectorMultiply(clip[0], inverse_w);
+			y[face] = XMVectorMultiply(clip[1], inverse_w);
+			depth[face] = XMVectorMultiply(clip[2], inverse_w);
+		}
+
+		if (XMVector4EqualInt(in_front, XMVectorTrueInt())) return true;
+
+		// Entirely behind the near plane cannot be seen, crossing it is treated as visible
+		visible = !XMVector4EqualInt(behind, XMVectorTrueInt());
+		return false;
+	}
+
+	float horizontal_min(FXMVECTOR v)
+	{
+		XMFLOAT4A lanes;
+		XMStoreFloat4A(&lanes, v);
+		return std::min(std::min(lanes.x, lanes.y), std::min(lanes.z, lanes.w));
+	}
+
+	float horizontal_max(FXMVECTOR v)
+	{
+		XMFLOAT4A lanes;
+		XMStoreFloat4A(&lanes, v);
+		return std::max(std::max(lanes.x, lanes.y), std::max(lanes.z, lanes.w));
+	}
+}
+
+namespace Math
+{
+	OcclusionBuffer::OcclusionBuffer(uint_t width, uint_t height) :
+		mViewProjection(XMMatrixIdentity()),
+		mWidth(width),
+		mHeight(height),
+		mBlocksX((width + BLOCK_SIZE - 1) / BLOCK_SIZE),
+		mBlocksY((height + BLOCK_SIZE - 1) / BLOCK_SIZE),
+		mTilesX((width + TILE_SIZE - 1) / TILE_SIZE),
+		mTilesY((height + TILE_SIZE - 1) / TILE_SIZE),
+		mDepths(mBlocksX * mBlocksY * BLOCK_PIXELS, 1.0f),
+		mBlockDepths(mBlocksX * mBlocksY, 1.0f),
+		mBins(mTilesX * mTilesY)
+	{
+		XMASSERT(width > 0 && height > 0);
+	}
+
+	OcclusionBuffer::OcclusionBuffer(const OcclusionBuffer& buffer) :
+		mViewProjection(buffer.mViewProjection),
+		mWidth(buffer.mWidth),
+		mHeight(buffer.mHeight),
+		mBlocksX(buffer.mBlocksX),
+		mBlocksY(buffer.mBlocksY),
+		mTilesX(buffer.mTilesX),
+		mTilesY(buffer.mTilesY),
+		mDepths(buffer.mDepths),
+		mBlockDepths(buffer.mBlockDepths),
+		mTriangles(buffer.mTriangles),
+		mBins(buffer.mBins)
+	{
+	}
+
+	OcclusionBuffer& OcclusionBuffer::operator = (const OcclusionBuffer& buffer)
+	{
+		mViewProjection = buffer.mViewProjection;
+		mWidth = buffer.mWidth;
+		mHeight = buffer.mHeight;
+		mBlocksX = buffer.mBlocksX;
+		mBlocksY = buffer.mBlocksY;
+		mTilesX = buffer.mTilesX;
+		mTilesY = buffer.mTilesY;
+		mDepths = buffer.mDepths;
+		mBlockDepths = buffer.mBlockDepths;
+		mTriangles = buffer.mTriangles;
+		mBins = buffer.mBins;
+		return *this;
+	}
+
+	float OcclusionBuffer::depth(uint_t x, uint_t y) const
+	{
+		XMASSERT(x < mWidth && y < mHeight);
+		const uint_t block = (y / BLOCK_SIZE) * mBlocksX + x / BLOCK_SIZE;
+		return mDepths[block * BLOCK_PIXELS + (y % BLOCK_SIZE) * BLOCK_SIZE + x % BLOCK_SIZE];
+	}
+
+	//--------------------------------------------------------------------------
+	// Occluders
+	//
+
+	void OcclusionBuffer::begin(const Matrix& view_projection)
+	{
+		mViewProjection = view_projection;
+		std::fill(mDepths.begin(), mDepths.end(), 1.0f);
+		std::fill(mBlockDepths.begin(), mBlockDepths.end(), 1.0f);
+		mTriangles.clear();
+		for (auto& bin : mBins)
+		{
+			bin.clear();
+		}
+	}
+
+	void OcclusionBuffer::add_occluder(const BoundingBox& box)
+	{
+		XMVECTOR corners[8];
+		for (uint_t corner = 0; corner < 8; ++corner)
+		{
+			const Vector3 point(
+				(corner & 1) ? box.maximum_corner().x : box.minimum_corner().x,
+				(corner & 2) ? box.maximum_corner().y : box.minimum_corner().y,
+				(corner & 4) ? box.maximum_corner().z : box.minimum_corner().z);
+			corners[corner] = XMVector3Transform(point, mViewProjection);
+		}
+
+		// Both sides of every face are drawn, as the nearest depth is kept it does not matter which faces are behind
+		for (uint_t face = 0; face < 6; ++face)
+		{
+			const uint_t* quad = BOX_FACES[face];
+			add_triangle(corners[quad[0]], corners[quad[1]], corners[quad[2]]);
+			add_triangle(corners[quad[0]], corners[quad[2]], corners[quad[3]]);
+		}
+	}
+
+	void OcclusionBuffer::add_occluder(const Triangle& triangle)
+	{
+		add_triangle(XMVector3Transform(triangle.point_a, mViewProjection), XMVector3Transform(triangle.point_b, mViewProjection), XMVector3Transform(triangle.point_c, mViewProjection));
+	}
+
+	void OcclusionBuffer::add_occluders(const Vector3* vertices, size_t vertex_count, const uint_t* indices, size_t index_count)
+	{
+		XMASSERT(index_count % 3 == 0);
+
+		std::vector<XMVECTOR> clip(vertex_count);
+		for (size_t i = 0; i < vertex_count; ++i)
+		{
+			clip[i] = XMVector3Transform(vertices[i], mViewProjection);
+		}
+
+		for (size_t i = 0; i + 2 < index_count; i += 3)
+		{
+			XMASSERT(indices[i] < vertex_count && indices[i + 1] < vertex_count && indices[i + 2] < vertex_count);
+			add_triangle(clip[indices[i]], clip[indices[i + 1]], clip[indices[i + 2]]);
+		}
+	}
+
+	void OcclusionBuffer::add_triangle(FXMVECTOR a, FXMVECTOR b, FXMVECTOR c)
+	{
+		// Clipped against the near plane (z >= 0), which leaves w positive, giving up to four vertices
+		const XMVECTOR input[3] = { a, b, c };
+		XMVECTOR clipped[4];
+		uint_t count = 0;
+		for (uint_t i = 0; i < 3; ++i)
+		{
+			const XMVECTOR current = input[i];
+			const XMVECTOR next = input[(i + 1) % 3];
+			const float current_z = XMVectorGetZ(current);
+			const float next_z = XMVectorGetZ(next);
+
+			if (current_z >= 0.0f) clipped[count++] = current;
+			if ((current_z >= 0.0f) != (next_z >= 0.0f))
+			{
+				clipped[count++] = XMVectorLerp(current, next, current_z / (current_z - next_z));
+			}
+		}
+		if (count < 3) return;
+
+		// Into pixels from the top left, keeping z / w as the depth
+		const XMVECTOR scale = XMVectorSet(0.5f * mWidth, -0.5f * mHeight, 1.0f, 0.0f);
+		const XMVECTOR offset = XMVectorSet(0.5f * mWidth, 0.5f * mHeight, 0.0f, 0.0f);
+		XMFLOAT4A screen[4];
+		for (uint_t i = 0; i < count; ++i)
+		{
+			const float w = XMVectorGetW(clipped[i]);
+			if (w <= FLT_EPSILON) return;
+			XMStoreFloat4A(&screen[i], XMVectorMultiplyAdd(XMVectorScale(clipped[i], 1.0f / w), scale, offset));
+		}
+
+		add_screen_triangle(screen);
+		if (count == 4)
+		{
+			const XMFLOAT4A second[3] = { screen[0], screen[2], screen[3] };
+			add_screen_triangle(second);
+		}
+	}
+
+	void OcclusionBuffer::add_screen_triangle(const XMFLOAT4A* vertices)
+	{
+		// Both windings are drawn, so the vertices are put in the order that makes the edge functions positive inside
+		const XMFLOAT4A& v0 = vertices[0];
+		float area = (vertices[1].x - v0.x) * (vertices[2].y - v0.y) - (vertices[2].x - v0.x) * (vertices[1].y - v0.y);
+		if (std::abs(area) <= DEGENERATE_AREA) return;
+
+		const XMFLOAT4A& v1 = (area > 0.0f) ? vertices[1] : vertices[2];
+		const XMFLOAT4A& v2 = (area > 0.0f) ? vertices[2] : vertices[1];
+		area = std::abs(area);
+
+		// Beyond the far plane it can never be nearer than a cleared pixel
+		if (std::min(std::min(v0.z, v1.z), v2.z) >= 1.0f) return;
+
+		// Pixels whose centers are within the triangle's bounds
+		const float min_x = std::max(std::ceil(std::min(std::min(v0.x, v1.x), v2.x) - 0.5f), 0.0f);
+		const float min_y = std::max(std::ceil(std::min(std::min(v0.y, v1.y), v2.y) - 0.5f), 0.0f);
+		const float max_x = std::min(std::floor(std::max(std::max(v0.x, v1.x), v2.x) - 0.5f), mWidth - 1.0f);
+		const float max_y = std::min(std::floor(std::max(std::max(v0.y, v1.y), v2.y) - 0.5f), mHeight - 1.0f);
+
+		// Written so that NaN bounds are dropped too, leaving only bounds within the buffer to convert to pixels
+		if (!(min_x <= max_x && min_y <= max_y)) return;
+
+		ScreenTriangle triangle;
+		triangle.min_x = static_cast<uint_t>(min_x);
+		triangle.min_y = static_cast<uint_t>(min_y);
+		triangle.max_x = static_cast<uint_t>(max_x);
+		triangle.max_y = static_cast<uint_t>(max_y);
+
+		const XMFLOAT4A* ordered[3] = { &v0, &v1, &v2 };
+		for (uint_t i = 0; i < 3; ++i)
+		{
+			const XMFLOAT4A& start = *ordered[i];
+			const XMFLOAT4A& end = *ordered[(i + 1) % 3];
+			triangle.edges[i][0] = start.y - end.y;
+			triangle.edges[i][1] = end.x - start.x;
+			triangle.edges[i][2] = -(triangle.edges[i][0] * start.x + triangle.edges[i][1] * start.y);
+		}
+
+		// The depth moves at most half a pixel's worth of each gradient from a pixel's center, so adding that makes
+		// the depth at the center the farthest the triangle can be anywhere in the pixel
+		const float dz1 = v1.z - v0.z;
+		const float dz2 = v2.z - v0.z;
+		const float dzdx = (dz1 * (v2.y - v0.y) - dz2 * (v1.y - v0.y)) / area;
+		const float dzdy = ((v1.x - v0.x) * dz2 - (v2.x - v0.x) * dz1) / area;
+		triangle.depth[0] = dzdx;
+		triangle.depth[1] = dzdy;
+		triangle.depth[2] = v0.z - dzdx * v0.x - dzdy * v0.y + 0.5f * (std::abs(dzdx) + std::abs(dzdy));
+		triangle.max_depth = std::max(std::max(v0.z, v1.z), v2.z);
+
+		const uint_t index = static_cast<uint_t>(mTriangles.size());
+		mTriangles.push_back(triangle);
+
+		for (uint_t tile_y = triangle.min_y / TILE_SIZE; tile_y <= triangle.max_y / TILE_SIZE; ++tile_y)
+		{
+			for (uint_t tile_x = triangle.min_x / TILE_SIZE; tile_x <= triangle.max_x / TILE_SIZE; ++tile_x)
+			{
+				mBins[tile_y * mTilesX + tile_x].push_back(index);
+			}
+		}
+	}
+
+	void OcclusionBuffer::rasterize(uint_t thread_count)
+	{
+		const uint_t tile_count = mTilesX * mTilesY;
+		const uint_t threads = std::min(::thread_total(thread_count), tile_count);
+
+		// The tiles are dealt out in turn so the busy parts of the screen are shared between the threads
+		auto rasterize_tiles = [this, tile_count, threads](uint_t first)
+		{
+			for (uint_t tile = first; tile < tile_count; tile += threads)
+			{
+				rasterize_tile(tile);
+			}
+		};
+
+		std::vector<std::future<void>> results;
+		for (uint_t thread = 1; thread < threads; ++thread)
+		{
+			results.push_back(std::async(std::launch::async, rasterize_tiles, thread));
+		}
+		rasterize_tiles(0);
+		for (auto& result : results)
+		{
+			result.get();
+		}
+
+		mTriangles.clear();
+		for (auto& bin : mBins)
+		{
+			bin.clear();
+		}
+	}
+
+	void OcclusionBuffer::rasterize_tile(uint_t tile)
+	{
+		const uint_t tile_x = (tile % mTilesX) * TILE_SIZE;
+		const uint_t tile_y = (tile / mTilesX) * TILE_SIZE;
+		const uint_t tile_max_x = std::min(tile_x + TILE_SIZE, mWidth) - 1;
+		const uint_t tile_max_y = std::min(tile_y + TILE_SIZE, mHeight) - 1;
+		const XMVECTOR zero = XMVectorZero();
+
+		for (uint_t index : mBins[tile])
+		{
+			const ScreenTriangle& triangle = mTriangles[index];
+			const uint_t min_x = std::max(triangle.min_x, tile_x);
+			const uint_t min_y = std::max(triangle.min_y, tile_y);
+			const uint_t max_x = std::min(triangle.max_x, tile_max_x);
+			const uint_t max_y = std::min(triangle.max_y, tile_max_y);
+
+			XMVECTOR edge_x[3];
+			for (uint_t edge = 0; edge < 3; ++edge)
+			{
+				edge_x[edge] = XMVectorReplicate(triangle.edges[edge][0]);
+			}
+			const XMVECTOR depth_x = XMVectorReplicate(triangle.depth[0]);
+			const XMVECTOR max_depth = XMVectorReplicate(triangle.max_depth);
+
+			// Four pixels of a row at a time, skipping the groups of four outside the triangle's bounds
+			for (uint_t y = min_y; y <= max_y; ++y)
+			{
+				const float center_y = y + 0.5f;
+				XMVECTOR edge_row[3];
+				for (uint_t edge = 0; edge < 3; ++edge)
+				{
+					edge_row[edge] = XMVectorReplicate(triangle.edges[edge][1] * center_y + triangle.edges[edge][2]);
+				}
+				const XMVECTOR depth_row = XMVectorReplicate(triangle.depth[1] * center_y + triangle.depth[2]);
+
+				float* row = &mDepths[((y / BLOCK_SIZE) * mBlocksX) * BLOCK_PIXELS + (y % BLOCK_SIZE) * BLOCK_SIZE];
+				for (uint_t x = min_x & ~3u; x <= max_x; x += 4)
+				{
+					const XMVECTOR center_x = XMVectorAdd(XMVectorReplicate(static_cast<float>(x)), LANE_OFFSETS);
+					XMVECTOR inside = XMVectorGreaterOrEqual(XMVectorMultiplyAdd(center_x, edge_x[0], edge_row[0]), zero);
+					inside = XMVectorAndInt(inside, XMVectorGreaterOrEqual(XMVectorMultiplyAdd(center_x, edge_x[1], edge_row[1]), zero));
+					inside = XMVectorAndInt(inside, XMVectorGreaterOrEqual(XMVectorMultiplyAdd(center_x, edge_x[2], edge_row[2]), zero));
+					if (!XMVector4NotEqualInt(inside, XMVectorFalseInt())) continue;
+
+					float* pixels = row + (x / BLOCK_SIZE) * BLOCK_PIXELS + x % BLOCK_SIZE;
+					const XMVECTOR depth = XMVectorMin(XMVectorMultiplyAdd(center_x, depth_x, depth_row), max_depth);
+					const XMVECTOR current = XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(pixels));
+					XMStoreFloat4A(reinterpret_cast<XMFLOAT4A*>(pixels), XMVectorSelect(current, XMVectorMin(current, depth), inside));
+				}
+			}
+		}
+
+		// The farthest depth of each block in the tile, which every pixel in it is at least as near as
+		const uint_t block_x = tile_x / BLOCK_SIZE;
+		const uint_t block_y = tile_y / BLOCK_SIZE;
+		for (uint_t by = block_y; by < std::min(block_y + TILE_BLOCKS, mBlocksY); ++by)
+		{
+			for (uint_t bx = block_x; bx < std::min(block_x + TILE_BLOCKS, mBlocksX); ++bx)
+			{
+				const uint_t block = by * mBlocksX + bx;
+				const float* pixels = &mDepths[block * BLOCK_PIXELS];
+				XMVECTOR farthest = XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(pixels));
+				for (uint_t i = 4; i < BLOCK_PIXELS; i += 4)
+				{
+					farthest = XMVectorMax(farthest, XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(pixels + i)));
+				}
+				mBlockDepths[block] = ::horizontal_max(farthest);
+			}
+		}
+	}
+
+	//--------------------------------------------------------------------------
+	// Occludees
+	//
+
+	bool OcclusionBuffer::is_visible(const BoundingBox& box) const
+	{
+		XMVECTOR x[2];
+		XMVECTOR y[2];
+		XMVECTOR depth[2];
+		bool visible = false;
+		if (!::project_box(mViewProjection, box, x, y, depth, visible)) return visible;
+
+		// Normalised device coordinates to pixels, with y flipped so the minimum comes from the maximum
+		const float min_x = (::horizontal_min(XMVectorMin(x[0], x[1])) * 0.5f + 0.5f) * mWidth;
+		const float max_x = (::horizontal_max(XMVectorMax(x[0], x[1])) * 0.5f + 0.5f) * mWidth;
+		const float min_y = (0.5f - ::horizontal_max(XMVectorMax(y[0], y[1])) * 0.5f) * mHeight;
+		const float max_y = (0.5f - ::horizontal_min(XMVectorMin(y[0], y[1])) * 0.5f) * mHeight;
+		return is_rectangle_visible(min_x, min_y, max_x, max_y, ::horizontal_min(XMVectorMin(depth[0], depth[1])));
+	}
+
+	bool OcclusionBuffer::is_visible(const BoundingSphere& sphere) const
+	{
+		const Vector3 radius(sphere.radius(), sphere.radius(), sphere.radius());
+		return is_visible(BoundingBox(sphere.center() - radius, sphere.center() + radius, ALREADY_SORTED));
+	}
+
+	void OcclusionBuffer::is_visible(const SoaView<BoundingBox>& boxes, bool* visible, uint_t thread_count) const
+	{
+		const size_t count = boxes.size();
+		const size_t useful_threads = std::max<size_t>(count / MINIMUM_OCCLUDEES_PER_THREAD, 1);
+		const size_t threads = std::min<size_t>(::thread_total(thread_count), useful_threads);
+
+		auto test_range = [this, &boxes, visible](size_t first, size_t last)
+		{
+			for (size_t i = first; i < last; ++i)
+			{
+				visible[i] = is_visible(boxes[i]);
+			}
+		};
+
+		const size_t range = (count + threads - 1) / threads;
+		std::vector<std::future<void>> results;
+		for (size_t first = range; first < count; first += range)
+		{
+			results.push_back(std::async(std::launch::async, test_range, first, std::min(first + range, count)));
+		}
+
+		// This thread does the first range while waiting for the others
+		test_range(0, std::min(range, count));
+		for (auto& result : results)
+		{
+			result.get();
+		}
+	}
+
+	bool OcclusionBuffer::is_rectangle_visible(float min_x, float min_y, float max_x, float max_y, float min_depth) const
+	{
+		// A NaN from a degenerate projection says nothing about where the box is, so it is kept
+		if (std::isnan(min_x) || std::isnan(min_y) || std::isnan(max_x) || std::isnan(max_y) || std::isnan(min_depth)) return true;
+		if (max_x < 0.0f || max_y < 0.0f || min_x > mWidth || min_y > mHeight) return false;
+
+		// Every pixel the rectangle touches, clamped to the buffer as floats since the extent may be too large (or
+		// infinite) to convert
+		const uint_t first_x = static_cast<uint_t>(std::max(min_x, 0.0f));
+		const uint_t first_y = static_cast<uint_t>(std::max(min_y, 0.0f));
+		const uint_t last_x = static_cast<uint_t>(std::min(max_x, mWidth - 1.0f));
+		const uint_t last_y = static_cast<uint_t>(std::min(max_y, mHeight - 1.0f));
+
+		const XMVECTOR nearest = XMVectorReplicate(min_depth);
+		const XMVECTOR first_center = XMVectorReplicate(static_cast<float>(first_x));
+		const XMVECTOR last_center = XMVectorReplicate(last_x + 1.0f);
+
+		for (uint_t block_y = first_y / BLOCK_SIZE; block_y <= last_y / BLOCK_SIZE; ++block_y)
+		{
+			const uint_t row_first = std::max(first_y, block_y * BLOCK_SIZE);
+			const uint_t row_last = std::min(last_y, block_y * BLOCK_SIZE + BLOCK_SIZE - 1);
+
+			for (uint_t block_x = first_x / BLOCK_SIZE; block_x <= last_x / BLOCK_SIZE; ++block_x)
+			{
+				// Hidden by every pixel of the block
+				const uint_t block = block_y * mBlocksX + block_x;
+				if (mBlockDepths[block] < min_depth) continue;
+
+				const uint_t column_first = std::max(first_x, block_x * BLOCK_SIZE) & ~3u;
+				const uint_t column_last = std::min(last_x, block_x * BLOCK_SIZE + BLOCK_SIZE - 1);
+				for (uint_t y = row_first; y <= row_last; ++y)
+				{
+					const float* row = &mDepths[block * BLOCK_PIXELS + (y % BLOCK_SIZE) * BLOCK_SIZE];
+					for (uint_t x = column_first; x <= column_last; x += 4)
+					{
+						const XMVECTOR center = XMVectorAdd(XMVectorReplicate(static_cast<float>(x)), LANE_OFFSETS);
+						const XMVECTOR in_rectangle = XMVectorAndInt(XMVectorGreater(center, first_center), XMVectorLess(center, last_center));
+						const XMVECTOR depth = XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(row + x % BLOCK_SIZE));
+						if (XMVector4NotEqualInt(XMVectorAndInt(in_rectangle, XMVectorGreaterOrEqual(depth, nearest)), XMVectorFalseInt())) return true;
+					}
+				}
+			}
+		}
+
+		return false;
+	}
+
+} // namespace Math
@@ -0,0 +1,146 @@
+#pragma once
+#ifndef __MATHS_OCCLUSIONBUFFER_HPP__
+#define __MATHS_OCCLUSIONBUFFER_HPP__
+
+#include "Matrix.hpp"
+
+#include <vector>
+
+namespace Math
+{
+	class Vector3;
+	class BoundingBox;
+	class BoundingSphere;
+	class Triangle;
+
+	template <class Type> class SoaView;
+
+	// Low resolution depth buffer for culling objects hidden behind large occluders on the CPU.
+	//
+	// Each frame the buffer is started with the view projection matrix (such as look_at * perspective_fov),
+	// occluders are added, which projects and clips them, and then rasterized. The screen is split into tiles
+	// which are rasterized concurrently, each tile only drawing the triangles binned to it. Depths are D3D's
+	// z / w, from 0 at the near plane to 1 at the far plane.
+	//
+	// Pixels are stored in 8x8 blocks, each with the farthest depth in it, so most occludee tests are settled
+	// by the blocks and only look at pixels four at a time where an occluder edge crosses the block.
+	class OcclusionBuffer
+	{
+	public:
+		static const uint_t BLOCK_SIZE = 8;
+		static const uint_t TILE_SIZE = 4 * BLOCK_SIZE; // Pixels along each side of a tile, a square of blocks
+
+	private:
+		// A triangle after projection, with the edge functions a * x + b * y + c that are positive inside it and
+		// the plane of its depths, both in pixels
+		struct ScreenTriangle
+		{
+			float edges[3][3];
+			float depth[3];
+			float max_depth;
+			uint_t min_x;
+			uint_t min_y;
+			uint_t max_x;
+			uint_t max_y;
+		};
+
+		Matrix mViewProjection;
+		uint_t mWidth;
+		uint_t mHeight;
+		uint_t mBlocksX;
+		uint_t mBlocksY;
+		uint_t mTilesX;
+		uint_t mTilesY;
+
+		std::vector<float> mDepths; // A block at a time, each block a row at a time
+		std::vector<float> mBlockDepths;
+		std::vector<ScreenTriangle> mTriangles;
+		std::vector<std::vector<uint_t>> mBins; // Triangles touching each tile
+
+	public:
+		//--------------------------------------------------------------------------
+		// Constructors
+		//
+
+		OcclusionBuffer(uint_t width, uint_t height);
+
+		OcclusionBuffer(const OcclusionBuffer& buffer);
+
+		//--------------------------------------------------------------------------
+		// Assignment
+		//
+
+		OcclusionBuffer& operator = (const OcclusionBuffer& buffer);
+
+		//--------------------------------------------------------------------------
+		// Accessors
+		//
+
+		uint_t width() const
+		{
+			return mWidth;
+		}
+
+		uint_t height() const
+		{
+			return mHeight;
+		}
+
+		const Matrix& view_projection() const
+		{
+			return mViewProjection;
+		}
+
+		// Pixels are counted from the top left of the screen
+		float depth(uint_t x, uint_t y) const;
+
+		//--------------------------------------------------------------------------
+		// Occluders
+		//
+		// Occluders are sampled at pixel centers, as a GPU would draw them, and the depth written to a pixel is
+		// the farthest the occluder's triangle can be within that pixel. Sampling at centers keeps the triangles
+		// of a face from leaving gaps between them, at the cost of an occludee showing by less than a pixel past
+		// an occluder's edge sometimes being hidden.
+		//
+
+		// Clears the depths and any occluders that were not rasterized
+		void begin(const Matrix& view_projection);
+
+		void add_occluder(const BoundingBox& box);
+		void add_occluder(const Triangle& triangle);
+
+		// Each three indices make a triangle, so index_count must be a multiple of three
+		void add_occluders(const Vector3* vertices, size_t vertex_count, const uint_t* indices, size_t index_count);
+
+		// A thread_count of 0 uses all hardware threads, with the tiles shared between the threads
+		void rasterize(uint_t thread_count = 1);
+
+		//--------------------------------------------------------------------------
+		// Occludees
+		//
+		// The object is projected to a screen rectangle covering every pixel it touches, and is hidden when
+		// each of those pixels has an occluder nearer than the nearest point of the object. Objects crossing
+		// the near plane are always visible, and objects outside the screen are not.
+		//
+
+		bool is_visible(const BoundingBox& box) const;
+
+		// Tested as the box around the sphere
+		bool is_visible(const BoundingSphere& sphere) const;
+
+		// A thread_count of 0 uses all hardware threads, large inputs are split between the threads
+		void is_visible(const SoaView<BoundingBox>& boxes, bool* visible, uint_t thread_count = 1) const;
+
+	private:
+		void add_triangle(FXMVECTOR a, FXMVECTOR b, FXMVECTOR c);
+
+		void add_screen_triangle(const XMFLOAT4A* vertices);
+
+		void rasterize_tile(uint_t tile);
+
+		bool is_rectangle_visible(float min_x, float min_y, float max_x, float max_y, float min_depth) const;
+	};
+
+} // namespace Math
+
+#endif // __MATHS_OCCLUSIONBUFFER_HPP__
@@ -0,0 +1,194 @@
+#include "Precompiled.hpp"
+#include "OrientedBox.hpp"
+#include "Matrix.hpp"
+
+namespace
+{
+	const uint_t JACOBI_MAX_SWEEPS = 16;
+
+	// Eigen decomposition of a symmetric 3x3 matrix with cyclic Jacobi rotations.
+	// On return the diagonal of a holds the eigenvalues and the columns of v the eigenvectors.
+	void jacobi_eigen(float a[3][3], float v[3][3])
+	{
+		for (uint_t i = 0; i < 3; ++i)
+		{
+			for (uint_t j = 0; j < 3; ++j)
+			{
+				v[i][j] = (i == j) ? 1.0f : 0.0f;
+			}
+		}
+
+		for (uint_t sweep = 0; sweep < JACOBI_MAX_SWEEPS; ++sweep)
+		{
+			const float off_diagonal = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+			if (off_diagonal <= FLT_EPSILON * FLT_EPSILON) break;
+
+			for (uint_t p = 0; p < 2; ++p)
+			{
+				for (uint_t q = p + 1; q < 3; ++q)
+				{
+					if (std::abs(a[p][q]) <= FLT_MIN) continue;
+
+					// Rotation angle that zeroes a[p][q], from Numerical Recipes
+					const float theta = (a[q][q] - a[p][p]) / (2.0f * a[p][q]);
+					const float t = (theta >= 0.0f ? 1.0f : -1.0f) / (std::abs(theta) + std::sqrt(theta * theta + 1.0f));
+					const float c = 1.0f / std::sqrt(t * t + 1.0f);
+					const float s = t * c;
+
+					for (uint_t k = 0; k < 3; ++k)
+					{
+						const float akp = a[k][p];
+						const float akq = a[k][q];
+						a[k][p] = c * akp - s * akq;
+						a[k][q] = s * akp + c * akq;
+					}
+					for (uint_t k = 0; k < 3; ++k)
+					{
+						const float apk = a[p][k];
+						const float aqk = a[q][k];
+						a[p][k] = c * apk - s * aqk;
+						a[q][k] = s * apk + c * aqk;
+					}
+					for (uint_t k = 0; k < 3; ++k)
+					{
+						const float vkp = v[k][p];
+						const float vkq = v[k][q];
+						v[k][p] = c * vkp - s * vkq;
+						v[k][q] = s * vkp + c * vkq;
+					}
+				}
+			}
+		}
+	}
+}
+
+namespace Math
+{
+	OrientedBox::OrientedBox(const BoundingBox& box) :
+		mCenter(Vector3::lerp(box.minimum_corner(), box.maximum_corner(), 0.5f)),
+		mExtents((box.maximum_corner() - box.minimum_corner()) * 0.5f)
+	{
+	}
+
+	bool OrientedBox::contains(const Vector3& point) const
+	{
+		// Rotate the point into the box's space where it is axis aligned
+		const XMVECTOR local = XMVector3Rotate(XMVectorSubtract(point, mCenter), XMQuaternionConjugate(mOrientation));
+		return XMVector3InBounds(local, mExtents) == TRUE;
+	}
+
+	Matrix OrientedBox::rotation_matrix() const
+	{
+		return Matrix::rotation_quaternion(mOrientation);
+	}
+
+	Vector3 OrientedBox::get_corner(BoxCorner corner) const
+	{
+		const float x = (corner & 1) ? mExtents.x : -mExtents.x;
+		const float y = (corner & 2) ? mExtents.y : -mExtents.y;
+		const float z = (corner & 4) ? mExtents.z : -mExtents.z;
+		return Vector3(XMVectorAdd(XMVector3Rotate(XMVectorSet(x, y, z, 0.0f), mOrientation), mCenter));
+	}
+
+	OrientedBox::CornerArray OrientedBox::get_all_corners() const
+	{
+		const Matrix rotation = rotation_matrix();
+		CornerArray result;
+
+		for (uint_t corner = 0; corner < result.size(); ++corner)
+		{
+			const float x = (corner & 1) ? mExtents.x : -mExtents.x;
+			const float y = (corner & 2) ? mExtents.y : -mExtents.y;
+			const float z = (corner & 4) ? mExtents.z : -mExtents.z;
+			result[corner] = XMVectorAdd(XMVector3TransformNormal(XMVectorSet(x, y, z, 0.0f), rotation), mCenter);
+		}
+
+		return result;
+	}
+
+	BoundingBox OrientedBox::get_bounding_box() const
+	{
+		// Each world axis is covered by the extents projected onto it through the absolute rotation
+		const Matrix rotation = rotation_matrix();
+		const Matrix absolute(XMVectorAbs(rotation.r[0]), XMVectorAbs(rotation.r[1]), XMVectorAbs(rotation.r[2]), XMVectorZero());
+		const XMVECTOR extents = XMVector3TransformNormal(mExtents, absolute);
+		return BoundingBox(Vector3(XMVectorSubtract(mCenter, extents)), Vector3(XMVectorAdd(mCenter, extents)), ALREADY_SORTED);
+	}
+
+	OrientedBox OrientedBox::transform(const Matrix& matrix) const
+	{
+		// Transform the scaled box axes, their new lengths give the new extents and their directions the new orientation
+		const Matrix rotation = rotation_matrix();
+		XMVECTOR axes[3];
+		XMVECTOR lengths[3];
+
+		for (uint_t i = 0; i < 3; ++i)
+		{
+			axes[i] = XMVector3TransformNormal(rotation.r[i], matrix);
+			lengths[i] = XMVector3Length(axes[i]);
+		}
+
+		// Gram-Schmidt to remove any drift so the rotation stays orthonormal
+		const XMVECTOR x = XMVector3Normalize(axes[0]);
+		const XMVECTOR y = XMVector3Normalize(XMVectorSubtract(axes[1], XMVectorMultiply(x, XMVector3Dot(axes[1], x))));
+		const XMVECTOR z = XMVector3Cross(x, y);
+		const Matrix orientation(x, y, z, XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f));
+
+		const Vector3 extents(mExtents.x * XMVectorGetX(lengths[0]), mExtents.y * XMVectorGetX(lengths[1]), mExtents.z * XMVectorGetX(lengths[2]));
+		return OrientedBox(matrix.transform(mCenter), extents, Quaternion(XMQuaternionRotationMatrix(orientation)));
+	}
+
+	OrientedBox OrientedBox::compute_from_points(const Vector3* points, size_t count)
+	{
+		if (count == 0) return OrientedBox();
+
+		// Mean and covariance of the points
+		XMVECTOR sum = XMVectorZero();
+		for (size_t i = 0; i < count; ++i)
+		{
+			sum = XMVectorAdd(sum, points[i]);
+		}
+		const XMVECTOR mean = XMVectorScale(sum, 1.0f / static_cast<float>(count));
+
+		XMVECTOR diagonal = XMVectorZero(); // xx, yy, zz
+		XMVECTOR off_diagonal = XMVectorZero(); // xy, xz, yz
+		for (size_t i = 0; i < count; ++i)
+		{
+			const XMVECTOR offset = XMVectorSubtract(points[i], mean);
+			diagonal = XMVectorMultiplyAdd(offset, offset, diagonal);
+			off_diagonal = XMVectorMultiplyAdd(XMVectorSwizzle(offset, 0, 0, 1, 3), XMVectorSwizzle(offset, 1, 2, 2, 3), off_diagonal);
+		}
+
+		float covariance[3][3] =
+		{
+			{ XMVectorGetX(diagonal), XMVectorGetX(off_diagonal), XMVectorGetY(off_diagonal) },
+			{ XMVectorGetX(off_diagonal), XMVectorGetY(diagonal), XMVectorGetZ(off_diagonal) },
+			{ XMVectorGetY(off_diagonal), XMVectorGetZ(off_diagonal), XMVectorGetZ(diagonal) }
+		};
+		float eigenvectors[3][3];
+		jacobi_eigen(covariance, eigenvectors);
+
+		// The eigenvectors are the columns, make a right handed rotation whose rows are the box axes
+		const XMVECTOR x = XMVector3Normalize(XMVectorSet(eigenvectors[0][0], eigenvectors[1][0], eigenvectors[2][0], 0.0f));
+		const XMVECTOR y = XMVector3Normalize(XMVectorSet(eigenvectors[0][1], eigenvectors[1][1], eigenvectors[2][1], 0.0f));
+		const XMVECTOR z = XMVector3Cross(x, y);
+		const Matrix rotation(x, y, z, XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f));
+		const Matrix inverse_rotation = rotation.transpose();
+
+		// Bounds of the points along the axes
+		XMVECTOR minimum = XMVectorSplatInfinity();
+		XMVECTOR maximum = XMVectorNegate(minimum);
+		for (size_t i = 0; i < count; ++i)
+		{
+			const XMVECTOR local = XMVector3TransformNormal(points[i], inverse_rotation);
+			minimum = XMVectorMin(minimum, local);
+			maximum = XMVectorMax(maximum, local);
+		}
+
+		const XMVECTOR local_center = XMVectorScale(XMVectorAdd(minimum, maximum), 0.5f);
+		const XMVECTOR extents = XMVectorScale(XMVectorSubtract(maximum, minimum), 0.5f);
+		const XMVECTOR center = XMVector3TransformNormal(local_center, rotation);
+		return OrientedBox(Vector3(center), Vector3(extents), Quaternion(XMQuaternionRotationMatrix(rotation)));
+	}
+
+} // namespace Math
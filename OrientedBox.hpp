@@ -0,0 +1,140 @@
+#pragma once
+#ifndef __MATHS_ORIENTEDBOX_HPP__
+#define __MATHS_ORIENTEDBOX_HPP__
+
+#include "Vector3.hpp"
+#include "Quaternion.hpp"
+#include "BoundingBox.hpp"
+
+#include <type_traits>
+#include <iterator>
+#include <vector>
+
+namespace Math
+{
+	class Matrix;
+
+	class OrientedBox
+	{
+	public:
+		typedef BoundingBox::BoxCorner BoxCorner;
+		typedef BoundingBox::CornerArray CornerArray;
+
+	private:
+		Vector3 mCenter;
+		Vector3 mExtents; // Half the size of the box along each of its axes
+		Quaternion mOrientation;
+
+	public:
+		//--------------------------------------------------------------------------
+		// Constructors
+		//
+
+		OrientedBox()
+		{
+		}
+
+		OrientedBox(const Vector3& center, const Vector3& extents, const Quaternion& orientation) :
+			mCenter(center),
+			mExtents(XMVectorAbs(extents)),
+			mOrientation(orientation)
+		{
+		}
+
+		explicit OrientedBox(const BoundingBox& box);
+
+		OrientedBox(const OrientedBox& box) : mCenter(box.mCenter), mExtents(box.mExtents), mOrientation(box.mOrientation)
+		{
+		}
+
+		//--------------------------------------------------------------------------
+		// Assignment
+		//
+
+		OrientedBox& operator = (const OrientedBox& box)
+		{
+			mCenter = box.mCenter;
+			mExtents = box.mExtents;
+			mOrientation = box.mOrientation;
+			return *this;
+		}
+
+		//--------------------------------------------------------------------------
+		// Comparison
+		//
+
+		bool operator == (const OrientedBox& box) const
+		{
+			return mCenter == box.mCenter && mExtents == box.mExtents && mOrientation == box.mOrientation;
+		}
+
+		bool operator != (const OrientedBox& box) const
+		{
+			return mCenter != box.mCenter || mExtents != box.mExtents || mOrientation != box.mOrientation;
+		}
+
+		bool contains(const Vector3& point) const;
+
+		bool is_empty() const
+		{
+			return mExtents == Vector3::ZERO;
+		}
+
+		//--------------------------------------------------------------------------
+		// Accessors
+		//
+
+		void set(const Vector3& center, const Vector3& extents, const Quaternion& orientation)
+		{
+			mCenter = center;
+			mExtents = XMVectorAbs(extents);
+			mOrientation = orientation;
+		}
+
+		const Vector3& center() const
+		{
+			return mCenter;
+		}
+
+		const Vector3& extents() const
+		{
+			return mExtents;
+		}
+
+		const Quaternion& orientation() const
+		{
+			return mOrientation;
+		}
+
+		// The rows are the box axes in world space
+		Matrix rotation_matrix() const;
+
+		Vector3 get_corner(BoxCorner corner) const;
+
+		CornerArray get_all_corners() const;
+
+		// The smallest axis aligned box containing this box
+		BoundingBox get_bounding_box() const;
+
+		//--------------------------------------------------------------------------
+		// Computation
+		//
+
+		// Assumes the matrix has no shear, non-uniform scale is applied along the box axes
+		OrientedBox transform(const Matrix& matrix) const;
+
+		// Fits the box to the principal axes of the points
+		static OrientedBox compute_from_points(const Vector3* points, size_t count);
+
+		template <class Iterator>
+		typename std::enable_if<std::is_same<typename std::iterator_traits<Iterator>::value_type, Vector3>::value, OrientedBox>::type
+			static compute_from_points(Iterator begin, Iterator end)
+		{
+			const std::vector<Vector3> points(begin, end);
+			return compute_from_points(points.data(), points.size());
+		}
+	};
+
+} // namespace Math
+
+#endif // __MATHS_ORIENTEDBOX_HPP__
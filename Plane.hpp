@@ -4,9 +4,13 @@
 
 #include "Vector3.hpp"
 #include "Vector4.hpp"
+#include "Trusted.hpp"
+#include "Precision.hpp"
 
 namespace Math
 {
+	template <class Type> struct SoaTraits;
+
 	class Plane : public XMFLOAT4A
 	{
 	public:
@@ -23,6 +27,11 @@ namespace Math
 			XMStoreFloat4A(this, XMPlaneNormalize(XMVectorSet(x, y, z, w)));
 		}
 
+		Plane(float x, float y, float z, float w, AlreadyNormalised) : XMFLOAT4A(x, y, z, w)
+		{
+			XMASSERT(is_normalised());
+		}
+
 		Plane(const Vector3& point, const Vector3& normal)
 		{
 			// ASSUME normal is normalised
@@ -44,6 +53,23 @@ namespace Math
 			XMStoreFloat4A(this, XMPlaneNormalize(v));
 		}
 
+		// Normalised with the normal's length from the FAST reciprocal square root
+		Plane(FXMVECTOR v, Precision::Fast)
+		{
+			set(v, Precision::FAST);
+		}
+
+		Plane(FXMVECTOR v, Precision::Precise)
+		{
+			set(v);
+		}
+
+		Plane(FXMVECTOR v, AlreadyNormalised)
+		{
+			XMStoreFloat4A(this, v);
+			XMASSERT(is_normalised());
+		}
+
 		Plane(const Plane& p) : XMFLOAT4A(p)
 		{
 		}
@@ -80,14 +106,44 @@ namespace Math
 		// Comparison
 		//
 
-		bool operator == (const Plane& plane)
+		bool operator == (const Plane& plane) const
 		{
 			return x == plane.x && y == plane.y && z == plane.z && w == plane.w;
 		}
 
-		bool operator != (const Plane& plane)
+		bool operator != (const Plane& plane) const
+		{
+			return x != plane.x || y != plane.y || z != plane.z || w != plane.w;
+		}
+
+		bool is_normalised() const
 		{
-			return x != plane.x && y != plane.y && z != plane.z && w != plane.w;
+			return std::abs(XMVectorGetX(XMVector3LengthSq(*this)) - 1.0f) <= UNIT_LENGTH_TOLERANCE;
+		}
+
+		//--------------------------------------------------------------------------
+		// Accessors
+		//
+
+		void set(FXMVECTOR v)
+		{
+			XMStoreFloat4A(this, XMPlaneNormalize(v));
+		}
+
+		void set(FXMVECTOR v, AlreadyNormalised)
+		{
+			XMStoreFloat4A(this, v);
+			XMASSERT(is_normalised());
+		}
+
+		void set(FXMVECTOR v, Precision::Fast)
+		{
+			XMStoreFloat4A(this, XMVectorMultiply(v, reciprocal_length(XMVector3LengthSq(v), Precision::FAST)));
+		}
+
+		void set(FXMVECTOR v, Precision::Precise)
+		{
+			set(v);
 		}
 
 		//--------------------------------------------------------------------------
@@ -111,6 +167,39 @@ namespace Math
 		static const Plane YZ_PLANE;
 	};
 
+	// Component layout of an SoaArray<Plane>
+	template <> struct SoaTraits<Plane>
+	{
+		enum Component : uint_t
+		{
+			NORMAL_X,
+			NORMAL_Y,
+			NORMAL_Z,
+			DISTANCE,
+
+			COMPONENT_COUNT
+		};
+
+		static void scatter(const Plane& plane, float* components)
+		{
+			components[NORMAL_X] = plane.x;
+			components[NORMAL_Y] = plane.y;
+			components[NORMAL_Z] = plane.z;
+			components[DISTANCE] = plane.w;
+		}
+
+		static Plane gather(const float* components)
+		{
+			// The planes were normalised when they were stored, so skip the normalising constructors
+			Plane plane;
+			plane.x = components[NORMAL_X];
+			plane.y = components[NORMAL_Y];
+			plane.z = components[NORMAL_Z];
+			plane.w = components[DISTANCE];
+			return plane;
+		}
+	};
+
 } // namespace Math
 
 #endif // __MATHS_PLANE_HPP__
@@ -0,0 +1,76 @@
+#pragma once
+#ifndef __MATHS_PRECISION_HPP__
+#define __MATHS_PRECISION_HPP__
+
+namespace Math
+{
+	//--------------------------------------------------------------------------
+	// Precision Tags
+	//
+	// Passed to length, normalise and the normalising constructors to choose how the
+	// square root or reciprocal is taken. PRECISE is the full precision square root and
+	// divide used when no tag is given. FAST starts from the hardware estimate (rsqrtps or
+	// rcpps, relative error at most 1.5 * 2^-12) and refines it with one Newton-Raphson
+	// step, which leaves a relative error below 1e-6, a few ulp, wherever the input and
+	// the result are normal floats. Tests/PrecisionTest.cpp checks the bound.
+	//
+
+	namespace Precision
+	{
+		struct Fast
+		{
+		};
+
+		struct Precise
+		{
+		};
+
+		static const Fast FAST = Fast();
+		static const Precise PRECISE = Precise();
+
+	} // namespace Precision
+
+	// 1 / v in each lane
+	inline XMVECTOR reciprocal(FXMVECTOR v, Precision::Precise)
+	{
+		return XMVectorReciprocal(v);
+	}
+
+	inline XMVECTOR reciprocal(FXMVECTOR v, Precision::Fast)
+	{
+		// y' = y (2 - v y)
+		const XMVECTOR estimate = XMVectorReciprocalEst(v);
+		return XMVectorMultiply(estimate, XMVectorNegativeMultiplySubtract(v, estimate, XMVectorReplicate(2.0f)));
+	}
+
+	// 1 / sqrt(length_squared) in each lane, as the scale that normalises a vector of that squared length.
+	// A zero vector is given zero so that it stays zero, and so is a vector too short for its squared length
+	// to be a normal float (shorter than about 1e-19), which the estimate would take to be zero.
+	inline XMVECTOR reciprocal_length(FXMVECTOR length_squared, Precision::Precise)
+	{
+		return XMVectorSelect(XMVectorZero(), XMVectorReciprocalSqrt(length_squared), XMVectorGreater(length_squared, XMVectorZero()));
+	}
+
+	inline XMVECTOR reciprocal_length(FXMVECTOR length_squared, Precision::Fast)
+	{
+		// y' = y (3 - v y^2) / 2
+		const XMVECTOR estimate = XMVectorReciprocalSqrtEst(length_squared);
+		const XMVECTOR half_length_squared = XMVectorMultiply(length_squared, XMVectorReplicate(0.5f));
+		const XMVECTOR step = XMVectorNegativeMultiplySubtract(half_length_squared, XMVectorMultiply(estimate, estimate), XMVectorReplicate(1.5f));
+		return XMVectorSelect(XMVectorZero(), XMVectorMultiply(estimate, step), XMVectorGreaterOrEqual(length_squared, XMVectorReplicate(FLT_MIN)));
+	}
+
+	// sqrt(length_squared) in each lane, as v * (1 / sqrt(v)) for FAST
+	inline XMVECTOR length_from_squared(FXMVECTOR length_squared, Precision::Precise)
+	{
+		return XMVectorSqrt(length_squared);
+	}
+
+	inline XMVECTOR length_from_squared(FXMVECTOR length_squared, Precision::Fast)
+	{
+		return XMVectorMultiply(length_squared, reciprocal_length(length_squared, Precision::FAST));
+	}
+
+} // namespace Math
+
+#endif // __MATHS_PRECISION_HPP__
@@ -1,5 +1,48 @@
 #include "Precompiled.hpp"
 #include "Quaternion.hpp"
+#include "ArrayView.hpp"
+#include "SoaArray.hpp"
+#include "SoaVector3.hpp"
+#include "Transcendental.hpp"
+
+namespace
+{
+	typedef Math::SoaTraits<Math::Vector3> Traits;
+
+	// Four values from first, repeating the last value past the end
+	XMVECTOR load_lanes(const Math::ArrayView<float>& values, size_t first)
+	{
+		if (values.size() - first >= Math::SOA_LANE_COUNT)
+		{
+			return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(values.data() + first));
+		}
+
+		XMVECTORF32 lanes;
+		for (uint_t lane = 0; lane < Math::SOA_LANE_COUNT; ++lane)
+		{
+			lanes.f[lane] = values[std::min(first + lane, values.size() - 1)];
+		}
+		return lanes.v;
+	}
+
+	// Writes the first lane_count of four quaternions held a component to a register
+	void store_lanes(FXMVECTOR x, FXMVECTOR y, FXMVECTOR z, CXMVECTOR w, uint_t lane_count, Math::Quaternion* quaternions)
+	{
+		XMVECTORF32 x_lanes;
+		XMVECTORF32 y_lanes;
+		XMVECTORF32 z_lanes;
+		XMVECTORF32 w_lanes;
+		x_lanes.v = x;
+		y_lanes.v = y;
+		z_lanes.v = z;
+		w_lanes.v = w;
+
+		for (uint_t lane = 0; lane < lane_count; ++lane)
+		{
+			quaternions[lane] = Math::Quaternion(x_lanes.f[lane], y_lanes.f[lane], z_lanes.f[lane], w_lanes.f[lane]);
+		}
+	}
+}
 
 
 namespace Math
@@ -12,4 +55,50 @@ namespace Math
 		XMVECTOR self = *this;
 		return Vector3(XMQuaternionMultiply(XMQuaternionMultiply(self, vector), XMQuaternionConjugate(self)));
 	}
+
+	void Quaternion::from_yaw_pitch_roll(const ArrayView<float>& yaws, const ArrayView<float>& pitches, const ArrayView<float>& rolls, Quaternion* quaternions)
+	{
+		XMASSERT(pitches.size() == yaws.size() && rolls.size() == yaws.size());
+
+		const XMVECTOR half = XMVectorReplicate(0.5f);
+		for (size_t first = 0; first < yaws.size(); first += SOA_LANE_COUNT)
+		{
+			XMVECTOR sy, cy, sp, cp, sr, cr;
+			Transcendental::sin_cos(XMVectorMultiply(::load_lanes(yaws, first), half), &sy, &cy);
+			Transcendental::sin_cos(XMVectorMultiply(::load_lanes(pitches, first), half), &sp, &cp);
+			Transcendental::sin_cos(XMVectorMultiply(::load_lanes(rolls, first), half), &sr, &cr);
+
+			// As XMQuaternionRotationRollPitchYaw, rolling then pitching then yawing
+			const XMVECTOR cy_cr = XMVectorMultiply(cy, cr);
+			const XMVECTOR sy_sr = XMVectorMultiply(sy, sr);
+			const XMVECTOR sy_cr = XMVectorMultiply(sy, cr);
+			const XMVECTOR cy_sr = XMVectorMultiply(cy, sr);
+			const XMVECTOR x = XMVectorMultiplyAdd(sp, cy_cr, XMVectorMultiply(cp, sy_sr));
+			const XMVECTOR y = XMVectorNegativeMultiplySubtract(sp, cy_sr, XMVectorMultiply(cp, sy_cr));
+			const XMVECTOR z = XMVectorNegativeMultiplySubtract(sp, sy_cr, XMVectorMultiply(cp, cy_sr));
+			const XMVECTOR w = XMVectorMultiplyAdd(sp, sy_sr, XMVectorMultiply(cp, cy_cr));
+
+			const uint_t lane_count = static_cast<uint_t>(std::min<size_t>(SOA_LANE_COUNT, yaws.size() - first));
+			::store_lanes(x, y, z, w, lane_count, quaternions + first);
+		}
+	}
+
+	void Quaternion::from_axis_angle(const SoaView<Vector3>& axes, const ArrayView<float>& angles, Quaternion* quaternions)
+	{
+		XMASSERT(angles.size() == axes.size());
+
+		const XMVECTOR half = XMVectorReplicate(0.5f);
+		for (size_t block = 0; block < axes.block_count(); ++block)
+		{
+			const SoaBlock<Vector3> axis = axes.load_block(block);
+			const SoaVector3 direction = soa_vector3(axis[::Traits::X], axis[::Traits::Y], axis[::Traits::Z]);
+
+			const size_t first = block * SOA_LANE_COUNT;
+			XMVECTOR sine, cosine;
+			Transcendental::sin_cos(XMVectorMultiply(::load_lanes(angles, first), half), &sine, &cosine);
+
+			const XMVECTOR scale = XMVectorMultiply(sine, reciprocal_length(soa_length_squared(direction), Precision::PRECISE));
+			::store_lanes(XMVectorMultiply(direction.x, scale), XMVectorMultiply(direction.y, scale), XMVectorMultiply(direction.z, scale), cosine, axes.lane_count(block), quaternions + first);
+		}
+	}
 }
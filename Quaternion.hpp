@@ -4,9 +4,12 @@
 
 #include "Vector3.hpp"
 #include "Vector4.hpp"
+#include "Precision.hpp"
 
 namespace Math
 {
+	template <class Type> class SoaView;
+	template <class Type> class ArrayView;
 
 	class Quaternion : public XMFLOAT4A
 	{
@@ -124,6 +127,16 @@ namespace Math
 			return XMVectorGetX(XMQuaternionLength(*this));
 		}
 
+		float length(Precision::Fast) const
+		{
+			return XMVectorGetX(length_from_squared(XMQuaternionLengthSq(*this), Precision::FAST));
+		}
+
+		float length(Precision::Precise) const
+		{
+			return length();
+		}
+
 		float length_squared() const
 		{
 			return XMVectorGetX(XMQuaternionLengthSq(*this));
@@ -134,6 +147,16 @@ namespace Math
 			XMStoreFloat4A(this, XMQuaternionNormalize(*this));
 		}
 
+		void normalise(Precision::Fast)
+		{
+			XMStoreFloat4A(this, XMVectorMultiply(*this, reciprocal_length(XMQuaternionLengthSq(*this), Precision::FAST)));
+		}
+
+		void normalise(Precision::Precise)
+		{
+			normalise();
+		}
+
 		Quaternion conjugate() const
 		{
 			return Quaternion(XMQuaternionConjugate(*this));
@@ -161,6 +184,18 @@ namespace Math
 
 		Vector3 transform(const Vector3& v) const;
 
+		//--------------------------------------------------------------------------
+		// Batch Construction
+		//
+		// A quaternion for every element of the inputs, as the constructors make one, with four at a time
+		// sharing the sines and cosines of Transcendental::sin_cos. The inputs must be as long as each other.
+		//
+
+		static void from_yaw_pitch_roll(const ArrayView<float>& yaws, const ArrayView<float>& pitches, const ArrayView<float>& rolls, Quaternion* quaternions);
+
+		// The axes need not be normalised
+		static void from_axis_angle(const SoaView<Vector3>& axes, const ArrayView<float>& angles, Quaternion* quaternions);
+
 		//--------------------------------------------------------------------------
 		// Constants
 		//
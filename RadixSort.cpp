@@ -0,0 +1,140 @@
+#include "Precompiled.hpp"
+#include "RadixSort.hpp"
+
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	const uint_t DIGIT_BITS = 8;
+	const uint_t DIGIT_COUNT = 1 << DIGIT_BITS;
+	const uint_t DIGIT_MASK = DIGIT_COUNT - 1;
+
+	// Fewer keys than this are not worth starting a thread for
+	const size_t MINIMUM_KEYS_PER_THREAD = 64 * 1024;
+
+	uint_t thread_total(uint_t thread_count)
+	{
+		return (thread_count == 0) ? std::max(std::thread::hardware_concurrency(), 1u) : thread_count;
+	}
+
+	// Calls function(index, first, last) for each range of [0, count), concurrently when there is more than one
+	template <class Function>
+	void for_each_range(size_t count, size_t range, Function function)
+	{
+		std::vector<std::future<void>> results;
+		for (size_t first = range; first < count; first += range)
+		{
+			results.push_back(std::async(std::launch::async, function, first / range, first, std::min(first + range, count)));
+		}
+
+		// This thread does the first range while waiting for the others
+		function(0, 0, std::min(range, count));
+		for (auto& result : results)
+		{
+			result.get();
+		}
+	}
+
+	// Sorts keys of any unsigned integer type
+	template <class Key>
+	void sort_keys(Key* keys, uint_t* payloads, size_t count, Key* key_scratch, uint_t* payload_scratch, uint_t thread_count)
+	{
+		if (count < 2) return;
+
+		const size_t useful_threads = std::max<size_t>(count / MINIMUM_KEYS_PER_THREAD, 1);
+		const size_t threads = std::min<size_t>(::thread_total(thread_count), useful_threads);
+		const size_t range = (count + threads - 1) / threads;
+		const size_t range_count = (count + range - 1) / range;
+
+		// The bits that differ from the first key in any key, so digits that are the same everywhere are skipped
+		std::vector<Key> differences(range_count, 0);
+		::for_each_range(count, range, [keys, &differences](size_t index, size_t first, size_t last)
+		{
+			Key difference = 0;
+			for (size_t i = first; i < last; ++i)
+			{
+				difference |= keys[i] ^ keys[0];
+			}
+			differences[index] = difference;
+		});
+
+		Key difference = 0;
+		for (Key range_difference : differences)
+		{
+			difference |= range_difference;
+		}
+
+		// A row of digit counts per range, turned into where that range writes each digit before scattering
+		std::vector<size_t> offsets(range_count * DIGIT_COUNT, 0);
+
+		Key* source_keys = keys;
+		uint_t* source_payloads = payloads;
+		Key* destination_keys = key_scratch;
+		uint_t* destination_payloads = payload_scratch;
+
+		for (uint_t shift = 0; shift < sizeof(Key) * 8; shift += DIGIT_BITS)
+		{
+			if (((difference >> shift) & DIGIT_MASK) == 0) continue;
+
+			::for_each_range(count, range, [source_keys, shift, &offsets](size_t index, size_t first, size_t last)
+			{
+				size_t* digit_counts = &offsets[index * DIGIT_COUNT];
+				std::fill(digit_counts, digit_counts + DIGIT_COUNT, 0);
+				for (size_t i = first; i < last; ++i)
+				{
+					++digit_counts[(source_keys[i] >> shift) & DIGIT_MASK];
+				}
+			});
+
+			// Each digit's keys go after every smaller digit, and within a digit the ranges go in order so the
+			// sort stays stable
+			size_t total = 0;
+			for (uint_t digit = 0; digit < DIGIT_COUNT; ++digit)
+			{
+				for (size_t index = 0; index < range_count; ++index)
+				{
+					const size_t digit_count = offsets[index * DIGIT_COUNT + digit];
+					offsets[index * DIGIT_COUNT + digit] = total;
+					total += digit_count;
+				}
+			}
+
+			::for_each_range(count, range, [=, &offsets](size_t index, size_t first, size_t last)
+			{
+				size_t* digit_offsets = &offsets[index * DIGIT_COUNT];
+				for (size_t i = first; i < last; ++i)
+				{
+					const size_t destination = digit_offsets[(source_keys[i] >> shift) & DIGIT_MASK]++;
+					destination_keys[destination] = source_keys[i];
+					destination_payloads[destination] = source_payloads[i];
+				}
+			});
+
+			std::swap(source_keys, destination_keys);
+			std::swap(source_payloads, destination_payloads);
+		}
+
+		if (source_keys != keys)
+		{
+			std::copy(source_keys, source_keys + count, keys);
+			std::copy(source_payloads, source_payloads + count, payloads);
+		}
+	}
+}
+
+namespace Math
+{
+
+	void radix_sort(uint32_t* keys, uint_t* payloads, size_t count, uint32_t* key_scratch, uint_t* payload_scratch, uint_t thread_count)
+	{
+		::sort_keys(keys, payloads, count, key_scratch, payload_scratch, thread_count);
+	}
+
+	void radix_sort(uint64_t* keys, uint_t* payloads, size_t count, uint64_t* key_scratch, uint_t* payload_scratch, uint_t thread_count)
+	{
+		::sort_keys(keys, payloads, count, key_scratch, payload_scratch, thread_count);
+	}
+
+} // namespace Math
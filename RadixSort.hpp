@@ -0,0 +1,19 @@
+#pragma once
+#ifndef __MATHS_RADIXSORT_HPP__
+#define __MATHS_RADIXSORT_HPP__
+
+namespace Math
+{
+	// Least significant digit first radix sort of keys into increasing order, moving each payload (such as the
+	// index of the object the key was made for) along with its key. Equal keys keep their order.
+	//
+	// The keys are sorted a byte at a time, and bytes that are the same in every key are skipped, so keys that
+	// only use their low bits cost fewer passes. The scratch arrays must hold count elements, and the sorted
+	// keys and payloads end up back in the keys and payloads arrays. A thread_count of 0 uses all hardware
+	// threads, large inputs are split between the threads.
+	void radix_sort(uint32_t* keys, uint_t* payloads, size_t count, uint32_t* key_scratch, uint_t* payload_scratch, uint_t thread_count = 1);
+	void radix_sort(uint64_t* keys, uint_t* payloads, size_t count, uint64_t* key_scratch, uint_t* payload_scratch, uint_t thread_count = 1);
+
+} // namespace Math
+
+#endif // __MATHS_RADIXSORT_HPP__
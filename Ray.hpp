@@ -3,6 +3,7 @@
 #define __MATHS_RAY_HPP__
 
 #include "Vector3.hpp"
+#include "Trusted.hpp"
 
 namespace Math
 {
@@ -26,6 +27,13 @@ namespace Math
 			mDirection.normalise();
 		}
 
+		Ray(const Vector3& origin, const Vector3& direction, AlreadyNormalised) :
+			mOrigin(origin),
+			mDirection(direction)
+		{
+			XMASSERT(std::abs(mDirection.length_squared() - 1.0f) <= UNIT_LENGTH_TOLERANCE);
+		}
+
 		Ray(const Ray& ray) :
 			mOrigin(ray.mOrigin),
 			mDirection(ray.mDirection)
@@ -85,6 +93,12 @@ namespace Math
 			mDirection.normalise();
 		}
 
+		void direction(const Vector3& d, AlreadyNormalised)
+		{
+			XMASSERT(std::abs(d.length_squared() - 1.0f) <= UNIT_LENGTH_TOLERANCE);
+			mDirection = d;
+		}
+
 		const Vector3& direction() const
 		{
 			return mDirection;
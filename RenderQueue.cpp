@@ -0,0 +1,205 @@
+#include "Precompiled.hpp"
+#include "RenderQueue.hpp"
+#include "RadixSort.hpp"
+#include "Matrix.hpp"
+#include "BoundingBox.hpp"
+#include "BoundingSphere.hpp"
+#include "Frustum.hpp"
+#include "SoaArray.hpp"
+
+#include <cstring>
+#include <future>
+#include <thread>
+
+namespace
+{
+	// Fewer objects than this are not worth starting a thread for
+	const size_t MINIMUM_OBJECTS_PER_THREAD = 16 * 1024;
+
+	typedef XMVECTOR PlaneLanes[Math::Frustum::FRUSTUM_PLANE_COUNT][4];
+
+	uint_t thread_total(uint_t thread_count)
+	{
+		return (thread_count == 0) ? std::max(std::thread::hardware_concurrency(), 1u) : thread_count;
+	}
+
+	// The sphere's center, and all lanes set where it is entirely behind one of the planes
+	XMVECTOR outside(const Math::SoaBlock<Math::BoundingSphere>& sphere, const PlaneLanes& planes, XMVECTOR* center)
+	{
+		typedef Math::SoaTraits<Math::BoundingSphere> Traits;
+
+		center[0] = sphere[Traits::CENTER_X];
+		center[1] = sphere[Traits::CENTER_Y];
+		center[2] = sphere[Traits::CENTER_Z];
+
+		const XMVECTOR negative_radius = XMVectorNegate(sphere[Traits::RADIUS]);
+		XMVECTOR result = XMVectorFalseInt();
+		for (uint_t plane = 0; plane < Math::Frustum::FRUSTUM_PLANE_COUNT; ++plane)
+		{
+			XMVECTOR distance = XMVectorMultiplyAdd(center[0], planes[plane][0], planes[plane][3]);
+			distance = XMVectorMultiplyAdd(center[1], planes[plane][1], distance);
+			distance = XMVectorMultiplyAdd(center[2], planes[plane][2], distance);
+			result = XMVectorOrInt(result, XMVectorLess(distance, negative_radius));
+		}
+		return result;
+	}
+
+	// A box is behind a plane when its corner farthest along the plane's normal is, which is the center's
+	// distance plus the extents projected onto the normal's absolute value
+	XMVECTOR outside(const Math::SoaBlock<Math::BoundingBox>& box, const PlaneLanes& planes, XMVECTOR* center)
+	{
+		typedef Math::SoaTraits<Math::BoundingBox> Traits;
+
+		const XMVECTOR half = XMVectorReplicate(0.5f);
+		XMVECTOR extents[3];
+		for (uint_t axis = 0; axis < 3; ++axis)
+		{
+			center[axis] = XMVectorMultiply(XMVectorAdd(box[Traits::MIN_X + axis], box[Traits::MAX_X + axis]), half);
+			extents[axis] = XMVectorMultiply(XMVectorSubtract(box[Traits::MAX_X + axis], box[Traits::MIN_X + axis]), half);
+		}
+
+		const XMVECTOR zero = XMVectorZero();
+		XMVECTOR result = XMVectorFalseInt();
+		for (uint_t plane = 0; plane < Math::Frustum::FRUSTUM_PLANE_COUNT; ++plane)
+		{
+			XMVECTOR distance = XMVectorMultiplyAdd(center[0], planes[plane][0], planes[plane][3]);
+			distance = XMVectorMultiplyAdd(center[1], planes[plane][1], distance);
+			distance = XMVectorMultiplyAdd(center[2], planes[plane][2], distance);
+			distance = XMVectorMultiplyAdd(extents[0], XMVectorAbs(planes[plane][0]), distance);
+			distance = XMVectorMultiplyAdd(extents[1], XMVectorAbs(planes[plane][1]), distance);
+			distance = XMVectorMultiplyAdd(extents[2], XMVectorAbs(planes[plane][2]), distance);
+			result = XMVectorOrInt(result, XMVectorLess(distance, zero));
+		}
+		return result;
+	}
+
+	// Culls the objects in the blocks [first_block, last_block) and writes the keys and indices of those left
+	// from the first object of the range onwards, returning how many were left.
+	//
+	// Every lane is written to the next free slot and the slot is only taken when the lane survives, so the
+	// survivors are packed together without a branch on each one. A slot is never past the lane's own object,
+	// so the writes stay inside the range.
+	template <class Bounds>
+	size_t cull_range(const Math::SoaView<Bounds>& bounds, size_t first_block, size_t last_block, const PlaneLanes& planes,
+		const XMVECTOR* view_z, XMVECTOR depth_flip, const uint_t* user_bits, uint64_t* keys, uint_t* indices)
+	{
+		const XMVECTOR zero = XMVectorZero();
+		const size_t first = first_block * Math::SOA_LANE_COUNT;
+		size_t cursor = first;
+
+		for (size_t block = first_block; block < last_block; ++block)
+		{
+			XMVECTOR center[3];
+			XMVECTORU32 culled_lanes;
+			culled_lanes.v = ::outside(bounds.load_block(block), planes, center);
+
+			// Non-negative floats order the same as their bits, and flipping every bit reverses the order
+			XMVECTOR depth = XMVectorMultiplyAdd(center[0], view_z[0], view_z[3]);
+			depth = XMVectorMultiplyAdd(center[1], view_z[1], depth);
+			depth = XMVectorMultiplyAdd(center[2], view_z[2], depth);
+			XMVECTORU32 depth_lanes;
+			depth_lanes.v = XMVectorXorInt(XMVectorMax(depth, zero), depth_flip);
+
+			const size_t index = block * Math::SOA_LANE_COUNT;
+			const uint_t lane_count = bounds.lane_count(block);
+			for (uint_t lane = 0; lane < lane_count; ++lane)
+			{
+				const uint64_t user = user_bits ? user_bits[index + lane] : 0;
+				keys[cursor] = (user << 32) | depth_lanes.u[lane];
+				indices[cursor] = static_cast<uint_t>(index + lane);
+				cursor += (~culled_lanes.u[lane]) & 1;
+			}
+		}
+
+		return cursor - first;
+	}
+}
+
+namespace Math
+{
+
+	void RenderQueue::build(const SoaView<BoundingSphere>& spheres, const Frustum& frustum, const Matrix& view, DepthOrder order,
+		const uint_t* user_bits, uint_t thread_count)
+	{
+		build_queue(spheres, frustum, view, order, user_bits, thread_count);
+	}
+
+	void RenderQueue::build(const SoaView<BoundingBox>& boxes, const Frustum& frustum, const Matrix& view, DepthOrder order,
+		const uint_t* user_bits, uint_t thread_count)
+	{
+		build_queue(boxes, frustum, view, order, user_bits, thread_count);
+	}
+
+	template <class Bounds>
+	void RenderQueue::build_queue(const SoaView<Bounds>& bounds, const Frustum& frustum, const Matrix& view, DepthOrder order,
+		const uint_t* user_bits, uint_t thread_count)
+	{
+		const size_t count = bounds.size();
+		if (mKeys.size() < count)
+		{
+			mKeys.resize(count);
+			mIndices.resize(count);
+		}
+
+		PlaneLanes planes;
+		for (uint_t plane = 0; plane < Frustum::FRUSTUM_PLANE_COUNT; ++plane)
+		{
+			const Plane& p = frustum.get_plane(static_cast<Frustum::FrustumPlane>(plane));
+			planes[plane][0] = XMVectorReplicate(p.x);
+			planes[plane][1] = XMVectorReplicate(p.y);
+			planes[plane][2] = XMVectorReplicate(p.z);
+			planes[plane][3] = XMVectorReplicate(p.w);
+		}
+
+		// Only the view space z is needed for the depth
+		XMVECTOR view_z[4];
+		for (uint_t row = 0; row < 4; ++row)
+		{
+			view_z[row] = XMVectorReplicate(view(row, 2));
+		}
+		const XMVECTOR depth_flip = (order == BACK_TO_FRONT) ? XMVectorTrueInt() : XMVectorZero();
+
+		const size_t block_count = bounds.block_count();
+		const size_t useful_threads = std::max<size_t>(count / MINIMUM_OBJECTS_PER_THREAD, 1);
+		const size_t threads = std::min<size_t>(::thread_total(thread_count), useful_threads);
+		const size_t range = (block_count + threads - 1) / threads;
+
+		uint64_t* keys = mKeys.data();
+		uint_t* indices = mIndices.data();
+		auto cull = [&, keys, indices](size_t first_block, size_t last_block)
+		{
+			return ::cull_range(bounds, first_block, last_block, planes, view_z, depth_flip, user_bits, keys, indices);
+		};
+
+		std::vector<std::future<size_t>> results;
+		for (size_t first = range; first < block_count; first += range)
+		{
+			results.push_back(std::async(std::launch::async, cull, first, std::min(first + range, block_count)));
+		}
+
+		// This thread does the first range while waiting for the others, then each range's survivors are moved
+		// down to follow the previous range's
+		mSize = cull(0, std::min(range, block_count));
+		for (size_t result = 0; result < results.size(); ++result)
+		{
+			const size_t first = (result + 1) * range * SOA_LANE_COUNT;
+			const size_t survivors = results[result].get();
+
+			// Nothing to move while every object so far has survived, and the ranges may overlap otherwise
+			if (mSize != first)
+			{
+				std::memmove(keys + mSize, keys + first, survivors * sizeof(uint64_t));
+				std::memmove(indices + mSize, indices + first, survivors * sizeof(uint_t));
+			}
+			mSize += survivors;
+		}
+
+		if (mKeyScratch.size() < mSize)
+		{
+			mKeyScratch.resize(mSize);
+			mIndexScratch.resize(mSize);
+		}
+		radix_sort(keys, indices, mSize, mKeyScratch.data(), mIndexScratch.data(), thread_count);
+	}
+
+} // namespace Math
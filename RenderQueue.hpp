@@ -0,0 +1,134 @@
+#pragma once
+#ifndef __MATHS_RENDERQUEUE_HPP__
+#define __MATHS_RENDERQUEUE_HPP__
+
+#include <vector>
+
+namespace Math
+{
+	class Matrix;
+	class BoundingBox;
+	class BoundingSphere;
+	class Frustum;
+
+	template <class Type> class SoaView;
+
+	// Sorted list of the objects to draw, built from their bounds in one call: the bounds are tested against
+	// the frustum, each object inside is given a 64 bit sort key, and the keys are sorted with the index of the
+	// object they belong to.
+	//
+	// A key holds the object's user bits (such as its layer, shader or material) in its high 32 bits and its
+	// depth in the low 32 bits, so objects are grouped by their user bits and then ordered by depth within a
+	// group. The depth is the view space z of the bounds' center, clamped to zero for centers behind the eye.
+	//
+	// The buffers are kept between builds, so a queue rebuilt every frame only allocates when it grows.
+	class RenderQueue
+	{
+	public:
+		enum DepthOrder
+		{
+			FRONT_TO_BACK, // For opaque objects, so nearer objects hide farther ones early
+			BACK_TO_FRONT  // For blended objects
+		};
+
+	private:
+		std::vector<uint64_t> mKeys;
+		std::vector<uint_t> mIndices;
+		std::vector<uint64_t> mKeyScratch;
+		std::vector<uint_t> mIndexScratch;
+		size_t mSize;
+
+	public:
+		//--------------------------------------------------------------------------
+		// Constructors
+		//
+
+		RenderQueue() : mSize(0)
+		{
+		}
+
+		RenderQueue(const RenderQueue& queue) : mKeys(queue.mKeys), mIndices(queue.mIndices), mSize(queue.mSize)
+		{
+		}
+
+		//--------------------------------------------------------------------------
+		// Assignment
+		//
+
+		RenderQueue& operator = (const RenderQueue& queue)
+		{
+			mKeys = queue.mKeys;
+			mIndices = queue.mIndices;
+			mSize = queue.mSize;
+			return *this;
+		}
+
+		//--------------------------------------------------------------------------
+		// Accessors
+		//
+
+		size_t size() const
+		{
+			return mSize;
+		}
+
+		bool empty() const
+		{
+			return mSize == 0;
+		}
+
+		// The position in the sorted order, from 0 to size() - 1
+		uint64_t key(size_t position) const
+		{
+			XMASSERT(position < mSize);
+			return mKeys[position];
+		}
+
+		// The index of the object's bounds in the view the queue was built from
+		uint_t index(size_t position) const
+		{
+			XMASSERT(position < mSize);
+			return mIndices[position];
+		}
+
+		const uint64_t* keys() const
+		{
+			return mKeys.data();
+		}
+
+		const uint_t* indices() const
+		{
+			return mIndices.data();
+		}
+
+		static uint_t user_bits(uint64_t key)
+		{
+			return static_cast<uint_t>(key >> 32);
+		}
+
+		//--------------------------------------------------------------------------
+		// Computation
+		//
+
+		void clear()
+		{
+			mSize = 0;
+		}
+
+		// Replaces the queue with the objects whose bounds are not outside the frustum, sorted by their keys.
+		// The user bits are read from user_bits[i] for object i, or are all zero when it is null. A thread_count
+		// of 0 uses all hardware threads, large inputs are split between the threads.
+		void build(const SoaView<BoundingSphere>& spheres, const Frustum& frustum, const Matrix& view, DepthOrder order,
+			const uint_t* user_bits = nullptr, uint_t thread_count = 1);
+		void build(const SoaView<BoundingBox>& boxes, const Frustum& frustum, const Matrix& view, DepthOrder order,
+			const uint_t* user_bits = nullptr, uint_t thread_count = 1);
+
+	private:
+		template <class Bounds>
+		void build_queue(const SoaView<Bounds>& bounds, const Frustum& frustum, const Matrix& view, DepthOrder order,
+			const uint_t* user_bits, uint_t thread_count);
+	};
+
+} // namespace Math
+
+#endif // __MATHS_RENDERQUEUE_HPP__
@@ -0,0 +1,650 @@
+#pragma once
+#ifndef __MATHS_SOAARRAY_HPP__
+#define __MATHS_SOAARRAY_HPP__
+
+#include "Vector3.hpp"
+
+#include <array>
+#include <vector>
+#include <iterator>
+
+namespace Math
+{
+	// Number of elements held in one XMVECTOR of a component stream, and so the width of the batch kernels
+	static const uint_t SOA_LANE_COUNT = 4;
+
+	//--------------------------------------------------------------------------
+	// Component Layouts
+	//
+	// Each specialisation names the float components of a type and converts between
+	// the type and a flat array of those components. The specialisations for the other
+	// types are in their own headers, so this one only depends on Vector3.
+	//
+
+	template <class Type> struct SoaTraits;
+
+	template <> struct SoaTraits<Vector3>
+	{
+		enum Component : uint_t
+		{
+			X,
+			Y,
+			Z,
+
+			COMPONENT_COUNT
+		};
+
+		static void scatter(const Vector3& v, float* components)
+		{
+			components[X] = v.x;
+			components[Y] = v.y;
+			components[Z] = v.z;
+		}
+
+		static Vector3 gather(const float* components)
+		{
+			return Vector3(components[X], components[Y], components[Z]);
+		}
+	};
+
+	//--------------------------------------------------------------------------
+	// SoaBlock
+	//
+	// SOA_LANE_COUNT consecutive elements loaded into registers, one XMVECTOR per component.
+	//
+
+	template <class Type>
+	struct SoaBlock
+	{
+		static const uint_t COMPONENT_COUNT = SoaTraits<Type>::COMPONENT_COUNT;
+
+		XMVECTOR components[COMPONENT_COUNT];
+
+		XMVECTOR operator [] (uint_t component) const
+		{
+			return components[component];
+		}
+
+		XMVECTOR& operator [] (uint_t component)
+		{
+			return components[component];
+		}
+	};
+
+	//--------------------------------------------------------------------------
+	// SoaView
+	//
+	// Non-owning read only view of component streams. Each stream must be 16 byte
+	// aligned and padded out to a whole number of blocks, which is how SoaArray stores
+	// them, so that external memory in the same layout can be viewed without copying.
+	//
+
+	template <class Type> class SoaBlockIterator;
+
+	template <class Type>
+	class SoaView
+	{
+	public:
+		typedef SoaTraits<Type> Traits;
+		typedef SoaBlock<Type> Block;
+		typedef SoaBlockIterator<Type> BlockIterator;
+
+		static const uint_t COMPONENT_COUNT = Traits::COMPONENT_COUNT;
+
+	private:
+		std::array<const float*, COMPONENT_COUNT> mComponents;
+		size_t mSize;
+
+	public:
+		//--------------------------------------------------------------------------
+		// Constructors
+		//
+
+		SoaView() : mSize(0)
+		{
+			mComponents.fill(nullptr);
+		}
+
+		SoaView(const float* const* components, size_t size) : mSize(size)
+		{
+			for (uint_t c = 0; c < COMPONENT_COUNT; ++c)
+			{
+				XMASSERT((reinterpret_cast<std::uintptr_t>(components[c]) & 15) == 0);
+				mComponents[c] = components[c];
+			}
+		}
+
+		SoaView(const SoaView& view) : mComponents(view.mComponents), mSize(view.mSize)
+		{
+		}
+
+		SoaView& operator = (const SoaView& view)
+		{
+			mComponents = view.mComponents;
+			mSize = view.mSize;
+			return *this;
+		}
+
+		//--------------------------------------------------------------------------
+		// Accessors
+		//
+
+		size_t size() const
+		{
+			return mSize;
+		}
+
+		bool empty() const
+		{
+			return mSize == 0;
+		}
+
+		size_t block_count() const
+		{
+			return (mSize + SOA_LANE_COUNT - 1) / SOA_LANE_COUNT;
+		}
+
+		uint_t lane_count(size_t block) const
+		{
+			const size_t remaining = mSize - block * SOA_LANE_COUNT;
+			return remaining < SOA_LANE_COUNT ? static_cast<uint_t>(remaining) : SOA_LANE_COUNT;
+		}
+
+		const float* component(uint_t c) const
+		{
+			return mComponents[c];
+		}
+
+		Type operator [] (size_t index) const
+		{
+			XMASSERT(index < mSize);
+			float values[COMPONENT_COUNT];
+			for (uint_t c = 0; c < COMPONENT_COUNT; ++c)
+			{
+				values[c] = mComponents[c][index];
+			}
+			return Traits::gather(values);
+		}
+
+		XMVECTOR load(uint_t c, size_t block) const
+		{
+			return XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(mComponents[c] + block * SOA_LANE_COUNT));
+		}
+
+		Block load_block(size_t block) const
+		{
+			Block result;
+			for (uint_t c = 0; c < COMPONENT_COUNT; ++c)
+			{
+				result.components[c] = load(c, block);
+			}
+			return result;
+		}
+
+		BlockIterator block_begin() const
+		{
+			return BlockIterator(*this, 0);
+		}
+
+		BlockIterator block_end() const
+		{
+			return BlockIterator(*this, block_count());
+		}
+
+		// View of the elements in blocks [first_block, first_block + count)
+		SoaView sub_view(size_t first_block, size_t count) const
+		{
+			XMASSERT(first_block + count <= block_count());
+			const float* components[COMPONENT_COUNT];
+			for (uint_t c = 0; c < COMPONENT_COUNT; ++c)
+			{
+				components[c] = mComponents[c] + first_block * SOA_LANE_COUNT;
+			}
+			// An empty view past the last element of a partial block still starts after mSize
+			const size_t first = first_block * SOA_LANE_COUNT;
+			const size_t last = std::max(first, std::min(mSize, (first_block + count) * SOA_LANE_COUNT));
+			return SoaView(components, last - first);
+		}
+
+		template <class OutputIterator>
+		OutputIterator copy_to(OutputIterator output) const
+		{
+			for (size_t i = 0; i < mSize; ++i)
+			{
+				*output++ = (*this)[i];
+			}
+			return output;
+		}
+	};
+
+	//--------------------------------------------------------------------------
+	// SoaBlockIterator
+	//
+	// Random access iterator over the blocks of a view, dereferencing to a loaded SoaBlock.
+	// It holds its own copy of the view so it stays valid while the underlying streams do.
+	//
+
+	template <class Type>
+	class SoaBlockIterator
+	{
+	public:
+		typedef std::random_access_iterator_tag iterator_category;
+		typedef SoaBlock<Type> value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const SoaBlock<Type>* pointer;
+		typedef SoaBlock<Type> reference;
+
+	private:
+		SoaView<Type> mView;
+		size_t mBlock;
+
+	public:
+		SoaBlockIterator() : mBlock(0)
+		{
+		}
+
+		SoaBlockIterator(const SoaView<Type>& view, size_t block) : mView(view), mBlock(block)
+		{
+		}
+
+		SoaBlock<Type> operator * () const
+		{
+			return mView.load_block(mBlock);
+		}
+
+		SoaBlock<Type> operator [] (difference_type n) const
+		{
+			return mView.load_block(mBlock + n);
+		}
+
+		// Number of lanes in the current block that hold real elements rather than padding
+		uint_t lane_count() const
+		{
+			return mView.lane_count(mBlock);
+		}
+
+		size_t block_index() const
+		{
+			return mBlock;
+		}
+
+		SoaBlockIterator& operator ++ ()
+		{
+			++mBlock;
+			return *this;
+		}
+
+		SoaBlockIterator operator ++ (int)
+		{
+			SoaBlockIterator old = *this;
+			++mBlock;
+			return old;
+		}
+
+		SoaBlockIterator& operator -- ()
+		{
+			--mBlock;
+			return *this;
+		}
+
+		SoaBlockIterator operator -- (int)
+		{
+			SoaBlockIterator old = *this;
+			--mBlock;
+			return old;
+		}
+
+		SoaBlockIterator& operator += (difference_type n)
+		{
+			mBlock += n;
+			return *this;
+		}
+
+		SoaBlockIterator& operator -= (difference_type n)
+		{
+			mBlock -= n;
+			return *this;
+		}
+
+		SoaBlockIterator operator + (difference_type n) const
+		{
+			return SoaBlockIterator(mView, mBlock + n);
+		}
+
+		SoaBlockIterator operator - (difference_type n) const
+		{
+			return SoaBlockIterator(mView, mBlock - n);
+		}
+
+		difference_type operator - (const SoaBlockIterator& it) const
+		{
+			return static_cast<difference_type>(mBlock) - static_cast<difference_type>(it.mBlock);
+		}
+
+		bool operator == (const SoaBlockIterator& it) const
+		{
+			return mBlock == it.mBlock;
+		}
+
+		bool operator != (const SoaBlockIterator& it) const
+		{
+			return mBlock != it.mBlock;
+		}
+
+		bool operator < (const SoaBlockIterator& it) const
+		{
+			return mBlock < it.mBlock;
+		}
+	};
+
+	//--------------------------------------------------------------------------
+	// SoaArray
+	//
+	// Owning structure of arrays container. Each component is stored in its own aligned
+	// stream of XMVECTORs, and the unused lanes of the last block repeat the last element
+	// so that kernels can process whole blocks without masking (min/max reductions and
+	// containment tests are unaffected by duplicates).
+	//
+
+	template <class Type>
+	class SoaArray
+	{
+	public:
+		typedef SoaTraits<Type> Traits;
+		typedef SoaBlock<Type> Block;
+		typedef SoaView<Type> View;
+		typedef SoaBlockIterator<Type> BlockIterator;
+
+		static const uint_t COMPONENT_COUNT = Traits::COMPONENT_COUNT;
+
+	private:
+		std::array<std::vector<XMVECTOR>, COMPONENT_COUNT> mComponents;
+		size_t mSize;
+
+	public:
+		//--------------------------------------------------------------------------
+		// Constructors
+		//
+
+		SoaArray() : mSize(0)
+		{
+		}
+
+		explicit SoaArray(size_t size) : mSize(0)
+		{
+			resize(size);
+		}
+
+		SoaArray(size_t size, const Type& value) : mSize(0)
+		{
+			resize(size, value);
+		}
+
+		template <class Iterator>
+		SoaArray(Iterator begin, Iterator end) : mSize(0)
+		{
+			assign(begin, end);
+		}
+
+		explicit SoaArray(const View& view) : mSize(0)
+		{
+			assign(view);
+		}
+
+		SoaArray(const SoaArray& array) : mComponents(array.mComponents), mSize(array.mSize)
+		{
+		}
+
+		SoaArray(SoaArray&& array) : mComponents(std::move(array.mComponents)), mSize(array.mSize)
+		{
+			array.mSize = 0;
+		}
+
+		//--------------------------------------------------------------------------
+		// Assignment
+		//
+
+		SoaArray& operator = (const SoaArray& array)
+		{
+			mComponents = array.mComponents;
+			mSize = array.mSize;
+			return *this;
+		}
+
+		SoaArray& operator = (SoaArray&& array)
+		{
+			mComponents = std::move(array.mComponents);
+			mSize = array.mSize;
+			array.mSize = 0;
+			return *this;
+		}
+
+		template <class Iterator>
+		void assign(Iterator begin, Iterator end)
+		{
+			clear();
+			reserve(std::distance(begin, end));
+			std::for_each(begin, end, [this](const Type& value) { push_back(value); });
+		}
+
+		void assign(const View& view)
+		{
+			mSize = view.size();
+			for (uint_t c = 0; c < COMPONENT_COUNT; ++c)
+			{
+				const XMVECTOR* stream = reinterpret_cast<const XMVECTOR*>(view.component(c));
+				mComponents[c].assign(stream, stream + view.block_count());
+			}
+		}
+
+		//--------------------------------------------------------------------------
+		// Accessors
+		//
+
+		size_t size() const
+		{
+			return mSize;
+		}
+
+		bool empty() const
+		{
+			return mSize == 0;
+		}
+
+		size_t block_count() const
+		{
+			return mComponents[0].size();
+		}
+
+		uint_t lane_count(size_t block) const
+		{
+			return view().lane_count(block);
+		}
+
+		float* component(uint_t c)
+		{
+			return reinterpret_cast<float*>(mComponents[c].data());
+		}
+
+		const float* component(uint_t c) const
+		{
+			return reinterpret_cast<const float*>(mComponents[c].data());
+		}
+
+		Type operator [] (size_t index) const
+		{
+			return view()[index];
+		}
+
+		void set(size_t index, const Type& value)
+		{
+			XMASSERT(index < mSize);
+			store_element(index, value);
+			if (index + 1 == mSize)
+			{
+				pad_last_block();
+			}
+		}
+
+		XMVECTOR load(uint_t c, size_t block) const
+		{
+			return mComponents[c][block];
+		}
+
+		void store(uint_t c, size_t block, FXMVECTOR v)
+		{
+			mComponents[c][block] = v;
+		}
+
+		Block load_block(size_t block) const
+		{
+			Block result;
+			for (uint_t c = 0; c < COMPONENT_COUNT; ++c)
+			{
+				result.components[c] = mComponents[c][block];
+			}
+			return result;
+		}
+
+		// Storing a block overwrites the padding lanes, so call pad_last_block() after storing the last block
+		void store_block(size_t block, const Block& values)
+		{
+			for (uint_t c = 0; c < COMPONENT_COUNT; ++c)
+			{
+				mComponents[c][block] = values.components[c];
+			}
+		}
+
+		View view() const
+		{
+			const float* components[COMPONENT_COUNT];
+			for (uint_t c = 0; c < COMPONENT_COUNT; ++c)
+			{
+				components[c] = component(c);
+			}
+			return View(components, mSize);
+		}
+
+		operator View () const
+		{
+			return view();
+		}
+
+		//--------------------------------------------------------------------------
+		// Modification
+		//
+
+		void clear()
+		{
+			for (uint_t c = 0; c < COMPONENT_COUNT; ++c)
+			{
+				mComponents[c].clear();
+			}
+			mSize = 0;
+		}
+
+		void reserve(size_t size)
+		{
+			const size_t blocks = (size + SOA_LANE_COUNT - 1) / SOA_LANE_COUNT;
+			for (uint_t c = 0; c < COMPONENT_COUNT; ++c)
+			{
+				mComponents[c].reserve(blocks);
+			}
+		}
+
+		// New elements have every component zero, rather than being a default constructed Type, which for
+		// some types is left uninitialised
+		void resize(size_t size)
+		{
+			const size_t old_size = mSize;
+			resize_blocks(size);
+			for (uint_t c = 0; c < COMPONENT_COUNT; ++c)
+			{
+				float* stream = component(c);
+				std::fill(stream + std::min(old_size, size), stream + size, 0.0f);
+			}
+			pad_last_block();
+		}
+
+		void resize(size_t size, const Type& value)
+		{
+			const size_t old_size = mSize;
+			resize_blocks(size);
+			for (size_t i = old_size; i < size; ++i)
+			{
+				store_element(i, value);
+			}
+			pad_last_block();
+		}
+
+		void push_back(const Type& value)
+		{
+			if (mSize % SOA_LANE_COUNT == 0)
+			{
+				for (uint_t c = 0; c < COMPONENT_COUNT; ++c)
+				{
+					mComponents[c].push_back(XMVectorZero());
+				}
+			}
+			store_element(mSize++, value);
+			pad_last_block();
+		}
+
+		// Fill the unused lanes of the last block with copies of the last element
+		void pad_last_block()
+		{
+			if (mSize == 0) return;
+
+			for (uint_t c = 0; c < COMPONENT_COUNT; ++c)
+			{
+				float* stream = component(c);
+				const size_t padded_size = mComponents[c].size() * SOA_LANE_COUNT;
+				std::fill(stream + mSize, stream + padded_size, stream[mSize - 1]);
+			}
+		}
+
+		//--------------------------------------------------------------------------
+		// Iteration
+		//
+
+		BlockIterator block_begin() const
+		{
+			return BlockIterator(view(), 0);
+		}
+
+		BlockIterator block_end() const
+		{
+			return BlockIterator(view(), block_count());
+		}
+
+		template <class OutputIterator>
+		OutputIterator copy_to(OutputIterator output) const
+		{
+			return view().copy_to(output);
+		}
+
+	private:
+		void resize_blocks(size_t size)
+		{
+			const size_t blocks = (size + SOA_LANE_COUNT - 1) / SOA_LANE_COUNT;
+			for (uint_t c = 0; c < COMPONENT_COUNT; ++c)
+			{
+				mComponents[c].resize(blocks, XMVectorZero());
+			}
+			mSize = size;
+		}
+
+		void store_element(size_t index, const Type& value)
+		{
+			float values[COMPONENT_COUNT];
+			Traits::scatter(value, values);
+			for (uint_t c = 0; c < COMPONENT_COUNT; ++c)
+			{
+				component(c)[index] = values[c];
+			}
+		}
+	};
+
+} // namespace Math
+
+#endif // __MATHS_SOAARRAY_HPP__
@@ -0,0 +1,86 @@
+#pragma once
+#ifndef __MATHS_SOAVECTOR3_HPP__
+#define __MATHS_SOAVECTOR3_HPP__
+
+namespace Math
+{
+	// Four three component vectors with each component in its own register, for the
+	// batch kernels working on SoaBlocks. Lane i of x, y and z make up vector i.
+	struct SoaVector3
+	{
+		XMVECTOR x;
+		XMVECTOR y;
+		XMVECTOR z;
+	};
+
+	inline SoaVector3 soa_vector3(FXMVECTOR x, FXMVECTOR y, FXMVECTOR z)
+	{
+		const SoaVector3 result = { x, y, z };
+		return result;
+	}
+
+	// The same vector in every lane
+	inline SoaVector3 soa_splat(FXMVECTOR v)
+	{
+		return soa_vector3(XMVectorSplatX(v), XMVectorSplatY(v), XMVectorSplatZ(v));
+	}
+
+	inline SoaVector3 soa_add(const SoaVector3& a, const SoaVector3& b)
+	{
+		return soa_vector3(XMVectorAdd(a.x, b.x), XMVectorAdd(a.y, b.y), XMVectorAdd(a.z, b.z));
+	}
+
+	inline SoaVector3 soa_subtract(const SoaVector3& a, const SoaVector3& b)
+	{
+		return soa_vector3(XMVectorSubtract(a.x, b.x), XMVectorSubtract(a.y, b.y), XMVectorSubtract(a.z, b.z));
+	}
+
+	// Scales each vector by the matching lane of s
+	inline SoaVector3 soa_scale(const SoaVector3& v, FXMVECTOR s)
+	{
+		return soa_vector3(XMVectorMultiply(v.x, s), XMVectorMultiply(v.y, s), XMVectorMultiply(v.z, s));
+	}
+
+	// a * s + b
+	inline SoaVector3 soa_multiply_add(const SoaVector3& a, FXMVECTOR s, const SoaVector3& b)
+	{
+		return soa_vector3(XMVectorMultiplyAdd(a.x, s, b.x), XMVectorMultiplyAdd(a.y, s, b.y), XMVectorMultiplyAdd(a.z, s, b.z));
+	}
+
+	inline SoaVector3 soa_cross(const SoaVector3& a, const SoaVector3& b)
+	{
+		return soa_vector3(
+			XMVectorSubtract(XMVectorMultiply(a.y, b.z), XMVectorMultiply(a.z, b.y)),
+			XMVectorSubtract(XMVectorMultiply(a.z, b.x), XMVectorMultiply(a.x, b.z)),
+			XMVectorSubtract(XMVectorMultiply(a.x, b.y), XMVectorMultiply(a.y, b.x)));
+	}
+
+	inline XMVECTOR soa_dot(const SoaVector3& a, const SoaVector3& b)
+	{
+		return XMVectorMultiplyAdd(a.x, b.x, XMVectorMultiplyAdd(a.y, b.y, XMVectorMultiply(a.z, b.z)));
+	}
+
+	inline XMVECTOR soa_length_squared(const SoaVector3& v)
+	{
+		return soa_dot(v, v);
+	}
+
+	inline SoaVector3 soa_min(const SoaVector3& a, const SoaVector3& b)
+	{
+		return soa_vector3(XMVectorMin(a.x, b.x), XMVectorMin(a.y, b.y), XMVectorMin(a.z, b.z));
+	}
+
+	inline SoaVector3 soa_max(const SoaVector3& a, const SoaVector3& b)
+	{
+		return soa_vector3(XMVectorMax(a.x, b.x), XMVectorMax(a.y, b.y), XMVectorMax(a.z, b.z));
+	}
+
+	// Picks b in the lanes where control is set, and a elsewhere
+	inline SoaVector3 soa_select(const SoaVector3& a, const SoaVector3& b, FXMVECTOR control)
+	{
+		return soa_vector3(XMVectorSelect(a.x, b.x, control), XMVectorSelect(a.y, b.y, control), XMVectorSelect(a.z, b.z, control));
+	}
+
+} // namespace Math
+
+#endif // __MATHS_SOAVECTOR3_HPP__
@@ -0,0 +1,297 @@
+#include "Precompiled.hpp"
+#include "SpatialCode.hpp"
+#include "Vector3.hpp"
+#include "BoundingBox.hpp"
+#include "BoundingSphere.hpp"
+#include "SoaArray.hpp"
+
+#include <future>
+#include <thread>
+
+namespace
+{
+	// Fewer points than this are not worth starting a thread for
+	const size_t MINIMUM_POINTS_PER_THREAD = 64 * 1024;
+
+	uint_t thread_total(uint_t thread_count)
+	{
+		return (thread_count == 0) ? std::max(std::thread::hardware_concurrency(), 1u) : thread_count;
+	}
+
+	// Moves the low 10 bits of the value so there are two zero bits between each of them
+	uint32_t spread_bits(uint32_t value)
+	{
+		value &= 0x000003FF;
+		value = (value | (value << 16)) & 0x030000FF;
+		value = (value | (value << 8)) & 0x0300F00F;
+		value = (value | (value << 4)) & 0x030C30C3;
+		value = (value | (value << 2)) & 0x09249249;
+		return value;
+	}
+
+	// As above for the low 21 bits
+	uint64_t spread_bits(uint64_t value)
+	{
+		value &= 0x00000000001FFFFF;
+		value = (value | (value << 32)) & 0x001F00000000FFFF;
+		value = (value | (value << 16)) & 0x001F0000FF0000FF;
+		value = (value | (value << 8)) & 0x100F00F00F00F00F;
+		value = (value | (value << 4)) & 0x10C30C30C30C30C3;
+		value = (value | (value << 2)) & 0x1249249249249249;
+		return value;
+	}
+
+	// Turns the cell's coordinates into the transposed form of its Hilbert index (J. Skilling, "Programming the
+	// Hilbert curve", 2004), where bit b of the index's digit i is bit b of cell[i]
+	void hilbert_transpose(uint32_t* cell, uint_t bits)
+	{
+		const uint32_t highest = 1u << (bits - 1);
+
+		// Undo the excess work of the inverse transform
+		for (uint32_t bit = highest; bit > 1; bit >>= 1)
+		{
+			const uint32_t below = bit - 1;
+			for (uint_t axis = 0; axis < 3; ++axis)
+			{
+				if (cell[axis] & bit)
+				{
+					cell[0] ^= below;
+				}
+				else
+				{
+					const uint32_t exchange = (cell[0] ^ cell[axis]) & below;
+					cell[0] ^= exchange;
+					cell[axis] ^= exchange;
+				}
+			}
+		}
+
+		// Gray encode
+		cell[1] ^= cell[0];
+		cell[2] ^= cell[1];
+		uint32_t flip = 0;
+		for (uint32_t bit = highest; bit > 1; bit >>= 1)
+		{
+			if (cell[2] & bit) flip ^= bit - 1;
+		}
+		for (uint_t axis = 0; axis < 3; ++axis)
+		{
+			cell[axis] ^= flip;
+		}
+	}
+
+	template <class Code>
+	struct Morton
+	{
+		static const uint_t BITS = (sizeof(Code) == 4) ? Math::SpatialCode::BITS_32 : Math::SpatialCode::BITS_64;
+
+		static Code encode(uint32_t x, uint32_t y, uint32_t z)
+		{
+			return ::spread_bits(Code(x)) | (::spread_bits(Code(y)) << 1) | (::spread_bits(Code(z)) << 2);
+		}
+	};
+
+	template <class Code>
+	struct Hilbert
+	{
+		static const uint_t BITS = Morton<Code>::BITS;
+
+		// The first digit of the transposed index is the most significant of each group of three bits
+		static Code encode(uint32_t x, uint32_t y, uint32_t z)
+		{
+			uint32_t cell[3] = { x, y, z };
+			::hilbert_transpose(cell, BITS);
+			return Morton<Code>::encode(cell[2], cell[1], cell[0]);
+		}
+	};
+
+	// Scale from the bounds to cells, with flat bounds putting every point in the first cell along that axis
+	XMVECTOR cell_scale(const Math::BoundingBox& bounds, uint_t bits)
+	{
+		const XMVECTOR size = XMVectorSubtract(bounds.maximum_corner(), bounds.minimum_corner());
+		const XMVECTOR scale = XMVectorDivide(XMVectorReplicate(static_cast<float>(1u << bits)), size);
+		return XMVectorSelect(scale, XMVectorZero(), XMVectorLessOrEqual(size, XMVectorZero()));
+	}
+
+	// The cell coordinates of the points in the lanes of position, clamped to the grid
+	XMVECTOR quantise(FXMVECTOR position, FXMVECTOR minimum, FXMVECTOR scale, FXMVECTOR last_cell)
+	{
+		const XMVECTOR cell = XMVectorMultiply(XMVectorSubtract(position, minimum), scale);
+		return XMConvertVectorFloatToUInt(XMVectorClamp(cell, XMVectorZero(), last_cell), 0);
+	}
+
+	template <class Curve, class Code>
+	Code encode_point(const Math::Vector3& point, const Math::BoundingBox& bounds)
+	{
+		const XMVECTOR last_cell = XMVectorReplicate(static_cast<float>((1u << Curve::BITS) - 1));
+		XMVECTORU32 cell;
+		cell.v = ::quantise(point, bounds.minimum_corner(), ::cell_scale(bounds, Curve::BITS), last_cell);
+		return Curve::encode(cell.u[0], cell.u[1], cell.u[2]);
+	}
+
+	void load_points(const Math::SoaView<Math::Vector3>& points, size_t block, XMVECTOR* positions)
+	{
+		typedef Math::SoaTraits<Math::Vector3> Traits;
+
+		const Math::SoaBlock<Math::Vector3> point = points.load_block(block);
+		positions[0] = point[Traits::X];
+		positions[1] = point[Traits::Y];
+		positions[2] = point[Traits::Z];
+	}
+
+	void load_points(const Math::SoaView<Math::BoundingBox>& boxes, size_t block, XMVECTOR* positions)
+	{
+		typedef Math::SoaTraits<Math::BoundingBox> Traits;
+
+		const Math::SoaBlock<Math::BoundingBox> box = boxes.load_block(block);
+		const XMVECTOR half = XMVectorReplicate(0.5f);
+		for (uint_t axis = 0; axis < 3; ++axis)
+		{
+			positions[axis] = XMVectorMultiply(XMVectorAdd(box[Traits::MIN_X + axis], box[Traits::MAX_X + axis]), half);
+		}
+	}
+
+	void load_points(const Math::SoaView<Math::BoundingSphere>& spheres, size_t block, XMVECTOR* positions)
+	{
+		typedef Math::SoaTraits<Math::BoundingSphere> Traits;
+
+		const Math::SoaBlock<Math::BoundingSphere> sphere = spheres.load_block(block);
+		positions[0] = sphere[Traits::CENTER_X];
+		positions[1] = sphere[Traits::CENTER_Y];
+		positions[2] = sphere[Traits::CENTER_Z];
+	}
+
+	template <class Curve, class Type, class Code>
+	void encode_points(const Math::SoaView<Type>& points, const Math::BoundingBox& bounds, Code* codes, uint_t thread_count)
+	{
+		const XMVECTOR last_cell = XMVectorReplicate(static_cast<float>((1u << Curve::BITS) - 1));
+		const XMVECTOR scale = ::cell_scale(bounds, Curve::BITS);
+		const XMVECTOR scales[3] = { XMVectorSplatX(scale), XMVectorSplatY(scale), XMVectorSplatZ(scale) };
+		const XMVECTOR minimum = bounds.minimum_corner();
+		const XMVECTOR minimums[3] = { XMVectorSplatX(minimum), XMVectorSplatY(minimum), XMVectorSplatZ(minimum) };
+
+		auto encode_blocks = [&](size_t first_block, size_t last_block)
+		{
+			for (size_t block = first_block; block < last_block; ++block)
+			{
+				XMVECTOR positions[3];
+				::load_points(points, block, positions);
+				XMVECTORU32 cells[3];
+				for (uint_t axis = 0; axis < 3; ++axis)
+				{
+					cells[axis].v = ::quantise(positions[axis], minimums[axis], scales[axis], last_cell);
+				}
+
+				const size_t first = block * Math::SOA_LANE_COUNT;
+				const uint_t lane_count = points.lane_count(block);
+				for (uint_t lane = 0; lane < lane_count; ++lane)
+				{
+					codes[first + lane] = Curve::encode(cells[0].u[lane], cells[1].u[lane], cells[2].u[lane]);
+				}
+			}
+		};
+
+		const size_t block_count = points.block_count();
+		const size_t useful_threads = std::max<size_t>(points.size() / MINIMUM_POINTS_PER_THREAD, 1);
+		const size_t threads = std::min<size_t>(::thread_total(thread_count), useful_threads);
+		const size_t range = (block_count + threads - 1) / threads;
+
+		std::vector<std::future<void>> results;
+		for (size_t first = range; first < block_count; first += range)
+		{
+			results.push_back(std::async(std::launch::async, encode_blocks, first, std::min(first + range, block_count)));
+		}
+
+		// This thread does the first range while waiting for the others
+		encode_blocks(0, std::min(range, block_count));
+		for (auto& result : results)
+		{
+			result.get();
+		}
+	}
+}
+
+namespace Math
+{
+
+	uint32_t SpatialCode::morton_32(const Vector3& point, const BoundingBox& bounds)
+	{
+		return ::encode_point<::Morton<uint32_t>, uint32_t>(point, bounds);
+	}
+
+	uint64_t SpatialCode::morton_64(const Vector3& point, const BoundingBox& bounds)
+	{
+		return ::encode_point<::Morton<uint64_t>, uint64_t>(point, bounds);
+	}
+
+	uint32_t SpatialCode::hilbert_32(const Vector3& point, const BoundingBox& bounds)
+	{
+		return ::encode_point<::Hilbert<uint32_t>, uint32_t>(point, bounds);
+	}
+
+	uint64_t SpatialCode::hilbert_64(const Vector3& point, const BoundingBox& bounds)
+	{
+		return ::encode_point<::Hilbert<uint64_t>, uint64_t>(point, bounds);
+	}
+
+	void SpatialCode::morton_32(const SoaView<Vector3>& points, const BoundingBox& bounds, uint32_t* codes, uint_t thread_count)
+	{
+		::encode_points<::Morton<uint32_t>>(points, bounds, codes, thread_count);
+	}
+
+	void SpatialCode::morton_64(const SoaView<Vector3>& points, const BoundingBox& bounds, uint64_t* codes, uint_t thread_count)
+	{
+		::encode_points<::Morton<uint64_t>>(points, bounds, codes, thread_count);
+	}
+
+	void SpatialCode::hilbert_32(const SoaView<Vector3>& points, const BoundingBox& bounds, uint32_t* codes, uint_t thread_count)
+	{
+		::encode_points<::Hilbert<uint32_t>>(points, bounds, codes, thread_count);
+	}
+
+	void SpatialCode::hilbert_64(const SoaView<Vector3>& points, const BoundingBox& bounds, uint64_t* codes, uint_t thread_count)
+	{
+		::encode_points<::Hilbert<uint64_t>>(points, bounds, codes, thread_count);
+	}
+
+	void SpatialCode::morton_32(const SoaView<BoundingBox>& boxes, const BoundingBox& bounds, uint32_t* codes, uint_t thread_count)
+	{
+		::encode_points<::Morton<uint32_t>>(boxes, bounds, codes, thread_count);
+	}
+
+	void SpatialCode::morton_64(const SoaView<BoundingBox>& boxes, const BoundingBox& bounds, uint64_t* codes, uint_t thread_count)
+	{
+		::encode_points<::Morton<uint64_t>>(boxes, bounds, codes, thread_count);
+	}
+
+	void SpatialCode::hilbert_32(const SoaView<BoundingBox>& boxes, const BoundingBox& bounds, uint32_t* codes, uint_t thread_count)
+	{
+		::encode_points<::Hilbert<uint32_t>>(boxes, bounds, codes, thread_count);
+	}
+
+	void SpatialCode::hilbert_64(const SoaView<BoundingBox>& boxes, const BoundingBox& bounds, uint64_t* codes, uint_t thread_count)
+	{
+		::encode_points<::Hilbert<uint64_t>>(boxes, bounds, codes, thread_count);
+	}
+
+	void SpatialCode::morton_32(const SoaView<BoundingSphere>& spheres, const BoundingBox& bounds, uint32_t* codes, uint_t thread_count)
+	{
+		::encode_points<::Morton<uint32_t>>(spheres, bounds, codes, thread_count);
+	}
+
+	void SpatialCode::morton_64(const SoaView<BoundingSphere>& spheres, const BoundingBox& bounds, uint64_t* codes, uint_t thread_count)
+	{
+		::encode_points<::Morton<uint64_t>>(spheres, bounds, codes, thread_count);
+	}
+
+	void SpatialCode::hilbert_32(const SoaView<BoundingSphere>& spheres, const BoundingBox& bounds, uint32_t* codes, uint_t thread_count)
+	{
+		::encode_points<::Hilbert<uint32_t>>(spheres, bounds, codes, thread_count);
+	}
+
+	void SpatialCode::hilbert_64(const SoaView<BoundingSphere>& spheres, const BoundingBox& bounds, uint64_t* codes, uint_t thread_count)
+	{
+		::encode_points<::Hilbert<uint64_t>>(spheres, bounds, codes, thread_count);
+	}
+
+} // namespace Math
@@ -0,0 +1,58 @@
+#pragma once
+#ifndef __MATHS_SPATIALCODE_HPP__
+#define __MATHS_SPATIALCODE_HPP__
+
+namespace Math
+{
+	class Vector3;
+	class BoundingBox;
+	class BoundingSphere;
+
+	template <class Type> class SoaView;
+
+	// Codes that order points along a curve through space, so that sorting points by their codes keeps points
+	// that are close together close in the sorted order. Used to build hierarchies, hash space and sort work
+	// for better cache use.
+	//
+	// Points are quantised to a grid of cells filling the bounds, with points outside the bounds clamped to
+	// the cells on its edges. The 32 bit codes use 10 bits per axis (1024 cells along each axis) and the 64 bit
+	// codes use 21 bits per axis.
+	namespace SpatialCode
+	{
+		static const uint_t BITS_32 = 10;
+		static const uint_t BITS_64 = 21;
+
+		// Morton (Z order) codes interleave the bits of the cell's coordinates, x in the lowest bit. They are
+		// cheap to make, but the curve jumps across space between some consecutive codes.
+		uint32_t morton_32(const Vector3& point, const BoundingBox& bounds);
+		uint64_t morton_64(const Vector3& point, const BoundingBox& bounds);
+
+		// Hilbert codes follow a curve where consecutive codes are always neighbouring cells, so they keep
+		// points together better than Morton codes at several times the cost of making them.
+		uint32_t hilbert_32(const Vector3& point, const BoundingBox& bounds);
+		uint64_t hilbert_64(const Vector3& point, const BoundingBox& bounds);
+
+		// The code of every point, quantising four points at a time. A thread_count of 0 uses all hardware
+		// threads, large inputs are split between the threads.
+		void morton_32(const SoaView<Vector3>& points, const BoundingBox& bounds, uint32_t* codes, uint_t thread_count = 1);
+		void morton_64(const SoaView<Vector3>& points, const BoundingBox& bounds, uint64_t* codes, uint_t thread_count = 1);
+		void hilbert_32(const SoaView<Vector3>& points, const BoundingBox& bounds, uint32_t* codes, uint_t thread_count = 1);
+		void hilbert_64(const SoaView<Vector3>& points, const BoundingBox& bounds, uint64_t* codes, uint_t thread_count = 1);
+
+		// The code of every box's center
+		void morton_32(const SoaView<BoundingBox>& boxes, const BoundingBox& bounds, uint32_t* codes, uint_t thread_count = 1);
+		void morton_64(const SoaView<BoundingBox>& boxes, const BoundingBox& bounds, uint64_t* codes, uint_t thread_count = 1);
+		void hilbert_32(const SoaView<BoundingBox>& boxes, const BoundingBox& bounds, uint32_t* codes, uint_t thread_count = 1);
+		void hilbert_64(const SoaView<BoundingBox>& boxes, const BoundingBox& bounds, uint64_t* codes, uint_t thread_count = 1);
+
+		// The code of every sphere's center
+		void morton_32(const SoaView<BoundingSphere>& spheres, const BoundingBox& bounds, uint32_t* codes, uint_t thread_count = 1);
+		void morton_64(const SoaView<BoundingSphere>& spheres, const BoundingBox& bounds, uint64_t* codes, uint_t thread_count = 1);
+		void hilbert_32(const SoaView<BoundingSphere>& spheres, const BoundingBox& bounds, uint32_t* codes, uint_t thread_count = 1);
+		void hilbert_64(const SoaView<BoundingSphere>& spheres, const BoundingBox& bounds, uint64_t* codes, uint_t thread_count = 1);
+
+	} // namespace SpatialCode
+
+} // namespace Math
+
+#endif // __MATHS_SPATIALCODE_HPP__
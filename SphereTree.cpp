@@ -0,0 +1,352 @@
+#include "Precompiled.hpp"
+#include "SphereTree.hpp"
+#include "Vector3.hpp"
+#include "BoundingBox.hpp"
+#include "Frustum.hpp"
+#include "SoaVector3.hpp"
+#include "SpatialCode.hpp"
+#include "RadixSort.hpp"
+
+#include <future>
+#include <thread>
+
+namespace
+{
+	typedef Math::SoaTraits<Math::BoundingSphere> Traits;
+
+	const uint_t BRANCHING = Math::SphereTree::BRANCHING;
+
+	// Fewer spheres than this are not worth starting a thread for
+	const size_t MINIMUM_SPHERES_PER_THREAD = 16 * 1024;
+
+	// Blocks waiting to be opened, each open pushes at most four and pops one, so a tree of 2^32 spheres
+	// (sixteen levels) never needs more than this
+	const uint_t MAX_STACK_SIZE = 64;
+
+	uint_t thread_total(uint_t thread_count)
+	{
+		return (thread_count == 0) ? std::max(std::thread::hardware_concurrency(), 1u) : thread_count;
+	}
+
+	// Splits [0, count) into one range per thread and calls function(first, last) for each concurrently
+	template <class Function>
+	void for_each_range(size_t count, uint_t thread_count, Function function)
+	{
+		const size_t useful_threads = std::max<size_t>(count / MINIMUM_SPHERES_PER_THREAD, 1);
+		const size_t threads = std::min<size_t>(::thread_total(thread_count), useful_threads);
+		const size_t range = (count + threads - 1) / threads;
+
+		std::vector<std::future<void>> results;
+		for (size_t first = range; first < count; first += range)
+		{
+			results.push_back(std::async(std::launch::async, function, first, std::min(first + range, count)));
+		}
+
+		// This thread does the first range while waiting for the others
+		function(0, std::min(range, count));
+		for (auto& result : results)
+		{
+			result.get();
+		}
+	}
+
+	Math::SoaVector3 centers(const Math::SoaBlock<Math::BoundingSphere>& spheres)
+	{
+		return Math::soa_vector3(spheres[Traits::CENTER_X], spheres[Traits::CENTER_Y], spheres[Traits::CENTER_Z]);
+	}
+
+	XMVECTOR horizontal_max(FXMVECTOR v)
+	{
+		const XMVECTOR pairs = XMVectorMax(v, XMVectorSwizzle(v, 2, 3, 0, 1));
+		return XMVectorMax(pairs, XMVectorSwizzle(pairs, 1, 0, 3, 2));
+	}
+
+	// Sorts a block of spheres into those entirely outside a sphere and those entirely inside it
+	class SphereClassifier
+	{
+	private:
+		Math::SoaVector3 mCenter;
+		XMVECTOR mRadius;
+
+	public:
+		explicit SphereClassifier(const Math::BoundingSphere& sphere) :
+			mCenter(Math::soa_splat(sphere.center())),
+			mRadius(XMVectorReplicate(sphere.radius()))
+		{
+		}
+
+		void classify(const Math::SoaBlock<Math::BoundingSphere>& spheres, XMVECTOR& outside, XMVECTOR& inside) const
+		{
+			const XMVECTOR distance_squared = Math::soa_length_squared(Math::soa_subtract(::centers(spheres), mCenter));
+			const XMVECTOR reach = XMVectorAdd(spheres[Traits::RADIUS], mRadius);
+			const XMVECTOR room = XMVectorSubtract(mRadius, spheres[Traits::RADIUS]);
+			outside = XMVectorGreater(distance_squared, XMVectorMultiply(reach, reach));
+			inside = XMVectorAndInt(XMVectorGreaterOrEqual(room, XMVectorZero()), XMVectorLessOrEqual(distance_squared, XMVectorMultiply(room, room)));
+		}
+	};
+
+	// As Frustum::test for each sphere, outside when it is behind any plane and inside when it is in front of all
+	class FrustumClassifier
+	{
+	private:
+		XMVECTOR mPlanes[Math::Frustum::FRUSTUM_PLANE_COUNT][4];
+
+	public:
+		explicit FrustumClassifier(const Math::Frustum& frustum)
+		{
+			for (uint_t plane = 0; plane < Math::Frustum::FRUSTUM_PLANE_COUNT; ++plane)
+			{
+				const Math::Plane& p = frustum.get_plane(static_cast<Math::Frustum::FrustumPlane>(plane));
+				mPlanes[plane][0] = XMVectorReplicate(p.x);
+				mPlanes[plane][1] = XMVectorReplicate(p.y);
+				mPlanes[plane][2] = XMVectorReplicate(p.z);
+				mPlanes[plane][3] = XMVectorReplicate(p.w);
+			}
+		}
+
+		void classify(const Math::SoaBlock<Math::BoundingSphere>& spheres, XMVECTOR& outside, XMVECTOR& inside) const
+		{
+			const XMVECTOR radius = spheres[Traits::RADIUS];
+			const XMVECTOR negative_radius = XMVectorNegate(radius);
+			outside = XMVectorFalseInt();
+			inside = XMVectorTrueInt();
+			for (uint_t plane = 0; plane < Math::Frustum::FRUSTUM_PLANE_COUNT; ++plane)
+			{
+				XMVECTOR distance = XMVectorMultiplyAdd(spheres[Traits::CENTER_X], mPlanes[plane][0], mPlanes[plane][3]);
+				distance = XMVectorMultiplyAdd(spheres[Traits::CENTER_Y], mPlanes[plane][1], distance);
+				distance = XMVectorMultiplyAdd(spheres[Traits::CENTER_Z], mPlanes[plane][2], distance);
+				outside = XMVectorOrInt(outside, XMVectorLess(distance, negative_radius));
+				inside = XMVectorAndInt(inside, XMVectorGreater(distance, radius));
+			}
+		}
+	};
+
+	bool touches(const Math::BoundingSphere& a, const Math::BoundingSphere& b)
+	{
+		const float reach = a.radius() + b.radius();
+		return Math::Vector3(b.center() - a.center()).length_squared() <= reach * reach;
+	}
+
+	// A pair of nodes from two trees whose spheres touch
+	struct NodePair
+	{
+		uint_t level_a;
+		uint_t index_a;
+		uint_t level_b;
+		uint_t index_b;
+	};
+}
+
+namespace Math
+{
+
+	SphereTree::SphereTree(const SoaView<BoundingSphere>& spheres, uint_t thread_count)
+	{
+		build(spheres, thread_count);
+	}
+
+	//--------------------------------------------------------------------------
+	// Building
+	//
+
+	void SphereTree::build(const SoaView<BoundingSphere>& spheres, uint_t thread_count)
+	{
+		const size_t count = spheres.size();
+		mLevels.clear();
+		mObjects.resize(count);
+		if (count == 0) return;
+
+		// Spheres next to each other in Morton order are close together, so grouping neighbours makes small nodes
+		XMVECTOR minimum = XMVectorSplatInfinity();
+		XMVECTOR maximum = XMVectorNegate(minimum);
+		for (size_t i = 0; i < count; ++i)
+		{
+			const XMVECTOR center = spheres[i].center();
+			minimum = XMVectorMin(minimum, center);
+			maximum = XMVectorMax(maximum, center);
+		}
+
+		std::vector<uint32_t> codes(count);
+		std::vector<uint32_t> code_scratch(count);
+		std::vector<uint_t> object_scratch(count);
+		SpatialCode::morton_32(spheres, BoundingBox(Vector3(minimum), Vector3(maximum), ALREADY_SORTED), codes.data(), thread_count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			mObjects[i] = static_cast<uint_t>(i);
+		}
+		radix_sort(codes.data(), mObjects.data(), count, code_scratch.data(), object_scratch.data(), thread_count);
+
+		mLevels.push_back(SoaArray<BoundingSphere>(count));
+		SoaArray<BoundingSphere>& objects = mLevels.back();
+		for (size_t i = 0; i < count; ++i)
+		{
+			objects.set(i, spheres[mObjects[i]]);
+		}
+
+		// Each node covers a run of span spheres in the first level. The merged sphere is centered by the merges
+		// and then shrunk to the farthest of those spheres, which is tighter than reaching the children.
+		size_t span = 1;
+		while (mLevels.back().size() > 1)
+		{
+			const size_t child_count = mLevels.back().size();
+			const size_t node_count = (child_count + BRANCHING - 1) / BRANCHING;
+			span *= BRANCHING;
+			mLevels.push_back(SoaArray<BoundingSphere>(node_count));
+
+			const SoaArray<BoundingSphere>& children = mLevels[mLevels.size() - 2];
+			const SoaArray<BoundingSphere>& leaves = mLevels.front();
+			SoaArray<BoundingSphere>& nodes = mLevels.back();
+			::for_each_range(node_count, thread_count, [&](size_t first, size_t last)
+			{
+				for (size_t node = first; node < last; ++node)
+				{
+					BoundingSphere group[BRANCHING];
+					const size_t group_size = std::min<size_t>(BRANCHING, child_count - node * BRANCHING);
+					for (size_t child = 0; child < group_size; ++child)
+					{
+						group[child] = children[node * BRANCHING + child];
+					}
+					const BoundingSphere merged = BoundingSphere::compute_containing_sphere(group, group_size);
+
+					// The runs start on block boundaries, and the padding of the last block repeats a real sphere
+					const SoaVector3 center = soa_splat(merged.center());
+					XMVECTOR radius = XMVectorZero();
+					const size_t first_block = node * span / BRANCHING;
+					const size_t last_block = std::min((node + 1) * span / BRANCHING, leaves.block_count());
+					for (size_t block = first_block; block < last_block; ++block)
+					{
+						const SoaBlock<BoundingSphere> sphere = leaves.load_block(block);
+						const XMVECTOR distance = XMVectorSqrt(soa_length_squared(soa_subtract(::centers(sphere), center)));
+						radius = XMVectorMax(radius, XMVectorAdd(distance, sphere[Traits::RADIUS]));
+					}
+
+					nodes.set(node, BoundingSphere(merged.center(), std::min(merged.radius(), XMVectorGetX(::horizontal_max(radius)))));
+				}
+			});
+		}
+	}
+
+	//--------------------------------------------------------------------------
+	// Queries
+	//
+
+	void SphereTree::query(const BoundingSphere& sphere, std::vector<uint_t>& objects) const
+	{
+		query_nodes(::SphereClassifier(sphere), objects);
+	}
+
+	void SphereTree::query(const Vector3& point, float radius, std::vector<uint_t>& objects) const
+	{
+		query_nodes(::SphereClassifier(BoundingSphere(point, radius)), objects);
+	}
+
+	void SphereTree::query(const Frustum& frustum, std::vector<uint_t>& objects) const
+	{
+		query_nodes(::FrustumClassifier(frustum), objects);
+	}
+
+	// Opens a block of children at a time, starting with the root as the only lane of the last level
+	template <class Classifier>
+	void SphereTree::query_nodes(const Classifier& classifier, std::vector<uint_t>& objects) const
+	{
+		if (is_empty()) return;
+
+		struct Entry
+		{
+			uint_t level;
+			uint_t block;
+		};
+
+		Entry stack[MAX_STACK_SIZE];
+		uint_t stack_size = 0;
+		const Entry root = { static_cast<uint_t>(mLevels.size() - 1), 0 };
+		stack[stack_size++] = root;
+
+		while (stack_size > 0)
+		{
+			const Entry entry = stack[--stack_size];
+			const SoaArray<BoundingSphere>& level = mLevels[entry.level];
+
+			XMVECTORU32 outside;
+			XMVECTORU32 inside;
+			classifier.classify(level.load_block(entry.block), outside.v, inside.v);
+
+			const uint_t lane_count = level.lane_count(entry.block);
+			for (uint_t lane = 0; lane < lane_count; ++lane)
+			{
+				if (outside.u[lane]) continue;
+
+				const uint_t node = entry.block * BRANCHING + lane;
+				if (entry.level == 0)
+				{
+					objects.push_back(mObjects[node]);
+				}
+				else if (inside.u[lane])
+				{
+					size_t span = 1;
+					for (uint_t i = 0; i < entry.level; ++i) span *= BRANCHING;
+					const size_t first = node * span;
+					const size_t last = std::min(first + span, mObjects.size());
+					objects.insert(objects.end(), mObjects.begin() + first, mObjects.begin() + last);
+				}
+				else
+				{
+					XMASSERT(stack_size < MAX_STACK_SIZE);
+					const Entry child = { entry.level - 1, node };
+					stack[stack_size++] = child;
+				}
+			}
+		}
+	}
+
+	void SphereTree::overlaps(const SphereTree& tree, std::vector<std::pair<uint_t, uint_t>>& pairs) const
+	{
+		if (is_empty() || tree.is_empty() || !::touches(bounds(), tree.bounds())) return;
+
+		std::vector<NodePair> stack;
+		const NodePair roots = { static_cast<uint_t>(mLevels.size() - 1), 0, static_cast<uint_t>(tree.mLevels.size() - 1), 0 };
+		stack.push_back(roots);
+
+		while (!stack.empty())
+		{
+			const NodePair pair = stack.back();
+			stack.pop_back();
+
+			if (pair.level_a == 0 && pair.level_b == 0)
+			{
+				pairs.push_back(std::make_pair(mObjects[pair.index_a], tree.mObjects[pair.index_b]));
+				continue;
+			}
+
+			// Opening the larger of the two (the one higher up its tree) keeps the nodes compared of similar sizes
+			const bool open_a = (pair.level_a >= pair.level_b && pair.level_a > 0) || pair.level_b == 0;
+			const SoaArray<BoundingSphere>& children = open_a ? mLevels[pair.level_a - 1] : tree.mLevels[pair.level_b - 1];
+			const uint_t block = open_a ? pair.index_a : pair.index_b;
+			const BoundingSphere other = open_a ? tree.mLevels[pair.level_b][pair.index_b] : mLevels[pair.level_a][pair.index_a];
+
+			XMVECTORU32 outside;
+			XMVECTORU32 inside;
+			::SphereClassifier(other).classify(children.load_block(block), outside.v, inside.v);
+
+			const uint_t lane_count = children.lane_count(block);
+			for (uint_t lane = 0; lane < lane_count; ++lane)
+			{
+				if (outside.u[lane]) continue;
+
+				NodePair child = pair;
+				if (open_a)
+				{
+					child.level_a = pair.level_a - 1;
+					child.index_a = block * BRANCHING + lane;
+				}
+				else
+				{
+					child.level_b = pair.level_b - 1;
+					child.index_b = block * BRANCHING + lane;
+				}
+				stack.push_back(child);
+			}
+		}
+	}
+
+} // namespace Math
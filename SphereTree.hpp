@@ -0,0 +1,121 @@
+#pragma once
+#ifndef __MATHS_SPHERETREE_HPP__
+#define __MATHS_SPHERETREE_HPP__
+
+#include "BoundingSphere.hpp"
+#include "SoaArray.hpp"
+
+#include <utility>
+#include <vector>
+
+namespace Math
+{
+	class Vector3;
+	class Frustum;
+
+	// Hierarchy of bounding spheres over an array of spheres, such as the ranges of sound emitters or the
+	// positions of agents, for finding which of them are near a point, in a frustum or near another tree's.
+	//
+	// The spheres are sorted by the Morton codes of their centers and grouped four at a time from the bottom
+	// up, each group merged into its parent's sphere with compute_containing_sphere. The parent is then
+	// shrunk to just reach the farthest sphere below it. Every node's four children are stored as one
+	// SoaBlock, so a node is opened with a single four wide sphere test.
+	//
+	// Only spheres are ever tested, so queries are conservative for anything the spheres bound, and report
+	// the index of each sphere in the view the tree was built from.
+	class SphereTree
+	{
+	public:
+		static const uint_t BRANCHING = SOA_LANE_COUNT;
+
+	private:
+		// The first level is the spheres in tree order, each level after it holds a node for every block of the
+		// level before, and the last level is the root alone
+		std::vector<SoaArray<BoundingSphere>> mLevels;
+		std::vector<uint_t> mObjects; // The sphere at each position of the first level
+
+	public:
+		//--------------------------------------------------------------------------
+		// Constructors
+		//
+
+		SphereTree()
+		{
+		}
+
+		// A thread_count of 0 uses all hardware threads, large inputs are split between the threads
+		explicit SphereTree(const SoaView<BoundingSphere>& spheres, uint_t thread_count = 1);
+
+		SphereTree(const SphereTree& tree) : mLevels(tree.mLevels), mObjects(tree.mObjects)
+		{
+		}
+
+		//--------------------------------------------------------------------------
+		// Assignment
+		//
+
+		SphereTree& operator = (const SphereTree& tree)
+		{
+			mLevels = tree.mLevels;
+			mObjects = tree.mObjects;
+			return *this;
+		}
+
+		//--------------------------------------------------------------------------
+		// Accessors
+		//
+
+		bool is_empty() const
+		{
+			return mObjects.empty();
+		}
+
+		size_t object_count() const
+		{
+			return mObjects.size();
+		}
+
+		size_t level_count() const
+		{
+			return mLevels.size();
+		}
+
+		BoundingSphere bounds() const
+		{
+			return is_empty() ? BoundingSphere() : mLevels.back()[0];
+		}
+
+		//--------------------------------------------------------------------------
+		// Building
+		//
+
+		void build(const SoaView<BoundingSphere>& spheres, uint_t thread_count = 1);
+
+		//--------------------------------------------------------------------------
+		// Queries
+		//
+		// The indices of the spheres found are appended to objects, or pairs of indices to pairs. Nodes entirely
+		// inside the query have all their spheres added without testing them.
+		//
+
+		// The spheres touching the sphere
+		void query(const BoundingSphere& sphere, std::vector<uint_t>& objects) const;
+
+		// The spheres within radius of the point
+		void query(const Vector3& point, float radius, std::vector<uint_t>& objects) const;
+
+		// The spheres not outside the frustum
+		void query(const Frustum& frustum, std::vector<uint_t>& objects) const;
+
+		// Every touching pair of a sphere in this tree and a sphere in the other, with this tree's sphere first.
+		// Both trees are walked down together so only the nodes that touch are opened.
+		void overlaps(const SphereTree& tree, std::vector<std::pair<uint_t, uint_t>>& pairs) const;
+
+	private:
+		template <class Classifier>
+		void query_nodes(const Classifier& classifier, std::vector<uint_t>& objects) const;
+	};
+
+} // namespace Math
+
+#endif // __MATHS_SPHERETREE_HPP__
@@ -0,0 +1,426 @@
+#include "Precompiled.hpp"
+#include "Sweep.hpp"
+#include "Plane.hpp"
+#include "Line.hpp"
+#include "BoundingSphere.hpp"
+#include "BoundingBox.hpp"
+#include "Triangle.hpp"
+#include "Capsule.hpp"
+#include "SoaArray.hpp"
+#include "SoaVector3.hpp"
+
+namespace
+{
+	// Squared lengths below this are treated as no movement, or as a segment of zero length
+	const float DEGENERATE_LENGTH_SQUARED = FLT_EPSILON * FLT_EPSILON;
+
+	float dot(FXMVECTOR a, FXMVECTOR b)
+	{
+		return XMVectorGetX(XMVector3Dot(a, b));
+	}
+
+	// Time a point moving from origin by movement first comes within radius of center
+	Math::Intersect::LinearResult sweep_sphere(FXMVECTOR origin, FXMVECTOR movement, FXMVECTOR center, float radius)
+	{
+		const XMVECTOR offset = XMVectorSubtract(origin, center);
+		const float c = dot(offset, offset) - radius * radius;
+		if (c <= 0.0f) return Math::Intersect::LinearResult(0.0f);
+
+		// Moving away from the center, or not moving at all
+		const float b = dot(movement, offset);
+		if (b >= 0.0f) return Math::Intersect::LinearResult();
+
+		const float a = dot(movement, movement);
+		const float discriminant = b * b - a * c;
+		if (discriminant < 0.0f) return Math::Intersect::LinearResult();
+
+		// The smaller root (-b - sqrt) / a written as c / (-b + sqrt), which does not cancel
+		const float t = c / (std::sqrt(discriminant) - b);
+		if (t > 1.0f) return Math::Intersect::LinearResult();
+		return Math::Intersect::LinearResult(t);
+	}
+
+	// Time a point moving from origin by movement first comes within radius of the segment [start, end], so a ray against
+	// capsule test. The capsule is the union of a cylinder and two end spheres, and the first contact is with one of them.
+	Math::Intersect::LinearResult sweep_capsule(FXMVECTOR origin, FXMVECTOR movement, FXMVECTOR start, CXMVECTOR end, float radius)
+	{
+		const XMVECTOR axis = XMVectorSubtract(end, start);
+		const XMVECTOR offset = XMVectorSubtract(origin, start);
+		const float axis_axis = dot(axis, axis);
+		if (axis_axis <= DEGENERATE_LENGTH_SQUARED) return sweep_sphere(origin, movement, start, radius);
+
+		const float axis_offset = dot(axis, offset);
+		const float axis_movement = dot(axis, movement);
+
+		// Squared distance from the infinite axis as a quadratic in t, scaled by axis_axis
+		const float k2 = axis_axis * dot(movement, movement) - axis_movement * axis_movement;
+		const float k1 = axis_axis * dot(movement, offset) - axis_offset * axis_movement;
+		const float k0 = axis_axis * dot(offset, offset) - axis_offset * axis_offset - radius * radius * axis_axis;
+
+		const bool within_axis = 0.0f <= axis_offset && axis_offset <= axis_axis;
+		if (k0 <= 0.0f && within_axis) return Math::Intersect::LinearResult(0.0f);
+
+		// Starting outside the infinite cylinder the whole capsule is inside it, so a hit on the side of the cylinder
+		// between the ends is the first contact. Otherwise the contact can only be with one of the end spheres.
+		if (k0 > 0.0f && k1 < 0.0f && k2 > DEGENERATE_LENGTH_SQUARED)
+		{
+			const float discriminant = k1 * k1 - k2 * k0;
+			if (discriminant < 0.0f) return Math::Intersect::LinearResult();
+
+			const float t = k0 / (std::sqrt(discriminant) - k1);
+			if (t > 1.0f) return Math::Intersect::LinearResult();
+
+			const float along = axis_offset + t * axis_movement;
+			if (0.0f <= along && along <= axis_axis) return Math::Intersect::LinearResult(t);
+		}
+
+		const Math::Intersect::LinearResult start_result = sweep_sphere(origin, movement, start, radius);
+		const Math::Intersect::LinearResult end_result = sweep_sphere(origin, movement, end, radius);
+		if (!end_result.intersects()) return start_result;
+		if (!start_result.intersects() || end_result.distance() < start_result.distance()) return end_result;
+		return start_result;
+	}
+
+	Math::Intersect::LinearResult earliest(const Math::Intersect::LinearResult& a, const Math::Intersect::LinearResult& b)
+	{
+		if (!a.intersects() || (b.intersects() && b.distance() < a.distance())) return b;
+		return a;
+	}
+
+	// Corner of a box with bit i of corner picking the maximum on axis i
+	XMVECTOR box_corner(FXMVECTOR minimum, FXMVECTOR maximum, uint_t corner)
+	{
+		static const XMVECTORU32 AXIS_MASKS[8] =
+		{
+			{ 0, 0, 0, 0 }, { 0xFFFFFFFF, 0, 0, 0 }, { 0, 0xFFFFFFFF, 0, 0 }, { 0xFFFFFFFF, 0xFFFFFFFF, 0, 0 },
+			{ 0, 0, 0xFFFFFFFF, 0 }, { 0xFFFFFFFF, 0, 0xFFFFFFFF, 0 }, { 0, 0xFFFFFFFF, 0xFFFFFFFF, 0 }, { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0 }
+		};
+		return XMVectorSelect(minimum, maximum, AXIS_MASKS[corner]);
+	}
+
+	// Whether a point on the triangle's plane is inside its edges, with normal being the unnormalised (b - a) x (c - a)
+	bool inside_edges(const Math::Triangle& triangle, FXMVECTOR normal, FXMVECTOR point)
+	{
+		const XMVECTOR a = triangle.point_a;
+		const XMVECTOR b = triangle.point_b;
+		const XMVECTOR c = triangle.point_c;
+		return dot(XMVector3Cross(XMVectorSubtract(b, a), XMVectorSubtract(point, a)), normal) >= 0.0f &&
+			dot(XMVector3Cross(XMVectorSubtract(c, b), XMVectorSubtract(point, b)), normal) >= 0.0f &&
+			dot(XMVector3Cross(XMVectorSubtract(a, c), XMVectorSubtract(point, c)), normal) >= 0.0f;
+	}
+
+	// Narrows [entry, exit] to the times a point moving from origin by movement is within [minimum, maximum] on one axis
+	void slab_axis(FXMVECTOR origin, FXMVECTOR movement, FXMVECTOR minimum, CXMVECTOR maximum, XMVECTOR& entry, XMVECTOR& exit)
+	{
+		const XMVECTOR parallel = XMVectorLessOrEqual(XMVectorAbs(movement), XMVectorSplatEpsilon());
+		const XMVECTOR inverse = XMVectorReciprocal(movement);
+		const XMVECTOR t1 = XMVectorMultiply(XMVectorSubtract(minimum, origin), inverse);
+		const XMVECTOR t2 = XMVectorMultiply(XMVectorSubtract(maximum, origin), inverse);
+
+		// A parallel slab is either never left or never entered
+		const XMVECTOR inside = XMVectorAndInt(XMVectorGreaterOrEqual(origin, minimum), XMVectorLessOrEqual(origin, maximum));
+		const XMVECTOR infinity = XMVectorSplatInfinity();
+		const XMVECTOR parallel_entry = XMVectorSelect(infinity, XMVectorNegate(infinity), inside);
+		const XMVECTOR parallel_exit = XMVectorSelect(XMVectorNegate(infinity), infinity, inside);
+
+		entry = XMVectorMax(entry, XMVectorSelect(XMVectorMin(t1, t2), parallel_entry, parallel));
+		exit = XMVectorMin(exit, XMVectorSelect(XMVectorMax(t1, t2), parallel_exit, parallel));
+	}
+
+	// Times a point moving from origin by movement enters each box of a block, in [0, 1] and zero when it starts inside.
+	// Lanes where the point misses the box are cleared in hit.
+	XMVECTOR slab_entry(const Math::SoaVector3& origin, const Math::SoaVector3& movement, const Math::SoaVector3& minimum, const Math::SoaVector3& maximum, XMVECTOR& hit)
+	{
+		XMVECTOR entry = XMVectorZero();
+		XMVECTOR exit = XMVectorSplatOne();
+		slab_axis(origin.x, movement.x, minimum.x, maximum.x, entry, exit);
+		slab_axis(origin.y, movement.y, minimum.y, maximum.y, entry, exit);
+		slab_axis(origin.z, movement.z, minimum.z, maximum.z, entry, exit);
+
+		hit = XMVectorLessOrEqual(entry, exit);
+		return entry;
+	}
+
+	// Writes the lanes of a block that hold real elements, so results only needs to hold the view's size
+	void store_results(FXMVECTOR hit, FXMVECTOR time, Math::Intersect::LinearResult* results, size_t block, uint_t lane_count)
+	{
+		XMVECTORU32 hits;
+		XMVECTORF32 times;
+		hits.v = hit;
+		times.v = time;
+
+		Math::Intersect::LinearResult* output = results + block * Math::SOA_LANE_COUNT;
+		for (uint_t lane = 0; lane < lane_count; ++lane)
+		{
+			output[lane] = hits.u[lane] ? Math::Intersect::LinearResult(times.f[lane]) : Math::Intersect::LinearResult();
+		}
+	}
+}
+
+namespace Math
+{
+
+	Intersect::LinearResult Sweep::test(const BoundingSphere& sphereA, const Vector3& movement, const Plane& planeB)
+	{
+		// The plane is touched when the center's distance from it is the radius, on whichever side the sphere starts
+		const float radius = sphereA.radius();
+		const float distance = planeB.distance(sphereA.center());
+		if (std::abs(distance) <= radius) return Intersect::LinearResult(0.0f);
+
+		const float rate = planeB.dot_normal(movement);
+		if (distance * rate >= 0.0f) return Intersect::LinearResult();
+
+		const float t = (distance - std::copysign(radius, distance)) / -rate;
+		if (t > 1.0f) return Intersect::LinearResult();
+		return Intersect::LinearResult(t);
+	}
+
+	Intersect::LinearResult Sweep::test(const BoundingSphere& sphereA, const Vector3& movement, const BoundingSphere& sphereB)
+	{
+		return ::sweep_sphere(sphereA.center(), movement, sphereB.center(), sphereA.radius() + sphereB.radius());
+	}
+
+	Intersect::LinearResult Sweep::test(const BoundingSphere& sphereA, const Vector3& movement, const BoundingBox& boxB)
+	{
+		// From Ericson's Real-Time Collision Detection (5.5.7). The center is swept against the box grown by the radius,
+		// and when it enters beside an edge or a corner of the original box the rounded part there is tested as capsules.
+		const XMVECTOR center = sphereA.center();
+		const float radius = sphereA.radius();
+		const XMVECTOR minimum = boxB.minimum_corner();
+		const XMVECTOR maximum = boxB.maximum_corner();
+
+		const XMVECTOR closest = XMVectorClamp(center, minimum, maximum);
+		if (XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(center, closest))) <= radius * radius) return Intersect::LinearResult(0.0f);
+		if (movement.length_squared() <= DEGENERATE_LENGTH_SQUARED) return Intersect::LinearResult();
+
+		const XMVECTOR grow = XMVectorReplicate(radius);
+		const BoundingBox grown(Vector3(XMVectorSubtract(minimum, grow)), Vector3(XMVectorAdd(maximum, grow)), ALREADY_SORTED);
+		const Intersect::LinearResult entry = Intersect::test(Line(sphereA.center(), sphereA.center() + movement), grown);
+		if (!entry.intersects()) return entry;
+
+		// Bit i of below and above is set when the entry point is outside the original box on axis i
+		const Vector3 point(XMVectorMultiplyAdd(movement, XMVectorReplicate(entry.distance()), center));
+		const Vector3& box_min = boxB.minimum_corner();
+		const Vector3& box_max = boxB.maximum_corner();
+		const uint_t below = (point.x < box_min.x ? 1 : 0) | (point.y < box_min.y ? 2 : 0) | (point.z < box_min.z ? 4 : 0);
+		const uint_t above = (point.x > box_max.x ? 1 : 0) | (point.y > box_max.y ? 2 : 0) | (point.z > box_max.z ? 4 : 0);
+		const uint_t outside = below | above;
+
+		// Beside a face the grown box is exact
+		if (outside == 0 || outside == 1 || outside == 2 || outside == 4) return entry;
+
+		if (outside == 7)
+		{
+			// Beside a corner, the first contact is with one of the three edges that meet there
+			Intersect::LinearResult result;
+			for (uint_t axis = 1; axis < 8; axis <<= 1)
+			{
+				result = ::earliest(result, ::sweep_capsule(center, movement, ::box_corner(minimum, maximum, above), ::box_corner(minimum, maximum, above ^ axis), radius));
+			}
+			return result;
+		}
+
+		// Beside an edge, which runs along the one axis the point is inside on
+		const uint_t axis = 7 & ~outside;
+		return ::sweep_capsule(center, movement, ::box_corner(minimum, maximum, above), ::box_corner(minimum, maximum, above | axis), radius);
+	}
+
+	Intersect::LinearResult Sweep::test(const BoundingSphere& sphereA, const Vector3& movement, const Triangle& triangleB)
+	{
+		// The volume the center has to enter is the triangle thickened by the radius, plus a capsule around each edge
+		const XMVECTOR center = sphereA.center();
+		const float radius = sphereA.radius();
+
+		const Vector3 closest = triangleB.closest_point(sphereA.center());
+		if (Vector3(closest - sphereA.center()).length_squared() <= radius * radius) return Intersect::LinearResult(0.0f);
+
+		const XMVECTOR normal = XMVector3Cross(XMVectorSubtract(triangleB.point_b, triangleB.point_a), XMVectorSubtract(triangleB.point_c, triangleB.point_a));
+		const float normal_length = XMVectorGetX(XMVector3Length(normal));
+		if (normal_length > FLT_EPSILON)
+		{
+			const float distance = ::dot(normal, XMVectorSubtract(center, triangleB.point_a)) / normal_length;
+			const float rate = ::dot(normal, movement) / normal_length;
+
+			// Outside the thickened plane the sphere has to reach it before it can touch anything
+			if (std::abs(distance) > radius)
+			{
+				if (distance * rate >= 0.0f) return Intersect::LinearResult();
+
+				const float offset = std::copysign(radius, distance);
+				const float t = (distance - offset) / -rate;
+				if (t > 1.0f) return Intersect::LinearResult();
+
+				// The sphere touches the plane at the point below its center, when that is on the triangle nothing came first
+				const XMVECTOR contact = XMVectorSubtract(XMVectorMultiplyAdd(movement, XMVectorReplicate(t), center), XMVectorScale(normal, offset / normal_length));
+				if (::inside_edges(triangleB, normal, contact)) return Intersect::LinearResult(t);
+			}
+		}
+
+		Intersect::LinearResult result = ::sweep_capsule(center, movement, triangleB.point_a, triangleB.point_b, radius);
+		result = ::earliest(result, ::sweep_capsule(center, movement, triangleB.point_b, triangleB.point_c, radius));
+		return ::earliest(result, ::sweep_capsule(center, movement, triangleB.point_c, triangleB.point_a, radius));
+	}
+
+	Intersect::LinearResult Sweep::test(const BoundingSphere& sphereA, const Vector3& movement, const Capsule& capsuleB)
+	{
+		const Line& segment = capsuleB.segment();
+		return ::sweep_capsule(sphereA.center(), movement, segment.start_point, segment.end_point, sphereA.radius() + capsuleB.radius());
+	}
+
+	Intersect::LinearResult Sweep::test(const BoundingBox& boxA, const Vector3& movement, const BoundingBox& boxB)
+	{
+		// A's center swept against B grown by A's extents, which touches B exactly when A does
+		const Vector3 extents = boxA.extents();
+		const Vector3 center = boxA.center();
+		const BoundingBox grown(boxB.minimum_corner() - extents, boxB.maximum_corner() + extents, ALREADY_SORTED);
+
+		if (grown.contains(center)) return Intersect::LinearResult(0.0f);
+		if (movement.length_squared() <= DEGENERATE_LENGTH_SQUARED) return Intersect::LinearResult();
+		return Intersect::test(Line(center, center + movement), grown);
+	}
+
+
+	void Sweep::test(const BoundingSphere& sphereA, const Vector3& movement, const SoaView<Plane>& planesB, Intersect::LinearResult* results)
+	{
+		typedef SoaTraits<Plane> Traits;
+
+		const SoaVector3 center = soa_splat(sphereA.center());
+		const SoaVector3 velocity = soa_splat(movement);
+		const XMVECTOR radius = XMVectorReplicate(sphereA.radius());
+		const XMVECTOR zero = XMVectorZero();
+
+		for (size_t block = 0; block < planesB.block_count(); ++block)
+		{
+			const SoaBlock<Plane> planes = planesB.load_block(block);
+			const SoaVector3 normal = soa_vector3(planes[Traits::NORMAL_X], planes[Traits::NORMAL_Y], planes[Traits::NORMAL_Z]);
+
+			const XMVECTOR distance = XMVectorAdd(soa_dot(normal, center), planes[Traits::DISTANCE]);
+			const XMVECTOR rate = soa_dot(normal, velocity);
+			const XMVECTOR touching = XMVectorLessOrEqual(XMVectorAbs(distance), radius);
+
+			const XMVECTOR offset = XMVectorSelect(radius, XMVectorNegate(radius), XMVectorLess(distance, zero));
+			const XMVECTOR t = XMVectorDivide(XMVectorSubtract(distance, offset), XMVectorNegate(rate));
+
+			XMVECTOR hit = XMVectorAndInt(XMVectorLess(XMVectorMultiply(distance, rate), zero), XMVectorLessOrEqual(t, XMVectorSplatOne()));
+			hit = XMVectorOrInt(hit, touching);
+			::store_results(hit, XMVectorSelect(t, zero, touching), results, block, planesB.lane_count(block));
+		}
+	}
+
+	void Sweep::test(const BoundingSphere& sphereA, const Vector3& movement, const SoaView<BoundingSphere>& spheresB, Intersect::LinearResult* results)
+	{
+		typedef SoaTraits<BoundingSphere> Traits;
+
+		const SoaVector3 center = soa_splat(sphereA.center());
+		const SoaVector3 velocity = soa_splat(movement);
+		const XMVECTOR radius = XMVectorReplicate(sphereA.radius());
+		const XMVECTOR a = XMVectorReplicate(movement.length_squared());
+		const XMVECTOR zero = XMVectorZero();
+
+		// The same quadratic as sweep_sphere in each lane
+		for (size_t block = 0; block < spheresB.block_count(); ++block)
+		{
+			const SoaBlock<BoundingSphere> spheres = spheresB.load_block(block);
+			const SoaVector3 offset = soa_subtract(center, soa_vector3(spheres[Traits::CENTER_X], spheres[Traits::CENTER_Y], spheres[Traits::CENTER_Z]));
+			const XMVECTOR sum = XMVectorAdd(radius, spheres[Traits::RADIUS]);
+
+			const XMVECTOR c = XMVectorSubtract(soa_length_squared(offset), XMVectorMultiply(sum, sum));
+			const XMVECTOR b = soa_dot(velocity, offset);
+			const XMVECTOR discriminant = XMVectorSubtract(XMVectorMultiply(b, b), XMVectorMultiply(a, c));
+			const XMVECTOR t = XMVectorDivide(c, XMVectorSubtract(XMVectorSqrt(XMVectorMax(discriminant, zero)), b));
+			const XMVECTOR touching = XMVectorLessOrEqual(c, zero);
+
+			XMVECTOR hit = XMVectorAndInt(XMVectorLess(b, zero), XMVectorGreaterOrEqual(discriminant, zero));
+			hit = XMVectorOrInt(XMVectorAndInt(hit, XMVectorLessOrEqual(t, XMVectorSplatOne())), touching);
+			::store_results(hit, XMVectorSelect(t, zero, touching), results, block, spheresB.lane_count(block));
+		}
+	}
+
+	void Sweep::test(const BoundingSphere& sphereA, const Vector3& movement, const SoaView<BoundingBox>& boxesB, Intersect::LinearResult* results)
+	{
+		typedef SoaTraits<BoundingBox> Traits;
+
+		const SoaVector3 center = soa_splat(sphereA.center());
+		const SoaVector3 velocity = soa_splat(movement);
+		const XMVECTOR radius = XMVectorReplicate(sphereA.radius());
+		const XMVECTOR radius_squared = XMVectorMultiply(radius, radius);
+
+		for (size_t block = 0; block < boxesB.block_count(); ++block)
+		{
+			const SoaBlock<BoundingBox> boxes = boxesB.load_block(block);
+			const SoaVector3 minimum = soa_vector3(boxes[Traits::MIN_X], boxes[Traits::MIN_Y], boxes[Traits::MIN_Z]);
+			const SoaVector3 maximum = soa_vector3(boxes[Traits::MAX_X], boxes[Traits::MAX_Y], boxes[Traits::MAX_Z]);
+
+			const SoaVector3 closest = soa_min(soa_max(center, minimum), maximum);
+			const XMVECTOR touching = XMVectorLessOrEqual(soa_length_squared(soa_subtract(center, closest)), radius_squared);
+
+			// Missing the grown box rules a box out, the rest need the scalar test for the rounded edges and corners
+			const SoaVector3 grow = soa_vector3(radius, radius, radius);
+			XMVECTOR candidate;
+			::slab_entry(center, velocity, soa_subtract(minimum, grow), soa_add(maximum, grow), candidate);
+			::store_results(touching, XMVectorZero(), results, block, boxesB.lane_count(block));
+
+			XMVECTORU32 refine;
+			refine.v = XMVectorAndCInt(candidate, touching);
+			for (uint_t lane = 0; lane < boxesB.lane_count(block); ++lane)
+			{
+				const size_t index = block * SOA_LANE_COUNT + lane;
+				if (refine.u[lane]) results[index] = test(sphereA, movement, boxesB[index]);
+			}
+		}
+	}
+
+	void Sweep::test(const BoundingSphere& sphereA, const Vector3& movement, const SoaView<Triangle>& trianglesB, Intersect::LinearResult* results)
+	{
+		typedef SoaTraits<Triangle> Traits;
+
+		// Triangles whose bounds, grown by the radius, the center never passes through are ruled out four at a time
+		const SoaVector3 center = soa_splat(sphereA.center());
+		const SoaVector3 velocity = soa_splat(movement);
+		const XMVECTOR radius = XMVectorReplicate(sphereA.radius());
+		const SoaVector3 grow = soa_vector3(radius, radius, radius);
+
+		for (size_t block = 0; block < trianglesB.block_count(); ++block)
+		{
+			const SoaBlock<Triangle> triangles = trianglesB.load_block(block);
+			const SoaVector3 a = soa_vector3(triangles[Traits::A_X], triangles[Traits::A_Y], triangles[Traits::A_Z]);
+			const SoaVector3 b = soa_vector3(triangles[Traits::B_X], triangles[Traits::B_Y], triangles[Traits::B_Z]);
+			const SoaVector3 c = soa_vector3(triangles[Traits::C_X], triangles[Traits::C_Y], triangles[Traits::C_Z]);
+
+			const SoaVector3 minimum = soa_subtract(soa_min(soa_min(a, b), c), grow);
+			const SoaVector3 maximum = soa_add(soa_max(soa_max(a, b), c), grow);
+			XMVECTOR candidate;
+			::slab_entry(center, velocity, minimum, maximum, candidate);
+
+			XMVECTORU32 refine;
+			refine.v = candidate;
+			for (uint_t lane = 0; lane < trianglesB.lane_count(block); ++lane)
+			{
+				const size_t index = block * SOA_LANE_COUNT + lane;
+				results[index] = refine.u[lane] ? test(sphereA, movement, trianglesB[index]) : Intersect::LinearResult();
+			}
+		}
+	}
+
+	void Sweep::test(const BoundingBox& boxA, const Vector3& movement, const SoaView<BoundingBox>& boxesB, Intersect::LinearResult* results)
+	{
+		typedef SoaTraits<BoundingBox> Traits;
+
+		// A's center swept against each B grown by A's extents, as in the single box test
+		const SoaVector3 center = soa_splat(boxA.center());
+		const SoaVector3 extents = soa_splat(boxA.extents());
+		const SoaVector3 velocity = soa_splat(movement);
+
+		for (size_t block = 0; block < boxesB.block_count(); ++block)
+		{
+			const SoaBlock<BoundingBox> boxes = boxesB.load_block(block);
+			const SoaVector3 minimum = soa_vector3(boxes[Traits::MIN_X], boxes[Traits::MIN_Y], boxes[Traits::MIN_Z]);
+			const SoaVector3 maximum = soa_vector3(boxes[Traits::MAX_X], boxes[Traits::MAX_Y], boxes[Traits::MAX_Z]);
+
+			XMVECTOR hit;
+			const XMVECTOR entry = ::slab_entry(center, velocity, soa_subtract(minimum, extents), soa_add(maximum, extents), hit);
+			::store_results(hit, entry, results, block, boxesB.lane_count(block));
+		}
+	}
+
+} // namespace Math
@@ -0,0 +1,43 @@
+#pragma once
+#ifndef __MATHS_SWEEP_HPP__
+#define __MATHS_SWEEP_HPP__
+
+#include "Intersect.hpp"
+
+namespace Math
+{
+	class Vector3;
+	class Plane;
+	class BoundingSphere;
+	class BoundingBox;
+	class Triangle;
+	class Capsule;
+
+	template <class Type> class SoaView;
+
+	namespace Sweep
+	{
+		// Result is: (Intersects, Time of first contact [0, 1])
+		// A starts where it is and moves by movement, the time is the fraction of the movement made before A
+		// first touches B, and is zero when they already touch. A sphere moving along a Line is the sphere at
+		// line.start_point moved by line.vector(). For two moving volumes use the movement of A minus that of B.
+		Intersect::LinearResult test(const BoundingSphere& sphereA, const Vector3& movement, const Plane& planeB);
+		Intersect::LinearResult test(const BoundingSphere& sphereA, const Vector3& movement, const BoundingSphere& sphereB);
+		Intersect::LinearResult test(const BoundingSphere& sphereA, const Vector3& movement, const BoundingBox& boxB);
+		Intersect::LinearResult test(const BoundingSphere& sphereA, const Vector3& movement, const Triangle& triangleB);
+		Intersect::LinearResult test(const BoundingSphere& sphereA, const Vector3& movement, const Capsule& capsuleB);
+		Intersect::LinearResult test(const BoundingBox& boxA, const Vector3& movement, const BoundingBox& boxB);
+
+
+		// One to many, results is given the result against each element of the view
+		void test(const BoundingSphere& sphereA, const Vector3& movement, const SoaView<Plane>& planesB, Intersect::LinearResult* results);
+		void test(const BoundingSphere& sphereA, const Vector3& movement, const SoaView<BoundingSphere>& spheresB, Intersect::LinearResult* results);
+		void test(const BoundingSphere& sphereA, const Vector3& movement, const SoaView<BoundingBox>& boxesB, Intersect::LinearResult* results);
+		void test(const BoundingSphere& sphereA, const Vector3& movement, const SoaView<Triangle>& trianglesB, Intersect::LinearResult* results);
+		void test(const BoundingBox& boxA, const Vector3& movement, const SoaView<BoundingBox>& boxesB, Intersect::LinearResult* results);
+
+	} // namespace Sweep
+
+} // namespace Math
+
+#endif // __MATHS_SWEEP_HPP__
@@ -0,0 +1,131 @@
+#include "../Precompiled.hpp"
+#include "../BoxBvh.hpp"
+#include "../BoundingBox.hpp"
+#include "../SoaArray.hpp"
+#include "Check.hpp"
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+// Times BoxBvh's refits against a full rebuild over a million moving boxes, and compares the cost of the refitted
+// trees with a fresh build's. Each refit must leave the root bounding every box, as the rebuild does.
+
+namespace
+{
+	const uint_t BOX_COUNT = 1000000;
+	const uint_t REPEAT_COUNT = 5;
+
+	std::mt19937 random_engine(46);
+
+	float random_float(float minimum, float maximum)
+	{
+		return std::uniform_real_distribution<float>(minimum, maximum)(random_engine);
+	}
+
+	Math::Vector3 random_vector(float size)
+	{
+		return Math::Vector3(random_float(-size, size), random_float(-size, size), random_float(-size, size));
+	}
+
+	Math::BoundingBox moved_box(const Math::BoundingBox& box, float distance)
+	{
+		const Math::Vector3 offset = random_vector(distance);
+		return Math::BoundingBox(box.minimum_corner() + offset, box.maximum_corner() + offset, Math::ALREADY_SORTED);
+	}
+
+	// The fastest of a few runs in milliseconds, set_up running untimed before each
+	template <class SetUp, class Function>
+	double time_fastest(SetUp set_up, Function function)
+	{
+		double fastest = 0.0;
+		for (uint_t repeat = 0; repeat < REPEAT_COUNT; ++repeat)
+		{
+			set_up();
+			const auto start = std::chrono::steady_clock::now();
+			function();
+			const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			fastest = (repeat == 0) ? milliseconds : std::min(fastest, milliseconds);
+		}
+		return fastest;
+	}
+}
+
+int main()
+{
+	using namespace Math;
+
+	std::vector<BoundingBox> boxes;
+	for (uint_t i = 0; i < BOX_COUNT; ++i)
+	{
+		const Vector3 center = random_vector(1000.0f);
+		const Vector3 extents(random_float(0.0f, 2.0f), random_float(0.0f, 2.0f), random_float(0.0f, 2.0f));
+		boxes.push_back(BoundingBox(center - extents, center + extents, ALREADY_SORTED));
+	}
+
+	const SoaArray<BoundingBox> start_boxes(boxes.begin(), boxes.end());
+	const BoxBvh start_tree(start_boxes.view());
+
+	// Every box moved a little, as in one frame of an animated scene
+	SoaArray<BoundingBox> moved_boxes;
+	for (const BoundingBox& box : boxes)
+	{
+		moved_boxes.push_back(moved_box(box, 4.0f));
+	}
+	const BoundingBox moved_bounds = BoundingBox::compute_containing_box(moved_boxes.view());
+
+	BoxBvh tree;
+	const auto reset = [&]() { tree = start_tree; };
+
+	const double rebuild = time_fastest(reset, [&]() { tree.build(moved_boxes.view()); });
+	const float rebuild_cost = tree.cost();
+	Tests::check(tree.bounds() == moved_bounds, "the rebuilt tree bounds every box");
+
+	const double full_refit = time_fastest(reset, [&]() { tree.refit(moved_boxes.view()); });
+	const float refit_cost = tree.cost();
+	Tests::check(tree.bounds() == moved_bounds, "the refitted tree bounds every box");
+
+	const double full_rotate = time_fastest(reset, [&]() { tree.refit(moved_boxes.view(), true); });
+	const float rotate_cost = tree.cost();
+	Tests::check(tree.bounds() == moved_bounds, "the refitted and rotated tree bounds every box");
+
+	std::printf("%u boxes, fastest of %u runs\n", BOX_COUNT, REPEAT_COUNT);
+	std::printf("rebuild               %8.2f ms  cost %.2f\n", rebuild, rebuild_cost);
+	std::printf("full refit            %8.2f ms  cost %.2f  %.1fx faster\n", full_refit, refit_cost, rebuild / full_refit);
+	std::printf("full refit and rotate %8.2f ms  cost %.2f  %.1fx faster\n", full_rotate, rotate_cost, rebuild / full_rotate);
+
+	// Only some of the boxes moved, refitting the nodes above their dirty leaves
+	for (uint_t percent : { 1u, 10u })
+	{
+		const uint_t moved_count = BOX_COUNT / 100 * percent;
+		std::vector<uint_t> objects;
+		for (uint_t i = 0; i < moved_count; ++i)
+		{
+			objects.push_back(random_engine() % BOX_COUNT);
+		}
+
+		SoaArray<BoundingBox> partly_moved = start_boxes;
+		for (uint_t object : objects)
+		{
+			partly_moved.set(object, moved_boxes[object]);
+		}
+		const BoundingBox partly_moved_bounds = BoundingBox::compute_containing_box(partly_moved.view());
+
+		const auto update = [&]()
+		{
+			tree = start_tree;
+			for (uint_t object : objects)
+			{
+				tree.update(object, moved_boxes[object]);
+			}
+		};
+
+		const double dirty_refit = time_fastest(update, [&]() { tree.refit(); });
+		Tests::check(tree.bounds() == partly_moved_bounds, "the tree refitted from dirty leaves bounds every box");
+
+		const double dirty_rebuild = time_fastest(reset, [&]() { tree.build(partly_moved.view()); });
+		std::printf("%3u%% dirty refit       %8.2f ms  against a rebuild of %.2f ms, %.1fx faster\n", percent, dirty_refit, dirty_rebuild, dirty_rebuild / dirty_refit);
+	}
+
+	return Tests::failure_count();
+}
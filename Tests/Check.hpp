@@ -0,0 +1,28 @@
+#pragma once
+#ifndef __MATHS_TESTS_CHECK_HPP__
+#define __MATHS_TESTS_CHECK_HPP__
+
+#include <cstdio>
+
+// The tests are standalone programs built with the library's sources. Each one reports the checks that fail
+// and returns the number of them from main, so zero means it passed.
+namespace Tests
+{
+	inline int& failure_count()
+	{
+		static int count = 0;
+		return count;
+	}
+
+	inline void check(bool condition, const char* description)
+	{
+		if (!condition)
+		{
+			++failure_count();
+			std::printf("FAILED: %s\n", description);
+		}
+	}
+
+} // namespace Tests
+
+#endif // __MATHS_TESTS_CHECK_HPP__
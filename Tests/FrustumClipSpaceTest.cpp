@@ -0,0 +1,75 @@
+#include "../Precompiled.hpp"
+#include "../Frustum.hpp"
+#include "../Matrix.hpp"
+#include "../BoundingBox.hpp"
+#include "../SoaArray.hpp"
+#include "Check.hpp"
+
+#include <random>
+#include <vector>
+
+// Frustum::test_clip_space against the plane test it stands in for. Its bound is looser than the planes, so it
+// may call a box intersecting that the planes find inside or outside, but it must never reject a box the planes
+// accept or call a box inside that the planes do not.
+
+namespace
+{
+	std::mt19937 random_engine(40);
+
+	float random_float(float minimum, float maximum)
+	{
+		return std::uniform_real_distribution<float>(minimum, maximum)(random_engine);
+	}
+
+	Math::Vector3 random_vector(float size)
+	{
+		return Math::Vector3(random_float(-size, size), random_float(-size, size), random_float(-size, size));
+	}
+}
+
+int main()
+{
+	using namespace Math;
+
+	size_t box_count = 0;
+	size_t same_count = 0;
+
+	for (uint_t camera = 0; camera < 60; ++camera)
+	{
+		const Matrix view = Matrix::look_at(random_vector(20.0f), random_vector(5.0f), Vector3::UNIT_Y);
+		const Matrix projection = (camera % 3 == 2) ?
+			Matrix::orthographic(30.0f, 20.0f, 0.5f, 80.0f) :
+			Matrix::perspective_fov(random_float(0.5f, 1.5f), random_float(0.8f, 2.0f), random_float(0.05f, 1.0f), random_float(50.0f, 200.0f));
+
+		Frustum frustum;
+		frustum.set_from(view * projection);
+
+		std::vector<BoundingBox> boxes;
+		for (uint_t i = 0; i < 2003; ++i)
+		{
+			const Vector3 center = random_vector(60.0f);
+			const Vector3 extents(random_float(0.01f, 4.0f), random_float(0.01f, 4.0f), random_float(0.01f, 4.0f));
+			boxes.push_back(BoundingBox(center - extents, center + extents, ALREADY_SORTED));
+		}
+
+		const SoaArray<BoundingBox> soa_boxes(boxes.begin(), boxes.end());
+		std::vector<Intersect::PlaneResult> batch_results(boxes.size());
+		frustum.test_clip_space(soa_boxes.view(), batch_results.data());
+
+		for (size_t i = 0; i < boxes.size(); ++i)
+		{
+			const Intersect::PlaneResult planes = frustum.test(boxes[i]);
+			const Intersect::PlaneResult clip_space = frustum.test_clip_space(boxes[i]);
+
+			Tests::check(batch_results[i] == clip_space, "the batch and single box clip space tests agree");
+			Tests::check(clip_space != Intersect::OUTSIDE_PLANE || planes == Intersect::OUTSIDE_PLANE, "a box outside in clip space is outside the planes");
+			Tests::check(clip_space != Intersect::INSIDE_PLANE || planes == Intersect::INSIDE_PLANE, "a box inside in clip space is inside the planes");
+
+			++box_count;
+			if (clip_space == planes) ++same_count;
+		}
+	}
+
+	std::printf("%u of %u boxes have the same result from both tests\n", static_cast<uint_t>(same_count), static_cast<uint_t>(box_count));
+	return Tests::failure_count();
+}
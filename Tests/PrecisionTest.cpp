@@ -0,0 +1,126 @@
+#include "../Precompiled.hpp"
+#include "../Precision.hpp"
+#include "../Vector2.hpp"
+#include "../Vector3.hpp"
+#include "../Vector4.hpp"
+#include "../Quaternion.hpp"
+#include "Check.hpp"
+
+#include <random>
+
+// The FAST kernels of Precision.hpp, the hardware estimate refined by one Newton-Raphson step, against the
+// documented bound of a relative error below 1e-6. Measured against double precision from the smallest to the
+// largest normal floats, along with the zero and denormal inputs that the FAST lengths give zero.
+
+namespace
+{
+	const double DOCUMENTED_BOUND = 1.0e-6;
+
+	std::mt19937 random_engine(49);
+
+	float random_float(float minimum, float maximum)
+	{
+		return std::uniform_real_distribution<float>(minimum, maximum)(random_engine);
+	}
+
+	double relative_error(float value, double expected)
+	{
+		return std::abs(value - expected) / std::abs(expected);
+	}
+
+	// A component of magnitude a quarter of the scale up to the scale, either sign
+	float random_component(float scale)
+	{
+		return random_float(0.25f, 1.0f) * scale * ((random_engine() & 1) ? 1.0f : -1.0f);
+	}
+
+	float first_lane(FXMVECTOR v)
+	{
+		return XMVectorGetX(v);
+	}
+}
+
+int main()
+{
+	using namespace Math;
+
+	double worst_reciprocal = 0.0;
+	double worst_reciprocal_length = 0.0;
+	double worst_length = 0.0;
+
+	// Every binade of the normal floats, with the results normal floats too
+	for (int exponent = -126; exponent <= 127; ++exponent)
+	{
+		for (uint_t i = 0; i < 2000; ++i)
+		{
+			const float v = std::ldexp(random_float(1.0f, 2.0f), exponent);
+			const XMVECTOR splat = XMVectorReplicate(v);
+
+			worst_reciprocal_length = std::max(worst_reciprocal_length, relative_error(first_lane(reciprocal_length(splat, Precision::FAST)), 1.0 / std::sqrt(static_cast<double>(v))));
+			worst_length = std::max(worst_length, relative_error(first_lane(length_from_squared(splat, Precision::FAST)), std::sqrt(static_cast<double>(v))));
+
+			if (exponent < 126)
+			{
+				worst_reciprocal = std::max(worst_reciprocal, relative_error(first_lane(reciprocal(splat, Precision::FAST)), 1.0 / v));
+				worst_reciprocal = std::max(worst_reciprocal, relative_error(first_lane(reciprocal(XMVectorNegate(splat), Precision::FAST)), -1.0 / v));
+			}
+		}
+	}
+
+	std::printf("worst relative error of reciprocal %.3g, reciprocal_length %.3g, length_from_squared %.3g\n", worst_reciprocal, worst_reciprocal_length, worst_length);
+	Tests::check(worst_reciprocal < DOCUMENTED_BOUND, "reciprocal is within the documented bound");
+	Tests::check(worst_reciprocal_length < DOCUMENTED_BOUND, "reciprocal_length is within the documented bound");
+	Tests::check(worst_length < DOCUMENTED_BOUND, "length_from_squared is within the documented bound");
+
+	// Zero, and squared lengths too small to be normal floats, give zero rather than infinity or NaN
+	const float small_inputs[] = { 0.0f, std::ldexp(1.0f, -149), std::ldexp(1.0f, -130), FLT_MIN * 0.5f };
+	for (float v : small_inputs)
+	{
+		Tests::check(first_lane(reciprocal_length(XMVectorReplicate(v), Precision::FAST)) == 0.0f, "reciprocal_length of zero or a denormal is zero");
+		Tests::check(first_lane(length_from_squared(XMVectorReplicate(v), Precision::FAST)) == 0.0f, "length_from_squared of zero or a denormal is zero");
+	}
+	Tests::check(first_lane(reciprocal_length(XMVectorReplicate(FLT_MIN), Precision::FAST)) > 0.0f, "reciprocal_length of the smallest normal float is not zero");
+
+	// Through the classes, over vectors of lengths from about 1e-18 to 1e18
+	double worst_vector_length = 0.0;
+	double worst_unit_length = 0.0;
+	for (uint_t i = 0; i < 100000; ++i)
+	{
+		const float scale = std::ldexp(1.0f, static_cast<int>(random_float(-60.0f, 60.0f)));
+		const Vector4 v4(random_component(scale), random_component(scale), random_component(scale), random_component(scale));
+		const Vector3 v3(v4.x, v4.y, v4.z);
+		const Vector2 v2(v4.x, v4.y);
+		const Quaternion q(v4.x, v4.y, v4.z, v4.w);
+
+		const double length4 = std::sqrt(static_cast<double>(v4.x) * v4.x + static_cast<double>(v4.y) * v4.y + static_cast<double>(v4.z) * v4.z + static_cast<double>(v4.w) * v4.w);
+		const double length3 = std::sqrt(static_cast<double>(v4.x) * v4.x + static_cast<double>(v4.y) * v4.y + static_cast<double>(v4.z) * v4.z);
+		const double length2 = std::sqrt(static_cast<double>(v4.x) * v4.x + static_cast<double>(v4.y) * v4.y);
+
+		// The squared length is rounded to a float before the kernel sees it, which adds up to half an ulp
+		worst_vector_length = std::max(worst_vector_length, relative_error(v2.length(Precision::FAST), length2));
+		worst_vector_length = std::max(worst_vector_length, relative_error(v3.length(Precision::FAST), length3));
+		worst_vector_length = std::max(worst_vector_length, relative_error(v4.length(Precision::FAST), length4));
+		worst_vector_length = std::max(worst_vector_length, relative_error(q.length(Precision::FAST), length4));
+
+		worst_unit_length = std::max(worst_unit_length, std::abs(v2.normalise(Precision::FAST).length() - 1.0));
+		worst_unit_length = std::max(worst_unit_length, std::abs(v3.normalise(Precision::FAST).length() - 1.0));
+		worst_unit_length = std::max(worst_unit_length, std::abs(v4.normalise(Precision::FAST).length() - 1.0));
+
+		Quaternion normalised = q;
+		normalised.normalise(Precision::FAST);
+		worst_unit_length = std::max(worst_unit_length, std::abs(normalised.length() - 1.0));
+	}
+
+	std::printf("worst relative error of the vector lengths %.3g, of the normalised lengths from one %.3g\n", worst_vector_length, worst_unit_length);
+	Tests::check(worst_vector_length < DOCUMENTED_BOUND, "the FAST vector lengths are within the documented bound");
+	Tests::check(worst_unit_length < DOCUMENTED_BOUND, "the FAST normalised vectors are within the documented bound of unit length");
+
+	// Zero and denormal vectors normalise to zero
+	const Vector3 zero(0.0f, 0.0f, 0.0f);
+	const Vector3 denormal(std::ldexp(1.0f, -140), 0.0f, std::ldexp(1.0f, -145));
+	Tests::check(zero.length(Precision::FAST) == 0.0f, "the FAST length of a zero vector is zero");
+	Tests::check(zero.normalise(Precision::FAST) == zero, "a zero vector normalises to zero");
+	Tests::check(denormal.normalise(Precision::FAST) == zero, "a denormal vector normalises to zero");
+
+	return Tests::failure_count();
+}
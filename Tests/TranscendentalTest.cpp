@@ -0,0 +1,167 @@
+#include "../Precompiled.hpp"
+#include "../Transcendental.hpp"
+#include "Check.hpp"
+
+#include <cstring>
+#include <limits>
+
+// The ULP sweep behind the error table in Transcendental.hpp. Each function is measured against double precision
+// at evenly spaced float bit patterns across its range, so every binade is covered, and the largest error must be
+// within the table's bound.
+
+namespace
+{
+	const uint_t SAMPLE_COUNT = 1 << 24;
+
+	float from_bits(uint_t bits)
+	{
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	uint_t to_bits(float value)
+	{
+		uint_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	// The spacing of floats at the magnitude of an exact result, the denormal spacing below the normal floats
+	double ulp(double expected)
+	{
+		if (std::abs(expected) < FLT_MIN) return std::ldexp(1.0, -149);
+		int exponent;
+		std::frexp(expected, &exponent);
+		return std::ldexp(1.0, exponent - 24);
+	}
+
+	struct Errors
+	{
+		double ulps;
+		double absolute;
+	};
+
+	// Errors of function against reference at every bit pattern from first up to last in steps over positive
+	// floats, and again for their negations when both_signs
+	template <class Function, class Reference>
+	Errors sweep(float first, float last, bool both_signs, Function function, Reference reference)
+	{
+		Errors errors = { 0.0, 0.0 };
+		const uint_t first_bits = to_bits(first);
+		const uint_t last_bits = to_bits(last);
+		const uint_t step = std::max((last_bits - first_bits) / SAMPLE_COUNT, 1u);
+
+		for (uint_t bits = first_bits; bits <= last_bits; bits += 4 * step)
+		{
+			for (uint_t sign = 0; sign < (both_signs ? 2u : 1u); ++sign)
+			{
+				XMVECTORF32 inputs;
+				for (uint_t lane = 0; lane < 4; ++lane)
+				{
+					const float input = from_bits(std::min(bits + lane * step, last_bits));
+					inputs.f[lane] = sign ? -input : input;
+				}
+
+				XMVECTORF32 results;
+				results.v = function(inputs.v);
+				for (uint_t lane = 0; lane < 4; ++lane)
+				{
+					const double expected = reference(static_cast<double>(inputs.f[lane]));
+					const double error = std::abs(results.f[lane] - expected);
+					errors.ulps = std::max(errors.ulps, error / ulp(expected));
+					errors.absolute = std::max(errors.absolute, error);
+				}
+			}
+		}
+		return errors;
+	}
+
+	// A denormal result can be no nearer than the nearest denormal, so its error is measured from that
+	template <class Reference>
+	double rounded(Reference reference, double x)
+	{
+		const double expected = reference(x);
+		return (std::abs(expected) < FLT_MIN) ? static_cast<float>(expected) : expected;
+	}
+
+	void report(const char* name, const Errors& errors)
+	{
+		std::printf("%-24s %6.2f ulp  %9.3g absolute\n", name, errors.ulps, errors.absolute);
+	}
+}
+
+int main()
+{
+	using namespace Math;
+
+	const auto sin_reference = [](double x) { return std::sin(x); };
+	const auto cos_reference = [](double x) { return std::cos(x); };
+	const auto exp_reference = [](double x) { return std::exp(x); };
+	const auto log_reference = [](double x) { return std::log(x); };
+
+	const Errors sin_small = sweep(FLT_MIN, 3.14159265f, true, Transcendental::sin, sin_reference);
+	const Errors cos_small = sweep(FLT_MIN, 3.14159265f, true, Transcendental::cos, cos_reference);
+	const Errors sin_large = sweep(FLT_MIN, 8192.0f, true, Transcendental::sin, sin_reference);
+	const Errors cos_large = sweep(FLT_MIN, 8192.0f, true, Transcendental::cos, cos_reference);
+	report("sin, |x| <= pi", sin_small);
+	report("cos, |x| <= pi", cos_small);
+	report("sin, |x| <= 8192", sin_large);
+	report("cos, |x| <= 8192", cos_large);
+	Tests::check(sin_small.ulps <= 2.0 && cos_small.ulps <= 2.0, "sin and cos are within 2 ulp up to pi");
+	Tests::check(sin_large.absolute <= 1.0e-7 && cos_large.absolute <= 1.0e-7, "sin and cos are within 1e-7 up to 8192");
+
+	// atan2 with y from 2^-40 to 2^40 times x, of either sign, for x of either sign and a spread of magnitudes
+	Errors atan2_errors = { 0.0, 0.0 };
+	const float x_values[] = { 1.0f, -1.0f, 3.0e-20f, -7.5e15f, 0.1f, -65536.0f };
+	for (float x : x_values)
+	{
+		const XMVECTOR x_splat = XMVectorReplicate(x);
+		const Errors errors = sweep(std::abs(x) * std::ldexp(1.0f, -40), std::abs(x) * std::ldexp(1.0f, 40), true,
+			[x_splat](FXMVECTOR y) { return Transcendental::atan2(y, x_splat); },
+			[x](double y) { return std::atan2(y, static_cast<double>(x)); });
+		atan2_errors.ulps = std::max(atan2_errors.ulps, errors.ulps);
+		atan2_errors.absolute = std::max(atan2_errors.absolute, errors.absolute);
+	}
+	report("atan2", atan2_errors);
+	Tests::check(atan2_errors.ulps <= 3.5, "atan2 is within 3.5 ulp");
+
+	const Errors acos_errors = sweep(0.0f, 1.0f, true, Transcendental::acos, [](double x) { return std::acos(x); });
+	report("acos, -1 <= x <= 1", acos_errors);
+	Tests::check(acos_errors.ulps <= 1.5, "acos is within 1.5 ulp");
+
+	const Errors exp_positive = sweep(0.0f, 88.0f, false, Transcendental::exp, exp_reference);
+	const Errors exp_negative = sweep(0.0f, 103.0f, false, [](FXMVECTOR x) { return Transcendental::exp(XMVectorNegate(x)); },
+		[exp_reference](double x) { return rounded(exp_reference, -x); });
+	report("exp, 0 <= x <= 88", exp_positive);
+	report("exp, -103 <= x <= 0", exp_negative);
+	Tests::check(exp_positive.ulps <= 1.0 && exp_negative.ulps <= 1.0, "exp is within 1 ulp");
+
+	const Errors log_errors = sweep(from_bits(1), FLT_MAX, false, Transcendental::log, log_reference);
+	report("log, x > 0", log_errors);
+	Tests::check(log_errors.ulps <= 1.0, "log is within 1 ulp");
+
+	// The special values the header documents
+	XMVECTORF32 results;
+	results.v = Transcendental::log(XMVectorSet(0.0f, -1.0f, std::numeric_limits<float>::infinity(), 1.0f));
+	Tests::check(results.f[0] == -std::numeric_limits<float>::infinity(), "log of zero is minus infinity");
+	Tests::check(std::isnan(results.f[1]), "log of a negative number is NaN");
+	Tests::check(results.f[2] == std::numeric_limits<float>::infinity(), "log of infinity is infinity");
+	Tests::check(results.f[3] == 0.0f, "log of one is zero");
+
+	results.v = Transcendental::log(XMVectorSet(std::numeric_limits<float>::quiet_NaN(), -std::numeric_limits<float>::quiet_NaN(), 1.0f, 1.0f));
+	Tests::check(std::isnan(results.f[0]) && std::isnan(results.f[1]), "log of a NaN of either sign is NaN");
+
+	results.v = Transcendental::exp(XMVectorSet(-200.0f, 200.0f, 0.0f, 1.0f));
+	Tests::check(results.f[0] == 0.0f && results.f[1] == std::numeric_limits<float>::infinity(), "exp underflows to zero and overflows to infinity");
+	Tests::check(results.f[2] == 1.0f, "exp of zero is one");
+
+	results.v = Transcendental::acos(XMVectorSet(1.0f, -1.0f, 2.0f, -2.0f));
+	Tests::check(results.f[0] == 0.0f, "acos of one is zero");
+	Tests::check(std::isnan(results.f[2]) && std::isnan(results.f[3]), "acos outside [-1, 1] is NaN");
+
+	results.v = Transcendental::atan2(XMVectorZero(), XMVectorZero());
+	Tests::check(results.f[0] == 0.0f, "atan2 of zero and zero is zero");
+
+	return Tests::failure_count();
+}
@@ -0,0 +1,148 @@
+#include "../Precompiled.hpp"
+#include "../Plane.hpp"
+#include "../Ray.hpp"
+#include "../BoundingBox.hpp"
+#include "Check.hpp"
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+// Times the trusted constructors of Trusted.hpp, which take their input as already normalised or sorted, against
+// the normal ones that normalise the plane or ray direction and sort the box corners. Given input that really is
+// in that form, each trusted constructor must build the same object as the normal one.
+
+namespace
+{
+	const uint_t OBJECT_COUNT = 1000000;
+	const uint_t REPEAT_COUNT = 5;
+
+	std::mt19937 random_engine(34);
+
+	float random_float(float minimum, float maximum)
+	{
+		return std::uniform_real_distribution<float>(minimum, maximum)(random_engine);
+	}
+
+	Math::Vector3 random_vector(float size)
+	{
+		return Math::Vector3(random_float(-size, size), random_float(-size, size), random_float(-size, size));
+	}
+
+	Math::Vector3 random_unit_vector()
+	{
+		Math::Vector3 v = random_vector(1.0f);
+		while (v.length_squared() < 0.01f)
+		{
+			v = random_vector(1.0f);
+		}
+		v.normalise();
+		return v;
+	}
+
+	// Within a few ulps, relative to the larger of one and each component
+	bool nearly_equal(FXMVECTOR a, FXMVECTOR b)
+	{
+		const XMVECTOR tolerance = XMVectorMultiply(XMVectorReplicate(1.0e-6f), XMVectorMax(XMVectorAbs(a), XMVectorSplatOne()));
+		return XMVector4LessOrEqual(XMVectorAbs(XMVectorSubtract(a, b)), tolerance);
+	}
+
+	// The fastest of a few runs in milliseconds
+	template <class Function>
+	double time_fastest(Function function)
+	{
+		double fastest = 0.0;
+		for (uint_t repeat = 0; repeat < REPEAT_COUNT; ++repeat)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			function();
+			const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			fastest = (repeat == 0) ? milliseconds : std::min(fastest, milliseconds);
+		}
+		return fastest;
+	}
+
+	void report(const char* name, double normal, double trusted)
+	{
+		std::printf("%-12s %8.2f ms  trusted %8.2f ms  %.1fx faster\n", name, normal, trusted, normal / trusted);
+	}
+}
+
+int main()
+{
+	using namespace Math;
+
+	// Input that is already in the form the normal constructors would put it in
+	std::vector<Plane> plane_input;
+	std::vector<Vector3> origins;
+	std::vector<Vector3> directions;
+	std::vector<Vector3> minima;
+	std::vector<Vector3> maxima;
+	for (uint_t i = 0; i < OBJECT_COUNT; ++i)
+	{
+		const Vector3 normal = random_unit_vector();
+		plane_input.push_back(Plane(normal.x, normal.y, normal.z, random_float(-1000.0f, 1000.0f), ALREADY_NORMALISED));
+
+		origins.push_back(random_vector(1000.0f));
+		directions.push_back(random_unit_vector());
+
+		const Vector3 center = random_vector(1000.0f);
+		const Vector3 extents(random_float(0.0f, 2.0f), random_float(0.0f, 2.0f), random_float(0.0f, 2.0f));
+		minima.push_back(center - extents);
+		maxima.push_back(center + extents);
+	}
+
+	std::printf("%u objects, fastest of %u runs\n", OBJECT_COUNT, REPEAT_COUNT);
+
+	std::vector<Plane> planes(OBJECT_COUNT);
+	std::vector<Plane> trusted_planes(OBJECT_COUNT);
+	const double plane = time_fastest([&]()
+	{
+		for (uint_t i = 0; i < OBJECT_COUNT; ++i) planes[i] = Plane(XMLoadFloat4A(&plane_input[i]));
+	});
+	const double trusted_plane = time_fastest([&]()
+	{
+		for (uint_t i = 0; i < OBJECT_COUNT; ++i) trusted_planes[i] = Plane(XMLoadFloat4A(&plane_input[i]), ALREADY_NORMALISED);
+	});
+	report("Plane", plane, trusted_plane);
+
+	std::vector<Ray> rays(OBJECT_COUNT);
+	std::vector<Ray> trusted_rays(OBJECT_COUNT);
+	const double ray = time_fastest([&]()
+	{
+		for (uint_t i = 0; i < OBJECT_COUNT; ++i) rays[i] = Ray(origins[i], directions[i]);
+	});
+	const double trusted_ray = time_fastest([&]()
+	{
+		for (uint_t i = 0; i < OBJECT_COUNT; ++i) trusted_rays[i] = Ray(origins[i], directions[i], ALREADY_NORMALISED);
+	});
+	report("Ray", ray, trusted_ray);
+
+	std::vector<BoundingBox> boxes(OBJECT_COUNT);
+	std::vector<BoundingBox> trusted_boxes(OBJECT_COUNT);
+	const double box = time_fastest([&]()
+	{
+		for (uint_t i = 0; i < OBJECT_COUNT; ++i) boxes[i] = BoundingBox(minima[i], maxima[i]);
+	});
+	const double trusted_box = time_fastest([&]()
+	{
+		for (uint_t i = 0; i < OBJECT_COUNT; ++i) trusted_boxes[i] = BoundingBox(minima[i], maxima[i], ALREADY_SORTED);
+	});
+	report("BoundingBox", box, trusted_box);
+
+	// Normalising an already normalised vector may move it by an ulp or so, sorting sorted corners leaves them alone
+	bool planes_match = true;
+	bool rays_match = true;
+	bool boxes_match = true;
+	for (uint_t i = 0; i < OBJECT_COUNT; ++i)
+	{
+		planes_match = planes_match && nearly_equal(XMLoadFloat4A(&planes[i]), XMLoadFloat4A(&trusted_planes[i]));
+		rays_match = rays_match && rays[i].origin() == trusted_rays[i].origin() && nearly_equal(rays[i].direction(), trusted_rays[i].direction());
+		boxes_match = boxes_match && boxes[i] == trusted_boxes[i];
+	}
+	Tests::check(planes_match, "the trusted planes match the normalised ones");
+	Tests::check(rays_match, "the trusted rays match the normalised ones");
+	Tests::check(boxes_match, "the trusted boxes match the sorted ones");
+
+	return Tests::failure_count();
+}
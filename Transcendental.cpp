@@ -0,0 +1,224 @@
+#include "Precompiled.hpp"
+#include "Transcendental.hpp"
+
+namespace
+{
+	const float TWO_OVER_PI = 0.636619772367581343f;
+	const float QUARTER_PI = 0.785398163397448310f;
+	const float HALF_PI = 1.57079632679489662f;
+	const float PI = 3.14159265358979324f;
+
+	// pi / 2 in three parts, the first two short enough that their products with multiples of up to 2^13
+	// (angles up to 8192) are exact, so the angles lose nothing to the reduction but the last part's rounding
+	const float HALF_PI_A = 1.5703125f;
+	const float HALF_PI_B = 4.837512969970703125e-4f;
+	const float HALF_PI_C = 7.54978995489188216e-8f;
+
+	const float LOG2_E = 1.44269504088896341f;
+	const float SQRT_HALF = 0.707106781186547524f;
+
+	// ln 2 in two parts, as for pi / 2
+	const float LN_2_A = 0.693359375f;
+	const float LN_2_B = -2.12194440e-4f;
+
+	// The angles less their nearest multiple of pi / 2 (within +-pi / 4), and which multiple modulo four
+	XMVECTOR reduce_angles(FXMVECTOR angles, XMVECTOR& quadrant)
+	{
+		const XMVECTOR multiple = XMVectorRound(XMVectorMultiply(angles, XMVectorReplicate(TWO_OVER_PI)));
+		XMVECTOR reduced = XMVectorNegativeMultiplySubtract(multiple, XMVectorReplicate(HALF_PI_A), angles);
+		reduced = XMVectorNegativeMultiplySubtract(multiple, XMVectorReplicate(HALF_PI_B), reduced);
+		reduced = XMVectorNegativeMultiplySubtract(multiple, XMVectorReplicate(HALF_PI_C), reduced);
+
+		const XMVECTOR four = XMVectorReplicate(4.0f);
+		quadrant = XMVectorNegativeMultiplySubtract(XMVectorFloor(XMVectorMultiply(multiple, XMVectorReplicate(0.25f))), four, multiple);
+		return reduced;
+	}
+
+	// sin(x) for |x| <= pi / 4, given z = x^2
+	XMVECTOR sin_polynomial(FXMVECTOR x, FXMVECTOR z)
+	{
+		XMVECTOR p = XMVectorMultiplyAdd(XMVectorReplicate(-1.9515295891e-4f), z, XMVectorReplicate(8.3321608736e-3f));
+		p = XMVectorMultiplyAdd(p, z, XMVectorReplicate(-1.6666654611e-1f));
+		return XMVectorMultiplyAdd(XMVectorMultiply(p, z), x, x);
+	}
+
+	// cos(x) for |x| <= pi / 4, given z = x^2
+	XMVECTOR cos_polynomial(FXMVECTOR z)
+	{
+		XMVECTOR p = XMVectorMultiplyAdd(XMVectorReplicate(2.443315711809948e-5f), z, XMVectorReplicate(-1.388731625493765e-3f));
+		p = XMVectorMultiplyAdd(p, z, XMVectorReplicate(4.166664568298827e-2f));
+		const XMVECTOR one_less_half_z = XMVectorNegativeMultiplySubtract(XMVectorReplicate(0.5f), z, XMVectorSplatOne());
+		return XMVectorMultiplyAdd(XMVectorMultiply(p, z), z, one_less_half_z);
+	}
+
+	// atan(x) for 0 <= x <= 1
+	XMVECTOR atan_unit(FXMVECTOR x)
+	{
+		// Above tan(pi / 8), atan(x) = pi / 4 + atan((x - 1) / (x + 1))
+		const XMVECTOR one = XMVectorSplatOne();
+		const XMVECTOR shifted = XMVectorGreater(x, XMVectorReplicate(0.414213562373095049f));
+		const XMVECTOR u = XMVectorSelect(x, XMVectorDivide(XMVectorSubtract(x, one), XMVectorAdd(x, one)), shifted);
+		const XMVECTOR z = XMVectorMultiply(u, u);
+
+		XMVECTOR p = XMVectorMultiplyAdd(XMVectorReplicate(8.05374449538e-2f), z, XMVectorReplicate(-1.38776856032e-1f));
+		p = XMVectorMultiplyAdd(p, z, XMVectorReplicate(1.99777106478e-1f));
+		p = XMVectorMultiplyAdd(p, z, XMVectorReplicate(-3.33329491539e-1f));
+		const XMVECTOR result = XMVectorMultiplyAdd(XMVectorMultiply(p, z), u, u);
+		return XMVectorAdd(result, XMVectorAndInt(shifted, XMVectorReplicate(QUARTER_PI)));
+	}
+
+	// 2^n for whole n in [-126, 127], built from the bits of the float
+	XMVECTOR power_of_two(FXMVECTOR n)
+	{
+		return XMConvertVectorFloatToInt(XMVectorAdd(n, XMVectorReplicate(127.0f)), 23);
+	}
+
+	XMVECTOR copy_sign(FXMVECTOR magnitude, FXMVECTOR sign)
+	{
+		const XMVECTOR sign_bit = XMVectorReplicateInt(0x80000000);
+		return XMVectorOrInt(XMVectorAndCInt(magnitude, sign_bit), XMVectorAndInt(sign, sign_bit));
+	}
+}
+
+namespace Math
+{
+
+	XMVECTOR Transcendental::sin(FXMVECTOR angles)
+	{
+		XMVECTOR sines;
+		XMVECTOR cosines;
+		sin_cos(angles, &sines, &cosines);
+		return sines;
+	}
+
+	XMVECTOR Transcendental::cos(FXMVECTOR angles)
+	{
+		XMVECTOR sines;
+		XMVECTOR cosines;
+		sin_cos(angles, &sines, &cosines);
+		return cosines;
+	}
+
+	void Transcendental::sin_cos(FXMVECTOR angles, XMVECTOR* sines, XMVECTOR* cosines)
+	{
+		XMASSERT(sines && cosines);
+
+		XMVECTOR quadrant;
+		const XMVECTOR reduced = ::reduce_angles(angles, quadrant);
+		const XMVECTOR z = XMVectorMultiply(reduced, reduced);
+		const XMVECTOR s = ::sin_polynomial(reduced, z);
+		const XMVECTOR c = ::cos_polynomial(z);
+
+		// Each quarter turn takes (sin, cos) to (cos, -sin)
+		const XMVECTOR one = XMVectorEqual(quadrant, XMVectorSplatOne());
+		const XMVECTOR two = XMVectorEqual(quadrant, XMVectorReplicate(2.0f));
+		const XMVECTOR three = XMVectorEqual(quadrant, XMVectorReplicate(3.0f));
+		const XMVECTOR swapped = XMVectorOrInt(one, three);
+		const XMVECTOR sine = XMVectorSelect(s, c, swapped);
+		const XMVECTOR cosine = XMVectorSelect(c, s, swapped);
+		*sines = XMVectorSelect(sine, XMVectorNegate(sine), XMVectorOrInt(two, three));
+		*cosines = XMVectorSelect(cosine, XMVectorNegate(cosine), XMVectorOrInt(one, two));
+	}
+
+	XMVECTOR Transcendental::atan2(FXMVECTOR y, FXMVECTOR x)
+	{
+		// The angle within the first octant, then reflected out to the quadrant of (x, y)
+		const XMVECTOR absolute_x = XMVectorAbs(x);
+		const XMVECTOR absolute_y = XMVectorAbs(y);
+		const XMVECTOR larger = XMVectorMax(absolute_x, absolute_y);
+		const XMVECTOR smaller = XMVectorMin(absolute_x, absolute_y);
+
+		XMVECTOR angle = ::atan_unit(XMVectorDivide(smaller, larger));
+		angle = XMVectorSelect(angle, XMVectorSubtract(XMVectorReplicate(HALF_PI), angle), XMVectorGreater(absolute_y, absolute_x));
+		angle = XMVectorSelect(angle, XMVectorSubtract(XMVectorReplicate(PI), angle), XMVectorLess(x, XMVectorZero()));
+		angle = XMVectorSelect(angle, XMVectorZero(), XMVectorEqual(larger, XMVectorZero()));
+		return ::copy_sign(angle, y);
+	}
+
+	XMVECTOR Transcendental::acos(FXMVECTOR v)
+	{
+		// asin(a) from its polynomial, with a = |v| up to a half and a = sqrt((1 - |v|) / 2) above, where
+		// acos(|v|) = 2 asin(a)
+		const XMVECTOR absolute = XMVectorAbs(v);
+		const XMVECTOR half = XMVectorReplicate(0.5f);
+		const XMVECTOR large = XMVectorGreater(absolute, half);
+		const XMVECTOR z = XMVectorSelect(XMVectorMultiply(v, v), XMVectorMultiply(half, XMVectorSubtract(XMVectorSplatOne(), absolute)), large);
+		const XMVECTOR a = XMVectorSelect(absolute, XMVectorSqrt(z), large);
+
+		XMVECTOR p = XMVectorMultiplyAdd(XMVectorReplicate(4.2163199048e-2f), z, XMVectorReplicate(2.4181311049e-2f));
+		p = XMVectorMultiplyAdd(p, z, XMVectorReplicate(4.5470025998e-2f));
+		p = XMVectorMultiplyAdd(p, z, XMVectorReplicate(7.4953002686e-2f));
+		p = XMVectorMultiplyAdd(p, z, XMVectorReplicate(1.6666752422e-1f));
+		const XMVECTOR asin = XMVectorMultiplyAdd(XMVectorMultiply(p, z), a, a);
+
+		const XMVECTOR small_result = XMVectorSubtract(XMVectorReplicate(HALF_PI), ::copy_sign(asin, v));
+		const XMVECTOR twice = XMVectorAdd(asin, asin);
+		const XMVECTOR large_result = XMVectorSelect(twice, XMVectorSubtract(XMVectorReplicate(PI), twice), XMVectorLess(v, XMVectorZero()));
+		return XMVectorSelect(small_result, large_result, large);
+	}
+
+	XMVECTOR Transcendental::exp(FXMVECTOR v)
+	{
+		// e^v = 2^n e^r with n the nearest whole number to v / ln 2, leaving |r| <= ln 2 / 2. Beyond the clamp
+		// the result is zero or infinite anyway.
+		const XMVECTOR clamped = XMVectorClamp(v, XMVectorReplicate(-104.0f), XMVectorReplicate(89.0f));
+		const XMVECTOR n = XMVectorRound(XMVectorMultiply(clamped, XMVectorReplicate(LOG2_E)));
+		XMVECTOR r = XMVectorNegativeMultiplySubtract(n, XMVectorReplicate(LN_2_A), clamped);
+		r = XMVectorNegativeMultiplySubtract(n, XMVectorReplicate(LN_2_B), r);
+
+		XMVECTOR p = XMVectorMultiplyAdd(XMVectorReplicate(1.9875691500e-4f), r, XMVectorReplicate(1.3981999507e-3f));
+		p = XMVectorMultiplyAdd(p, r, XMVectorReplicate(8.3334519073e-3f));
+		p = XMVectorMultiplyAdd(p, r, XMVectorReplicate(4.1665795894e-2f));
+		p = XMVectorMultiplyAdd(p, r, XMVectorReplicate(1.6666665459e-1f));
+		p = XMVectorMultiplyAdd(p, r, XMVectorReplicate(5.0000001201e-1f));
+		const XMVECTOR exp_r = XMVectorAdd(XMVectorMultiplyAdd(XMVectorMultiply(p, r), r, r), XMVectorSplatOne());
+
+		// 2^n in two halves, so that neither leaves the exponents of normal floats and the product can
+		// underflow gradually to a denormal or overflow to infinity
+		const XMVECTOR first_half = XMVectorFloor(XMVectorMultiply(n, XMVectorReplicate(0.5f)));
+		const XMVECTOR second_half = XMVectorSubtract(n, first_half);
+		return XMVectorMultiply(XMVectorMultiply(exp_r, ::power_of_two(first_half)), ::power_of_two(second_half));
+	}
+
+	XMVECTOR Transcendental::log(FXMVECTOR v)
+	{
+		// Denormals are scaled up to normal floats first so their exponents can be read from the bits
+		const XMVECTOR denormal = XMVectorLess(v, XMVectorReplicate(FLT_MIN));
+		const XMVECTOR x = XMVectorSelect(v, XMVectorMultiply(v, XMVectorReplicate(33554432.0f)), denormal);
+
+		// v = m 2^e with m in [sqrt(1/2), sqrt(2)), and log(v) = log(m) + e ln 2
+		const XMVECTOR exponent_bits = XMVectorAndInt(x, XMVectorReplicateInt(0x7F800000));
+		XMVECTOR e = XMVectorSubtract(XMConvertVectorIntToFloat(exponent_bits, 23), XMVectorReplicate(126.0f));
+		e = XMVectorSubtract(e, XMVectorAndInt(denormal, XMVectorReplicate(25.0f)));
+		XMVECTOR m = XMVectorOrInt(XMVectorAndInt(x, XMVectorReplicateInt(0x007FFFFF)), XMVectorReplicateInt(0x3F000000));
+
+		const XMVECTOR one = XMVectorSplatOne();
+		const XMVECTOR low = XMVectorLess(m, XMVectorReplicate(SQRT_HALF));
+		e = XMVectorSubtract(e, XMVectorAndInt(low, one));
+		m = XMVectorSubtract(XMVectorSelect(m, XMVectorAdd(m, m), low), one);
+
+		const XMVECTOR z = XMVectorMultiply(m, m);
+		XMVECTOR p = XMVectorMultiplyAdd(XMVectorReplicate(7.0376836292e-2f), m, XMVectorReplicate(-1.1514610310e-1f));
+		p = XMVectorMultiplyAdd(p, m, XMVectorReplicate(1.1676998740e-1f));
+		p = XMVectorMultiplyAdd(p, m, XMVectorReplicate(-1.2420140846e-1f));
+		p = XMVectorMultiplyAdd(p, m, XMVectorReplicate(1.4249322787e-1f));
+		p = XMVectorMultiplyAdd(p, m, XMVectorReplicate(-1.6668057665e-1f));
+		p = XMVectorMultiplyAdd(p, m, XMVectorReplicate(2.0000714765e-1f));
+		p = XMVectorMultiplyAdd(p, m, XMVectorReplicate(-2.4999993993e-1f));
+		p = XMVectorMultiplyAdd(p, m, XMVectorReplicate(3.3333331174e-1f));
+
+		XMVECTOR y = XMVectorMultiply(XMVectorMultiply(m, z), p);
+		y = XMVectorMultiplyAdd(e, XMVectorReplicate(LN_2_B), y);
+		y = XMVectorNegativeMultiplySubtract(XMVectorReplicate(0.5f), z, y);
+		XMVECTOR result = XMVectorMultiplyAdd(e, XMVectorReplicate(LN_2_A), XMVectorAdd(m, y));
+
+		const XMVECTOR infinity = XMVectorSplatInfinity();
+		result = XMVectorSelect(result, infinity, XMVectorEqual(v, infinity));
+		result = XMVectorSelect(result, XMVectorNegate(infinity), XMVectorEqual(v, XMVectorZero()));
+		result = XMVectorSelect(result, XMVectorReplicateInt(0x7FC00000), XMVectorLess(v, XMVectorZero()));
+
+		// A NaN's exponent bits would otherwise be read as a number
+		return XMVectorSelect(result, v, XMVectorIsNaN(v));
+	}
+
+} // namespace Math
@@ -0,0 +1,49 @@
+#pragma once
+#ifndef __MATHS_TRANSCENDENTAL_HPP__
+#define __MATHS_TRANSCENDENTAL_HPP__
+
+namespace Math
+{
+	// Four wide polynomial approximations of the transcendental functions, for batch kernels that take
+	// the sine, arctangent or exponential of every lane of an SoaBlock. Each function is the same
+	// handful of multiply-adds and selects in every lane, with no branches or table lookups.
+	//
+	// The reductions and polynomials are those of the Cephes single precision library (S. Moshier). The
+	// errors against double precision over the ranges given are within these bounds, as checked by the
+	// sweep over every binade in Tests/TranscendentalTest.cpp:
+	//
+	//     sin, cos     |x| <= pi              2 ulp
+	//                  |x| <= 8192            1e-7 absolute
+	//     atan2        finite x and y         3.5 ulp
+	//     acos         -1 <= x <= 1           1.5 ulp
+	//     exp          -103 <= x <= 88        1 ulp, denormal results included
+	//     log          x > 0, denormals too   1 ulp
+	//
+	// Angles beyond 8192 lose a bit of accuracy for every doubling as the multiple of pi/2 taken off
+	// grows. Outside the ranges the results follow the C library where it matters: exp overflows to
+	// infinity and underflows to zero, log of zero is minus infinity, of infinity is infinity and of a
+	// negative number is NaN, log of a NaN is that NaN, and acos outside [-1, 1] is NaN. Other infinite
+	// and NaN inputs are not handled.
+	namespace Transcendental
+	{
+		XMVECTOR sin(FXMVECTOR angles);
+		XMVECTOR cos(FXMVECTOR angles);
+
+		// Both from one reduction of the angles, for about the cost of one of them
+		void sin_cos(FXMVECTOR angles, XMVECTOR* sines, XMVECTOR* cosines);
+
+		// The angle of (x, y) from the x axis in [-pi, pi], zero when both are zero
+		XMVECTOR atan2(FXMVECTOR y, FXMVECTOR x);
+
+		// In [0, pi]
+		XMVECTOR acos(FXMVECTOR v);
+
+		// Natural exponential and logarithm, XMVectorExp and XMVectorLog being base 2
+		XMVECTOR exp(FXMVECTOR v);
+		XMVECTOR log(FXMVECTOR v);
+
+	} // namespace Transcendental
+
+} // namespace Math
+
+#endif // __MATHS_TRANSCENDENTAL_HPP__
@@ -0,0 +1,71 @@
+#include "Precompiled.hpp"
+#include "Triangle.hpp"
+#include "Plane.hpp"
+
+namespace Math
+{
+	Vector3 Triangle::normal() const
+	{
+		return Vector3(XMVector3Normalize(XMVector3Cross(XMVectorSubtract(point_b, point_a), XMVectorSubtract(point_c, point_a))));
+	}
+
+	float Triangle::area() const
+	{
+		return 0.5f * XMVectorGetX(XMVector3Length(XMVector3Cross(XMVectorSubtract(point_b, point_a), XMVectorSubtract(point_c, point_a))));
+	}
+
+	Vector3 Triangle::centroid() const
+	{
+		static const float THIRD = 1.0f / 3.0f;
+		return Vector3(XMVectorMultiply(XMVectorAdd(XMVectorAdd(point_a, point_b), point_c), XMVectorReplicate(THIRD)));
+	}
+
+	Plane Triangle::plane() const
+	{
+		return Plane(point_a, point_b, point_c);
+	}
+
+	Vector3 Triangle::closest_point(const Vector3& point) const
+	{
+		// Works out which Voronoi region of the triangle the point is in, from Ericson's Real-Time Collision Detection (5.1.5)
+		const Vector3 ab = point_b - point_a;
+		const Vector3 ac = point_c - point_a;
+		const Vector3 ap = point - point_a;
+
+		const float d1 = ab.dot(ap);
+		const float d2 = ac.dot(ap);
+		if (d1 <= 0.0f && d2 <= 0.0f) return point_a;
+
+		const Vector3 bp = point - point_b;
+		const float d3 = ab.dot(bp);
+		const float d4 = ac.dot(bp);
+		if (d3 >= 0.0f && d4 <= d3) return point_b;
+
+		const float vc = d1 * d4 - d3 * d2;
+		if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+		{
+			return point_a + ab * (d1 / (d1 - d3));
+		}
+
+		const Vector3 cp = point - point_c;
+		const float d5 = ab.dot(cp);
+		const float d6 = ac.dot(cp);
+		if (d6 >= 0.0f && d5 <= d6) return point_c;
+
+		const float vb = d5 * d2 - d1 * d6;
+		if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+		{
+			return point_a + ac * (d2 / (d2 - d6));
+		}
+
+		const float va = d3 * d6 - d5 * d4;
+		if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+		{
+			return point_b + (point_c - point_b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+		}
+
+		const float denom = 1.0f / (va + vb + vc);
+		return point_at(vb * denom, vc * denom);
+	}
+
+} // namespace Math
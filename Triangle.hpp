@@ -0,0 +1,109 @@
+#pragma once
+#ifndef __MATHS_TRIANGLE_HPP__
+#define __MATHS_TRIANGLE_HPP__
+
+#include "Vector3.hpp"
+
+namespace Math
+{
+	class Plane;
+	template <class Type> struct SoaTraits;
+
+	class Triangle
+	{
+	public:
+		Vector3 point_a;
+		Vector3 point_b;
+		Vector3 point_c;
+
+		Triangle()
+		{
+		}
+
+		Triangle(const Vector3& a, const Vector3& b, const Vector3& c) : point_a(a), point_b(b), point_c(c)
+		{
+		}
+
+		Triangle(const Triangle& triangle) : point_a(triangle.point_a), point_b(triangle.point_b), point_c(triangle.point_c)
+		{
+		}
+
+		Triangle& operator = (const Triangle& triangle)
+		{
+			point_a = triangle.point_a;
+			point_b = triangle.point_b;
+			point_c = triangle.point_c;
+			return *this;
+		}
+
+		bool operator == (const Triangle& triangle) const
+		{
+			return point_a == triangle.point_a && point_b == triangle.point_b && point_c == triangle.point_c;
+		}
+
+		bool operator != (const Triangle& triangle) const
+		{
+			return point_a != triangle.point_a || point_b != triangle.point_b || point_c != triangle.point_c;
+		}
+
+
+		// Normalised, facing the side from which the points are clockwise (matching the left handed Matrix functions)
+		Vector3 normal() const;
+
+		float area() const;
+
+		Vector3 centroid() const;
+
+		Plane plane() const;
+
+		// Point from barycentric coordinates, weighted (1 - u - v) for A, u for B and v for C
+		Vector3 point_at(float u, float v) const
+		{
+			return point_a + (point_b - point_a) * u + (point_c - point_a) * v;
+		}
+
+		Vector3 closest_point(const Vector3& point) const;
+	};
+
+	// Component layout of an SoaArray<Triangle>
+	template <> struct SoaTraits<Triangle>
+	{
+		enum Component : uint_t
+		{
+			A_X,
+			A_Y,
+			A_Z,
+			B_X,
+			B_Y,
+			B_Z,
+			C_X,
+			C_Y,
+			C_Z,
+
+			COMPONENT_COUNT
+		};
+
+		static void scatter(const Triangle& triangle, float* components)
+		{
+			components[A_X] = triangle.point_a.x;
+			components[A_Y] = triangle.point_a.y;
+			components[A_Z] = triangle.point_a.z;
+			components[B_X] = triangle.point_b.x;
+			components[B_Y] = triangle.point_b.y;
+			components[B_Z] = triangle.point_b.z;
+			components[C_X] = triangle.point_c.x;
+			components[C_Y] = triangle.point_c.y;
+			components[C_Z] = triangle.point_c.z;
+		}
+
+		static Triangle gather(const float* components)
+		{
+			return Triangle(Vector3(components[A_X], components[A_Y], components[A_Z]),
+				Vector3(components[B_X], components[B_Y], components[B_Z]),
+				Vector3(components[C_X], components[C_Y], components[C_Z]));
+		}
+	};
+
+} // namespace Math
+
+#endif // __MATHS_TRIANGLE_HPP__
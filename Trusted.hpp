@@ -0,0 +1,31 @@
+#pragma once
+#ifndef __MATHS_TRUSTED_HPP__
+#define __MATHS_TRUSTED_HPP__
+
+namespace Math
+{
+	// How far a squared length may be from one and still count as normalised
+	static const float UNIT_LENGTH_TOLERANCE = 1.0e-4f;
+
+	//--------------------------------------------------------------------------
+	// Trusted Construction Tags
+	//
+	// Passed to the constructors and setters that take their input as already being
+	// in the form the normal ones would put it in, so the normalising or sorting is
+	// skipped. Debug builds assert that the input really is in that form.
+	//
+
+	struct AlreadyNormalised
+	{
+	};
+
+	struct AlreadySorted
+	{
+	};
+
+	static const AlreadyNormalised ALREADY_NORMALISED = AlreadyNormalised();
+	static const AlreadySorted ALREADY_SORTED = AlreadySorted();
+
+} // namespace Math
+
+#endif // __MATHS_TRUSTED_HPP__
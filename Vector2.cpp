@@ -17,6 +17,21 @@ namespace Math
 		return Vector2(XMVector2Normalize(*this));
 	}
 
+	float Vector2::length(Precision::Fast) const
+	{
+		return XMVectorGetX(length_from_squared(XMVector2LengthSq(*this), Precision::FAST));
+	}
+
+	void Vector2::normalise(Precision::Fast)
+	{
+		*this = XMVectorMultiply(*this, reciprocal_length(XMVector2LengthSq(*this), Precision::FAST));
+	}
+
+	Vector2 Vector2::normalise(Precision::Fast) const
+	{
+		return Vector2(XMVectorMultiply(*this, reciprocal_length(XMVector2LengthSq(*this), Precision::FAST)));
+	}
+
 	Vector2 Vector2::lerp(const Vector2& a, const Vector2& b, float t)
 	{
 		return Vector2(XMVectorLerp(a, b, t));
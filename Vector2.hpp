@@ -2,6 +2,8 @@
 #ifndef __MATHS_VECTOR2_HPP__
 #define __MATHS_VECTOR2_HPP__
 
+#include "Precision.hpp"
+
 namespace Math
 {
 	class Vector2 : public XMFLOAT2
@@ -105,6 +107,13 @@ namespace Math
 			return sqrtf(x * x + y * y);
 		}
 
+		float length(Precision::Fast) const;
+
+		float length(Precision::Precise) const
+		{
+			return length();
+		}
+
 		float length_squared() const
 		{
 			return x * x + y * y;
@@ -114,6 +123,20 @@ namespace Math
 
 		Vector2 normalise() const;
 
+		void normalise(Precision::Fast);
+
+		Vector2 normalise(Precision::Fast) const;
+
+		void normalise(Precision::Precise)
+		{
+			normalise();
+		}
+
+		Vector2 normalise(Precision::Precise) const
+		{
+			return normalise();
+		}
+
 		//--------------------------------------------------------------------------
 		// Arithmetic Operators
 		//
@@ -29,6 +29,21 @@ namespace Math
 		return Vector3(XMVector3Normalize(*this));
 	}
 
+	float Vector3::length(Precision::Fast) const
+	{
+		return XMVectorGetX(length_from_squared(XMVector3LengthSq(*this), Precision::FAST));
+	}
+
+	void Vector3::normalise(Precision::Fast)
+	{
+		*this = XMVectorMultiply(*this, reciprocal_length(XMVector3LengthSq(*this), Precision::FAST));
+	}
+
+	Vector3 Vector3::normalise(Precision::Fast) const
+	{
+		return Vector3(XMVectorMultiply(*this, reciprocal_length(XMVector3LengthSq(*this), Precision::FAST)));
+	}
+
 	float Vector3::dot(const Vector3& v) const
 	{
 		return XMVectorGetX(XMVector3Dot(*this, v));
@@ -2,6 +2,8 @@
 #ifndef __MATHS_VECTOR3_HPP__
 #define __MATHS_VECTOR3_HPP__
 
+#include "Precision.hpp"
+
 namespace Math
 {
 	class Vector3 : public XMFLOAT3A
@@ -99,12 +101,33 @@ namespace Math
 
 		float length() const;
 
+		float length(Precision::Fast) const;
+
+		float length(Precision::Precise) const
+		{
+			return length();
+		}
+
 		float length_squared() const;
 
 		void normalise();
 
 		Vector3 normalise() const;
 
+		void normalise(Precision::Fast);
+
+		Vector3 normalise(Precision::Fast) const;
+
+		void normalise(Precision::Precise)
+		{
+			normalise();
+		}
+
+		Vector3 normalise(Precision::Precise) const
+		{
+			return normalise();
+		}
+
 		float dot(const Vector3& v) const;
 
 		Vector3 cross(const Vector3& v) const;
@@ -30,6 +30,21 @@ namespace Math
 		return Vector4(XMVector4Normalize(*this));
 	}
 
+	float Vector4::length(Precision::Fast) const
+	{
+		return XMVectorGetX(length_from_squared(XMVector4LengthSq(*this), Precision::FAST));
+	}
+
+	void Vector4::normalise(Precision::Fast)
+	{
+		*this = XMVectorMultiply(*this, reciprocal_length(XMVector4LengthSq(*this), Precision::FAST));
+	}
+
+	Vector4 Vector4::normalise(Precision::Fast) const
+	{
+		return Vector4(XMVectorMultiply(*this, reciprocal_length(XMVector4LengthSq(*this), Precision::FAST)));
+	}
+
 	float Vector4::dot(const Vector4& v) const
 	{
 		return XMVectorGetX(XMVector4Dot(*this, v));
@@ -2,6 +2,8 @@
 #ifndef __MATHS_VECTOR4_HPP__
 #define __MATHS_VECTOR4_HPP__
 
+#include "Precision.hpp"
+
 namespace Math
 {
 	class Vector4 : public XMFLOAT4A
@@ -100,12 +102,33 @@ namespace Math
 
 		float length() const;
 
+		float length(Precision::Fast) const;
+
+		float length(Precision::Precise) const
+		{
+			return length();
+		}
+
 		float length_squared() const;
 
 		void normalise();
 
 		Vector4 normalise() const;
 
+		void normalise(Precision::Fast);
+
+		Vector4 normalise(Precision::Fast) const;
+
+		void normalise(Precision::Precise)
+		{
+			normalise();
+		}
+
+		Vector4 normalise(Precision::Precise) const
+		{
+			return normalise();
+		}
+
 		float dot(const Vector4& v) const;
 
 		Vector4 cross(const Vector4& a, const Vector4& b) const;